@@ -0,0 +1,517 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+  #include <sys/resource.h>
+#endif
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+#include "viennashe/version.hpp"
+#include "viennashe/util/profiler.hpp"
+#include "viennashe/util/timer.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+
+/** \file she_scaling.cpp Benchmark of the scaling of SHE simulations
+ *
+ *  Creates one-, two- and three-dimensional resistors, pn-diodes and MOS structures of increasing size,
+ *  computes a drift-diffusion initial guess and then runs a fixed number of nonlinear SHE iterations
+ *  for each combination of expansion order, energy spacing and linear solver.
+ *  Assembly, elimination and solver times as well as throughputs (unknowns/s, nonzeros/s) are taken from
+ *  the profiler of the simulator and written as one CSV row per case, so that results can be compared across commits.
+ *  With --hardware-counters, instructions per cycle and last level cache misses of the calling thread are reported as well (Linux only, empty otherwise).
+ *
+ *  Usage: she_scaling-benchmark [--sweep=quick|full] [--output=file.csv] [--label=text] [--dims=123] [--iterations=N] [--hardware-counters]
+ */
+
+
+/** @brief Settings of a benchmark run, see usage above */
+struct benchmark_settings
+{
+  benchmark_settings() : full_sweep(false), output("she_scaling.csv"), label(""), dims("123"), iterations(2), hardware_counters(false) {}
+
+  bool          full_sweep;
+  std::string   output;
+  std::string   label;
+  std::string   dims;
+  std::size_t   iterations;
+  bool          hardware_counters;
+
+  std::vector<long> expansion_orders() const
+  {
+    std::vector<long> result;
+    result.push_back(1);
+    result.push_back(3);
+    if (full_sweep)
+    {
+      result.push_back(5);
+      result.push_back(7);
+    }
+    return result;
+  }
+
+  /** @brief Energy spacings in meV */
+  std::vector<double> energy_spacings() const
+  {
+    std::vector<double> result;
+    result.push_back(31.0);
+    if (full_sweep)
+      result.push_back(15.5);
+    return result;
+  }
+
+  std::vector<std::string> solvers() const
+  {
+    std::vector<std::string> result;
+    result.push_back("serial_linear_solver");
+    if (full_sweep)
+    {
+      result.push_back("parallel_linear_solver");
+      result.push_back("schwarz_linear_solver");
+    }
+    return result;
+  }
+
+  /** @brief Number of grid points in x-direction for each size level. The number of points in the other directions is derived from it. */
+  std::vector<std::size_t> sizes(std::size_t dim) const
+  {
+    std::size_t sizes_1d[] = { 101, 401, 1601 };
+    std::size_t sizes_2d[] = {  41,  81,  161 };
+    std::size_t sizes_3d[] = {   9,  13,   17 };
+    std::size_t * sizes = (dim == 1) ? sizes_1d : ((dim == 2) ? sizes_2d : sizes_3d);
+    return std::vector<std::size_t>(sizes, sizes + (full_sweep ? 3 : 1));
+  }
+};
+
+
+/** @brief Returns the peak resident set size of the process in MB (monotonic over the lifetime of the process) */
+inline double peak_rss_mb()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  #ifdef __APPLE__
+  return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);  // bytes
+  #else
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;             // kilobytes
+  #endif
+#endif
+}
+
+inline double per_second(double amount, double seconds) { return (seconds > 0) ? amount / seconds : 0.0; }
+
+
+//
+// Device setup
+//
+
+/** @brief Sets doping and contacts of a resistor or a pn-diode along the x-axis */
+template <typename DeviceType>
+void init_resistor_or_diode(DeviceType & device, double len_x, bool diode)
+{
+  typedef typename DeviceType::mesh_type           MeshType;
+
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  device.set_material(viennashe::materials::si());
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit  = cells.begin();
+                    cit != cells.end();
+                  ++cit)
+  {
+    const double x = viennagrid::centroid(*cit)[0];
+    const bool p_type = diode && (x > 0.5 * len_x);
+    device.set_doping_n(p_type ? 1e9  : 1e23, *cit);
+    device.set_doping_p(p_type ? 1e23 : 1e9,  *cit);
+
+    if (x < 0.05 * len_x)
+      device.set_contact_potential(0.0, *cit);
+    if (x > 0.95 * len_x)
+      device.set_contact_potential(diode ? -0.2 : 0.1, *cit);
+  }
+}
+
+/** @brief Sets up a one-dimensional MOS structure: gate metal, oxide, and a p-doped bulk with a contact at the end */
+template <typename DeviceType>
+void init_mos_1d(DeviceType & device, std::size_t points_x)
+{
+  const double len_gate  = 1e-9;
+  const double len_oxide = 2e-9;
+  const double len_bulk  = 100e-9;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0,                    len_gate,  3);
+  generator_params.add_segment(len_gate,               len_oxide, 11);
+  generator_params.add_segment(len_gate + len_oxide,   len_bulk,  static_cast<unsigned long>(points_x));
+  device.generate_mesh(generator_params);
+
+  device.set_material(viennashe::materials::metal(), device.segment(0));
+  device.set_material(viennashe::materials::sio2(),  device.segment(1));
+  device.set_material(viennashe::materials::si(),    device.segment(2));
+
+  device.set_doping_n(1e9,  device.segment(2));
+  device.set_doping_p(1e23, device.segment(2));
+
+  device.set_contact_potential(0.5, device.segment(0));
+
+  typedef typename DeviceType::mesh_type                                        MeshType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+    if (viennagrid::centroid(*cit)[0] > len_gate + len_oxide + 0.95 * len_bulk)
+      device.set_contact_potential(0.0, *cit);
+}
+
+/** @brief Sets up a two-dimensional MOSFET-like structure: Silicon body with n+ source and drain regions, gate oxide and gate metal on top.
+ *
+ * @param points_x   Number of grid points along the channel. (points_x - 1) must be divisible by four.
+ */
+template <typename DeviceType>
+void init_mosfet_2d(DeviceType & device, std::size_t points_x)
+{
+  const double len_x  = 100e-9;
+  const double len_y  =  25e-9;
+  const double t_ox   =   2e-9;
+  const double t_gate =   1e-9;
+  const unsigned long nx = static_cast<unsigned long>(points_x);
+  const unsigned long ny = static_cast<unsigned long>((points_x - 1) / 4 + 1);
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0,          0.0,                len_x,       len_y,  nx,              ny);
+  generator_params.add_segment(0.25 * len_x, len_y,              0.5 * len_x, t_ox,   (nx - 1) / 2 + 1, 3);
+  generator_params.add_segment(0.25 * len_x, len_y + t_ox,       0.5 * len_x, t_gate, (nx - 1) / 2 + 1, 2);
+  device.generate_mesh(generator_params);
+
+  device.set_material(viennashe::materials::si(),    device.segment(0));
+  device.set_material(viennashe::materials::sio2(),  device.segment(1));
+  device.set_material(viennashe::materials::metal(), device.segment(2));
+  device.set_contact_potential(0.8, device.segment(2));
+
+  typedef typename DeviceType::segment_type                                     SegmentType;
+  typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+  CellContainer cells(device.segment(0));
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    const double x = viennagrid::centroid(*cit)[0];
+    const double y = viennagrid::centroid(*cit)[1];
+    const bool n_plus = (x < 0.25 * len_x || x > 0.75 * len_x) && y > 0.5 * len_y;
+    device.set_doping_n(n_plus ? 1e25 : 1e9,  *cit);
+    device.set_doping_p(n_plus ? 1e9  : 1e23, *cit);
+
+    if (y > 0.9 * len_y && x < 0.1 * len_x)
+      device.set_contact_potential(0.0, *cit);  // source
+    else if (y > 0.9 * len_y && x > 0.9 * len_x)
+      device.set_contact_potential(0.5, *cit);  // drain
+    else if (y < 0.05 * len_y)
+      device.set_contact_potential(0.0, *cit);  // bulk
+  }
+}
+
+/** @brief Creates a structured hexahedral mesh of a cuboid with a single segment. Points are numbered lexicographically, as are the vertices of each hexahedron. */
+template <typename DeviceType>
+void generate_cuboid(DeviceType & device, double len_x, std::size_t nx, std::size_t ny, std::size_t nz)
+{
+  const double h = len_x / static_cast<double>(nx - 1);
+
+  std::vector<double> points;
+  for (std::size_t k=0; k<nz; ++k)
+    for (std::size_t j=0; j<ny; ++j)
+      for (std::size_t i=0; i<nx; ++i)
+      {
+        points.push_back(static_cast<double>(i) * h);
+        points.push_back(static_cast<double>(j) * h);
+        points.push_back(static_cast<double>(k) * h);
+      }
+
+  std::vector<unsigned long> cells;
+  for (std::size_t k=0; k+1<nz; ++k)
+    for (std::size_t j=0; j+1<ny; ++j)
+      for (std::size_t i=0; i+1<nx; ++i)
+        for (std::size_t dk=0; dk<2; ++dk)
+          for (std::size_t dj=0; dj<2; ++dj)
+            for (std::size_t di=0; di<2; ++di)
+              cells.push_back(static_cast<unsigned long>(((k + dk) * ny + (j + dj)) * nx + (i + di)));
+
+  viennashe::util::device_from_flat_array_generator<unsigned long> generator(&(points[0]), &(cells[0]), NULL,
+                                                                             static_cast<unsigned long>(points.size() / 3),
+                                                                             static_cast<unsigned long>(cells.size() / 8));
+  device.generate_mesh(generator);
+}
+
+
+//
+// Benchmark execution
+//
+
+/** @brief Writes the CSV header and one row per benchmark case. Rows are flushed immediately, so that partial results survive a crash. */
+class benchmark_report
+{
+  public:
+    benchmark_report(std::string const & filename, std::string const & label) : stream_(filename.c_str()), label_(label)
+    {
+      if (!stream_)
+        throw viennashe::io::cannot_open_file_exception(filename);
+      stream_ << "label,version,structure,dim,cells,expansion_order,energy_spacing_meV,linear_solver,iterations,"
+              << "unknowns,nonzeros,reduced_unknowns,reduced_nonzeros,"
+              << "assembly_s,assembly_unknowns_per_s,assembly_nonzeros_per_s,"
+              << "elimination_s,elimination_nonzeros_per_s,"
+              << "solve_s,solve_unknowns_per_s,solve_nonzeros_per_s,"
+              << "total_s,peak_rss_mb,"
+              << "assembly_ipc,assembly_llc_misses,elimination_ipc,elimination_llc_misses,solve_ipc,solve_llc_misses,status" << std::endl;
+    }
+
+    template <typename DeviceType>
+    void write(std::string const & structure, std::size_t dim, DeviceType const & device,
+               long L, double spacing_meV, std::string const & solver,
+               viennashe::util::profiler const & prof, double total_seconds, std::string const & status)
+    {
+      const std::string edf   = viennashe::quantity::electron_distribution_function();
+      const std::string iter  = "run/nonlinear_iteration";
+      const std::string assembly    = iter + "/assemble/" + edf;
+      const std::string elimination = iter + "/solve/" + edf + "/elimination";
+      const std::string solve       = iter + "/solve/" + edf + "/linear_solver";
+
+      std::size_t index = prof.find(iter);
+      std::size_t iterations = (index == viennashe::util::profiler::no_parent) ? 0 : prof.phases()[index].calls;
+      double its = iterations > 0 ? static_cast<double>(iterations) : 1.0;
+
+      stream_ << label_ << "," << viennashe::version() << "," << structure << "," << dim << "," << viennagrid::cells(device.mesh()).size() << ","
+              << L << "," << spacing_meV << "," << solver << "," << iterations << ","
+              << prof.counter(assembly, "unknowns") / its << "," << prof.counter(assembly, "nonzeros") / its << ","
+              << prof.counter(solve, "unknowns") / its << "," << prof.counter(solve, "nonzeros") / its << ","
+              << prof.seconds(assembly) << ","
+              << per_second(prof.counter(assembly, "unknowns"), prof.seconds(assembly)) << ","
+              << per_second(prof.counter(assembly, "nonzeros"), prof.seconds(assembly)) << ","
+              << prof.seconds(elimination) << ","
+              << per_second(prof.counter(elimination, "nonzeros"), prof.seconds(elimination)) << ","
+              << prof.seconds(solve) << ","
+              << per_second(prof.counter(solve, "unknowns"), prof.seconds(solve)) << ","
+              << per_second(prof.counter(solve, "nonzeros"), prof.seconds(solve)) << ","
+              << total_seconds << "," << peak_rss_mb() << ","
+              << hardware_figures(prof, assembly) << "," << hardware_figures(prof, elimination) << "," << hardware_figures(prof, solve) << ","
+              << status << std::endl;
+    }
+
+  private:
+    /** @brief Returns the instructions per cycle and the last level cache misses of a phase, or empty columns if no hardware events were recorded */
+    static std::string hardware_figures(viennashe::util::profiler const & prof, std::string const & phase)
+    {
+      if (prof.counter(phase, viennashe::util::hardware_event_name(viennashe::util::HARDWARE_CYCLES)) <= 0)
+        return ",";
+      std::ostringstream oss;
+      oss << prof.instructions_per_cycle(phase) << "," << prof.counter(phase, viennashe::util::hardware_event_name(viennashe::util::HARDWARE_LLC_MISSES));
+      return oss.str();
+    }
+
+    std::ofstream stream_;
+    std::string   label_;
+};
+
+/** @brief Removes characters from an error message which would break the CSV format */
+inline std::string sanitize(std::string str)
+{
+  for (std::size_t i=0; i<str.size(); ++i)
+    if (str[i] == ',' || str[i] == '\n' || str[i] == '"')
+      str[i] = ' ';
+  return str;
+}
+
+/** @brief Computes a drift-diffusion initial guess once, then runs the SHE simulations for all expansion orders, energy spacings and solvers */
+template <typename DeviceType>
+void run_structure(benchmark_settings const & settings, benchmark_report & report,
+                   std::string const & structure, std::size_t dim, DeviceType & device)
+{
+  std::cout << "* run_structure(): " << structure << " (" << dim << "D, " << viennagrid::cells(device.mesh()).size() << " cells)" << std::endl;
+
+  viennashe::config dd_cfg;
+  dd_cfg.with_electrons(true);
+  dd_cfg.with_holes(true);
+  dd_cfg.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.nonlinear_solver().max_iters(50);
+  dd_cfg.nonlinear_solver().damping(0.5);
+
+  viennashe::simulator<DeviceType> dd_simulator(device, dd_cfg);
+  dd_simulator.run();
+
+  std::vector<long>        orders   = settings.expansion_orders();
+  std::vector<double>      spacings = settings.energy_spacings();
+  std::vector<std::string> solvers  = settings.solvers();
+
+  for (std::size_t i=0; i<orders.size(); ++i)
+    for (std::size_t j=0; j<spacings.size(); ++j)
+      for (std::size_t k=0; k<solvers.size(); ++k)
+      {
+        viennashe::config config;
+        config.with_electrons(true);
+        config.with_holes(true);
+        config.set_electron_equation(viennashe::EQUATION_SHE);
+        config.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+        config.max_expansion_order(orders[i]);
+        config.energy_spacing(spacings[j] * viennashe::physics::constants::q / 1000.0);
+        config.linear_solver().set(solvers[k]);
+        config.nonlinear_solver().max_iters(settings.iterations);
+        config.nonlinear_solver().damping(1.0);
+
+        viennashe::simulator<DeviceType> she_simulator(device, config);
+        if (settings.hardware_counters && !she_simulator.profiler().enable_hardware_counters())
+          std::cout << "*   Hardware counters not available: " << she_simulator.profiler().hardware_counters_error() << std::endl;
+        she_simulator.set_initial_guess(viennashe::quantity::potential(),        dd_simulator.potential());
+        she_simulator.set_initial_guess(viennashe::quantity::electron_density(), dd_simulator.electron_density());
+        she_simulator.set_initial_guess(viennashe::quantity::hole_density(),     dd_simulator.hole_density());
+
+        std::string status = "ok";
+        viennashe::util::timer stopwatch;
+        stopwatch.start();
+        try
+        {
+          she_simulator.run();
+        }
+        catch (std::exception const & e)
+        {
+          status = "failed: " + sanitize(e.what());
+        }
+        double total_seconds = stopwatch.get();
+
+        std::cout << "*   L=" << orders[i] << ", dH=" << spacings[j] << " meV, " << solvers[k] << ": " << total_seconds << " s (" << status << ")" << std::endl;
+        report.write(structure, dim, device, orders[i], spacings[j], solvers[k], she_simulator.profiler(), total_seconds, status);
+      }
+}
+
+
+int main(int argc, char **argv)
+{
+  benchmark_settings settings;
+  for (int i=1; i<argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if      (arg == "--sweep=full")                 settings.full_sweep = true;
+    else if (arg == "--sweep=quick")                settings.full_sweep = false;
+    else if (arg.find("--output=") == 0)            settings.output = arg.substr(9);
+    else if (arg.find("--label=") == 0)             settings.label  = arg.substr(8);
+    else if (arg.find("--dims=") == 0)              settings.dims   = arg.substr(7);
+    else if (arg.find("--iterations=") == 0)        settings.iterations = static_cast<std::size_t>(std::atoi(arg.substr(13).c_str()));
+    else if (arg == "--hardware-counters")          settings.hardware_counters = true;
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--sweep=quick|full] [--output=file.csv] [--label=text] [--dims=123] [--iterations=N] [--hardware-counters]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << viennashe::preamble() << std::endl;
+
+  benchmark_report report(settings.output, sanitize(settings.label));
+
+  if (settings.dims.find('1') != std::string::npos)
+  {
+    typedef viennashe::device<viennagrid::line_1d_mesh>   DeviceType;
+    std::vector<std::size_t> sizes = settings.sizes(1);
+    for (std::size_t s=0; s<sizes.size(); ++s)
+    {
+      const double len_x = 1e-6;
+      viennashe::util::device_generation_config generator_params;
+      generator_params.add_segment(0.0, len_x, static_cast<unsigned long>(sizes[s]));
+
+      DeviceType resistor;
+      resistor.generate_mesh(generator_params);
+      init_resistor_or_diode(resistor, len_x, false);
+      run_structure(settings, report, "resistor", 1, resistor);
+
+      DeviceType diode;
+      diode.generate_mesh(generator_params);
+      init_resistor_or_diode(diode, len_x, true);
+      run_structure(settings, report, "diode", 1, diode);
+
+      DeviceType mos;
+      init_mos_1d(mos, sizes[s]);
+      run_structure(settings, report, "mos", 1, mos);
+    }
+  }
+
+  if (settings.dims.find('2') != std::string::npos)
+  {
+    typedef viennashe::device<viennagrid::quadrilateral_2d_mesh>   DeviceType;
+    std::vector<std::size_t> sizes = settings.sizes(2);
+    for (std::size_t s=0; s<sizes.size(); ++s)
+    {
+      const double len_x = 1e-6;
+      viennashe::util::device_generation_config generator_params;
+      generator_params.add_segment(0.0, 0.0, len_x, 0.25 * len_x, static_cast<unsigned long>(sizes[s]), static_cast<unsigned long>((sizes[s] - 1) / 4 + 1));
+
+      DeviceType resistor;
+      resistor.generate_mesh(generator_params);
+      init_resistor_or_diode(resistor, len_x, false);
+      run_structure(settings, report, "resistor", 2, resistor);
+
+      DeviceType diode;
+      diode.generate_mesh(generator_params);
+      init_resistor_or_diode(diode, len_x, true);
+      run_structure(settings, report, "diode", 2, diode);
+
+      DeviceType mosfet;
+      init_mosfet_2d(mosfet, sizes[s]);
+      run_structure(settings, report, "mosfet", 2, mosfet);
+    }
+  }
+
+  if (settings.dims.find('3') != std::string::npos)
+  {
+    typedef viennashe::device<viennagrid::hexahedral_3d_mesh>   DeviceType;
+    std::vector<std::size_t> sizes = settings.sizes(3);
+    for (std::size_t s=0; s<sizes.size(); ++s)
+    {
+      const double len_x = 1e-6;
+      const std::size_t n_yz = (sizes[s] - 1) / 2 + 1;
+
+      DeviceType resistor;
+      generate_cuboid(resistor, len_x, sizes[s], n_yz, n_yz);
+      init_resistor_or_diode(resistor, len_x, false);
+      run_structure(settings, report, "resistor", 3, resistor);
+
+      DeviceType diode;
+      generate_cuboid(diode, len_x, sizes[s], n_yz, n_yz);
+      init_resistor_or_diode(diode, len_x, true);
+      run_structure(settings, report, "diode", 3, diode);
+    }
+  }
+
+  std::cout << "* main(): Results written to " << settings.output << std::endl;
+
+  return EXIT_SUCCESS;
+}
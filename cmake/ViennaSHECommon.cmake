@@ -32,6 +32,10 @@ file(RELATIVE_PATH CONF_REL_INCLUDE_DIR "${INSTALL_CMAKE_DIR}"
 
 OPTION(BUILD_TESTING "Build the tests " ON)
 
+OPTION(BUILD_BENCHMARKS "Build the benchmarks" OFF)
+
+OPTION(ENABLE_PERFORMANCE_TESTS "Build and run the performance regression tests. Requires VIENNASHE_PERFORMANCE_BASELINE_DIR" OFF)
+
 ##OPTION(WITH_VSHE "Build the main ViennaSHE application" ON)
 
 OPTION(ENABLE_PYTHON_BINDINGS "Enable Python bindings. Requires SWIG 2.0" OFF)
@@ -40,6 +44,8 @@ OPTION(ENABLE_OPENCL "Enable OpenCL-accelerated solver" OFF)
 
 OPTION(ENABLE_OPENMP "Enable OpenMP-accelerated solver" OFF)
 
+OPTION(ENABLE_ZLIB "Enable zlib-compressed binary VTK output" OFF)
+
 # If you want to build the examples that use Eigen
 option(DISABLE_LOGGING "Disables all logging in ViennaSHE" OFF)
 
@@ -52,6 +58,12 @@ mark_as_advanced(DISABLE_LOGGING)
 # Find prerequisites
 ####################
 
+find_package(Threads REQUIRED)  # background output (viennashe/io/async_writer.hpp), asynchronous runs of libviennashe
+
+# std::thread, std::atomic and thread_local need C++11
+set(CMAKE_CXX_STANDARD 11)
+set(CMAKE_CXX_STANDARD_REQUIRED ON)
+
 if (ENABLE_OPENCL)
   INCLUDE_DIRECTORIES("external/")
   find_package(OpenCL)
@@ -66,6 +78,12 @@ if (ENABLE_OPENMP)
   ADD_DEFINITIONS( -DVIENNACL_WITH_OPENMP -DVIENNASHE_WITH_OPENMP )
 endif(ENABLE_OPENMP)
 
+if (ENABLE_ZLIB)
+  find_package(ZLIB REQUIRED)
+  INCLUDE_DIRECTORIES(${ZLIB_INCLUDE_DIRS})
+  ADD_DEFINITIONS( -DVIENNASHE_HAVE_ZLIB )
+endif(ENABLE_ZLIB)
+
 
 
 # ************************** Section 3: Miscellaneous compiler settings **************************
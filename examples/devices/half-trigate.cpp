@@ -157,12 +157,14 @@ int main()
       we load a mesh generated by Netgen. The spatial coordinates
       of the Netgen mesh are in nanometers, while ViennaSHE expects
       SI units (meter). Thus, we scale the mesh by a factor of \f$ 10^{-9} \f$.
+      Parsing the Netgen file takes a while, hence the mesh is stored in a binary cache
+      in the working directory after the first run and reloaded from there as long as the mesh file is unchanged.
   **/
   std::cout << "* main(): Creating and scaling device..." << std::endl;
   DeviceType device;
   try
   {
-    device.load_mesh("../examples/data/half-trigate57656.mesh");
+    viennashe::io::load_mesh_cached(device, "../examples/data/half-trigate57656.mesh", "half-trigate57656.mesh.cache");
   }
   catch (std::runtime_error const & e)
   {
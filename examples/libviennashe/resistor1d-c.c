@@ -101,6 +101,19 @@ void print_potential(viennashe_device dev, viennashe_quan_register reg)
   }
 }
 
+/** @brief Prints the electrostatic potential profile to stdout without copying the values (zero-copy view) */
+void print_potential_view(viennashe_simulator sim)
+{
+  viennashe_quantity_view view;
+  viennashe_index_type i = 0;
+
+  /* The view refers to the storage of the simulator and is valid until the simulator is run again or freed */
+  if (viennashe_get_cell_based_quantity_view(sim, "Electrostatic potential", &view) == 0)
+  {
+    for (i = 0; i < view.len; ++i)
+      printf("%2ld => %e\n", i, view.values[i * view.stride]);
+  }
+}
 
 /*
  *
@@ -174,6 +187,8 @@ int main()
 
   print_quan_info(reg);
 
+  print_potential_view(sim_dd);
+
   /* print_potential(dom, reg); */
 
   /* Write solution to CSV files for gnuplot */
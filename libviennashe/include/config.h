@@ -32,7 +32,8 @@ typedef viennashe_config_impl* viennashe_config; /*! The simulator configuration
 
 /** @brief Enum of available linear solvers */
 typedef enum { viennashe_linear_solver_dense, viennashe_linear_solver_serial,
-               viennashe_linear_solver_parallel, viennashe_linear_solver_gpu_parallel } viennashe_linear_solver_id;
+               viennashe_linear_solver_parallel, viennashe_linear_solver_gpu_parallel,
+               viennashe_linear_solver_schwarz } viennashe_linear_solver_id;
 
 /** @brief Enum of available non-linear solvers*/
 typedef enum { viennashe_nonlinear_solver_gummel, viennashe_nonlinear_solver_newton } viennashe_nonlinear_solver_id;
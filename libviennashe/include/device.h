@@ -35,6 +35,7 @@ typedef enum { viennashe_line_1d,
 
 
 typedef viennashe_device_impl*        viennashe_device; /*! The device! */
+typedef viennashe_prepared_device_impl* viennashe_prepared_device; /*! A device shared by simulators, cf. viennashe_prepare_device() */
 
 /*
 // Functions
@@ -51,6 +52,34 @@ VIENNASHE_EXPORT viennasheErrorCode viennashe_set_contact_potential_cells(vienna
 VIENNASHE_EXPORT viennasheErrorCode viennashe_set_contact_potential_segment(viennashe_device dev, double   value, viennashe_index_type   segment_id);
 
 
+/* **************** */
+/* Prepared devices */
+/* **************** */
+
+/**
+ * @brief Prepares a device for the use by many simulators (cf. viennashe_create_simulator_on_prepared_device()), e.g. in parameter sweeps.
+ *
+ * The mesh, materials, doping and traps of the device are shared by all simulators instead of being prepared per simulator, and the doping
+ * next to the contacts is smoothed once. The SHE coupling matrices are computed once per maximum expansion order and shared as well. Simulators on a prepared device may run concurrently. Biases are set per simulator with
+ * viennashe_set_simulator_contact_potential_cells() or viennashe_set_simulator_contact_potential_segment().
+ *
+ * The device data is moved into the prepared device, which cannot be modified afterwards. The device dev is left empty, but still has to be freed.
+ * @param prep Pointer to the result
+ * @param dev  A valid device
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_prepare_device(viennashe_prepared_device * prep, viennashe_device dev);
+
+/** @brief Frees the prepared device. The device is destroyed along with the last simulator operating on it. */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_free_prepared_device(viennashe_prepared_device prep);
+
+/**
+ * @brief Returns a handle to the device of a prepared device for the mesh getters and the quantity preallocation
+ *
+ * The handle is owned by the prepared device and valid until it is freed. The device must neither be modified nor freed!
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_prepared_device(viennashe_prepared_device prep, viennashe_device * dev);
+
+
 /* *************** */
 /* Device creators */
 /* *************** */
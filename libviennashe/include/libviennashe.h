@@ -49,6 +49,7 @@ VIENNASHE_EXPORT viennasheErrorCode viennashe_finalize(void);
 #include "libviennashe/include/config.h"
 #include "libviennashe/include/simulator.h"
 #include "libviennashe/include/output.h"
+#include "libviennashe/include/result_file.h"
 
 
 
@@ -31,6 +31,9 @@ VIENNASHE_EXPORT  viennasheErrorCode viennashe_write_to_gnuplot(viennashe_quan_r
 
 VIENNASHE_EXPORT  viennasheErrorCode viennashe_write_she_results_to_gnuplot(viennashe_quan_register reg, viennashe_carrier_ids ctype, char const * filename);
 
+/** @brief Writes the same data as viennashe_write_she_results_to_gnuplot() as binary records of doubles (no comments, no block separators). Read with e.g. binary format="%7double" in 2d. */
+VIENNASHE_EXPORT  viennasheErrorCode viennashe_write_she_results_to_gnuplot_binary(viennashe_quan_register reg, viennashe_carrier_ids ctype, char const * filename);
+
 
 #ifdef	__cplusplus
 }
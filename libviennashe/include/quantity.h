@@ -55,6 +55,55 @@ VIENNASHE_EXPORT viennasheErrorCode viennashe_get_she_group_velocity (viennashe_
 /* ************** */
 
 
+/* ******************************************* */
+/* Zero-copy views                             */
+/*
+ * The views below refer to the storage of the simulator instead of copying the values. The pointers are borrowed:
+ * They must not be freed or written to, and they are only valid until the next call to viennashe_run(),
+ * viennashe_set_initial_guess(), viennashe_set_initial_guess_from_other_sim() or viennashe_free_simulator()
+ * for the same simulator. Views must not be accessed while viennashe_run() is in progress.
+ */
+
+/** @brief A read-only view of a cell based quantity. The value on the cell with ID i is values[i * stride]. */
+typedef struct
+{
+  const double *        values;  /*!< Borrowed pointer to the value on the first cell */
+  viennashe_index_type  len;     /*!< Number of cells */
+  viennashe_index_type  stride;  /*!< Distance between the values of consecutive cells in units of double */
+} viennashe_quantity_view;
+
+/**
+ * @brief Returns a view of a quantity solved for by the simulator: potential, carrier densities, density gradient corrections, lattice temperature
+ * @param sim   The simulator
+ * @param name  The name of the quantity as used by viennashe_get_cell_based_quantity(), e.g. "Electrostatic potential"
+ * @param view  Pointer to the result
+ * @return 2 if the quantity is not stored as an array by the simulator (use viennashe_get_cell_based_quantity() instead)
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_cell_based_quantity_view(viennashe_simulator sim, char const * name, viennashe_quantity_view * view);
+
+/**
+ * @brief Returns the dimensions of the even SHE coefficients of a carrier type: The number of cells and of discrete total energies per cell
+ * @param sim          The simulator
+ * @param ctype        The carrier type
+ * @param num_cells    Pointer to the result. Zero if SHE is not used for the carrier type
+ * @param num_energies Pointer to the result
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_she_coefficients_size(viennashe_simulator sim, viennashe_carrier_ids ctype, viennashe_index_type * num_cells, viennashe_index_type * num_energies);
+
+/**
+ * @brief Returns a view of the even SHE coefficients on the (x,H)-node given by a cell and the index of the total energy.
+ *        The number of coefficients depends on the expansion order of the node, nodes outside the energy range carry none.
+ * @param sim      The simulator
+ * @param ctype    The carrier type
+ * @param cell_id  The ID of the cell
+ * @param index_H  The index of the total energy, less than num_energies of viennashe_get_she_coefficients_size()
+ * @param values   Pointer to the result, a borrowed pointer to the first coefficient. NULL if the node carries no coefficients
+ * @param len      Pointer to the result, the number of coefficients
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_she_coefficients_view(viennashe_simulator sim, viennashe_carrier_ids ctype,
+                                                                        viennashe_index_type cell_id, viennashe_index_type index_H,
+                                                                        const double ** values, viennashe_index_type * len);
+
 /* ******************************************* */
 /* Convenience functions for memory management */
 
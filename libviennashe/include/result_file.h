@@ -0,0 +1,66 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#ifndef LIBVIENNASHE_RESULT_FILE_H
+#define	LIBVIENNASHE_RESULT_FILE_H
+
+/* C includes */
+#include "libviennashe/include/sys.h"
+#include "libviennashe/include/error.h"
+#include "libviennashe/include/simulator.h"
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+/*  Types  */
+typedef viennashe_result_file_impl* viennashe_result_file;
+
+/** @brief Element types of arrays in a result file */
+typedef enum
+{
+  viennashe_result_float64 = 1,   /* double    */
+  viennashe_result_int64   = 2    /* long long */
+} viennashe_result_type_id;
+
+/*  Functions  */
+
+/** @brief Writes mesh, device data, spatial quantities and SHE coefficients of the simulator to a native (binary) result file */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_write_result_file(viennashe_simulator sim, char const * filename);
+
+/** @brief Opens (memory-maps) a result file for reading */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_open_result_file(viennashe_result_file * file, char const * filename);
+
+/** @brief Closes a result file. All data pointers obtained from the file become invalid. */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_close_result_file(viennashe_result_file file);
+
+/** @brief Returns the number of arrays in a result file */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_result_file_num_arrays(viennashe_result_file file, viennashe_index_type * num);
+
+/** @brief Returns the name of the array with the given index. The string is owned by the file. */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_result_file_array_name(viennashe_result_file file, viennashe_index_type index, char const ** name);
+
+/** @brief Returns the element type, the total number of values and the number of values per item of an array */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_result_file_array_info(viennashe_result_file file, char const * name,
+                                                                          viennashe_result_type_id * type, viennashe_index_type * size, viennashe_index_type * components);
+
+/** @brief Returns a pointer to the data of an array without copying. Valid until the file is closed. */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_result_file_array_data(viennashe_result_file file, char const * name, void const ** data);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif	/* LIBVIENNASHE_RESULT_FILE_H */
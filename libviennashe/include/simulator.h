@@ -32,9 +32,52 @@ extern "C"
 
 typedef viennashe_simulator_impl* viennashe_simulator;
 
+/** @brief The state of the nonlinear solver after an iteration of viennashe_run() */
+typedef struct
+{
+  viennashe_index_type iteration;              /*!< Number of the nonlinear iteration, starting with 1 */
+  viennashe_index_type max_iterations;         /*!< Maximum number of nonlinear iterations */
+  double residual_norm;                        /*!< Norm of the residual */
+  double potential_update_norm;                /*!< Norm of the update of the potential */
+  double total_update_norm;                    /*!< Norm of the update of all quantities */
+  double iteration_seconds;                    /*!< Wall-clock time of this iteration */
+  double elapsed_seconds;                      /*!< Wall-clock time since viennashe_run() was called */
+  viennashe_index_type num_unknowns;           /*!< Total number of unknowns */
+  viennashe_index_type electron_even_unknowns; /*!< Even unknowns of the electron distribution function (zero without SHE for electrons) */
+  viennashe_index_type electron_odd_unknowns;  /*!< Odd unknowns of the electron distribution function */
+  viennashe_index_type hole_even_unknowns;     /*!< Even unknowns of the hole distribution function (zero without SHE for holes) */
+  viennashe_index_type hole_odd_unknowns;      /*!< Odd unknowns of the hole distribution function */
+  libviennashe_bool    converged;              /*!< True if this is the last iteration, because the convergence criterion has been met */
+} viennashe_iteration_info;
+
+/** @brief Callback invoked after each nonlinear iteration. A nonzero return value cancels the simulation. */
+typedef int (*viennashe_iteration_callback)(const viennashe_iteration_info * info, void * user_data);
+
+/** @brief The state of the last simulation started by viennashe_run() or viennashe_run_async() */
+typedef enum
+{
+  viennashe_run_idle,       /*!< No simulation has been started yet */
+  viennashe_run_queued,     /*!< Started by viennashe_run_async(), waiting for a worker thread */
+  viennashe_run_running,    /*!< In progress */
+  viennashe_run_finished,   /*!< Finished, either converged or the maximum number of nonlinear iterations has been reached */
+  viennashe_run_cancelled,  /*!< Cancelled by viennashe_cancel() or by the iteration callback */
+  viennashe_run_failed      /*!< Failed, viennashe_wait() returns the error code */
+} viennashe_run_status;
+
 /*  Functions  */
 
 VIENNASHE_EXPORT viennasheErrorCode viennashe_create_simulator(viennashe_simulator * sim, viennashe_device dev, viennashe_config conf);
+
+/**
+ * @brief Creates a simulator on a prepared device (cf. viennashe_prepare_device()), which is shared with other simulators
+ *
+ * The simulator keeps the device alive and does not modify it. Biases differing from the contact potentials of the device are
+ * set with viennashe_set_simulator_contact_potential_cells() or viennashe_set_simulator_contact_potential_segment().
+ * The lattice heat equation is not available on a prepared device.
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_create_simulator_on_prepared_device(viennashe_simulator * sim, viennashe_prepared_device prep, viennashe_config conf);
+
+/* Cancels a queued or running simulation (cf. viennashe_cancel()) and waits for it before the simulator is destroyed */
 VIENNASHE_EXPORT viennasheErrorCode viennashe_free_simulator(viennashe_simulator sim);
 
 
@@ -42,14 +85,99 @@ VIENNASHE_EXPORT viennasheErrorCode viennashe_set_initial_guess_from_other_sim(v
 
 VIENNASHE_EXPORT viennasheErrorCode viennashe_set_initial_guess(viennashe_simulator sim, const char * name, double * values);
 
+/* Sets contact potentials for the simulator only, overriding the ones of the device, which is not modified. Allows for different biases on a shared device */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_set_simulator_contact_potential_cells(viennashe_simulator sim, viennashe_index_type * cell_ids, double * values, viennashe_index_type len);
+VIENNASHE_EXPORT viennasheErrorCode viennashe_set_simulator_contact_potential_segment(viennashe_simulator sim, double value, viennashe_index_type segment_id);
+
+/**
+ * @brief Runs the simulation and returns when it has finished or has been cancelled
+ * @return 2 if a simulation of the simulator is already queued or in progress
+ */
 VIENNASHE_EXPORT viennasheErrorCode viennashe_run(viennashe_simulator sim);
 
+/* Asynchronous execution */
+
+/*
+ * Simulations started by viennashe_run_async() are executed by a pool of worker threads of the library, one per hardware thread
+ * unless the environment variable VIENNASHE_ASYNC_WORKERS gives the number of threads. Simulators run concurrently as long as
+ * they do not share a device other than a prepared device (cf. viennashe_prepare_device()). While a simulation is queued or in
+ * progress, its simulator, device and configuration must not be modified, and only viennashe_poll_status(),
+ * viennashe_get_iteration_info(), viennashe_cancel() and viennashe_wait() may be called for the simulator.
+ * The iteration callback is invoked on the worker thread.
+ */
+
+/**
+ * @brief Queues the simulation for execution on a worker thread and returns immediately
+ * @return 2 if a simulation of the simulator is already queued or in progress
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_run_async(viennashe_simulator sim);
+
+/**
+ * @brief Waits until the simulation started by viennashe_run_async() has finished, has been cancelled or has failed
+ * @return The return value of the simulation as of viennashe_run(), 0 if no simulation has been started
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_wait(viennashe_simulator sim);
+
+/**
+ * @brief Returns the state of the simulation without blocking
+ * @param sim    The simulator
+ * @param status Pointer to the result
+ * @param info   Pointer to the result, the state of the last nonlinear iteration (cf. viennashe_get_iteration_info()). May be NULL
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_poll_status(viennashe_simulator sim, viennashe_run_status * status, viennashe_iteration_info * info);
+
+/**
+ * @brief Requests cancellation of a queued or running simulation and returns immediately. May be called from any thread, also during viennashe_run().
+ *
+ * A queued simulation is not started. A running simulation stops at the next boundary of a nonlinear iteration or of an iteration
+ * of the iterative linear solver, and keeps the solution of the last completed nonlinear update. Has no effect if no simulation is queued or running.
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_cancel(viennashe_simulator sim);
+
+/* Progress */
+
+/**
+ * @brief Registers a callback, which is invoked by viennashe_run() after each nonlinear iteration
+ * @param sim       The simulator
+ * @param callback  The callback. NULL removes a previously registered callback
+ * @param user_data Passed to the callback unchanged
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_set_iteration_callback(viennashe_simulator sim, viennashe_iteration_callback callback, void * user_data);
+
+/**
+ * @brief Returns the state of the last nonlinear iteration of the current or the last call to viennashe_run()
+ * @param sim       The simulator
+ * @param info      Pointer to the result. All members are zero if viennashe_run() has not been called yet
+ * @param cancelled Pointer to the result, true if the last call to viennashe_run() has been cancelled by the callback. May be NULL
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_iteration_info(viennashe_simulator sim, viennashe_iteration_info * info, libviennashe_bool * cancelled);
+
+/* Memory accounting */
+
+/**
+ * @brief Returns the peak memory in bytes accounted during the calls to viennashe_run() of a simulator
+ * @param sim      The simulator
+ * @param phase    The path of a phase of the simulator profiler, e.g. "run/nonlinear_iteration/assemble". NULL or "" for the whole run
+ * @param category The memory category, e.g. "system_matrix", "eliminated_matrix", "she_quantities", "quantity_history",
+ *                 "coupling_matrices" or "solver_workspace". NULL or "" for the total of all categories
+ * @param bytes    Pointer to the result. Zero if the phase or the category is unknown
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_get_peak_memory(viennashe_simulator sim, const char * phase, const char * category, double * bytes);
+
+/**
+ * @brief Predicts the memory in bytes of a simulation before the simulator is created
+ * @param dev             The device
+ * @param conf            The simulator configuration
+ * @param potential_range The expected difference between the maximum and the minimum potential in the semiconductor in Volt
+ * @param category        The memory category (see viennashe_get_peak_memory()). NULL or "" for the total of all categories
+ * @param bytes           Pointer to the result
+ */
+VIENNASHE_EXPORT viennasheErrorCode viennashe_estimate_memory(viennashe_device dev, viennashe_config conf, double potential_range, const char * category, double * bytes);
+
 /*
 // TODO:
 //
 // *) Time dependence
-//
-// Maybe: *) Status messages? Callbacks ??
 */
 
 
@@ -33,12 +33,18 @@ typedef enum { libviennashe_false=0, libviennashe_true } libviennashe_bool;
 /** @brief Device implementation type */
 typedef struct viennashe_device_impl     viennashe_device_impl;
 
+/** @brief Prepared device implementation type */
+typedef struct viennashe_prepared_device_impl viennashe_prepared_device_impl;
+
 /** @brief Simulator implementation type */
 typedef struct viennashe_simulator_impl  viennashe_simulator_impl;
 
 /** @brief Quantity register implementation type */
 typedef struct viennashe_quan_register_impl viennashe_quan_register_impl;
 
+/** @brief Result file implementation type */
+typedef struct viennashe_result_file_impl viennashe_result_file_impl;
+
 typedef unsigned long  viennashe_index_type;
 
 #ifdef	__cplusplus
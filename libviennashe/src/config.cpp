@@ -286,6 +286,9 @@ viennasheErrorCode viennashe_set_linear_solver_config    (viennashe_config conf,
       case viennashe_linear_solver_gpu_parallel:
         int_conf->linear_solver().set(viennashe::config::linear_solver_config_type::gpu_parallel_linear_solver);
         break;
+      case viennashe_linear_solver_schwarz:
+        int_conf->linear_solver().set(viennashe::config::linear_solver_config_type::schwarz_linear_solver);
+        break;
       default:
         viennashe::log::error() << "ERROR! set_linear_solver_config(): sol_id must be a valid solver id!" << std::endl;
         return 2;
@@ -499,6 +502,7 @@ viennasheErrorCode viennashe_get_linear_solver_config(viennashe_config conf, vie
     else if (int_conf->linear_solver().id() == viennashe::config::linear_solver_config_type::serial_linear_solver) *sol_id = viennashe_linear_solver_serial;
     else if (int_conf->linear_solver().id() == viennashe::config::linear_solver_config_type::parallel_linear_solver) *sol_id = viennashe_linear_solver_parallel;
     else if (int_conf->linear_solver().id() == viennashe::config::linear_solver_config_type::gpu_parallel_linear_solver) *sol_id = viennashe_linear_solver_gpu_parallel;
+    else if (int_conf->linear_solver().id() == viennashe::config::linear_solver_config_type::schwarz_linear_solver) *sol_id = viennashe_linear_solver_schwarz;
 
     *max_iters = static_cast<long>(int_conf->linear_solver().max_iters());
 
@@ -198,6 +198,100 @@ viennasheErrorCode viennashe_free_device(viennashe_device dev)
   return 0;
 }
 
+viennasheErrorCode viennashe_prepare_device(viennashe_prepared_device * prep, viennashe_device dev)
+{
+  try
+  {
+    //
+    // Checks
+    CHECK_ARGUMENT_FOR_NULL(prep,1,"prep");
+    CHECK_ARGUMENT_FOR_NULL(dev,2,"dev");
+
+    viennashe_device_impl * int_dev = (dev);
+
+    if (!int_dev->is_valid())
+    {
+      viennashe::log::error() << "ERROR! prepare_device(): The device (dev) must be valid!" << std::endl;
+      return 2;
+    }
+
+    //
+    // Smooth the doping next to the contacts once for all simulators (cf. viennashe::simulator)
+    switch (int_dev->stype)
+    {
+    case libviennashe::meshtype::line_1d:           viennashe::detail::smooth_doping_at_contacts(*int_dev->device_1d); break;
+    case libviennashe::meshtype::quadrilateral_2d:  viennashe::detail::smooth_doping_at_contacts(*int_dev->device_quad_2d); break;
+    case libviennashe::meshtype::triangular_2d:     viennashe::detail::smooth_doping_at_contacts(*int_dev->device_tri_2d); break;
+    case libviennashe::meshtype::hexahedral_3d:     viennashe::detail::smooth_doping_at_contacts(*int_dev->device_hex_3d); break;
+    case libviennashe::meshtype::tetrahedral_3d:    viennashe::detail::smooth_doping_at_contacts(*int_dev->device_tet_3d); break;
+    default:
+      viennashe::log::error() << "ERROR! prepare_device(): UNKOWN DEVICE TYPE!" << std::endl;
+      return -1;
+    }
+
+    //
+    // Move the device data, such that the caller cannot modify it anymore
+    std::shared_ptr<viennashe_device_impl> shared_dev(new viennashe_device_impl());
+    shared_dev->stype     = int_dev->stype;
+    shared_dev->device_1d = int_dev->device_1d; // all members of the union are pointers
+    int_dev->stype     = -1;
+    int_dev->device_1d = NULL;
+
+    // RETURN
+    *prep = new viennashe_prepared_device_impl(shared_dev);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! prepare_device(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_free_prepared_device(viennashe_prepared_device prep)
+{
+  try
+  {
+    if (prep != NULL)
+    {
+      // The device itself is destroyed with the last simulator operating on it
+      delete (prep);
+    }
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! free_prepared_device(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_prepared_device(viennashe_prepared_device prep, viennashe_device * dev)
+{
+  try
+  {
+    //
+    // Checks
+    CHECK_ARGUMENT_FOR_NULL(prep,1,"prep");
+    CHECK_ARGUMENT_FOR_NULL(dev,2,"dev");
+
+    if (!prep->is_valid())
+    {
+      viennashe::log::error() << "ERROR! get_prepared_device(): The prepared device (prep) must be valid!" << std::endl;
+      return 1;
+    }
+
+    // RETURN
+    *dev = prep->device.get();
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_prepared_device(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
 viennasheErrorCode viennashe_initalize_device(viennashe_device dev, viennashe_material_id * material_ids, double * doping_n, double * doping_p)
 {
   try
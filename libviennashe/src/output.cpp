@@ -99,9 +99,11 @@ namespace libviennashe
    * @param sim The SHE simulator
    * @param ctype The carrier type for which to write the results
    * @param filename The name of the gnuplot file (will be overwritten)
+   * @param format ASCII or binary (records of doubles without comments and block separators)
    */
   template < typename SimulatorT >
-  void write_she_to_gnuplot(SimulatorT const & sim, viennashe::carrier_type_id ctype, std::string filename)
+  void write_she_to_gnuplot(SimulatorT const & sim, viennashe::carrier_type_id ctype, std::string filename,
+                            viennashe::io::gnuplot_format_id format = viennashe::io::GNUPLOT_FORMAT_ASCII)
   {
     typedef typename SimulatorT::device_type DeviceType;
     typedef typename DeviceType::mesh_type   MeshType;
@@ -112,6 +114,7 @@ namespace libviennashe
 
     typedef typename SimulatorT::edf_type                              EDFType;
     typedef typename SimulatorT::generalized_edf_type                  GeneralizedEDFType;
+    typedef typename SimulatorT::she_quantity_type                     SHEQuantityType;
     typedef typename viennashe::config::dispersion_relation_type       DispersionRelationType;
 
     // Safety check
@@ -131,57 +134,123 @@ namespace libviennashe
     DispersionRelationType    disp   = conf.dispersion_relation(ctype);
     EDFType            edf  = sim.edf(ctype);
     GeneralizedEDFType gedf = sim.generalized_edf(ctype);
+    SHEQuantityType const & quan = sim.quantities().carrier_distribution_function(ctype);
 
+    viennashe::io::column_writer writer(filename, format);
 
-    std::ofstream writer(filename.c_str());
-
-    if (!writer)
-    {
-      throw viennashe::io::cannot_open_file_exception(filename);
-    }
+    writer.comment("# ViennaSHE - gnuplot output of SHE " + std::string((ctype == viennashe::ELECTRON_TYPE_ID) ? "Electron" : "Hole")
+                   + " Quantities in SI units unless otherwise noted");
+    writer.comment("# x_i are the vertex coordinates (meter)  ");
 
-    writer << "## ViennaSHE - gnuplot output of SHE "
-           << ((ctype == viennashe::ELECTRON_TYPE_ID) ? "Electron" : "Hole")
-           <<  " Quantities in SI units unless otherwise noted" << std::endl;
-    writer << "## x_i are the vertex coordinates (meter)  " << std::endl;
-
-    bool first = true;
+    std::string preamble = " ";
+    for (std::size_t i = 0; i < static_cast<std::size_t>(PointType::dim); ++i)
+      preamble += " x_" + std::string(1, static_cast<char>('0' + i)) + " ";
+    writer.comment(preamble + "     energy     edf      generalized_edf      dos      vg");
 
     CellContainer cells(device.mesh());
     for (CellIterator cit = cells.begin();
          cit != cells.end();
          ++cit)
     {
-      // Write preamble
-      if (first)
-      {
-        writer << "# ";
-        for (std::size_t i = 0; i < static_cast<std::size_t>(PointType::dim); ++i) writer << " x_" << i << " ";
-        writer << "     energy     edf      generalized_edf      dos      vg" << std::endl;
-        first = false;
-      }
+      PointType centroid = viennagrid::centroid(*cit);
 
       // Write values at point
-      for (std::size_t index_H = 1; index_H < sim.quantities().carrier_distribution_function(ctype).get_value_H_size()-1; ++index_H)
+      for (std::size_t index_H = 1; index_H < quan.get_value_H_size()-1; ++index_H)
       {
-        const double eps  = sim.quantities().carrier_distribution_function(ctype).get_kinetic_energy(*cit, index_H);
+        const double eps  = quan.get_kinetic_energy(*cit, index_H);
         const double dos  = disp.density_of_states(eps);
         const double velo = disp.velocity(eps);
 
         if (eps >= 0.0)
         {
-          for (std::size_t i = 0; i < static_cast<std::size_t>(PointType::dim); ++i) writer << viennagrid::centroid(*cit)[i] << " ";
-          writer << eps << " " << edf(*cit, eps, index_H) << " " << gedf(*cit, eps, index_H) << " " << dos << " " << velo << std::endl;
+          for (std::size_t i = 0; i < static_cast<std::size_t>(PointType::dim); ++i) writer << centroid[i];
+          writer << eps << edf(*cit, eps, index_H) << gedf(*cit, eps, index_H) << dos << velo;
+          writer.end_row();
         }
       }
 
-      writer << std::endl;
-      writer << std::endl;
+      writer.end_block();
     } // for vertices
 
+    writer.close();
+
     viennashe::log::info() << "* write_she_to_gnuplot(): Writing data to '"
       << filename
-      << "' (can be viewed with e.g. gnuplot)" << std::endl;
+      << "' (can be viewed with e.g. gnuplot"
+      << ((format == viennashe::io::GNUPLOT_FORMAT_BINARY) ? " using binary format=\"" + writer.gnuplot_binary_format() + "\"" : std::string())
+      << ")" << std::endl;
+  }
+
+  /** @brief Dispatches write_she_to_gnuplot() on the mesh type of the simulator. Returns false for an unknown mesh type. */
+  inline bool write_she_to_gnuplot_dispatch(viennashe_simulator_impl const & int_sim, viennashe::carrier_type_id ctype, std::string filename,
+                                            viennashe::io::gnuplot_format_id format)
+  {
+    if (int_sim.stype == libviennashe::meshtype::line_1d)
+      libviennashe::write_she_to_gnuplot(*(int_sim.sim1d), ctype, filename, format);
+    else if (int_sim.stype == libviennashe::meshtype::quadrilateral_2d)
+      libviennashe::write_she_to_gnuplot(*(int_sim.simq2d), ctype, filename, format);
+    else if (int_sim.stype == libviennashe::meshtype::triangular_2d)
+      libviennashe::write_she_to_gnuplot(*(int_sim.simt2d), ctype, filename, format);
+    else if (int_sim.stype == libviennashe::meshtype::hexahedral_3d)
+      libviennashe::write_she_to_gnuplot(*(int_sim.simh3d), ctype, filename, format);
+    else if (int_sim.stype == libviennashe::meshtype::tetrahedral_3d)
+      libviennashe::write_she_to_gnuplot(*(int_sim.simt3d), ctype, filename, format);
+    else
+      return false;
+    return true;
+  }
+
+  /** @brief Implementation of viennashe_write_she_results_to_gnuplot() and viennashe_write_she_results_to_gnuplot_binary() */
+  inline viennasheErrorCode write_she_results_to_gnuplot(viennashe_quan_register reg, viennashe_carrier_ids carriertype, char const * filename,
+                                                         viennashe::io::gnuplot_format_id format)
+  {
+    try
+    {
+      //
+      // CHECKS
+      if (reg == NULL)
+      {
+        viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: The quantity regiser (reg) must not be NULL!" << std::endl;
+        return 1;
+      }
+      if (filename == NULL)
+      {
+        viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: The filename must not be NULL!" << std::endl;
+        return 3;
+      }
+
+      // Get the internal structure
+      libviennashe::quan_register_internal * int_reg = reinterpret_cast<libviennashe::quan_register_internal *>(reg);
+      // Get internal simulator
+      viennashe_simulator_impl const * int_sim = int_reg->int_sim;
+      // More checks
+      if (!int_sim->is_valid())
+      {
+        viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot(): The simulator (sim) must be valid!" << std::endl;
+        return 1;
+      }
+
+      viennashe::carrier_type_id ctype = ((carriertype == viennashe_electron_id) ? viennashe::ELECTRON_TYPE_ID : viennashe::HOLE_TYPE_ID);
+
+      // Do the actual work
+      if (!libviennashe::write_she_to_gnuplot_dispatch(*int_sim, ctype, std::string(filename), format))
+      {
+        viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot(): Unkown grid type!" << std::endl;
+        return -2;
+      }
+    }
+    catch (std::exception const & ex)
+    {
+      viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: Exception!" << std::endl;
+      viennashe::log::error() << "What? " << ex.what() << std::endl;
+      return -1;
+    }
+    catch (...)
+    {
+      viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: UNKOWN ERROR!" << std::endl;
+      return -1;
+    }
+    return 0;
   }
 
 } // namespace libviennashe
@@ -269,67 +338,12 @@ viennasheErrorCode viennashe_write_to_gnuplot(viennashe_quan_register reg, char
 
 VIENNASHE_EXPORT  viennasheErrorCode viennashe_write_she_results_to_gnuplot(viennashe_quan_register reg, viennashe_carrier_ids carriertype, char const * filename)
 {
-  try
-  {
-    //
-    // CHECKS
-    if (reg == NULL)
-    {
-      viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: The quantity regiser (reg) must not be NULL!" << std::endl;
-      return 1;
-    }
-    if (filename == NULL)
-    {
-      viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: The filename must not be NULL!" << std::endl;
-      return 3;
-    }
-
-    // Get the internal structure
-    libviennashe::quan_register_internal * int_reg = reinterpret_cast<libviennashe::quan_register_internal *>(reg);
-    // Get internal simulator
-    viennashe_simulator_impl const * int_sim = int_reg->int_sim;
-    // More checks
-    if (!int_sim->is_valid())
-    {
-      viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot(): The simulator (sim) must be valid!" << std::endl;
-      return 1;
-    }
-
-    viennashe::carrier_type_id ctype = ((carriertype == viennashe_electron_id) ? viennashe::ELECTRON_TYPE_ID : viennashe::HOLE_TYPE_ID);
+  return libviennashe::write_she_results_to_gnuplot(reg, carriertype, filename, viennashe::io::GNUPLOT_FORMAT_ASCII);
+}
 
-    // Do the actual work
-    if (int_sim->stype == libviennashe::meshtype::line_1d)
-    {
-      libviennashe::write_she_to_gnuplot(*(int_sim->sim1d), ctype, std::string(filename));
-    }
-    else if (int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
-    {
-      libviennashe::write_she_to_gnuplot(*(int_sim->simq2d), ctype, std::string(filename));
-    }
-    else if (int_sim->stype == libviennashe::meshtype::triangular_2d)
-    {
-      libviennashe::write_she_to_gnuplot(*(int_sim->simt2d), ctype, std::string(filename));
-    }
-    else if (int_sim->stype == libviennashe::meshtype::hexahedral_3d)
-    {
-      libviennashe::write_she_to_gnuplot(*(int_sim->simh3d), ctype, std::string(filename));
-    }
-    else if (int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
-    {
-      libviennashe::write_she_to_gnuplot(*(int_sim->simt3d), ctype, std::string(filename));
-    }
-    else
-    {
-      viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot(): Unkown grid type!" << std::endl;
-      return -2;
-    }
-  }
-  catch (...)
-  {
-    viennashe::log::error() << "ERROR! viennashe_write_she_results_to_gnuplot: UNKOWN ERROR!" << std::endl;
-    return -1;
-  }
-  return 0;
+VIENNASHE_EXPORT  viennasheErrorCode viennashe_write_she_results_to_gnuplot_binary(viennashe_quan_register reg, viennashe_carrier_ids carriertype, char const * filename)
+{
+  return libviennashe::write_she_results_to_gnuplot(reg, carriertype, filename, viennashe::io::GNUPLOT_FORMAT_BINARY);
 }
 
 
@@ -335,6 +335,146 @@ VIENNASHE_EXPORT viennasheErrorCode viennashe_get_she_group_velocity(viennashe_q
 }
 
 
+viennasheErrorCode viennashe_get_cell_based_quantity_view(viennashe_simulator sim, char const * name, viennashe_quantity_view * view)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(name,2,"name");
+    CHECK_ARGUMENT_FOR_NULL(view,3,"view");
+
+    viennashe_simulator_impl * int_sim = sim;
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! viennashe_get_cell_based_quantity_view(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    bool found = false;
+    if (int_sim->stype == libviennashe::meshtype::line_1d)
+      found = libviennashe::get_quantity_view(*(int_sim->sim1d), std::string(name), *view);
+    else if (int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      found = libviennashe::get_quantity_view(*(int_sim->simq2d), std::string(name), *view);
+    else if (int_sim->stype == libviennashe::meshtype::triangular_2d)
+      found = libviennashe::get_quantity_view(*(int_sim->simt2d), std::string(name), *view);
+    else if (int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      found = libviennashe::get_quantity_view(*(int_sim->simh3d), std::string(name), *view);
+    else if (int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      found = libviennashe::get_quantity_view(*(int_sim->simt3d), std::string(name), *view);
+    else
+    {
+      viennashe::log::error() << "ERROR! viennashe_get_cell_based_quantity_view(): Malconfigured simulator!" << std::endl;
+      return 1;
+    }
+
+    if (!found)
+    {
+      viennashe::log::error() << "ERROR: viennashe_get_cell_based_quantity_view(): The quantity '" << name << "' is not stored by the simulator." << std::endl;
+      return 2;
+    }
+  }
+  catch (...)
+  {
+    viennashe::log::error() << "ERROR: viennashe_get_cell_based_quantity_view(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_she_coefficients_size(viennashe_simulator sim, viennashe_carrier_ids ctype, viennashe_index_type * num_cells, viennashe_index_type * num_energies)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(num_cells,3,"num_cells");
+    CHECK_ARGUMENT_FOR_NULL(num_energies,4,"num_energies");
+
+    viennashe_simulator_impl * int_sim = sim;
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! viennashe_get_she_coefficients_size(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    viennashe::carrier_type_id arg_ctype = (ctype == viennashe_electron_id) ? viennashe::ELECTRON_TYPE_ID : viennashe::HOLE_TYPE_ID;
+
+    if (int_sim->stype == libviennashe::meshtype::line_1d)
+      libviennashe::get_she_coefficients_size(*(int_sim->sim1d), arg_ctype, num_cells, num_energies);
+    else if (int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      libviennashe::get_she_coefficients_size(*(int_sim->simq2d), arg_ctype, num_cells, num_energies);
+    else if (int_sim->stype == libviennashe::meshtype::triangular_2d)
+      libviennashe::get_she_coefficients_size(*(int_sim->simt2d), arg_ctype, num_cells, num_energies);
+    else if (int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      libviennashe::get_she_coefficients_size(*(int_sim->simh3d), arg_ctype, num_cells, num_energies);
+    else if (int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      libviennashe::get_she_coefficients_size(*(int_sim->simt3d), arg_ctype, num_cells, num_energies);
+    else
+    {
+      viennashe::log::error() << "ERROR! viennashe_get_she_coefficients_size(): Malconfigured simulator!" << std::endl;
+      return 1;
+    }
+  }
+  catch (...)
+  {
+    viennashe::log::error() << "ERROR: viennashe_get_she_coefficients_size(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_she_coefficients_view(viennashe_simulator sim, viennashe_carrier_ids ctype,
+                                                       viennashe_index_type cell_id, viennashe_index_type index_H,
+                                                       const double ** values, viennashe_index_type * len)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(values,5,"values");
+    CHECK_ARGUMENT_FOR_NULL(len,6,"len");
+
+    viennashe_simulator_impl * int_sim = sim;
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! viennashe_get_she_coefficients_view(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    viennashe::carrier_type_id arg_ctype = (ctype == viennashe_electron_id) ? viennashe::ELECTRON_TYPE_ID : viennashe::HOLE_TYPE_ID;
+    std::size_t cell = static_cast<std::size_t>(cell_id);
+    std::size_t idx_H = static_cast<std::size_t>(index_H);
+
+    bool in_range = false;
+    if (int_sim->stype == libviennashe::meshtype::line_1d)
+      in_range = libviennashe::get_she_coefficients_view(*(int_sim->sim1d), arg_ctype, cell, idx_H, values, len);
+    else if (int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      in_range = libviennashe::get_she_coefficients_view(*(int_sim->simq2d), arg_ctype, cell, idx_H, values, len);
+    else if (int_sim->stype == libviennashe::meshtype::triangular_2d)
+      in_range = libviennashe::get_she_coefficients_view(*(int_sim->simt2d), arg_ctype, cell, idx_H, values, len);
+    else if (int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      in_range = libviennashe::get_she_coefficients_view(*(int_sim->simh3d), arg_ctype, cell, idx_H, values, len);
+    else if (int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      in_range = libviennashe::get_she_coefficients_view(*(int_sim->simt3d), arg_ctype, cell, idx_H, values, len);
+    else
+    {
+      viennashe::log::error() << "ERROR! viennashe_get_she_coefficients_view(): Malconfigured simulator!" << std::endl;
+      return 1;
+    }
+
+    if (!in_range)
+    {
+      viennashe::log::error() << "ERROR: viennashe_get_she_coefficients_view(): Cell " << cell_id << " or energy index " << index_H << " out of range." << std::endl;
+      return 3;
+    }
+  }
+  catch (...)
+  {
+    viennashe::log::error() << "ERROR: viennashe_get_she_coefficients_view(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+
 VIENNASHE_EXPORT viennasheErrorCode viennashe_prealloc_cell_based_quantity(viennashe_device dev, double *** uarray, viennashe_index_type ** len)
 {
   try
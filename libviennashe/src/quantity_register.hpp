@@ -354,6 +354,70 @@ namespace libviennashe
   } // register_quans
 
 
+  /**
+   * @brief Sets up a view of an unknown quantity of the simulator without copying the values
+   * @param sim The simulator
+   * @param name The name of the quantity
+   * @param view Return value. The view of the quantity
+   * @return False if the simulator has no unknown quantity of the given name
+   */
+  template < typename SimulatorT >
+  bool get_quantity_view(SimulatorT const & sim, std::string const & name, viennashe_quantity_view & view)
+  {
+    for (std::size_t i=0; i<sim.quantities().unknown_quantities().size(); ++i)
+    {
+      if (sim.quantities().unknown_quantities()[i].get_name() != name)
+        continue;
+
+      std::vector<double> const & values = sim.quantities().unknown_quantities()[i].values();
+      view.values = values.empty() ? NULL : &(values[0]);
+      view.len    = static_cast<viennashe_index_type>(values.size());
+      view.stride = 1;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * @brief Returns the number of cells and energies of the SHE quantity of a carrier type
+   * @param sim The simulator
+   * @param ctype The carrier type
+   * @param num_cells Return value. Zero if SHE is not used for the carrier type
+   * @param num_energies Return value
+   */
+  template < typename SimulatorT >
+  void get_she_coefficients_size(SimulatorT const & sim, viennashe::carrier_type_id ctype, viennashe_index_type * num_cells, viennashe_index_type * num_energies)
+  {
+    typename SimulatorT::she_quantity_type const & quan = sim.quantities().carrier_distribution_function(ctype);
+    *num_cells    = static_cast<viennashe_index_type>(quan.get_value_H_size() > 0 ? quan.get_size1() : 0);
+    *num_energies = static_cast<viennashe_index_type>(quan.get_value_H_size());
+  }
+
+  /**
+   * @brief Sets up a view of the even SHE coefficients on a (x,H)-node without copying the values
+   * @param sim The simulator
+   * @param ctype The carrier type
+   * @param cell_id The ID of the cell
+   * @param index_H The index of the total energy
+   * @param values Return value. Pointer to the coefficients, NULL if there are none
+   * @param len Return value. The number of coefficients
+   * @return False if the cell or the energy index is out of range
+   */
+  template < typename SimulatorT >
+  bool get_she_coefficients_view(SimulatorT const & sim, viennashe::carrier_type_id ctype, std::size_t cell_id, std::size_t index_H,
+                                 double const ** values, viennashe_index_type * len)
+  {
+    typename SimulatorT::she_quantity_type const & quan = sim.quantities().carrier_distribution_function(ctype);
+    if (cell_id >= quan.get_size1() || index_H >= quan.get_value_H_size())
+      return false;
+
+    std::vector<double> const & coefficients = quan.get_values_by_id(cell_id, index_H);
+    *values = coefficients.empty() ? NULL : &(coefficients[0]);
+    *len    = static_cast<viennashe_index_type>(coefficients.size());
+    return true;
+  }
+
+
   /**
    * @brief Fills the given C-arrays with the EDF at a vertex
    * @param quan The SHE quantities
@@ -0,0 +1,219 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// C++ includes
+#include "viennashe_all.hpp"
+
+// C includes
+#include "libviennashe/include/result_file.h"
+
+
+/** @brief Internal C++ to C wrapper for a memory-mapped result file. Has a typedef in the C header. */
+struct viennashe_result_file_impl
+{
+  viennashe_result_file_impl(std::string const & filename) : reader(filename) {}
+
+  viennashe::io::result_file_reader reader;
+};
+
+
+#ifdef	__cplusplus
+extern "C"
+{
+#endif
+
+viennasheErrorCode viennashe_write_result_file(viennashe_simulator sim, char const * filename)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(filename,2,"filename");
+
+    viennashe_simulator_impl * int_sim = sim;
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! write_result_file(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    if(int_sim->stype == libviennashe::meshtype::line_1d)
+    {
+      viennashe::io::write_result_file(int_sim->sim1d->device(), int_sim->sim1d->quantities(), filename);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+    {
+      viennashe::io::write_result_file(int_sim->simq2d->device(), int_sim->simq2d->quantities(), filename);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+    {
+      viennashe::io::write_result_file(int_sim->simt2d->device(), int_sim->simt2d->quantities(), filename);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+    {
+      viennashe::io::write_result_file(int_sim->simh3d->device(), int_sim->simh3d->quantities(), filename);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+    {
+      viennashe::io::write_result_file(int_sim->simt3d->device(), int_sim->simt3d->quantities(), filename);
+    }
+    else
+    {
+      viennashe::log::error() << "ERROR! write_result_file(): Unkown grid type!" << std::endl;
+      return 1;
+    }
+  }
+  catch(std::exception const & ex)
+  {
+    viennashe::log::error() << "ERROR! write_result_file(): " << ex.what() << std::endl;
+    return -1;
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! write_result_file(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_open_result_file(viennashe_result_file * file, char const * filename)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(file,1,"file");
+    CHECK_ARGUMENT_FOR_NULL(filename,2,"filename");
+
+    *file = new viennashe_result_file_impl(filename);
+  }
+  catch(std::exception const & ex)
+  {
+    viennashe::log::error() << "ERROR! open_result_file(): " << ex.what() << std::endl;
+    return -1;
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! open_result_file(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_close_result_file(viennashe_result_file file)
+{
+  try
+  {
+    if (file != NULL)
+      delete file;
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! close_result_file(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_result_file_num_arrays(viennashe_result_file file, viennashe_index_type * num)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(file,1,"file");
+    CHECK_ARGUMENT_FOR_NULL(num,2,"num");
+
+    *num = static_cast<viennashe_index_type>(file->reader.num_arrays());
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_result_file_num_arrays(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_result_file_array_name(viennashe_result_file file, viennashe_index_type index, char const ** name)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(file,1,"file");
+    CHECK_ARGUMENT_FOR_NULL(name,3,"name");
+
+    if (index >= file->reader.num_arrays())
+    {
+      viennashe::log::error() << "ERROR! get_result_file_array_name(): The index (index) is out of range!" << std::endl;
+      return 2;
+    }
+
+    *name = file->reader.entry(static_cast<std::size_t>(index)).name;
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_result_file_array_name(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_result_file_array_info(viennashe_result_file file, char const * name,
+                                                         viennashe_result_type_id * type, viennashe_index_type * size, viennashe_index_type * components)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(file,1,"file");
+    CHECK_ARGUMENT_FOR_NULL(name,2,"name");
+
+    if (!file->reader.has_array(name))
+    {
+      viennashe::log::error() << "ERROR! get_result_file_array_info(): No array '" << name << "' in the file!" << std::endl;
+      return 2;
+    }
+
+    viennashe::io::result_file_index_entry const & entry = file->reader.entry(std::string(name));
+    if (type != NULL)       *type       = static_cast<viennashe_result_type_id>(entry.type);
+    if (size != NULL)       *size       = static_cast<viennashe_index_type>(entry.size);
+    if (components != NULL) *components = static_cast<viennashe_index_type>(entry.components);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_result_file_array_info(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_result_file_array_data(viennashe_result_file file, char const * name, void const ** data)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(file,1,"file");
+    CHECK_ARGUMENT_FOR_NULL(name,2,"name");
+    CHECK_ARGUMENT_FOR_NULL(data,3,"data");
+
+    if (!file->reader.has_array(name))
+    {
+      viennashe::log::error() << "ERROR! get_result_file_array_data(): No array '" << name << "' in the file!" << std::endl;
+      return 2;
+    }
+
+    *data = file->reader.raw_data(name);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_result_file_array_data(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+#ifdef	__cplusplus
+}
+#endif
@@ -14,6 +14,7 @@
 
 // C++ includes
 #include "viennashe_all.hpp"
+#include "worker_pool.hpp"
 
 // C includes
 #include "libviennashe/include/simulator.h"
@@ -48,6 +49,286 @@ namespace libviennashe
     sim.set_initial_guess(name, tacc);
   }
 
+  /**
+   * @brief Sets the contact potentials per cell for the simulator only (cf. viennashe::simulator::set_contact_potential())
+   * @param sim The simulator
+   * @param cell_ids A C-array of cell ids
+   * @param values An array of contact potentials. Has to have the same length as cell_ids
+   * @param len The number of cells (length of cell_ids) for which to set the contact potential
+   */
+  template < typename SimulatorT >
+  void set_contact_potential(SimulatorT & sim, viennashe_index_type * cell_ids, double * values, viennashe_index_type len)
+  {
+    typedef typename SimulatorT::device_type::mesh_type   MeshType;
+
+    typedef typename viennagrid::result_of::const_cell_range<MeshType>::type     CellContainer;
+
+    CellContainer   cells(sim.device().mesh());
+
+    for (std::size_t i = 0; i < len; ++i)
+    {
+      const viennashe_index_type id = cell_ids[i];
+      if (id < cells.size())
+        sim.set_contact_potential(values[i], cells[id]);
+      else
+        viennashe::log::warn() << "WARNING! set_simulator_contact_potential(): Invalid cell id '" << id << "' ... skipping!" << std::endl;
+    }
+  }
+
+  /**
+   * @brief Sets the contact potential of a segment for the simulator only (cf. viennashe::simulator::set_contact_potential())
+   * @param sim The simulator
+   * @param segment_id An ID to a valid ViennaGrid segment on the current mesh
+   * @param value The contact potential (Volt!) to be set for all cells in the segment
+   */
+  template < typename SimulatorT >
+  void set_contact_potential(SimulatorT & sim, viennashe_index_type segment_id, double value)
+  {
+    if (segment_id < sim.device().segmentation().size())
+      sim.set_contact_potential(value, sim.device().segment(static_cast<int>(segment_id)));
+    else
+      viennashe::log::warn() << "WARNING! set_simulator_contact_potential(): Invalid segment id '" << segment_id << "' ... skipping!" << std::endl;
+  }
+
+  /**
+   * @brief Returns the peak memory accounted by the profiler of the simulator
+   * @param sim The simulator
+   * @param phase The path of the phase, empty for the whole run
+   * @param category The memory category, empty for the total
+   */
+  template < typename SimulatorT >
+  double get_peak_memory(SimulatorT const & sim, std::string const & phase, std::string const & category)
+  {
+    if (phase.empty() && category.empty())
+      return sim.profiler().peak_memory();
+    return sim.profiler().peak_memory(phase.empty() ? std::string("run") : phase, category);
+  }
+
+  /** @brief Copies the state of a nonlinear iteration to its C representation */
+  inline void to_iteration_info(viennashe::nonlinear_iteration_info const & src, viennashe_iteration_info & dest)
+  {
+    dest.iteration              = src.iteration;
+    dest.max_iterations         = src.max_iterations;
+    dest.residual_norm          = src.residual_norm;
+    dest.potential_update_norm  = src.potential_update_norm;
+    dest.total_update_norm      = src.total_update_norm;
+    dest.iteration_seconds      = src.iteration_seconds;
+    dest.elapsed_seconds        = src.elapsed_seconds;
+    dest.num_unknowns           = src.unknowns;
+    dest.electron_even_unknowns = src.electron_even_unknowns;
+    dest.electron_odd_unknowns  = src.electron_odd_unknowns;
+    dest.hole_even_unknowns     = src.hole_even_unknowns;
+    dest.hole_odd_unknowns      = src.hole_odd_unknowns;
+    dest.converged              = src.converged ? libviennashe_true : libviennashe_false;
+  }
+
+  /** @brief Adapts a C iteration callback and its user data to the iteration callback of the simulator */
+  class iteration_callback_adapter
+  {
+    public:
+      iteration_callback_adapter(viennashe_iteration_callback callback, void * user_data) : callback_(callback), user_data_(user_data) {}
+
+      bool operator()(viennashe::nonlinear_iteration_info const & info) const
+      {
+        viennashe_iteration_info c_info;
+        to_iteration_info(info, c_info);
+        return callback_(&c_info, user_data_) != 0;
+      }
+
+    private:
+      viennashe_iteration_callback callback_;
+      void * user_data_;
+  };
+
+  /**
+   * @brief Registers a C iteration callback with the simulator
+   * @param sim The simulator
+   * @param callback The callback, NULL to remove the callback
+   * @param user_data Passed to the callback
+   */
+  template < typename SimulatorT >
+  void set_iteration_callback(SimulatorT & sim, viennashe_iteration_callback callback, void * user_data)
+  {
+    if (callback)
+      sim.set_iteration_callback(iteration_callback_adapter(callback, user_data));
+    else
+      sim.set_iteration_callback(typename SimulatorT::iteration_callback_type());
+  }
+
+  /**
+   * @brief Returns the state of the last nonlinear iteration of the simulator
+   * @param sim The simulator
+   * @param info The result
+   * @param cancelled The result, true if the last run has been cancelled. May be NULL
+   */
+  template < typename SimulatorT >
+  void get_iteration_info(SimulatorT const & sim, viennashe_iteration_info & info, libviennashe_bool * cancelled)
+  {
+    to_iteration_info(sim.last_iteration(), info);
+    if (cancelled)
+      *cancelled = sim.cancelled() ? libviennashe_true : libviennashe_false;
+  }
+
+  /**
+   * @brief Requests or withdraws cancellation of the current run of the simulator
+   * @param sim The simulator
+   * @param request True to request cancellation, false to withdraw a pending request
+   */
+  template < typename SimulatorT >
+  void request_cancel(SimulatorT & sim, bool request)
+  {
+    if (request)
+      sim.cancel();
+    else
+      sim.clear_cancel_request();
+  }
+
+  /** @brief Calls run() of the simulator. Returns the error code of viennashe_run() */
+  inline viennasheErrorCode run_simulator(viennashe_simulator_impl * int_sim)
+  {
+    try
+    {
+      if(int_sim->stype == libviennashe::meshtype::line_1d)
+      {
+        int_sim->sim1d->run();
+      }
+      else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      {
+        int_sim->simq2d->run();
+      }
+      else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+      {
+        int_sim->simt2d->run();
+      }
+      else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      {
+        int_sim->simh3d->run();
+      }
+      else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      {
+        int_sim->simt3d->run();
+      }
+      else
+      {
+        viennashe::log::error() << "ERROR! run(): Unkown grid type!" << std::endl;
+        return -2;
+      }
+    }
+    catch(...)
+    {
+      viennashe::log::error() << "ERROR! run(): UNKOWN ERROR!" << std::endl;
+      return -1;
+    }
+    return 0;
+  }
+
+  /** @brief Requests (or withdraws) cancellation of the current run of the simulator */
+  inline void set_cancel_request(viennashe_simulator_impl * int_sim, bool request)
+  {
+    if(int_sim->stype == libviennashe::meshtype::line_1d)
+      request_cancel(*(int_sim->sim1d), request);
+    else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      request_cancel(*(int_sim->simq2d), request);
+    else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+      request_cancel(*(int_sim->simt2d), request);
+    else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      request_cancel(*(int_sim->simh3d), request);
+    else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      request_cancel(*(int_sim->simt3d), request);
+  }
+
+  /**
+   * @brief Marks a run as started. Returns false if a run of the simulator is already queued or in progress.
+   * @param int_sim The simulator
+   * @param status  viennashe_run_queued or viennashe_run_running
+   */
+  inline bool begin_run(viennashe_simulator_impl * int_sim, int status)
+  {
+    std::lock_guard<std::mutex> lock(int_sim->run->mutex);
+    if (int_sim->run->status == viennashe_run_queued || int_sim->run->status == viennashe_run_running)
+      return false;
+    int_sim->run->status = status;
+    int_sim->run->result = 0;
+    return true;
+  }
+
+  /** @brief Runs the simulation and records the result in the run state. The run must have been marked as running by the caller. */
+  inline viennasheErrorCode execute_run(viennashe_simulator_impl * int_sim)
+  {
+    viennasheErrorCode result = run_simulator(int_sim);
+
+    viennashe_iteration_info info;
+    libviennashe_bool cancelled = libviennashe_false;
+    viennashe_get_iteration_info(int_sim, &info, &cancelled);
+
+    std::shared_ptr<run_state> state = int_sim->run;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->result = result;
+      if (result != 0)
+        state->status = viennashe_run_failed;
+      else
+        state->status = cancelled ? viennashe_run_cancelled : viennashe_run_finished;
+      // A request made after run() has returned must not cancel the next run:
+      set_cancel_request(int_sim, false);
+    }
+    state->finished.notify_all();
+    return result;
+  }
+
+  /** @brief The job executed on a worker thread for viennashe_run_async(). Does not touch the simulator if the run has been cancelled while queued. */
+  inline void run_queued(std::shared_ptr<run_state> state, viennashe_simulator_impl * int_sim)
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->status != viennashe_run_queued)
+        return;
+      state->status = viennashe_run_running;
+    }
+    execute_run(int_sim);
+  }
+
+  /** @brief Marks a queued simulation as cancelled and wakes up the threads waiting for it. Used if the job is dropped from the queue of the worker pool. */
+  inline void discard_queued(std::shared_ptr<run_state> state)
+  {
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->status != viennashe_run_queued)
+        return;
+      state->status = viennashe_run_cancelled;
+      state->result = 0;
+    }
+    state->finished.notify_all();
+  }
+
+  /** @brief Cancels a queued or running simulation. A queued simulation is marked as cancelled right away. */
+  inline void cancel_run(viennashe_simulator_impl * int_sim)
+  {
+    std::shared_ptr<run_state> state = int_sim->run;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      if (state->status == viennashe_run_running)
+      {
+        set_cancel_request(int_sim, true);
+        return;
+      }
+      if (state->status != viennashe_run_queued)
+        return;
+      state->status = viennashe_run_cancelled;
+      state->result = 0;
+    }
+    state->finished.notify_all();
+  }
+
+  /** @brief Waits until the simulation is neither queued nor running. Returns the result of the run. */
+  inline viennasheErrorCode wait_for_run(viennashe_simulator_impl * int_sim)
+  {
+    std::shared_ptr<run_state> state = int_sim->run;
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state]{ return state->status != viennashe_run_queued && state->status != viennashe_run_running; });
+    return state->result;
+  }
+
 } // namespace libviennashe
 
 
@@ -118,12 +399,93 @@ viennasheErrorCode viennashe_create_simulator (viennashe_simulator * sim, vienna
   return 0;
 }
 
+viennasheErrorCode viennashe_create_simulator_on_prepared_device(viennashe_simulator * sim, viennashe_prepared_device prep, viennashe_config conf)
+{
+  try
+  {
+    //
+    // Checks
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(prep,2,"prep");
+    CHECK_ARGUMENT_FOR_NULL(conf,3,"conf");
+
+    if (!prep->is_valid())
+    {
+      viennashe::log::error() << "ERROR! create_simulator_on_prepared_device(): The prepared device (prep) must be valid!" << std::endl;
+      return 2;
+    }
+
+    // Get internal configuration and device
+    viennashe::config     * int_conf = reinterpret_cast<viennashe::config *>(conf);
+    viennashe_device_impl * int_dev  = prep->device.get();
+
+    // Create the internal simulator object, which keeps the device alive
+    std::unique_ptr<viennashe_simulator_impl> int_sim(new viennashe_simulator_impl(int_dev->stype, int_conf));
+    int_sim->shared_device = prep->device;
+
+    //
+    // Create viennashe::simulator per grid type. The simulators do not modify the device
+    if(int_dev->stype == libviennashe::meshtype::line_1d)
+    {
+      int_sim->sim1d  = new viennashe_simulator_impl::sim1d_type(*(int_dev->device_1d), *int_conf, viennashe::shared_device_tag());
+    }
+    else if(int_dev->stype == libviennashe::meshtype::quadrilateral_2d)
+    {
+      int_sim->simq2d  = new viennashe_simulator_impl::simq2d_type(*(int_dev->device_quad_2d), *int_conf, viennashe::shared_device_tag());
+    }
+    else if(int_dev->stype == libviennashe::meshtype::triangular_2d)
+    {
+      int_sim->simt2d  = new viennashe_simulator_impl::simt2d_type(*(int_dev->device_tri_2d), *int_conf, viennashe::shared_device_tag());
+    }
+    else if(int_dev->stype == libviennashe::meshtype::hexahedral_3d)
+    {
+      int_sim->simh3d  = new viennashe_simulator_impl::simh3d_type(*(int_dev->device_hex_3d), *int_conf, viennashe::shared_device_tag());
+    }
+    else if(int_dev->stype == libviennashe::meshtype::tetrahedral_3d)
+    {
+      int_sim->simt3d  = new viennashe_simulator_impl::simt3d_type(*(int_dev->device_tet_3d), *int_conf, viennashe::shared_device_tag());
+    }
+    else
+    {
+      viennashe::log::error() << "ERROR! create_simulator_on_prepared_device(): The given mesh is malconfigured!" << std::endl;
+      return 2;
+    }
+
+    // Share the SHE coupling matrices with the other simulators on the prepared device
+    const bool with_she = (int_conf->with_electrons() && int_conf->get_electron_equation() == viennashe::EQUATION_SHE)
+                       || (int_conf->with_holes()     && int_conf->get_hole_equation()     == viennashe::EQUATION_SHE);
+    if (with_she)
+    {
+      viennashe_prepared_device_impl::coupling_matrices_ptr coupling = prep->coupling_matrices(int_conf->max_expansion_order());
+      if      (int_dev->stype == libviennashe::meshtype::line_1d)          int_sim->sim1d->set_coupling_matrices(coupling);
+      else if (int_dev->stype == libviennashe::meshtype::quadrilateral_2d) int_sim->simq2d->set_coupling_matrices(coupling);
+      else if (int_dev->stype == libviennashe::meshtype::triangular_2d)    int_sim->simt2d->set_coupling_matrices(coupling);
+      else if (int_dev->stype == libviennashe::meshtype::hexahedral_3d)    int_sim->simh3d->set_coupling_matrices(coupling);
+      else if (int_dev->stype == libviennashe::meshtype::tetrahedral_3d)   int_sim->simt3d->set_coupling_matrices(coupling);
+    }
+
+    // RETURN
+    *sim = int_sim.release();
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! create_simulator_on_prepared_device(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
 viennasheErrorCode viennashe_free_simulator (viennashe_simulator_impl * sim)
 {
   try
   {
     if (sim != NULL)
     {
+      if (sim->is_valid())
+      {
+        libviennashe::cancel_run(sim);
+        libviennashe::wait_for_run(sim);
+      }
       // The internal configuration is not destroyed!
       delete sim;
     }
@@ -269,6 +631,88 @@ viennasheErrorCode viennashe_set_initial_guess(viennashe_simulator_impl * sim, c
   return 0;
 }
 
+viennasheErrorCode viennashe_set_simulator_contact_potential_cells(viennashe_simulator sim, viennashe_index_type * cell_ids, double * values, viennashe_index_type len)
+{
+  try
+  {
+    //
+    // Checks
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(cell_ids,2,"cell_ids");
+    CHECK_ARGUMENT_FOR_NULL(values,3,"values");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! set_simulator_contact_potential_cells(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    if(int_sim->stype == libviennashe::meshtype::line_1d)
+      libviennashe::set_contact_potential(*(int_sim->sim1d), cell_ids, values, len);
+    else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      libviennashe::set_contact_potential(*(int_sim->simq2d), cell_ids, values, len);
+    else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+      libviennashe::set_contact_potential(*(int_sim->simt2d), cell_ids, values, len);
+    else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      libviennashe::set_contact_potential(*(int_sim->simh3d), cell_ids, values, len);
+    else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      libviennashe::set_contact_potential(*(int_sim->simt3d), cell_ids, values, len);
+    else
+    {
+      viennashe::log::error() << "ERROR! set_simulator_contact_potential_cells(): Unkown grid type!" << std::endl;
+      return -2;
+    }
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! set_simulator_contact_potential_cells(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_set_simulator_contact_potential_segment(viennashe_simulator sim, double value, viennashe_index_type segment_id)
+{
+  try
+  {
+    //
+    // Checks
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! set_simulator_contact_potential_segment(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    if(int_sim->stype == libviennashe::meshtype::line_1d)
+      libviennashe::set_contact_potential(*(int_sim->sim1d), segment_id, value);
+    else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+      libviennashe::set_contact_potential(*(int_sim->simq2d), segment_id, value);
+    else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+      libviennashe::set_contact_potential(*(int_sim->simt2d), segment_id, value);
+    else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+      libviennashe::set_contact_potential(*(int_sim->simh3d), segment_id, value);
+    else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+      libviennashe::set_contact_potential(*(int_sim->simt3d), segment_id, value);
+    else
+    {
+      viennashe::log::error() << "ERROR! set_simulator_contact_potential_segment(): Unkown grid type!" << std::endl;
+      return -2;
+    }
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! set_simulator_contact_potential_segment(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
 viennasheErrorCode viennashe_run(viennashe_simulator_impl * sim)
 {
   try
@@ -284,40 +728,335 @@ viennasheErrorCode viennashe_run(viennashe_simulator_impl * sim)
       return 1;
     }
 
+    if (!libviennashe::begin_run(int_sim, viennashe_run_running))
+    {
+      viennashe::log::error() << "ERROR! run(): A simulation of the simulator (sim) is already queued or in progress!" << std::endl;
+      return 2;
+    }
+
+    return libviennashe::execute_run(int_sim);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! run(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_run_async(viennashe_simulator_impl * sim)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! run_async(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    if (!libviennashe::begin_run(int_sim, viennashe_run_queued))
+    {
+      viennashe::log::error() << "ERROR! run_async(): A simulation of the simulator (sim) is already queued or in progress!" << std::endl;
+      return 2;
+    }
+
+    std::shared_ptr<libviennashe::run_state> state = int_sim->run;
+    libviennashe::async_worker_pool().submit([state, int_sim]() { libviennashe::run_queued(state, int_sim); },
+                                             [state]() { libviennashe::discard_queued(state); });
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! run_async(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_wait(viennashe_simulator_impl * sim)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! wait(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    return libviennashe::wait_for_run(int_sim);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! wait(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_poll_status(viennashe_simulator_impl * sim, viennashe_run_status * status, viennashe_iteration_info * info)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(status,2,"status");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! poll_status(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(int_sim->run->mutex);
+      *status = static_cast<viennashe_run_status>(int_sim->run->status);
+    }
+
+    if (info != NULL)
+      return viennashe_get_iteration_info(int_sim, info, NULL);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! poll_status(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_cancel(viennashe_simulator_impl * sim)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! cancel(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    libviennashe::cancel_run(int_sim);
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! cancel(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_set_iteration_callback(viennashe_simulator_impl * sim, viennashe_iteration_callback callback, void * user_data)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! set_iteration_callback(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
     if(int_sim->stype == libviennashe::meshtype::line_1d)
     {
-      int_sim->sim1d->run();
+      libviennashe::set_iteration_callback(*(int_sim->sim1d), callback, user_data);
     }
     else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
     {
-      int_sim->simq2d->run();
+      libviennashe::set_iteration_callback(*(int_sim->simq2d), callback, user_data);
     }
     else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
     {
-      int_sim->simt2d->run();
+      libviennashe::set_iteration_callback(*(int_sim->simt2d), callback, user_data);
     }
     else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
     {
-      int_sim->simh3d->run();
+      libviennashe::set_iteration_callback(*(int_sim->simh3d), callback, user_data);
     }
     else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
     {
-      int_sim->simt3d->run();
+      libviennashe::set_iteration_callback(*(int_sim->simt3d), callback, user_data);
     }
     else
     {
-      viennashe::log::error() << "ERROR! run(): Unkown grid type!" << std::endl;
+      viennashe::log::error() << "ERROR! set_iteration_callback(): Unkown grid type!" << std::endl;
       return -2;
     }
   }
   catch(...)
   {
-    viennashe::log::error() << "ERROR! run(): UNKOWN ERROR!" << std::endl;
+    viennashe::log::error() << "ERROR! set_iteration_callback(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_get_iteration_info(viennashe_simulator_impl * sim, viennashe_iteration_info * info, libviennashe_bool * cancelled)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(info,2,"info");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! get_iteration_info(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    if(int_sim->stype == libviennashe::meshtype::line_1d)
+    {
+      libviennashe::get_iteration_info(*(int_sim->sim1d), *info, cancelled);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+    {
+      libviennashe::get_iteration_info(*(int_sim->simq2d), *info, cancelled);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+    {
+      libviennashe::get_iteration_info(*(int_sim->simt2d), *info, cancelled);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+    {
+      libviennashe::get_iteration_info(*(int_sim->simh3d), *info, cancelled);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+    {
+      libviennashe::get_iteration_info(*(int_sim->simt3d), *info, cancelled);
+    }
+    else
+    {
+      viennashe::log::error() << "ERROR! get_iteration_info(): Unkown grid type!" << std::endl;
+      return -2;
+    }
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_iteration_info(): UNKOWN ERROR!" << std::endl;
     return -1;
   }
   return 0;
 }
 
+viennasheErrorCode viennashe_get_peak_memory(viennashe_simulator_impl * sim, const char * phase, const char * category, double * bytes)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(sim,1,"sim");
+    CHECK_ARGUMENT_FOR_NULL(bytes,4,"bytes");
+
+    viennashe_simulator_impl * int_sim = sim;
+
+    if (!int_sim->is_valid())
+    {
+      viennashe::log::error() << "ERROR! get_peak_memory(): The simulator (sim) must be valid!" << std::endl;
+      return 1;
+    }
+
+    std::string phase_path(phase ? phase : "");
+    std::string category_name(category ? category : "");
+
+    if(int_sim->stype == libviennashe::meshtype::line_1d)
+    {
+      *bytes = libviennashe::get_peak_memory(*(int_sim->sim1d), phase_path, category_name);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::quadrilateral_2d)
+    {
+      *bytes = libviennashe::get_peak_memory(*(int_sim->simq2d), phase_path, category_name);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::triangular_2d)
+    {
+      *bytes = libviennashe::get_peak_memory(*(int_sim->simt2d), phase_path, category_name);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::hexahedral_3d)
+    {
+      *bytes = libviennashe::get_peak_memory(*(int_sim->simh3d), phase_path, category_name);
+    }
+    else if(int_sim->stype == libviennashe::meshtype::tetrahedral_3d)
+    {
+      *bytes = libviennashe::get_peak_memory(*(int_sim->simt3d), phase_path, category_name);
+    }
+    else
+    {
+      viennashe::log::error() << "ERROR! get_peak_memory(): Unkown grid type!" << std::endl;
+      return -2;
+    }
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! get_peak_memory(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
+
+viennasheErrorCode viennashe_estimate_memory(viennashe_device dev, viennashe_config conf, double potential_range, const char * category, double * bytes)
+{
+  try
+  {
+    CHECK_ARGUMENT_FOR_NULL(dev,1,"dev");
+    CHECK_ARGUMENT_FOR_NULL(conf,2,"conf");
+    CHECK_ARGUMENT_FOR_NULL(bytes,5,"bytes");
+
+    viennashe::config     * int_conf = reinterpret_cast<viennashe::config *>(conf);
+    viennashe_device_impl * int_dev  = dev;
+
+    if (!int_dev->is_valid())
+    {
+      viennashe::log::error() << "ERROR! estimate_memory(): The device (dev) must be valid!" << std::endl;
+      return 1;
+    }
+
+    viennashe::she::memory_estimate estimate;
+    if(int_dev->stype == libviennashe::meshtype::line_1d)
+    {
+      estimate = viennashe::she::estimate_memory(*(int_dev->device_1d), *int_conf, potential_range);
+    }
+    else if(int_dev->stype == libviennashe::meshtype::quadrilateral_2d)
+    {
+      estimate = viennashe::she::estimate_memory(*(int_dev->device_quad_2d), *int_conf, potential_range);
+    }
+    else if(int_dev->stype == libviennashe::meshtype::triangular_2d)
+    {
+      estimate = viennashe::she::estimate_memory(*(int_dev->device_tri_2d), *int_conf, potential_range);
+    }
+    else if(int_dev->stype == libviennashe::meshtype::hexahedral_3d)
+    {
+      estimate = viennashe::she::estimate_memory(*(int_dev->device_hex_3d), *int_conf, potential_range);
+    }
+    else if(int_dev->stype == libviennashe::meshtype::tetrahedral_3d)
+    {
+      estimate = viennashe::she::estimate_memory(*(int_dev->device_tet_3d), *int_conf, potential_range);
+    }
+    else
+    {
+      viennashe::log::error() << "ERROR! estimate_memory(): Unkown grid type!" << std::endl;
+      return -2;
+    }
+
+    *bytes = estimate(category ? category : "");
+  }
+  catch(...)
+  {
+    viennashe::log::error() << "ERROR! estimate_memory(): UNKOWN ERROR!" << std::endl;
+    return -1;
+  }
+  return 0;
+}
 
 #ifdef	__cplusplus
 }
@@ -34,6 +34,10 @@
 #include <iostream>
 #include <cstdlib>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
 
 #include "viennashe/forwards.h"
 #include "viennashe/device.hpp"
@@ -44,6 +48,9 @@
 #include "viennashe/config.hpp"
 #include "viennashe/she/postproc/all.hpp"
 #include "viennashe/io/gnuplot_writer.hpp"
+#include "viennashe/io/column_writer.hpp"
+#include "viennashe/io/result_file.hpp"
+#include "viennashe/she/memory_estimate.hpp"
 
 #include "viennashe/postproc/current_density.hpp"
 #include "viennashe/postproc/electric_field.hpp"
@@ -139,6 +146,21 @@ namespace libviennashe
       tetrahedral_3d
     };
   };
+
+  /**
+   * @brief The state of viennashe_run() and viennashe_run_async() for a simulator.
+   *
+   * Shared between the simulator and a job queued by viennashe_run_async(), so that the simulator can be freed while the job is still queued.
+   */
+  struct run_state
+  {
+    run_state() : status(0), result(0) {}
+
+    std::mutex               mutex;
+    std::condition_variable  finished;  ///< Notified whenever a run ends
+    int                      status;    ///< A value of viennashe_run_status
+    int                      result;    ///< The return value of the last run, as of viennashe_run()
+  };
 }
 
 
@@ -189,6 +211,35 @@ struct viennashe_device_impl
 }; // viennashe_device_impl
 
 
+/** @brief Internal C++ to C wrapper for a prepared device. Holds the device shared by simulators, which is destroyed with the last reference,
+ *         and the SHE coupling matrices shared by these simulators.
+ */
+struct viennashe_prepared_device_impl
+{
+  typedef std::shared_ptr<viennashe::she::coupling_matrices const>   coupling_matrices_ptr;
+
+  viennashe_prepared_device_impl(std::shared_ptr<viennashe_device_impl> const & d) : device(d) {  }
+
+  bool is_valid() const { return (device && device->is_valid()); }
+
+  /** @brief Returns the SHE coupling matrices for the maximum expansion order L_max. Computed by the first simulator asking for them. */
+  coupling_matrices_ptr coupling_matrices(long L_max)
+  {
+    std::lock_guard<std::mutex> lock(coupling_mutex);
+    coupling_matrices_ptr & coupling = coupling_cache[L_max];
+    if (!coupling)
+      coupling = std::make_shared<viennashe::she::coupling_matrices const>(L_max);
+    return coupling;
+  }
+
+  std::shared_ptr<viennashe_device_impl> device; // Never modified after preparation !
+
+private:
+  std::mutex                            coupling_mutex;
+  std::map<long, coupling_matrices_ptr> coupling_cache;
+}; // viennashe_prepared_device_impl
+
+
 /** @brief Internal C++ to C wrapper for the simulator. Has typedefs and destructor. */
   struct viennashe_simulator_impl
 {
@@ -220,7 +271,7 @@ struct viennashe_device_impl
   typedef viennashe::simulator<devt3d_type> simt3d_type;
 
 
-  viennashe_simulator_impl(int s, viennashe::config * c) : stype(s), conf(c), sim1d(0) {  }
+  viennashe_simulator_impl(int s, viennashe::config * c) : stype(s), conf(c), sim1d(0), run(new libviennashe::run_state()) {  }
 
   ~viennashe_simulator_impl()
   {
@@ -257,6 +308,10 @@ struct viennashe_device_impl
     simt3d_type * simt3d;
   };
 
+  std::shared_ptr<libviennashe::run_state> run;
+
+  std::shared_ptr<viennashe_device_impl>    shared_device; // The prepared device the simulator operates on, if any. Keeps the device alive
+
 };
 
 #endif	/* LIBVIENNASHE_VIENNASHE_ALL_HPP */
@@ -0,0 +1,139 @@
+#ifndef LIBVIENNASHE_WORKER_POOL_HPP
+#define	LIBVIENNASHE_WORKER_POOL_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+/** @file libviennashe/src/worker_pool.hpp
+    @brief Contains the pool of worker threads executing the simulations started by viennashe_run_async()
+*/
+
+#include <cstdlib>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <utility>
+
+namespace libviennashe
+{
+
+  /** @brief A fixed number of worker threads processing a queue of jobs in FIFO order.
+   *
+   * Jobs are functors without arguments and must not throw. Jobs still queued when the pool is destroyed are not executed,
+   * but their discard functors are invoked, so that threads waiting for them are woken up. Jobs in progress are waited for.
+   */
+  class worker_pool
+  {
+    public:
+      typedef std::function<void()>   job_type;
+
+      explicit worker_pool(std::size_t num_threads) : shutdown_(false)
+      {
+        if (num_threads == 0)
+          num_threads = 1;
+        for (std::size_t i=0; i<num_threads; ++i)
+          threads_.push_back(std::thread(&worker_pool::worker_loop, this));
+      }
+
+      ~worker_pool()
+      {
+        std::deque<queued_job> dropped_jobs;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          shutdown_ = true;
+          dropped_jobs.swap(jobs_);
+        }
+        job_available_.notify_all();
+
+        // Invoked without holding the lock and before the jobs in progress are waited for, since these may wait for the dropped jobs:
+        for (std::size_t i=0; i<dropped_jobs.size(); ++i)
+          if (dropped_jobs[i].second)
+            dropped_jobs[i].second();
+        dropped_jobs.clear();
+
+        for (std::size_t i=0; i<threads_.size(); ++i)
+          threads_[i].join();
+      }
+
+      /** @brief Adds a job to the queue. Never blocks.
+       *
+       * @param job      The job
+       * @param discard  Invoked instead of the job if the job is dropped from the queue when the pool is destroyed. May be empty
+       */
+      void submit(job_type job, job_type discard = job_type())
+      {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          jobs_.push_back(queued_job(std::move(job), std::move(discard)));
+        }
+        job_available_.notify_one();
+      }
+
+      std::size_t num_threads() const { return threads_.size(); }
+
+    private:
+      typedef std::pair<job_type, job_type>   queued_job;   ///< The job and its discard functor
+
+      worker_pool(worker_pool const &);
+      worker_pool & operator=(worker_pool const &);
+
+      void worker_loop()
+      {
+        while (true)
+        {
+          job_type job;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            job_available_.wait(lock, [this]{ return shutdown_ || !jobs_.empty(); });
+            if (shutdown_)
+              return;
+
+            job = std::move(jobs_.front().first);
+            jobs_.pop_front();
+          }
+          job();
+        }
+      }
+
+      std::deque<queued_job>    jobs_;
+      bool                      shutdown_;
+      std::mutex                mutex_;
+      std::condition_variable   job_available_;
+      std::vector<std::thread>  threads_;
+  };
+
+  /** @brief Returns the number of threads of the worker pool: The value of the environment variable VIENNASHE_ASYNC_WORKERS if set, one per hardware thread otherwise */
+  inline std::size_t async_worker_count()
+  {
+    if (char const * env = std::getenv("VIENNASHE_ASYNC_WORKERS"))
+    {
+      long num = std::atol(env);
+      if (num > 0)
+        return static_cast<std::size_t>(num);
+    }
+    return std::thread::hardware_concurrency();
+  }
+
+  /** @brief Returns the worker pool of the library, which is created on first use with async_worker_count() threads */
+  inline worker_pool & async_worker_pool()
+  {
+    static worker_pool pool(async_worker_count());
+    return pool;
+  }
+
+} // namespace libviennashe
+
+#endif	/* LIBVIENNASHE_WORKER_POOL_HPP */
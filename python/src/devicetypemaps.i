@@ -34,47 +34,60 @@
 %typemap(freearg) (viennashe_material_id * material_ids) { if ($1) free($1); }
 
 
-%typemap(in) (double * doping_n) {
-  int i = 0;
-  if (!PyList_Check($input)) {
-    PyErr_SetString(PyExc_ValueError, "Expecting a list");
-    return NULL;
-  }
-  int size = PyList_Size($input);
-  $1 = (double *) malloc(size * sizeof(double));
-  for (i = 0; i < size; i++)
-  {
-    PyObject *s = PyList_GetItem($input, i);
-    if (!PyFloat_Check(s)) {
-        free($1);
-        PyErr_SetString(PyExc_ValueError, "List items must be floats");
-        return NULL;
-    }
-    $1[i] = PyFloat_AsDouble(s);
-  }
+/* Arrays of doubles can be passed either as a list of floats or, without copying, as any object providing a
+   C-contiguous float64 buffer in native byte order (e.g. a numpy array). The latter is the fast path for large meshes. */
+%{
+/* Returns nonzero if the buffer format (cf. the struct module) denotes a float64 in native byte order */
+static int viennashe_is_native_float64_format(char const * format) {
+  const union { int i; char c; } probe = { 1 };
+  if (format == NULL)
+    return 0;  /* unsigned bytes */
+  if (strcmp(format, "d") == 0 || strcmp(format, "@d") == 0 || strcmp(format, "=d") == 0)
+    return 1;
+  if (probe.c)  /* little endian */
+    return strcmp(format, "<d") == 0;
+  return strcmp(format, ">d") == 0 || strcmp(format, "!d") == 0;
 }
-%typemap(freearg) (double * doping_n) { if ($1) free($1); }
+%}
 
-%typemap(in) (double * doping_p) {
+%define VIENNASHE_DOUBLE_ARRAY_TYPEMAP(NAME)
+%typemap(in) (double * NAME) (Py_buffer buffer, int is_buffer = 0) {
   int i = 0;
-  if (!PyList_Check($input)) {
-    PyErr_SetString(PyExc_ValueError, "Expecting a list");
-    return NULL;
+  if (PyObject_CheckBuffer($input)) {
+    if (PyObject_GetBuffer($input, &buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+      return NULL;
+    if (buffer.itemsize != sizeof(double) || !viennashe_is_native_float64_format(buffer.format)) {
+      PyBuffer_Release(&buffer);
+      PyErr_SetString(PyExc_ValueError, "Buffer items must be float64 in native byte order");
+      return NULL;
+    }
+    is_buffer = 1;
+    $1 = (double *) buffer.buf;
   }
-  int size = PyList_Size($input);
-  $1 = (double *) malloc(size * sizeof(double));
-  for (i = 0; i < size; i++)
-  {
-    PyObject *s = PyList_GetItem($input, i);
-    if (!PyFloat_Check(s)) {
-        free($1);
-        PyErr_SetString(PyExc_ValueError, "List items must be floats");
-        return NULL;
+  else {
+    if (!PyList_Check($input)) {
+      PyErr_SetString(PyExc_ValueError, "Expecting a list or a float64 buffer");
+      return NULL;
+    }
+    int size = PyList_Size($input);
+    $1 = (double *) malloc(size * sizeof(double));
+    for (i = 0; i < size; i++)
+    {
+      PyObject *s = PyList_GetItem($input, i);
+      if (!PyFloat_Check(s)) {
+          free($1);
+          PyErr_SetString(PyExc_ValueError, "List items must be floats");
+          return NULL;
+      }
+      $1[i] = PyFloat_AsDouble(s);
     }
-    $1[i] = PyFloat_AsDouble(s);
   }
 }
-%typemap(freearg) (double * doping_p) { if ($1) free($1); }
+%typemap(freearg) (double * NAME) { if (is_buffer$argnum) PyBuffer_Release(&buffer$argnum); else if ($1) free($1); }
+%enddef
+
+VIENNASHE_DOUBLE_ARRAY_TYPEMAP(doping_n)
+VIENNASHE_DOUBLE_ARRAY_TYPEMAP(doping_p)
 
 %typemap(in) (viennashe_index_type * cell_ids) {
   int i = 0;
@@ -98,26 +111,7 @@
 %typemap(freearg) (viennashe_index_type * cell_ids) { if ($1) free($1); }
 
 
-%typemap(in) (double * values) {
-  int i = 0;
-  if (!PyList_Check($input)) {
-    PyErr_SetString(PyExc_ValueError, "Expecting a list");
-    return NULL;
-  }
-  int size = PyList_Size($input);
-  $1 = (double *) malloc(size * sizeof(double));
-  for (i = 0; i < size; i++)
-  {
-    PyObject *s = PyList_GetItem($input, i);
-    if (!PyFloat_Check(s)) {
-        free($1);
-        PyErr_SetString(PyExc_ValueError, "List items must be floats");
-        return NULL;
-    }
-    $1[i] = PyFloat_AsDouble(s);
-  }
-}
-%typemap(freearg) (double * values) { if ($1) free($1); }
+VIENNASHE_DOUBLE_ARRAY_TYPEMAP(values)
 
 
 %apply double * OUTPUT { double * x };
@@ -19,6 +19,180 @@
 #include "libviennashe.h"
 %}
 
+%{ /* helpers for the views on the storage of a simulator or a result file, not wrapped */
+
+/* An exporter of a read-only buffer on the storage of a simulator or a result file. It holds a reference to the Python object of the owner,
+   hence the owner stays alive as long as a memoryview (or an array obtained from it) exists. The number of buffers exported per
+   owner is counted, such that functions reallocating or releasing the storage can refuse to run while buffers are exported. */
+typedef struct
+{
+  PyObject_HEAD
+  PyObject *           owner;     /* the Python object of the simulator or result file */
+  void *               handle;    /* the simulator or result file */
+  const void *         data;
+  Py_ssize_t           len;       /* number of values */
+  Py_ssize_t           itemsize;
+  char const *         format;    /* 'd' for float64, 'q' for int64 */
+} viennashe_view_exporter;
+
+static PyObject * viennashe_view_exports = NULL;  /* dict: address of a simulator or result file -> number of exported buffers */
+
+static Py_ssize_t viennashe_num_view_exports(void * sim) {
+  PyObject * key = NULL;
+  PyObject * count = NULL;
+  Py_ssize_t result = 0;
+  if (viennashe_view_exports == NULL) return 0;
+  key = PyLong_FromVoidPtr((void *)sim);
+  if (key == NULL) { PyErr_Clear(); return 0; }
+  count = PyDict_GetItem(viennashe_view_exports, key);  /* borrowed */
+  if (count != NULL) result = PyLong_AsSsize_t(count);
+  Py_DECREF(key);
+  return result;
+}
+
+static int viennashe_add_view_exports(void * sim, Py_ssize_t delta) {
+  PyObject * key = NULL;
+  PyObject * count = NULL;
+  int err = -1;
+  const Py_ssize_t num = viennashe_num_view_exports(sim) + delta;
+  if (viennashe_view_exports == NULL && (viennashe_view_exports = PyDict_New()) == NULL) return -1;
+  key = PyLong_FromVoidPtr((void *)sim);
+  if (key == NULL) return -1;
+  if (num > 0)
+  {
+    count = PyLong_FromSsize_t(num);
+    if (count != NULL) err = PyDict_SetItem(viennashe_view_exports, key, count);
+    Py_XDECREF(count);
+  }
+  else if (PyDict_GetItem(viennashe_view_exports, key) != NULL)
+    err = PyDict_DelItem(viennashe_view_exports, key);
+  else
+    err = 0;
+  Py_DECREF(key);
+  return err;
+}
+
+static int viennashe_view_exporter_getbuffer(PyObject * obj, Py_buffer * view, int flags) {
+  viennashe_view_exporter * self = (viennashe_view_exporter *) obj;
+  view->obj = NULL;
+  if (flags & PyBUF_WRITABLE)
+  {
+    PyErr_SetString(PyExc_BufferError, "Views on the storage of a simulator or result file are read-only");
+    return -1;
+  }
+  if (viennashe_add_view_exports(self->handle, 1) != 0)
+    return -1;
+  view->buf        = (void *) self->data;
+  view->obj        = obj;
+  Py_INCREF(obj);
+  view->len        = self->len * self->itemsize;
+  view->readonly   = 1;
+  view->itemsize   = self->itemsize;
+  view->format     = (flags & PyBUF_FORMAT) ? (char *) self->format : NULL;
+  view->ndim       = 1;
+  view->shape      = (flags & PyBUF_ND) ? &self->len : NULL;
+  view->strides    = NULL;  /* contiguous */
+  view->suboffsets = NULL;
+  view->internal   = NULL;
+  return 0;
+}
+
+static void viennashe_view_exporter_releasebuffer(PyObject * obj, Py_buffer * view) {
+  (void)view;
+  if (viennashe_add_view_exports(((viennashe_view_exporter *) obj)->handle, -1) != 0)
+    PyErr_Clear();
+}
+
+static void viennashe_view_exporter_dealloc(PyObject * obj) {
+  Py_XDECREF(((viennashe_view_exporter *) obj)->owner);
+  PyObject_Del(obj);
+}
+
+static PyBufferProcs viennashe_view_exporter_buffer_procs;
+static PyTypeObject  viennashe_view_exporter_type = { PyVarObject_HEAD_INIT(NULL, 0) };
+
+/* Returns a read-only memoryview with the given format on 'len' values at 'data' owned by the simulator or result file 'handle' with the Python object 'owner' */
+static PyObject * viennashe_new_typed_view(PyObject * owner, void * handle, const void * data, Py_ssize_t len, char const * format, Py_ssize_t itemsize) {
+  static int type_ready = 0;
+  viennashe_view_exporter * exporter = NULL;
+  PyObject * result = NULL;
+
+  if (!type_ready)
+  {
+    viennashe_view_exporter_buffer_procs.bf_getbuffer     = viennashe_view_exporter_getbuffer;
+    viennashe_view_exporter_buffer_procs.bf_releasebuffer = viennashe_view_exporter_releasebuffer;
+    viennashe_view_exporter_type.tp_name      = "pyviennashe.view_exporter";
+    viennashe_view_exporter_type.tp_basicsize = sizeof(viennashe_view_exporter);
+    viennashe_view_exporter_type.tp_dealloc   = viennashe_view_exporter_dealloc;
+    viennashe_view_exporter_type.tp_as_buffer = &viennashe_view_exporter_buffer_procs;
+#ifdef Py_TPFLAGS_HAVE_NEWBUFFER
+    viennashe_view_exporter_type.tp_flags     = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+#else
+    viennashe_view_exporter_type.tp_flags     = Py_TPFLAGS_DEFAULT;
+#endif
+    viennashe_view_exporter_type.tp_doc       = "Exports a read-only buffer on the storage of a simulator or result file";
+    if (PyType_Ready(&viennashe_view_exporter_type) < 0)
+      return NULL;
+    type_ready = 1;
+  }
+
+  exporter = PyObject_New(viennashe_view_exporter, &viennashe_view_exporter_type);
+  if (exporter == NULL)
+    return NULL;
+  Py_INCREF(owner);
+  exporter->owner    = owner;
+  exporter->handle   = handle;
+  exporter->data     = data;
+  exporter->len      = len;
+  exporter->itemsize = itemsize;
+  exporter->format   = format;
+
+  result = PyMemoryView_FromObject((PyObject *) exporter);  /* the memoryview references the exporter */
+  Py_DECREF(exporter);
+  return result;
+}
+
+/* Returns a read-only memoryview (format 'd') on 'len' values at 'data' owned by the simulator 'sim' with the Python object 'owner' */
+static PyObject * viennashe_new_view(PyObject * owner, viennashe_simulator sim, const double * data, Py_ssize_t len) {
+  return viennashe_new_typed_view(owner, (void *) sim, data, len, "d", (Py_ssize_t) sizeof(double));
+}
+
+/* Extracts the simulator from its Python object. Fails if the simulation is queued or in progress. */
+static int viennashe_view_simulator(PyObject * obj, viennashe_simulator * sim) {
+  void * ptr = NULL;
+  viennashe_run_status status;
+  if (!SWIG_IsOK(SWIG_ConvertPtr(obj, &ptr, SWIGTYPE_p_viennashe_simulator_impl, 0)) || ptr == NULL)
+  {
+    PyErr_SetString(PyExc_TypeError, "Expecting a simulator");
+    return -1;
+  }
+  *sim = (viennashe_simulator) ptr;
+  if (viennashe_poll_status(*sim, &status, NULL) == 0 && (status == viennashe_run_queued || status == viennashe_run_running))
+  {
+    PyErr_SetString(PyExc_BufferError, "The simulation is queued or in progress");
+    return -1;
+  }
+  return 0;
+}
+%}
+
+/* Functions reallocating the storage of the simulator must not run while views on it exist: */
+%define VIENNASHE_REQUIRE_NO_VIEWS(FUNCTION)
+%exception FUNCTION {
+  if (viennashe_num_view_exports((void *) arg1) > 0)
+  {
+    PyErr_SetString(PyExc_BufferError, "Views on the storage of the simulator exist. Release the memoryviews and arrays obtained from them first");
+    SWIG_fail;
+  }
+  $action
+}
+%enddef
+
+VIENNASHE_REQUIRE_NO_VIEWS(viennashe_run)
+VIENNASHE_REQUIRE_NO_VIEWS(viennashe_run_async)
+VIENNASHE_REQUIRE_NO_VIEWS(viennashe_set_initial_guess)
+VIENNASHE_REQUIRE_NO_VIEWS(viennashe_set_initial_guess_from_other_sim)
+
 /*************************************************/
 /*              RENAME SECTION                   */
 
@@ -45,6 +219,18 @@
 // Rule for damping factor output
 %apply double * OUTPUT { double * damping };
 
+// Rules for result file array info output
+%apply int * OUTPUT { viennashe_result_type_id * type }; // note: enum values are integers ...
+%apply viennashe_index_type * OUTPUT { viennashe_index_type * size };
+%apply viennashe_index_type * OUTPUT { viennashe_index_type * components };
+
+// Rule for the status of asynchronous runs
+%apply int * OUTPUT { viennashe_run_status * status }; // note: enum values are integers ...
+
+// Rules for the dimensions of the SHE coefficients
+%apply viennashe_index_type * OUTPUT { viennashe_index_type * num_cells };
+%apply viennashe_index_type * OUTPUT { viennashe_index_type * num_energies };
+
 
 // We have to wrap this manually ...
 %ignore viennashe_get_grid;
@@ -55,6 +241,9 @@
 %ignore viennashe_create_device_from_file;
 %ignore viennashe_create_1d_device;
 %ignore viennashe_free_device;
+%ignore viennashe_prepare_device;
+%ignore viennashe_free_prepared_device;
+%ignore viennashe_get_prepared_device;
 
 // CTOR rules for the config
 %ignore viennashe_create_config;
@@ -62,12 +251,23 @@
 
 // CTOR rules for the simulator
 %ignore viennashe_create_simulator;
+%ignore viennashe_create_simulator_on_prepared_device;
 %ignore viennashe_free_simulator;
 
 // CTOR rules for the quantity register
 %ignore viennashe_create_quantity_register;
 %ignore viennashe_free_quantity_register;
 
+// CTOR rules and manually wrapped accessors for result files
+%ignore viennashe_open_result_file;
+%ignore viennashe_close_result_file;
+%ignore viennashe_get_result_file_array_name;
+%ignore viennashe_get_result_file_array_data;
+
+// Manually wrapped views on the storage of the simulator
+%ignore viennashe_get_cell_based_quantity_view;
+%ignore viennashe_get_she_coefficients_view;
+
 
 /*************************************************/
 
@@ -145,6 +345,38 @@ viennashe_simulator create_simulator(viennashe_device dev, viennashe_config conf
 %delobject viennashe_free_simulator;
 
 
+%inline %{ /* creators for prepared devices and simulators sharing them */
+viennashe_prepared_device prepare_device(viennashe_device dev) {
+  viennashe_prepared_device ptr;
+  viennasheErrorCode returnValue;
+  returnValue = viennashe_prepare_device(&ptr, dev);
+  if (returnValue != 0) ptr = NULL;
+  return ptr;
+}
+
+void free_prepared_device(viennashe_prepared_device prep) {
+  viennashe_free_prepared_device(prep);
+}
+
+/* Returns the device of a prepared device for the mesh getters. Must not be modified or freed */
+viennashe_device get_prepared_device(viennashe_prepared_device prep) {
+  viennashe_device ptr;
+  if (viennashe_get_prepared_device(prep, &ptr) != 0) ptr = NULL;
+  return ptr;
+}
+
+viennashe_simulator create_simulator_on_prepared_device(viennashe_prepared_device prep, viennashe_config conf) {
+  viennashe_simulator   ptr;
+  viennasheErrorCode returnValue;
+  returnValue = viennashe_create_simulator_on_prepared_device(&ptr, prep, conf);
+  if (returnValue != 0) ptr = NULL;
+  return ptr;
+}%}
+%newobject prepare_device;
+%delobject free_prepared_device;
+%newobject create_simulator_on_prepared_device;
+
+
 %inline %{ /* creator for the quantity register */
 viennashe_quan_register create_quantity_register(viennashe_simulator sim) {
   viennashe_quan_register   ptr;
@@ -157,6 +389,182 @@ viennashe_quan_register create_quantity_register(viennashe_simulator sim) {
 %delobject viennashe_free_quantity_register;
 
 
+%inline %{ /* creator for result files */
+viennashe_result_file open_result_file(char const * filename) {
+  viennashe_result_file   ptr;
+  viennasheErrorCode returnValue;
+  returnValue = viennashe_open_result_file(&ptr, filename);
+  if (returnValue != 0) ptr = NULL;
+  return ptr;
+}
+
+/* Extracts the result file from its Python object */
+static int viennashe_view_result_file(PyObject * obj, viennashe_result_file * file, int flags) {
+  void * ptr = NULL;
+  if (!SWIG_IsOK(SWIG_ConvertPtr(obj, &ptr, SWIGTYPE_p_viennashe_result_file_impl, flags)) || ptr == NULL)
+  {
+    PyErr_SetString(PyExc_TypeError, "Expecting a result file");
+    return -1;
+  }
+  *file = (viennashe_result_file) ptr;
+  return 0;
+}
+
+/* Closes the result file. Raises BufferError while views on its arrays (or arrays obtained from them) exist. */
+PyObject * close_result_file(PyObject * file_obj) {
+  viennashe_result_file file = NULL;
+  if (viennashe_view_result_file(file_obj, &file, 0) != 0)
+    return NULL;
+  if (viennashe_num_view_exports((void *) file) > 0)
+  {
+    PyErr_SetString(PyExc_BufferError, "Views on the arrays of the result file exist. Release the memoryviews and arrays obtained from them first");
+    return NULL;
+  }
+  if (viennashe_view_result_file(file_obj, &file, SWIG_POINTER_DISOWN) != 0)  /* the proxy must not close the file again */
+    return NULL;
+  viennashe_close_result_file(file);
+  Py_RETURN_NONE;
+}
+
+char const * get_result_file_array_name(viennashe_result_file file, viennashe_index_type index) {
+  char const * name = NULL;
+  if (viennashe_get_result_file_array_name(file, index, &name) != 0) return NULL;
+  return name;
+}
+
+/* Returns a read-only memoryview on the mapped data of an array (no copy), with format 'd' for float64 and 'q' for int64 arrays.
+   The view keeps the file alive. While views (or arrays obtained from them) exist, close_result_file() raises BufferError.
+   Use e.g. numpy.asarray(view) to obtain an array. */
+PyObject * get_result_file_array_view(PyObject * file_obj, char const * name) {
+  static const double empty = 0;
+  viennashe_result_file file = NULL;
+  void const * data = NULL;
+  viennashe_result_type_id type;
+  viennashe_index_type size = 0;
+  if (viennashe_view_result_file(file_obj, &file, 0) != 0)
+    return NULL;
+  if (viennashe_get_result_file_array_info(file, name, &type, &size, NULL) != 0
+      || viennashe_get_result_file_array_data(file, name, &data) != 0)
+  {
+    PyErr_SetString(PyExc_KeyError, name);
+    return NULL;
+  }
+  if (size == 0 || data == NULL) { data = &empty; size = 0; }
+  if (type == viennashe_result_int64)
+    return viennashe_new_typed_view(file_obj, (void *) file, data, (Py_ssize_t)size, "q", (Py_ssize_t) sizeof(long long));
+  return viennashe_new_typed_view(file_obj, (void *) file, data, (Py_ssize_t)size, "d", (Py_ssize_t) sizeof(double));
+}
+%}
+%newobject open_result_file;
+
+
+%{ /* helper for the bulk accessors below, not wrapped */
+/* Returns a typed memoryview of the raw bytes (format 'B') given. Used to hand out arrays which numpy.asarray() accepts without a dtype. */
+PyObject * viennashe_typed_memoryview(PyObject * bytes_view, char const * format, Py_ssize_t rows, Py_ssize_t cols) {
+  PyObject * result;
+  if (bytes_view == NULL) return NULL;
+  if (cols > 0) result = PyObject_CallMethod(bytes_view, (char *)"cast", (char *)"s(nn)", format, rows, cols);
+  else          result = PyObject_CallMethod(bytes_view, (char *)"cast", (char *)"s", format);
+  Py_DECREF(bytes_view);
+  return result;
+}
+%}
+
+%inline %{ /* bulk access to quantities, SHE coefficients and the mesh */
+
+/* Returns a read-only memoryview (format 'd') on the values of a quantity solved for by the simulator (no copy).
+   The value on the cell with ID i is view[i * stride], where stride is the second entry of the returned tuple.
+   The view keeps the simulator alive. While views (or arrays obtained from them) exist, run(), run_async() and
+   set_initial_guess() raise BufferError. Use e.g. numpy.asarray(view)[::stride] to obtain an array. */
+PyObject * get_cell_based_quantity_view(PyObject * sim_obj, char const * name) {
+  static const double empty = 0;
+  viennashe_simulator sim = NULL;
+  viennashe_quantity_view view;
+  Py_ssize_t num_values = 0;
+  if (viennashe_view_simulator(sim_obj, &sim) != 0)
+    return NULL;
+  if (viennashe_get_cell_based_quantity_view(sim, name, &view) != 0)
+  {
+    PyErr_SetString(PyExc_KeyError, name);
+    return NULL;
+  }
+  if (view.len > 0) num_values = (Py_ssize_t)((view.len - 1) * view.stride + 1);
+  else             view.values = &empty;
+  return Py_BuildValue("(Nn)", viennashe_new_view(sim_obj, sim, view.values, num_values), (Py_ssize_t)view.stride);
+}
+
+/* Returns a read-only memoryview (format 'd') on the even SHE coefficients of an (x,H)-node (no copy).
+   The dimensions are given by get_she_coefficients_size(). The view behaves as the one of get_cell_based_quantity_view(). */
+PyObject * get_she_coefficients_view(PyObject * sim_obj, viennashe_carrier_ids ctype, viennashe_index_type cell_id, viennashe_index_type index_H) {
+  static const double empty = 0;
+  viennashe_simulator sim = NULL;
+  const double * values = NULL;
+  viennashe_index_type len = 0;
+  if (viennashe_view_simulator(sim_obj, &sim) != 0)
+    return NULL;
+  if (viennashe_get_she_coefficients_view(sim, ctype, cell_id, index_H, &values, &len) != 0)
+  {
+    PyErr_SetString(PyExc_IndexError, "Invalid carrier type, cell ID or energy index");
+    return NULL;
+  }
+  if (values == NULL) { values = &empty; len = 0; }
+  return viennashe_new_view(sim_obj, sim, values, (Py_ssize_t)len);
+}
+
+/* Returns the mesh as a tuple (vertices, cells) of two-dimensional memoryviews: The coordinates (format 'd', num_vertices x dim)
+   and the vertex IDs of each cell (format 'L', num_cells x vertices per cell). Use numpy.asarray() to obtain arrays.
+   The mesh is not stored as arrays by the device, hence it is copied once in bulk. */
+PyObject * get_mesh_arrays(viennashe_device dev) {
+  viennashe_index_type dim = 0, nen = 0, num_vertices = 0, num_cells = 0, i = 0;
+  viennasheErrorCode err = 0;
+  PyObject * vertex_bytes = NULL;
+  PyObject * cell_bytes   = NULL;
+  PyObject * result       = NULL;
+  double ** vertex_rows = NULL;
+  viennashe_index_type ** cell_rows = NULL;
+
+  if (viennashe_get_dimension(dev, &dim) != 0 || viennashe_get_num_vertices_per_cell(dev, &nen) != 0
+      || viennashe_get_num_vertices(dev, &num_vertices) != 0 || viennashe_get_num_cells(dev, &num_cells) != 0)
+  {
+    PyErr_SetString(PyExc_ValueError, "Invalid device");
+    return NULL;
+  }
+
+  vertex_bytes = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)(num_vertices * dim * sizeof(double)));
+  cell_bytes   = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)(num_cells * nen * sizeof(viennashe_index_type)));
+  vertex_rows  = (double **) malloc((num_vertices + 1) * sizeof(double *));
+  cell_rows    = (viennashe_index_type **) malloc((num_cells + 1) * sizeof(viennashe_index_type *));
+  if (vertex_bytes == NULL || cell_bytes == NULL || vertex_rows == NULL || cell_rows == NULL)
+  {
+    Py_XDECREF(vertex_bytes); Py_XDECREF(cell_bytes);
+    free(vertex_rows); free(cell_rows);
+    return PyErr_NoMemory();
+  }
+
+  for (i = 0; i < num_vertices; ++i) vertex_rows[i] = ((double *) PyByteArray_AsString(vertex_bytes)) + i * dim;
+  for (i = 0; i < num_cells; ++i)    cell_rows[i]   = ((viennashe_index_type *) PyByteArray_AsString(cell_bytes)) + i * nen;
+
+  err = viennashe_get_grid(dev, vertex_rows, &num_vertices, cell_rows, &num_cells);
+  free(vertex_rows);
+  free(cell_rows);
+  if (err != 0)
+  {
+    Py_DECREF(vertex_bytes); Py_DECREF(cell_bytes);
+    PyErr_SetString(PyExc_ValueError, "Cannot read the mesh of the device");
+    return NULL;
+  }
+
+  /* the memoryviews keep the bytearrays alive */
+  result = Py_BuildValue("(NN)",
+                         viennashe_typed_memoryview(PyMemoryView_FromObject(vertex_bytes), "d", (Py_ssize_t)num_vertices, (Py_ssize_t)dim),
+                         viennashe_typed_memoryview(PyMemoryView_FromObject(cell_bytes),   "L", (Py_ssize_t)num_cells,    (Py_ssize_t)nen));
+  Py_DECREF(vertex_bytes);
+  Py_DECREF(cell_bytes);
+  return result;
+}
+%}
+
+
 
 
 /*********************************/
@@ -41,6 +41,13 @@ namespace viennashe
       return solve_impl(A, b, config);
     }
 
+    // sparse matrix, several right hand sides
+    std::vector<std::vector<double> > solve(viennashe::math::sparse_matrix<double> & A,
+        std::vector<std::vector<double> > const & b, linear_solver_config const & config)
+    {
+      return solve_multiple_impl(A, b, config);
+    }
+
     // dense matrix
     std::vector<double> solve(viennashe::math::dense_matrix<double> & A,
         std::vector<double> const & b)
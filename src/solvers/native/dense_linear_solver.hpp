@@ -164,6 +164,108 @@ namespace viennashe
       return solve(A_dense, b, config, viennashe::solvers::dense_linear_solver_tag());
     }
 
+
+    /** @brief Solves the provided system for several right hand sides using a dense Gauss solver with partial pivoting.
+    *          The elimination is carried out only once and applied to all right hand sides.
+    *
+    * @param A        The system matrix
+    * @param b        The load vectors (right hand sides)
+    * @param config   The linear solver configuration object
+    */
+    template <typename NumericT, typename VectorType>
+    std::vector<VectorType> solve_multiple(viennashe::math::dense_matrix<NumericT> const & A,
+                                           std::vector<VectorType> const & b,
+                                           viennashe::solvers::linear_solver_config const & config,
+                                           viennashe::solvers::dense_linear_solver_tag)
+    {
+      (void)config; //Silence unused parameter warnings
+      log::info<log_linear_solver>() << "* solve(): Solving system for " << b.size() << " right hand sides (Gauss solver, single-threaded)... " << std::endl;
+
+      viennashe::math::dense_matrix<NumericT> B(A); // work matrix
+      std::vector<VectorType> c(b);
+
+      //
+      // Phase 1: Eliminate lower-triangular entries to obtain upper triangular matrix:
+      //
+      for (std::size_t i=0; i<B.size1(); ++i)
+      {
+        // pivot if necessary (rows only, hence the order of the unknowns is not changed):
+        std::size_t pivot_row = i;
+        for (std::size_t k=i+1; k<B.size1(); ++k)
+          if (std::fabs(B(k, i)) > std::fabs(B(pivot_row, i)))
+            pivot_row = k;
+
+        if (pivot_row > i)
+        {
+          for (std::size_t j=0; j<B.size2(); ++j)
+            std::swap(B(pivot_row, j), B(i, j));
+          for (std::size_t k=0; k<c.size(); ++k)
+            std::swap(c[k][pivot_row], c[k][i]);
+        }
+
+        if (!B(i,i))
+          throw std::runtime_error("Provided matrix is singular!");
+
+        // eliminate column entries below diagonal
+        for (std::size_t elim_row = i+1; elim_row < B.size1(); ++elim_row)
+        {
+          NumericT factor = B(elim_row, i) / B(i,i);
+          if (!factor)
+            continue;
+          for (std::size_t k=0; k<c.size(); ++k)
+            c[k][elim_row] -= c[k][i] * factor;
+          for (std::size_t j=i; j<B.size2(); ++j)
+            B(elim_row, j) -= B(i, j) * factor;
+        }
+      }
+
+      //
+      // Phase 2: Substitute:
+      //
+      for (std::size_t k=0; k<c.size(); ++k)
+      {
+        for (std::size_t i=0; i < B.size1(); ++i)
+        {
+          std::size_t row = B.size1() - (i+1);
+          for (std::size_t j=row+1; j<B.size2(); ++j)
+            c[k][row] -= B(row, j) * c[k][j];
+          c[k][row] /= B(row, row);
+        }
+      }
+
+      return c;
+    }
+
+    /** @brief Specialization for a sparse matrix and several right hand sides */
+    template <typename NumericT,
+              typename VectorType>
+    std::vector<VectorType> solve_multiple(viennashe::math::sparse_matrix<NumericT> const & A,
+                                           std::vector<VectorType> const & b,
+                                           viennashe::solvers::linear_solver_config const & config,
+                                           viennashe::solvers::dense_linear_solver_tag)
+    {
+      viennashe::math::dense_matrix<NumericT> A_dense(A.size1(), A.size2());
+
+      for (std::size_t i  = 0;
+                       i != A.size1();
+                     ++i)
+      {
+        typedef typename viennashe::math::sparse_matrix<NumericT>::const_iterator2   AlongRowIterator;
+        typedef typename viennashe::math::sparse_matrix<NumericT>::row_type          RowType;
+
+        RowType const & row_i = A.row(i);
+
+        for (AlongRowIterator col_it  = row_i.begin();
+                              col_it != row_i.end();
+                            ++col_it)
+        {
+          A_dense(i, col_it->first) = col_it->second;
+        }
+      }
+
+      return solve_multiple(A_dense, b, config, viennashe::solvers::dense_linear_solver_tag());
+    }
+
   } // namespace solvers
 } // namespace viennashe
 
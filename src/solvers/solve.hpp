@@ -50,6 +50,10 @@ namespace viennashe
                           VectorType const & rhs,
                           linear_solver_config const & config)
     {
+      // solvers without support for cancellation between iterations (dense, PETSc) are cancelled before they start:
+      if (config.cancel_requested())
+        throw viennashe::solvers::cancelled_exception();
+
       // check for invalid entries first
       const long invalid_row = viennashe::util::matrix_consistency_check(system_matrix);
       if (invalid_row >= 0)
@@ -73,6 +77,8 @@ namespace viennashe
           return viennashe::solvers::solve(system_matrix, rhs, config, viennashe::solvers::serial_linear_solver_tag());
         case linear_solver_config::parallel_linear_solver:
           return viennashe::solvers::solve(system_matrix, rhs, config, viennashe::solvers::parallel_linear_solver_tag());
+        case linear_solver_config::schwarz_linear_solver:
+          return viennashe::solvers::solve(system_matrix, rhs, config, viennashe::solvers::schwarz_linear_solver_tag());
         case linear_solver_config::petsc_parallel_linear_solver:
           return viennashe::solvers::solve(system_matrix, rhs, config, viennashe::solvers::petsc_linear_solver_tag());
 #ifdef VIENNASHE_HAVE_GPU_SOLVER
@@ -87,6 +93,67 @@ namespace viennashe
     }
 
 
+    /** @brief Public interface for solving a system of linear equations for several right hand sides
+    *
+    * The dense solver factors the system matrix once, the serial solver sets up its preconditioner once.
+    * The other solvers solve the systems one after another.
+    *
+    * @param system_matrix     The system matrix
+    * @param rhs               The load vectors
+    * @param config            Linear solver configuration object
+    */
+    template <typename MatrixType,
+              typename VectorType>
+    std::vector<VectorType> solve_multiple_impl(MatrixType & system_matrix,
+                                                std::vector<VectorType> const & rhs,
+                                                linear_solver_config const & config)
+    {
+      if (config.cancel_requested())
+        throw viennashe::solvers::cancelled_exception();
+
+      const long invalid_row = viennashe::util::matrix_consistency_check(system_matrix);
+      if (invalid_row >= 0)
+      {
+        throw viennashe::util::linear_solver_exception("solve(): Found empty row in system_matrix.");
+      }
+
+      // trivial solutions are set directly, the other load vectors are passed to the solver:
+      std::vector<VectorType>  results(rhs.size(), VectorType(system_matrix.size1()));
+      std::vector<VectorType>  nontrivial_rhs;
+      std::vector<std::size_t> nontrivial_index;
+      for (std::size_t i=0; i<rhs.size(); ++i)
+      {
+        viennashe::util::check_vector_for_valid_entries(rhs[i], "solve(): ");
+        if (viennacl::linalg::norm_2(rhs[i]))
+        {
+          nontrivial_rhs.push_back(rhs[i]);
+          nontrivial_index.push_back(i);
+        }
+      }
+      if (nontrivial_rhs.empty())
+        return results;
+
+      std::vector<VectorType> nontrivial_results;
+      switch (config.id())
+      {
+        case linear_solver_config::dense_linear_solver:
+          nontrivial_results = viennashe::solvers::solve_multiple(system_matrix, nontrivial_rhs, config, viennashe::solvers::dense_linear_solver_tag());
+          break;
+        case linear_solver_config::serial_linear_solver:
+          nontrivial_results = viennashe::solvers::solve_multiple(system_matrix, nontrivial_rhs, config, viennashe::solvers::serial_linear_solver_tag());
+          break;
+        default:
+          for (std::size_t i=0; i<nontrivial_rhs.size(); ++i)
+            nontrivial_results.push_back(solve_impl(system_matrix, nontrivial_rhs[i], config));
+      }
+
+      for (std::size_t i=0; i<nontrivial_index.size(); ++i)
+        results[nontrivial_index[i]].swap(nontrivial_results[i]);
+
+      return results;
+    }
+
+
 
 
   }
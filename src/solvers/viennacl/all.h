@@ -17,6 +17,7 @@
 
 #include "src/solvers/viennacl/serial_linear_solver.hpp"
 #include "src/solvers/viennacl/parallel_linear_solver.hpp"
+#include "src/solvers/viennacl/schwarz_linear_solver.hpp"
 
 /** @file all.h
     @brief Convenience header file for all the ViennaCL solver bindings.
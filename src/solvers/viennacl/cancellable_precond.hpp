@@ -0,0 +1,65 @@
+#ifndef VIENNASHE_SOLVERS_VIENNACL_CANCELLABLE_PRECOND_HPP
+#define VIENNASHE_SOLVERS_VIENNACL_CANCELLABLE_PRECOND_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// viennashe
+#include "viennashe/solvers/config.hpp"
+#include "viennashe/solvers/exception.hpp"
+
+/** @file cancellable_precond.hpp
+    @brief Provides a preconditioner wrapper which allows to cancel the Krylov solvers of ViennaCL between iterations
+*/
+
+namespace viennashe
+{
+  namespace solvers
+  {
+
+    /** @brief Wraps a preconditioner and checks the cancellation flag of the linear solver configuration before each application.
+     *
+     * The Krylov solvers of ViennaCL do not provide a hook per iteration, but apply the preconditioner in every iteration (twice per BiCGStab iteration).
+     * Follows the preconditioner interface of ViennaCL, i.e. provides a member function apply(). Throws a cancelled_exception if cancellation is requested.
+     */
+    template <typename PrecondT>
+    class cancellable_precond
+    {
+      public:
+        cancellable_precond(PrecondT const & precond, viennashe::solvers::linear_solver_config const & config) : precond_(precond), config_(config) {}
+
+        template <typename VectorT>
+        void apply(VectorT & vec) const
+        {
+          if (config_.cancel_requested())
+            throw viennashe::solvers::cancelled_exception();
+          precond_.apply(vec);
+        }
+
+      private:
+        PrecondT const & precond_;
+        viennashe::solvers::linear_solver_config const & config_;
+    };
+
+    /** @brief Convenience function for the creation of a cancellable preconditioner */
+    template <typename PrecondT>
+    cancellable_precond<PrecondT> make_cancellable(PrecondT const & precond, viennashe::solvers::linear_solver_config const & config)
+    {
+      return cancellable_precond<PrecondT>(precond, config);
+    }
+
+  } // solvers
+} // viennashe
+
+#endif
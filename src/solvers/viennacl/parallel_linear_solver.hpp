@@ -21,7 +21,10 @@
 #include "viennashe/util/checks.hpp"
 #include "viennashe/math/linalg_util.hpp"
 #include "viennashe/solvers/config.hpp"
+#include "viennashe/util/memory.hpp"
+#include "viennashe/util/profiler.hpp"
 #include "src/solvers/log_keys.h"
+#include "src/solvers/viennacl/cancellable_precond.hpp"
 
 #include "viennashe/log/log.hpp"
 #include "src/solvers/log_keys.h"
@@ -72,6 +75,7 @@ namespace viennashe
       //
 
       log::info<log_linear_solver>() << "* solve(): Computing block preconditioner (multi-threaded)... " << std::endl;
+      viennashe::util::profiler_scope precond_scope("preconditioner_setup");
       //viennacl::linalg::ilut_tag precond_tag(config.ilut_entries(),
       //                                       config.ilut_drop_tolerance());
       viennacl::linalg::ilu0_tag precond_tag;
@@ -91,6 +95,10 @@ namespace viennashe
 
       viennacl::linalg::block_ilu_precond<viennacl::compressed_matrix<NumericT>,
                                           viennacl::linalg::ilu0_tag> block_preconditioner(A, precond_tag, 1);//block_indices);
+      // compressed matrix, block ILU0 factors and the vectors of BiCGStab:
+      viennashe::util::tracked_memory workspace_memory("solver_workspace", 2.0 * viennashe::util::compressed_matrix_bytes<NumericT>(A.size1(), A.nnz())
+                                                                           + 10.0 * static_cast<double>(A.size1()) * sizeof(NumericT));
+      precond_scope.stop();
       //log::debug<log_linear_solver>() << "Time: " << timer.get() << std::endl;
 
       //
@@ -99,10 +107,12 @@ namespace viennashe
       log::info<log_linear_solver>() << "* solve(): Solving system (multi-threaded)... " << std::endl;
       viennacl::linalg::bicgstab_tag  solver_tag(config.tolerance(), config.max_iters());
 
+      viennashe::util::profiler_scope krylov_scope("krylov_solve");
       viennacl::vector<NumericT> vcl_result = viennacl::linalg::solve(A,
                                                                       b,
                                                                       solver_tag,
-                                                                      block_preconditioner);
+                                                                      viennashe::solvers::make_cancellable(block_preconditioner, config));
+      krylov_scope.stop();
 
       //log::debug<log_linear_solver>() << "Time: " << timer.get() << std::endl;
       //log::debug<log_linear_solver>() << "Number of iterations (block ILUT): " << solver_tag.iters() << std::endl;
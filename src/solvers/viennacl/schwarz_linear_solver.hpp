@@ -0,0 +1,406 @@
+#ifndef VIENNASHE_SOLVERS_VIENNACL_SCHWARZ_LINEAR_SOLVER_HPP
+#define VIENNASHE_SOLVERS_VIENNACL_SCHWARZ_LINEAR_SOLVER_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <vector>
+#include <deque>
+#include <memory>
+#include <algorithm>
+
+#ifdef VIENNASHE_WITH_OPENMP
+#include <omp.h>
+#endif
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/util/checks.hpp"
+#include "viennashe/math/linalg_util.hpp"
+#include "viennashe/solvers/config.hpp"
+#include "viennashe/solvers/exception.hpp"
+#include "viennashe/util/memory.hpp"
+#include "viennashe/util/profiler.hpp"
+
+#include "viennashe/log/log.hpp"
+#include "src/solvers/log_keys.h"
+#include "src/solvers/viennacl/cancellable_precond.hpp"
+#include "src/solvers/viennacl/serial_linear_solver.hpp"
+
+// viennacl
+#include "viennacl/linalg/bicgstab.hpp"
+#include "viennacl/linalg/ilu.hpp"
+#include "viennacl/linalg/norm_2.hpp"
+#include "viennacl/linalg/prod.hpp"
+
+/** @file schwarz_linear_solver.hpp
+    @brief Provides a multithreaded overlapping Schwarz preconditioner with ILUT subdomain solves based on functionality in ViennaCL
+*/
+
+namespace viennashe
+{
+  namespace solvers
+  {
+    namespace detail
+    {
+      /** @brief Returns the symmetrized adjacency graph of the sparse matrix (without the diagonal) */
+      template <typename NumericT>
+      std::vector<std::vector<std::size_t> > matrix_graph(viennashe::math::sparse_matrix<NumericT> const & A)
+      {
+        typedef typename viennashe::math::sparse_matrix<NumericT>::const_iterator2   AlongRowIterator;
+        typedef typename viennashe::math::sparse_matrix<NumericT>::row_type          RowType;
+
+        std::vector<std::vector<std::size_t> > graph(A.size1());
+        for (std::size_t i=0; i<A.size1(); ++i)
+        {
+          RowType const & row_i = A.row(i);
+          for (AlongRowIterator iter = row_i.begin(); iter != row_i.end(); ++iter)
+          {
+            if (iter->first == i)
+              continue;
+            graph[i].push_back(iter->first);
+            graph[iter->first].push_back(i);
+          }
+        }
+
+        for (std::size_t i=0; i<graph.size(); ++i)
+        {
+          std::sort(graph[i].begin(), graph[i].end());
+          graph[i].erase(std::unique(graph[i].begin(), graph[i].end()), graph[i].end());
+        }
+
+        return graph;
+      }
+
+      /** @brief Runs a breadth-first search starting at 'start', appends all visited nodes to 'order' and returns the last node visited. */
+      inline std::size_t breadth_first_search(std::vector<std::vector<std::size_t> > const & graph,
+                                              std::size_t start,
+                                              std::vector<bool> & visited,
+                                              std::vector<std::size_t> & order)
+      {
+        std::deque<std::size_t> queue;
+        queue.push_back(start);
+        visited[start] = true;
+
+        std::size_t last = start;
+        while (!queue.empty())
+        {
+          last = queue.front();
+          queue.pop_front();
+          order.push_back(last);
+
+          for (std::size_t k=0; k<graph[last].size(); ++k)
+          {
+            const std::size_t next = graph[last][k];
+            if (!visited[next])
+            {
+              visited[next] = true;
+              queue.push_back(next);
+            }
+          }
+        }
+
+        return last;
+      }
+
+      /**
+       * @brief Partitions the matrix graph into 'num_parts' connected chunks of (approximately) equal size.
+       *
+       * Each connected component is traversed in breadth-first order starting from a pseudo-peripheral node,
+       * and the resulting level-set ordering is cut into contiguous pieces.
+       */
+      inline std::vector<long> graph_partition(std::vector<std::vector<std::size_t> > const & graph, std::size_t num_parts)
+      {
+        const std::size_t N = graph.size();
+        std::vector<long> partition(N, 0);
+
+        if (num_parts <= 1 || N == 0)
+          return partition;
+
+        std::vector<std::size_t> order;
+        order.reserve(N);
+
+        std::vector<bool> visited(N, false);
+        std::vector<bool> visited_probe(N, false);
+        for (std::size_t i=0; i<N; ++i)
+        {
+          if (visited[i])
+            continue;
+
+          // find a pseudo-peripheral node of this component:
+          std::vector<std::size_t> probe_order;
+          std::size_t peripheral = breadth_first_search(graph, i, visited_probe, probe_order);
+
+          breadth_first_search(graph, peripheral, visited, order);
+        }
+
+        const std::size_t chunk_size = (N + num_parts - 1) / num_parts;
+        for (std::size_t k=0; k<order.size(); ++k)
+          partition[order[k]] = static_cast<long>(k / chunk_size);
+
+        return partition;
+      }
+
+
+      /** @brief A subdomain of the Schwarz preconditioner: global indices, ownership flags and the ILUT factorization of the local matrix */
+      template <typename NumericT>
+      struct schwarz_subdomain
+      {
+        typedef viennacl::compressed_matrix<NumericT>                      LocalMatrixType;
+        typedef viennacl::linalg::ilut_precond<LocalMatrixType>            LocalPrecondType;
+
+        std::vector<std::size_t>           indices;   // sorted global indices including the overlap
+        std::vector<bool>                  owned;     // true if the unknown belongs to the non-overlapping part
+        LocalMatrixType                    matrix;
+        std::unique_ptr<LocalPrecondType>  precond;
+      };
+    } // namespace detail
+
+
+    /** @brief Overlapping additive (or restricted additive) Schwarz preconditioner. Subdomain problems are solved approximately using ILUT, in parallel if OpenMP is enabled.
+     *
+     * Follows the preconditioner interface of ViennaCL, i.e. provides a member function apply().
+     */
+    template <typename NumericT>
+    class schwarz_precond
+    {
+        typedef detail::schwarz_subdomain<NumericT>   SubdomainType;
+
+      public:
+        /**
+         * @brief Sets up the subdomains and computes the local factorizations
+         *
+         * @param A          The system matrix
+         * @param partition  Subdomain ID for each unknown (non-overlapping)
+         * @param config     The linear solver configuration (provides overlap, RAS/AS variant and ILUT parameters)
+         */
+        schwarz_precond(viennashe::math::sparse_matrix<NumericT> const & A,
+                        std::vector<long> const & partition,
+                        viennashe::solvers::linear_solver_config const & config)
+          : size_(A.size1()), restricted_(config.schwarz_restricted())
+        {
+          typedef typename viennashe::math::sparse_matrix<NumericT>::const_iterator2   AlongRowIterator;
+          typedef typename viennashe::math::sparse_matrix<NumericT>::row_type          RowType;
+
+          long num_subdomains = 0;
+          for (std::size_t i=0; i<partition.size(); ++i)
+            num_subdomains = std::max(num_subdomains, partition[i] + 1);
+
+          std::vector<std::vector<std::size_t> > graph = detail::matrix_graph(A);
+
+          subdomains_.resize(static_cast<std::size_t>(num_subdomains));
+          for (std::size_t i=0; i<partition.size(); ++i)
+            if (partition[i] >= 0)
+              subdomains_[static_cast<std::size_t>(partition[i])].indices.push_back(i);
+
+          viennacl::linalg::ilut_tag precond_tag(config.ilut_entries(), config.ilut_drop_tolerance());
+
+#ifdef VIENNASHE_WITH_OPENMP
+          #pragma omp parallel for
+#endif
+          for (long s=0; s<num_subdomains; ++s)
+          {
+            SubdomainType & subdomain = subdomains_[static_cast<std::size_t>(s)];
+            std::vector<std::size_t> & indices = subdomain.indices;
+
+            // Step 1: Add overlap layers through the matrix graph
+            std::size_t layer_begin = 0;
+            for (std::size_t layer = 0; layer < config.schwarz_overlap(); ++layer)
+            {
+              std::size_t layer_end = indices.size();
+              std::vector<std::size_t> new_indices;
+              for (std::size_t k = layer_begin; k < layer_end; ++k)
+                for (std::size_t l=0; l<graph[indices[k]].size(); ++l)
+                  new_indices.push_back(graph[indices[k]][l]);
+
+              std::vector<std::size_t> current(indices);
+              std::sort(current.begin(), current.end());
+              std::sort(new_indices.begin(), new_indices.end());
+              new_indices.erase(std::unique(new_indices.begin(), new_indices.end()), new_indices.end());
+
+              for (std::size_t k=0; k<new_indices.size(); ++k)
+                if (!std::binary_search(current.begin(), current.end(), new_indices[k]))
+                  indices.push_back(new_indices[k]);
+
+              layer_begin = layer_end;
+            }
+
+            std::sort(indices.begin(), indices.end());
+            subdomain.owned.resize(indices.size());
+            for (std::size_t k=0; k<indices.size(); ++k)
+              subdomain.owned[k] = (partition[indices[k]] == s);
+
+            // Step 2: Extract local matrix (couplings to unknowns outside the subdomain are dropped)
+            viennashe::math::sparse_matrix<NumericT> local_matrix(indices.size(), indices.size());
+            for (std::size_t k=0; k<indices.size(); ++k)
+            {
+              RowType const & row_k = A.row(indices[k]);
+              for (AlongRowIterator iter = row_k.begin(); iter != row_k.end(); ++iter)
+              {
+                std::vector<std::size_t>::const_iterator pos = std::lower_bound(indices.begin(), indices.end(), iter->first);
+                if (pos != indices.end() && *pos == iter->first)
+                  local_matrix(k, std::size_t(pos - indices.begin())) = iter->second;
+              }
+            }
+
+            // Step 3: Local factorization
+            subdomain.matrix.resize(indices.size(), indices.size(), false);
+            detail::copy(local_matrix, subdomain.matrix);
+            subdomain.precond.reset(new typename SubdomainType::LocalPrecondType(subdomain.matrix, precond_tag));
+          }
+        }
+
+        /** @brief Applies the preconditioner to the provided vector (in-place) */
+        template <typename VectorT>
+        void apply(VectorT & vec) const
+        {
+          std::vector<NumericT> residual(size_);
+          viennacl::fast_copy(vec.begin(), vec.end(), residual.begin());
+
+          std::vector<std::vector<NumericT> > local_results(subdomains_.size());
+
+#ifdef VIENNASHE_WITH_OPENMP
+          #pragma omp parallel for
+#endif
+          for (long s=0; s<static_cast<long>(subdomains_.size()); ++s)
+          {
+            SubdomainType const & subdomain = subdomains_[static_cast<std::size_t>(s)];
+            std::vector<NumericT> & local = local_results[static_cast<std::size_t>(s)];
+
+            local.resize(subdomain.indices.size());
+            for (std::size_t k=0; k<subdomain.indices.size(); ++k)
+              local[k] = residual[subdomain.indices[k]];
+
+            viennacl::vector<NumericT> local_vec(local.size());
+            viennacl::fast_copy(local.begin(), local.end(), local_vec.begin());
+            subdomain.precond->apply(local_vec);
+            viennacl::fast_copy(local_vec.begin(), local_vec.end(), local.begin());
+          }
+
+          // Combine local results (serially, as subdomains overlap):
+          std::vector<NumericT> result(size_);
+          for (std::size_t s=0; s<subdomains_.size(); ++s)
+          {
+            SubdomainType const & subdomain = subdomains_[s];
+            for (std::size_t k=0; k<subdomain.indices.size(); ++k)
+              if (!restricted_ || subdomain.owned[k])
+                result[subdomain.indices[k]] += local_results[s][k];
+          }
+
+          viennacl::fast_copy(result.begin(), result.end(), vec.begin());
+        }
+
+        std::size_t num_subdomains() const { return subdomains_.size(); }
+
+      private:
+        schwarz_precond(schwarz_precond const &);
+        void operator=(schwarz_precond const &);
+
+        std::size_t                 size_;
+        bool                        restricted_;
+        std::vector<SubdomainType>  subdomains_;
+    };
+
+
+    /** @brief Solves the provided system using an iterative solver with an overlapping Schwarz preconditioner on CPU
+    *
+    * The subdomains are taken from config.schwarz_partition() if provided (e.g. from device segments), otherwise the matrix graph is partitioned.
+    *
+    * @param system_matrix        The system matrix
+    * @param rhs                  The load vector (right hand side)
+    * @param config               The linear solver configuration object
+    */
+    template <typename NumericT,
+              typename VectorType>
+    VectorType solve(viennashe::math::sparse_matrix<NumericT> const & system_matrix,
+                     VectorType const & rhs,
+                     viennashe::solvers::linear_solver_config const & config,
+                     viennashe::solvers::schwarz_linear_solver_tag
+                    )
+    {
+      //
+      // Step 1: Convert data to ViennaCL types:
+      //
+      viennacl::compressed_matrix<NumericT> A(system_matrix.size1(), system_matrix.size2());
+      viennacl::vector<NumericT>            b(system_matrix.size1());
+
+      viennacl::fast_copy(&(rhs[0]), &(rhs[0]) + rhs.size(), b.begin());
+      detail::copy(system_matrix, A);
+
+      //
+      // Step 2: Set up subdomains and preconditioner
+      //
+      viennashe::util::profiler_scope precond_scope("preconditioner_setup");
+      std::vector<long> partition(config.schwarz_partition());
+      if (partition.size() != system_matrix.size1())
+      {
+        if (partition.size() > 0)
+          log::warning() << "* solve(): Schwarz partition does not match system size, using graph partitioning instead." << std::endl;
+
+        std::size_t num_subdomains = config.schwarz_subdomains();
+        if (num_subdomains == 0)
+        {
+#ifdef VIENNASHE_WITH_OPENMP
+          num_subdomains = static_cast<std::size_t>(omp_get_max_threads());
+#else
+          num_subdomains = 1;
+#endif
+        }
+        partition = detail::graph_partition(detail::matrix_graph(system_matrix), num_subdomains);
+      }
+
+      log::info<log_linear_solver>() << "* solve(): Computing Schwarz preconditioner (multi-threaded)... " << std::endl;
+      schwarz_precond<NumericT> preconditioner(system_matrix, partition, config);
+      log::info<log_linear_solver>() << "* solve(): Number of subdomains: " << preconditioner.num_subdomains()
+                                     << ", overlap: " << config.schwarz_overlap() << std::endl;
+      // compressed matrix, subdomain factors (about one copy of the matrix without overlap) and the vectors of BiCGStab:
+      viennashe::util::tracked_memory workspace_memory("solver_workspace", 2.0 * viennashe::util::compressed_matrix_bytes<NumericT>(A.size1(), A.nnz())
+                                                                           + 10.0 * static_cast<double>(A.size1()) * sizeof(NumericT));
+      precond_scope.stop();
+
+      //
+      // Step 3: Solve system:
+      //
+      log::info<log_linear_solver>() << "* solve(): Solving system (multi-threaded)... " << std::endl;
+      viennacl::linalg::bicgstab_tag  solver_tag(config.tolerance(), config.max_iters());
+
+      viennashe::util::profiler_scope krylov_scope("krylov_solve");
+      viennacl::vector<NumericT> vcl_result = viennacl::linalg::solve(A,
+                                                                      b,
+                                                                      solver_tag,
+                                                                      viennashe::solvers::make_cancellable(preconditioner, config));
+      krylov_scope.stop();
+
+      //
+      // Step 4: Convert data back:
+      //
+      VectorType result(vcl_result.size());
+      viennacl::fast_copy(vcl_result.begin(), vcl_result.end(), &(result[0]));
+
+      viennashe::util::check_vector_for_valid_entries(result);
+
+      log::info<log_linear_solver>() << "* solve(): residual: "
+                << viennacl::linalg::norm_2(viennacl::linalg::prod(A, vcl_result) - b) / viennacl::linalg::norm_2(b)
+                << " after " << solver_tag.iters() << " iterations." << std::endl;
+
+      return result;
+    }
+
+  } // solvers
+
+} // viennashe
+
+
+#endif
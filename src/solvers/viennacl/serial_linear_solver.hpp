@@ -21,7 +21,10 @@
 #include "viennashe/math/linalg_util.hpp"
 #include "viennashe/log/log.hpp"
 #include "viennashe/solvers/config.hpp"
+#include "viennashe/util/memory.hpp"
+#include "viennashe/util/profiler.hpp"
 #include "src/solvers/log_keys.h"
+#include "src/solvers/viennacl/cancellable_precond.hpp"
 
 // viennacl
 #include "viennacl/linalg/bicgstab.hpp"
@@ -120,20 +123,27 @@ namespace viennashe
       // Step 2: Setup preconditioner and run solver
       //
       log::info<log_linear_solver>() << "* solve(): Computing preconditioner (single-threaded)... " << std::endl;
+      viennashe::util::profiler_scope precond_scope("preconditioner_setup");
       //viennacl::linalg::ilut_tag precond_tag(config.ilut_entries(),
       //                                        config.ilut_drop_tolerance());
       viennacl::linalg::ilu0_tag precond_tag;
       viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > preconditioner(A, precond_tag);
+      // compressed matrix, ILU0 factors and the vectors of BiCGStab:
+      viennashe::util::tracked_memory workspace_memory("solver_workspace", 2.0 * viennashe::util::compressed_matrix_bytes<NumericT>(A.size1(), A.nnz())
+                                                                           + 10.0 * static_cast<double>(A.size1()) * sizeof(NumericT));
+      precond_scope.stop();
 
       log::info<log_linear_solver>() << "* solve(): Solving system (single-threaded)... " << std::endl;
       viennacl::linalg::bicgstab_tag  solver_tag(config.tolerance(), config.max_iters());
 
       //log::debug<log_linear_solver>() << "Compressed matrix: " << system_matrix << std::endl;
       //log::debug<log_linear_solver>() << "Compressed rhs: " << rhs << std::endl;
+      viennashe::util::profiler_scope krylov_scope("krylov_solve");
       viennacl::vector<NumericT> vcl_result = viennacl::linalg::solve(A,
                                                                        b,
                                                                        solver_tag,
-                                                                       preconditioner);
+                                                                       viennashe::solvers::make_cancellable(preconditioner, config));
+      krylov_scope.stop();
       //log::debug<log_linear_solver>() << "Number of iterations (ILUT): " << solver_tag.iters() << std::endl;
 
       //
@@ -156,6 +166,64 @@ namespace viennashe
     }
 
 
+    /** @brief Solves the provided system for several right hand sides in a serial fashion.
+    *          The ILU0 preconditioner is computed only once and reused for all right hand sides.
+    *
+    * @param system_matrix        The system matrix
+    * @param rhs                  The load vectors (right hand sides)
+    * @param config               The linear solver configuration object
+    */
+    template <typename MatrixType,
+              typename VectorType>
+    std::vector<VectorType> solve_multiple(MatrixType const & system_matrix,
+                                           std::vector<VectorType> const & rhs,
+                                           viennashe::solvers::linear_solver_config const & config,
+                                           viennashe::solvers::serial_linear_solver_tag
+                                          )
+    {
+      typedef typename VectorType::value_type     NumericT;
+
+      viennacl::compressed_matrix<NumericT> A(system_matrix.size1(), system_matrix.size2());
+      detail::copy(system_matrix, A);
+
+      log::info<log_linear_solver>() << "* solve(): Computing preconditioner (single-threaded)... " << std::endl;
+      viennashe::util::profiler_scope precond_scope("preconditioner_setup");
+      viennacl::linalg::ilu0_tag precond_tag;
+      viennacl::linalg::ilu0_precond<viennacl::compressed_matrix<NumericT> > preconditioner(A, precond_tag);
+      viennashe::util::tracked_memory workspace_memory("solver_workspace", 2.0 * viennashe::util::compressed_matrix_bytes<NumericT>(A.size1(), A.nnz())
+                                                                           + 10.0 * static_cast<double>(A.size1()) * sizeof(NumericT));
+      precond_scope.stop();
+
+      std::vector<VectorType> results(rhs.size());
+      for (std::size_t k=0; k<rhs.size(); ++k)
+      {
+        viennacl::vector<NumericT> b(system_matrix.size1());
+        viennacl::fast_copy(&(rhs[k][0]), &(rhs[k][0]) + rhs[k].size(), b.begin());
+
+        log::info<log_linear_solver>() << "* solve(): Solving system for right hand side " << k << " (single-threaded)... " << std::endl;
+        viennacl::linalg::bicgstab_tag  solver_tag(config.tolerance(), config.max_iters());
+
+        viennashe::util::profiler_scope krylov_scope("krylov_solve");
+        viennacl::vector<NumericT> vcl_result = viennacl::linalg::solve(A,
+                                                                         b,
+                                                                         solver_tag,
+                                                                         viennashe::solvers::make_cancellable(preconditioner, config));
+        krylov_scope.stop();
+
+        results[k].resize(vcl_result.size());
+        viennacl::fast_copy(vcl_result.begin(), vcl_result.end(), &(results[k][0]));
+
+        viennashe::util::check_vector_for_valid_entries(results[k]);
+
+        log::info<log_linear_solver>() << "* solve(): residual: "
+                  << viennacl::linalg::norm_2(viennacl::linalg::prod(A, vcl_result) - b) / viennacl::linalg::norm_2(b)
+                  << " after " << solver_tag.iters() << " iterations." << std::endl;
+      }
+
+      return results;
+    }
+
+
   } // solvers
 } // viennashe
 
@@ -0,0 +1,174 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file async_output.cpp Contains a test of the background output service
+ *  \test Writes results through viennashe::io::async_writer and checks that the files are identical to the ones written synchronously, that snapshots are taken at submission, and that errors are reported by flush().
+ */
+
+/** @brief A cell quantity stored in a std::vector, used to check that the background writer operates on a snapshot */
+struct vector_cell_quantity
+{
+  vector_cell_quantity(std::vector<double> const & v) : values(v) {}
+
+  template <typename CellT>
+  double operator()(CellT const & cell) const { return values.at(static_cast<std::size_t>(cell.id().get())); }
+
+  std::vector<double> const & values;
+};
+
+/** @brief Returns the content of a file */
+inline std::string read_file(std::string const & filename)
+{
+  std::ifstream file(filename.c_str());
+  if (!file)
+    throw viennashe::io::cannot_open_file_exception(filename);
+
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+inline int check_files_equal(std::string const & file1, std::string const & file2)
+{
+  if (read_file(file1) != read_file(file2) || read_file(file1).empty())
+  {
+    std::cerr << "* ERROR: Files " << file1 << " and " << file2 << " differ!" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "* check_files_equal(): " << file1 << " and " << file2 << " are identical" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+
+int main()
+{
+  typedef viennagrid::quadrilateral_2d_mesh                     MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  typedef viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 1e-6, 20,   //start at x=, length, points
+                               0.0, 1e-7,  2);  //start at y=, length, points
+  device.generate_mesh(generator_params);
+  init_pn_device(device, generator_params.at(0).get_length_x(), 0.3);
+
+  std::cout << "* main(): Running DD simulation..." << std::endl;
+  viennashe::config dd_cfg;
+  dd_cfg.with_electrons(true);
+  dd_cfg.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.with_holes(true);
+  dd_cfg.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+
+  viennashe::simulator<DeviceType> dd_simulator(device, dd_cfg);
+  dd_simulator.run();
+
+  //
+  // Test 1: Output of the background writer is identical to synchronous output
+  //
+  viennashe::io::write_cell_quantity_for_gnuplot(dd_simulator.potential(),        device, "async_output_potential_sync.dat");
+  viennashe::io::write_cell_quantity_for_gnuplot(dd_simulator.electron_density(), device, "async_output_electrons_sync.dat");
+
+  viennashe::io::async_writer writer(1);
+  viennashe::io::write_cell_quantity_for_gnuplot_async(writer, dd_simulator.potential(),        device, "async_output_potential_async.dat");
+  viennashe::io::write_cell_quantity_for_gnuplot_async(writer, dd_simulator.electron_density(), device, "async_output_electrons_async.dat");
+  writer.flush();
+
+  if (writer.pending_jobs() != 0)
+  {
+    std::cerr << "* ERROR: Jobs pending after flush()" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (check_files_equal("async_output_potential_sync.dat", "async_output_potential_async.dat") != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+  if (check_files_equal("async_output_electrons_sync.dat", "async_output_electrons_async.dat") != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  //
+  // Test 2: Data is taken at the time of submission, not at the time of writing
+  //
+  CellContainer cells(device.mesh());
+  std::vector<double> values(cells.size());
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+    values[static_cast<std::size_t>(cit->id().get())] = viennagrid::centroid(*cit)[0];
+
+  viennashe::io::write_cell_quantity_for_gnuplot(vector_cell_quantity(values), device, "async_output_snapshot_sync.dat");
+  for (std::size_t i=0; i<10; ++i)
+  {
+    viennashe::io::write_cell_quantity_for_gnuplot_async(writer, vector_cell_quantity(values), device, "async_output_snapshot_async.dat");
+    for (std::size_t j=0; j<values.size(); ++j)
+      values[j] += 1.0;      // modify while the previous snapshot may still be written
+    writer.flush();
+    if (check_files_equal("async_output_snapshot_sync.dat", "async_output_snapshot_async.dat") != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+    viennashe::io::write_cell_quantity_for_gnuplot(vector_cell_quantity(values), device, "async_output_snapshot_sync.dat");
+  }
+
+  //
+  // Test 3: Errors are reported by flush()
+  //
+  bool error_reported = false;
+  viennashe::io::write_cell_quantity_for_gnuplot_async(writer, dd_simulator.potential(), device, "non_existing_directory/async_output.dat");
+  try
+  {
+    writer.flush();
+  }
+  catch (viennashe::io::cannot_open_file_exception const &)
+  {
+    error_reported = true;
+  }
+
+  if (!error_reported)
+  {
+    std::cerr << "* ERROR: Failed background output was not reported" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
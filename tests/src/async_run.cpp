@@ -0,0 +1,333 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+// C interface and its worker pool:
+#include "libviennashe/include/libviennashe.h"
+#include "libviennashe/src/worker_pool.hpp"
+
+
+/** \file async_run.cpp Contains a test of the cancellation and the asynchronous execution of simulations
+ *  \test Checks the cancellation via simulator::cancel(), that the worker pool wakes up the waiters of dropped jobs,
+ *        and the states of viennashe_run_async(), viennashe_wait(), viennashe_poll_status() and viennashe_cancel() of libviennashe,
+ *        including a simulator freed while its simulation is queued.
+ */
+
+/** @brief Iteration callback, which requests cancellation through simulator::cancel() (as done from another thread) after a given number of iterations */
+template <typename SimulatorType>
+struct request_cancel_after_iterations
+{
+  request_cancel_after_iterations(std::size_t n, SimulatorType & sim) : n_(n), sim_(&sim) {}
+
+  bool operator()(viennashe::nonlinear_iteration_info const & info) const
+  {
+    if (info.iteration >= n_)
+      sim_->cancel();
+    return false;
+  }
+
+  std::size_t n_;
+  SimulatorType * sim_;
+};
+
+/** @brief A gate, which is closed until opened once. Threads waiting for the gate block until it is opened. */
+struct gate
+{
+  gate() : entered(false), opened(false) {}
+
+  /** @brief Signals that a thread has arrived at the gate and blocks until the gate is opened */
+  void pass()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    entered = true;
+    changed.notify_all();
+    changed.wait(lock, [this]{ return opened; });
+  }
+
+  /** @brief Blocks until a thread has arrived at the gate */
+  void wait_for_arrival()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [this]{ return entered; });
+  }
+
+  void open()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    opened = true;
+    changed.notify_all();
+  }
+
+  std::mutex               mutex;
+  std::condition_variable  changed;
+  bool                     entered;
+  bool                     opened;
+};
+
+/** @brief C iteration callback, which blocks in the first nonlinear iteration until the gate passed as user data is opened */
+extern "C" int block_in_first_iteration(const viennashe_iteration_info * info, void * user_data)
+{
+  if (info->iteration == 1)
+    static_cast<gate *>(user_data)->pass();
+  return 0;
+}
+
+/** @brief Checks the status of a simulator of libviennashe */
+bool check_status(viennashe_simulator sim, viennashe_run_status expected, char const * message)
+{
+  viennashe_run_status status = viennashe_run_idle;
+  if (viennashe_poll_status(sim, &status, NULL) != 0 || status != expected)
+  {
+    std::cerr << "* ERROR: " << message << " (status " << status << ", expected " << expected << ")" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+int main()
+{
+  typedef viennagrid::line_1d_mesh                              MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  //
+  // Test 1: Cancellation via simulator::cancel()
+  //
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 1e-6, 21);
+  device.generate_mesh(generator_params);
+  init_device(device, 1e-6);
+
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(false);
+  config.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  config.nonlinear_solver().max_iters(20);
+  config.nonlinear_solver().tolerance(1e-30);
+
+  std::cout << "* main(): Computing DD with cancellation request..." << std::endl;
+  viennashe::simulator<DeviceType> cancelled_simulator(device, config);
+  cancelled_simulator.set_iteration_callback(request_cancel_after_iterations<viennashe::simulator<DeviceType> >(3, cancelled_simulator));
+  cancelled_simulator.run();
+  if (!cancelled_simulator.cancelled() || cancelled_simulator.last_iteration().iteration != 3 || cancelled_simulator.cancel_requested())
+  {
+    std::cerr << "* ERROR: Simulation not cancelled at the next nonlinear iteration" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A request made before run() cancels the run before the first iteration:
+  cancelled_simulator.set_iteration_callback(viennashe::simulator<DeviceType>::iteration_callback_type());
+  cancelled_simulator.cancel();
+  cancelled_simulator.run();
+  if (!cancelled_simulator.cancelled() || cancelled_simulator.last_iteration().iteration != 0 || cancelled_simulator.cancel_requested())
+  {
+    std::cerr << "* ERROR: Pending cancellation request not served" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The cancellation flag is reset by the next run:
+  cancelled_simulator.run();
+  if (cancelled_simulator.cancelled() || cancelled_simulator.last_iteration().iteration == 0)
+  {
+    std::cerr << "* ERROR: Simulation cancelled without request" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 2: Jobs dropped by the worker pool are discarded, so that the threads waiting for them are woken up
+  //
+  std::cout << "* main(): Destroying worker pool with queued job..." << std::endl;
+  {
+    gate running_job;
+    bool dropped_job_executed = false;
+    {
+      libviennashe::worker_pool pool(1);
+      pool.submit([&running_job]() { running_job.pass(); });
+      // The discard functor opens the gate, hence the running job only finishes if the queued job is discarded before the workers are joined:
+      pool.submit([&dropped_job_executed]() { dropped_job_executed = true; },
+                  [&running_job]() { running_job.open(); });
+      running_job.wait_for_arrival();
+    }
+    if (dropped_job_executed)
+    {
+      std::cerr << "* ERROR: Queued job executed after the worker pool has been destroyed" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // Test 3: States of asynchronous simulations in libviennashe
+  //
+  std::cout << "* main(): Asynchronous simulations with libviennashe..." << std::endl;
+
+  // A single worker thread, so that further simulations stay queued while the first one is blocked in its callback.
+  // Must be set before the worker pool is created by the first call to viennashe_run_async():
+#if defined(_MSC_VER)
+  _putenv_s("VIENNASHE_ASYNC_WORKERS", "1");
+#else
+  setenv("VIENNASHE_ASYNC_WORKERS", "1", 1);
+#endif
+
+  const long points_x = 21;
+  std::vector<viennashe_material_id> matids(points_x - 1);
+  std::vector<double>                Nd(points_x - 1, 1e24);
+  std::vector<double>                Na(points_x - 1, 1e8);
+  viennashe_index_type               bnd_cells[] = { 0, points_x - 2 };
+  double                             bnd_pot[]   = { 0.0, 0.1 };
+
+  for (long i = 0; i < points_x - 1; ++i)
+    viennashe_get_silicon_id(&matids[i]);
+  viennashe_get_metal_id(&matids[0]);
+  viennashe_get_metal_id(&matids[points_x - 2]);
+
+  viennashe_initalize();
+
+  viennashe_device dev = NULL;
+  viennashe_config conf = NULL;
+  viennashe_create_1d_device(&dev, 1e-6, points_x);
+  viennashe_initalize_device(dev, &matids[0], &Nd[0], &Na[0]);
+  viennashe_set_contact_potential_cells(dev, bnd_cells, bnd_pot, 2);
+
+  viennashe_create_config(&conf);
+  viennashe_config_standard_dd(conf);
+  viennashe_set_nonlinear_solver_config(conf, viennashe_nonlinear_solver_gummel, 10, 0.5);
+
+  viennashe_simulator sim = NULL;
+  viennashe_simulator sim_queued = NULL;
+  viennashe_simulator sim_freed = NULL;
+  viennashe_create_simulator(&sim, dev, conf);
+  viennashe_create_simulator(&sim_queued, dev, conf);
+  viennashe_create_simulator(&sim_freed, dev, conf);
+
+  if (!check_status(sim, viennashe_run_idle, "New simulator not idle"))
+    return EXIT_FAILURE;
+  if (viennashe_wait(sim) != 0)
+  {
+    std::cerr << "* ERROR: Waiting for an idle simulator failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (viennashe_run_async(NULL) != 1 || viennashe_wait(NULL) != 1 || viennashe_cancel(NULL) != 1)
+  {
+    std::cerr << "* ERROR: Invalid simulator not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The first simulation blocks the only worker thread in its first iteration:
+  gate callback_gate;
+  viennashe_set_iteration_callback(sim, block_in_first_iteration, &callback_gate);
+  if (viennashe_run_async(sim) != 0)
+  {
+    std::cerr << "* ERROR: viennashe_run_async() failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  callback_gate.wait_for_arrival();
+  if (!check_status(sim, viennashe_run_running, "Simulation not running"))
+    return EXIT_FAILURE;
+  if (viennashe_run_async(sim) != 2 || viennashe_run(sim) != 2)
+  {
+    std::cerr << "* ERROR: Second run of a running simulator not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Further simulations are queued, a queued simulation is cancelled right away:
+  viennashe_run_async(sim_queued);
+  if (!check_status(sim_queued, viennashe_run_queued, "Simulation not queued"))
+    return EXIT_FAILURE;
+  viennashe_cancel(sim_queued);
+  if (!check_status(sim_queued, viennashe_run_cancelled, "Queued simulation not cancelled"))
+    return EXIT_FAILURE;
+  viennashe_iteration_info info;
+  if (viennashe_wait(sim_queued) != 0 || viennashe_get_iteration_info(sim_queued, &info, NULL) != 0 || info.iteration != 0)
+  {
+    std::cerr << "* ERROR: Cancelled queued simulation has been run" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A simulator may be freed while its simulation is queued. The worker thread must not touch it later on:
+  viennashe_run_async(sim_freed);
+  if (!check_status(sim_freed, viennashe_run_queued, "Simulation not queued"))
+    return EXIT_FAILURE;
+  if (viennashe_free_simulator(sim_freed) != 0)
+  {
+    std::cerr << "* ERROR: Freeing a simulator with a queued simulation failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  sim_freed = NULL;
+
+  // Cancel the running simulation, which stops at the end of the blocked iteration:
+  viennashe_cancel(sim);
+  callback_gate.open();
+  libviennashe_bool cancelled = libviennashe_false;
+  if (viennashe_wait(sim) != 0 || !check_status(sim, viennashe_run_cancelled, "Running simulation not cancelled")
+      || viennashe_get_iteration_info(sim, &info, &cancelled) != 0 || !cancelled || info.iteration != 1)
+  {
+    std::cerr << "* ERROR: Running simulation not cancelled after the first iteration" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The queued cancelled simulation can be started again and runs to the end:
+  viennashe_run_async(sim_queued);
+  viennashe_run_status status = viennashe_run_idle;
+  if (viennashe_wait(sim_queued) != 0 || viennashe_poll_status(sim_queued, &status, &info) != 0
+      || status != viennashe_run_finished || info.iteration == 0)
+  {
+    std::cerr << "* ERROR: Restarted simulation did not finish" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Cancellation of a finished simulation has no effect on the next run:
+  viennashe_set_iteration_callback(sim, NULL, NULL);
+  viennashe_cancel(sim);
+  if (viennashe_run(sim) != 0 || !check_status(sim, viennashe_run_finished, "Simulation cancelled by an outdated request"))
+    return EXIT_FAILURE;
+
+  viennashe_free_simulator(sim);
+  viennashe_free_simulator(sim_queued);
+  viennashe_free_config(conf);
+  viennashe_free_device(dev);
+
+  viennashe_finalize();
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
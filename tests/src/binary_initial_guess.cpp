@@ -0,0 +1,182 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file binary_initial_guess.cpp Contains a test of the binary vector and initial guess files
+ *  \test Writes the solution of a drift-diffusion simulation to binary initial guess files, maps them into a second simulator and compares the values. Also checks the plain vector round trip, the rejection of a corrupt vector size and the detection of a mesh mismatch.
+ */
+
+/** @brief Compares the values of an unknown quantity of the simulator with an accessor on all cells */
+template <typename DeviceType, typename SimulatorType, typename AccessorType>
+bool compare_quantity(DeviceType const & device, SimulatorType const & simulator, std::string const & name, AccessorType const & reference)
+{
+  typedef typename DeviceType::mesh_type                                        MeshType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    if (simulator.quantities().get_unknown_quantity(name).get_value(*cit) != reference(*cit))
+    {
+      std::cerr << "* ERROR: Mismatch of quantity '" << name << "' at cell " << cit->id().get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+int main()
+{
+  typedef viennagrid::line_1d_mesh                              MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+  typedef viennashe::simulator<DeviceType>                      SimulatorType;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 1e-6, 51);   //start at x=, length, points
+  device.generate_mesh(generator_params);
+  init_pn_device(device, 1e-6, 0.2);
+
+  //
+  // Test 1: Plain vector round trip
+  //
+  std::vector<double> vec(1000);
+  for (std::size_t i=0; i<vec.size(); ++i)
+    vec[i] = 1.0 / static_cast<double>(i + 1) - 1e-3 * static_cast<double>(i);
+  viennashe::io::write_vector_to_binary_file(vec, "binary_initial_guess_vector.bin", "test_vector", 42);
+
+  std::vector<double> vec2;
+  viennashe::io::read_vector_from_binary_file(vec2, "binary_initial_guess_vector.bin");
+  viennashe::io::mapped_vector mapped("binary_initial_guess_vector.bin");
+  if (vec2 != vec || mapped.name() != "test_vector" || mapped.mesh_hash() != 42)
+  {
+    std::cerr << "* ERROR: Vector round trip failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A corrupt size, for which size * sizeof(double) overflows, must not be accepted:
+  viennashe::io::write_vector_to_binary_file(vec, "binary_initial_guess_corrupt.bin", "test_vector", 42);
+  {
+    std::fstream file("binary_initial_guess_corrupt.bin", std::ios::in | std::ios::out | std::ios::binary);
+    const unsigned long long corrupt_size = (1ULL << 61) + 1;
+    file.seekp(static_cast<std::streamoff>(offsetof(viennashe::io::vector_file_header, size)));
+    file.write(reinterpret_cast<char const *>(&corrupt_size), sizeof(corrupt_size));
+  }
+  bool size_error = false;
+  try
+  {
+    viennashe::io::mapped_vector corrupt("binary_initial_guess_corrupt.bin");
+  }
+  catch (viennashe::io::premature_end_of_file_exception const & e)
+  {
+    std::cout << "* main(): Expected exception: " << e.what() << std::endl;
+    size_error = true;
+  }
+  if (!size_error)
+  {
+    std::cerr << "* ERROR: Corrupt vector size not detected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 2: Initial guess round trip
+  //
+  std::cout << "* main(): Computing DD..." << std::endl;
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(true);
+  config.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  config.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+  config.nonlinear_solver().max_iters(20);
+
+  SimulatorType dd_simulator(device, config);
+  dd_simulator.run();
+
+  std::cout << "* main(): Writing initial guess..." << std::endl;
+  viennashe::io::write_initial_guess_binary(device, dd_simulator.potential(),        viennashe::quantity::potential(),        "binary_initial_guess_potential.bin");
+  viennashe::io::write_initial_guess_binary(device, dd_simulator.electron_density(), viennashe::quantity::electron_density(), "binary_initial_guess_electrons.bin");
+  viennashe::io::write_initial_guess_binary(device, dd_simulator.hole_density(),     viennashe::quantity::hole_density(),     "binary_initial_guess_holes.bin");
+
+  std::cout << "* main(): Reading initial guess..." << std::endl;
+  SimulatorType simulator(device, config);
+  viennashe::io::read_initial_guess_binary(simulator, "binary_initial_guess_potential.bin");
+  viennashe::io::read_initial_guess_binary(simulator, "binary_initial_guess_electrons.bin");
+  viennashe::io::read_initial_guess_binary(simulator, "binary_initial_guess_holes.bin");
+
+  if (!compare_quantity(device, simulator, viennashe::quantity::potential(),        dd_simulator.potential())
+      || !compare_quantity(device, simulator, viennashe::quantity::electron_density(), dd_simulator.electron_density())
+      || !compare_quantity(device, simulator, viennashe::quantity::hole_density(),     dd_simulator.hole_density()))
+    return EXIT_FAILURE;
+
+  //
+  // Test 3: A different mesh must be detected
+  //
+  DeviceType device2;
+  viennashe::util::device_generation_config generator_params2;
+  generator_params2.add_segment(0.0, 1e-6, 41);
+  device2.generate_mesh(generator_params2);
+  init_pn_device(device2, 1e-6, 0.2);
+
+  SimulatorType simulator2(device2, config);
+  bool mesh_error = false;
+  try
+  {
+    viennashe::io::read_initial_guess_binary(simulator2, "binary_initial_guess_potential.bin");
+  }
+  catch (viennashe::io::io_operation_unsupported_exception const & e)
+  {
+    std::cout << "* main(): Expected exception: " << e.what() << std::endl;
+    mesh_error = true;
+  }
+  if (!mesh_error)
+  {
+    std::cerr << "* ERROR: Mesh mismatch not detected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,275 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+
+/** \file device_cache.cpp Contains a test of the binary device cache
+ *  \test Writes a device with two segments to a cache file, reloads it into a new device, compares mesh, segmentation and device data, and checks that a modified source file invalidates the cache.
+ *        Truncated or inconsistent caches must be rejected without modifying the device.
+ */
+
+/** @brief Initalizes the device with an oxide segment, a semiconductor segment and two contacts */
+template <typename DeviceType>
+void init_device(DeviceType & device, double len_x)
+{
+  typedef typename DeviceType::mesh_type           MeshType;
+
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  device.set_material(viennashe::materials::sio2(), 0);
+  device.set_material(viennashe::materials::si(),   1);
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit  = cells.begin();
+                    cit != cells.end();
+                  ++cit)
+  {
+    const double x = viennagrid::centroid(*cit)[0];
+    device.set_doping_n(1e20 + 1e26 * x, *cit);
+    device.set_doping_p(1e8  + 1e24 * x, *cit);
+
+    if (x < 0.1 * len_x)
+      device.set_contact_potential(0.2, *cit);
+    if (x > 0.9 * len_x)
+      device.set_contact_potential(-0.4, *cit);
+  }
+}
+
+/** @brief Writes a dummy source file, since the cache is validated against the file the mesh was read from */
+inline void write_source_file(std::string const & filename, std::string const & content)
+{
+  std::ofstream file(filename.c_str());
+  file << content;
+}
+
+/** @brief Copies a device cache, replacing the array 'name' by 'values'. Used to create truncated and inconsistent caches. */
+inline void write_modified_cache(std::string const & source_cache, std::string const & filename,
+                                 std::string const & name, std::vector<long long> const & values)
+{
+  viennashe::io::result_file_reader reader(source_cache);
+  viennashe::io::result_file_writer writer(filename);
+  for (std::size_t i=0; i<reader.num_arrays(); ++i)
+  {
+    viennashe::io::result_file_index_entry const & entry = reader.entry(i);
+    std::string const array_name(entry.name);
+    std::size_t const size = static_cast<std::size_t>(entry.size);
+    if (array_name == name)
+      writer.add_array(array_name, values);
+    else if (entry.type == viennashe::io::RESULT_FILE_FLOAT64)
+      writer.add_array(array_name, std::vector<double>(reader.data<double>(array_name), reader.data<double>(array_name) + size), entry.components);
+    else
+      writer.add_array(array_name, std::vector<long long>(reader.data<long long>(array_name), reader.data<long long>(array_name) + size), entry.components);
+  }
+  writer.close();
+}
+
+/** @brief Checks that a modified copy of a valid cache is rejected and leaves the device untouched */
+template <typename DeviceType>
+bool check_invalid_cache(std::string const & name, std::vector<long long> const & values)
+{
+  write_modified_cache("device_cache_test.cache", "device_cache_invalid.cache", name, values);
+
+  DeviceType device;
+  if (viennashe::io::read_device_cache(device, "device_cache_invalid.cache", "", "test"))
+  {
+    std::cerr << "* ERROR: Cache with invalid array '" << name << "' accepted" << std::endl;
+    return false;
+  }
+  if (viennagrid::vertices(device.mesh()).size() != 0 || viennagrid::cells(device.mesh()).size() != 0 || device.segmentation().size() != 0)
+  {
+    std::cerr << "* ERROR: Device modified by cache with invalid array '" << name << "'" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+template <typename DeviceType>
+int compare_devices(DeviceType const & device1, DeviceType const & device2)
+{
+  typedef typename DeviceType::mesh_type                                        MeshType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+  typedef typename viennagrid::result_of::const_vertex_range<MeshType>::type    VertexContainer;
+  typedef typename viennagrid::result_of::iterator<VertexContainer>::type       VertexIterator;
+
+  VertexContainer vertices1(device1.mesh());
+  VertexContainer vertices2(device2.mesh());
+  CellContainer   cells1(device1.mesh());
+  CellContainer   cells2(device2.mesh());
+
+  if (vertices1.size() != vertices2.size() || cells1.size() != cells2.size() || device1.segmentation().size() != device2.segmentation().size())
+  {
+    std::cerr << "* ERROR: Mesh size mismatch" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (VertexIterator vit = vertices1.begin(); vit != vertices1.end(); ++vit)
+  {
+    if (viennagrid::point(*vit) != viennagrid::point(vertices2[static_cast<std::size_t>(vit->id().get())]))
+    {
+      std::cerr << "* ERROR: Vertex mismatch at vertex " << vit->id().get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  for (std::size_t s=0; s<device1.segmentation().size(); ++s)
+  {
+    if (viennagrid::cells(device1.segment(s)).size() != viennagrid::cells(device2.segment(s)).size())
+    {
+      std::cerr << "* ERROR: Segment size mismatch for segment " << s << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  for (CellIterator cit = cells1.begin(); cit != cells1.end(); ++cit)
+  {
+    typename viennagrid::result_of::cell<MeshType>::type const & other = cells2[static_cast<std::size_t>(cit->id().get())];
+    if (!viennashe::testing::fuzzy_equal(viennagrid::centroid(*cit)[0], viennagrid::centroid(other)[0])
+        || device1.get_material(*cit)  != device2.get_material(other)
+        || device1.get_doping_n(*cit)  != device2.get_doping_n(other)
+        || device1.get_doping_p(*cit)  != device2.get_doping_p(other)
+        || device1.has_contact_potential(*cit) != device2.has_contact_potential(other)
+        || (device1.has_contact_potential(*cit) && device1.get_contact_potential(*cit) != device2.get_contact_potential(other)))
+    {
+      std::cerr << "* ERROR: Device data mismatch at cell " << cit->id().get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "* compare_devices(): Devices are identical" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+
+int main()
+{
+  typedef viennagrid::quadrilateral_2d_mesh                     MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 1e-7, 5,    //start at x=, length, points
+                               0.0, 1e-7, 3);   //start at y=, length, points
+  generator_params.add_segment(1e-7, 5e-7, 20,
+                               0.0,  1e-7,  3);
+  device.generate_mesh(generator_params);
+  init_device(device, 6e-7);
+
+  write_source_file("device_cache_source.txt", "version 1");
+
+  std::cout << "* main(): Writing cache..." << std::endl;
+  viennashe::io::write_device_cache(device, "device_cache_test.cache", "device_cache_source.txt", "test");
+
+  //
+  // Test 1: Valid cache
+  //
+  DeviceType cached_device;
+  if (!viennashe::io::read_device_cache(cached_device, "device_cache_test.cache", "device_cache_source.txt", "test"))
+  {
+    std::cerr << "* ERROR: Valid cache not accepted" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (compare_devices(device, cached_device) != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  //
+  // Test 2: Different loader settings
+  //
+  DeviceType device2;
+  if (viennashe::io::read_device_cache(device2, "device_cache_test.cache", "device_cache_source.txt", "other"))
+  {
+    std::cerr << "* ERROR: Cache with different loader tag accepted" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 3: Modified source file
+  //
+  write_source_file("device_cache_source.txt", "version 2");
+  if (viennashe::io::read_device_cache(device2, "device_cache_test.cache", "device_cache_source.txt", "test"))
+  {
+    std::cerr << "* ERROR: Outdated cache accepted" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 4: Truncated and inconsistent caches
+  //
+  {
+    viennashe::io::result_file_reader reader("device_cache_test.cache");
+    std::vector<long long> segment_offsets(reader.data<long long>("segmentation/offsets"),
+                                           reader.data<long long>("segmentation/offsets") + reader.size("segmentation/offsets"));
+    std::vector<long long> segment_cells(reader.data<long long>("segmentation/cells"),
+                                         reader.data<long long>("segmentation/cells") + reader.size("segmentation/cells"));
+    std::vector<long long> cells(reader.data<long long>("mesh/cells"),
+                                 reader.data<long long>("mesh/cells") + reader.size("mesh/cells"));
+    const long long num_vertices = static_cast<long long>(reader.size("mesh/vertices") / 2);
+    const long long num_cells    = static_cast<long long>(reader.size("device/material"));
+
+    std::vector<long long> truncated_offsets(segment_offsets.begin(), segment_offsets.end() - 1);
+    std::vector<long long> decreasing_offsets(segment_offsets);
+    decreasing_offsets[1] = segment_offsets.back() + 10;
+    std::vector<long long> invalid_segment_cells(segment_cells);
+    invalid_segment_cells.back() = num_cells;
+    std::vector<long long> invalid_cells(cells);
+    invalid_cells.back() = num_vertices;
+
+    if (   !check_invalid_cache<DeviceType>("segmentation/offsets", truncated_offsets)
+        || !check_invalid_cache<DeviceType>("segmentation/offsets", decreasing_offsets)
+        || !check_invalid_cache<DeviceType>("segmentation/cells",   invalid_segment_cells)
+        || !check_invalid_cache<DeviceType>("mesh/cells",           invalid_cells)
+        || !check_invalid_cache<DeviceType>("device/material",      std::vector<long long>(static_cast<std::size_t>(num_cells - 1), 1))
+        || !check_invalid_cache<DeviceType>("device/contact_mask",  std::vector<long long>(static_cast<std::size_t>(num_cells / 2), 0)))
+      return EXIT_FAILURE;
+  }
+
+  //
+  // Test 5: Missing cache
+  //
+  if (viennashe::io::read_device_cache(device2, "device_cache_missing.cache"))
+  {
+    std::cerr << "* ERROR: Missing cache accepted" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file gnuplot_output.cpp Contains a test of the buffered gnuplot output
+ *  \test Checks the number formatting against std::ostream and printf and compares the ASCII and binary output of the energy distribution function of a resistor.
+ */
+
+/** @brief Returns the text written by std::ostream for a value with the given precision */
+inline std::string stream_format(double value, int precision)
+{
+  std::ostringstream stream;
+  stream.precision(precision);
+  stream << value;
+  return stream.str();
+}
+
+/** @brief Compares the result of detail::format_double() with the expected text */
+inline bool check_format(double value, int precision, std::string const & expected)
+{
+  char buffer[64];
+  std::string result(buffer, viennashe::io::detail::format_double(value, precision, buffer));
+  if (result != expected)
+  {
+    std::cerr << "* ERROR: format_double() returned " << result << ", expected " << expected << " (precision " << precision << ")" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** @brief Compares detail::format_double() with std::ostream and printf("%.*g") for random bit patterns and a range of magnitudes, which must match exactly */
+inline int check_format_double()
+{
+  std::size_t num_values = 0;
+
+  // random bit patterns, covering all exponents:
+  std::mt19937_64 engine(42);
+  for (std::size_t i = 0; i < 200000; ++i)
+  {
+    std::mt19937_64::result_type bits = engine();
+    double value;
+    std::memcpy(&value, &bits, sizeof(double));
+    int precision = 1 + static_cast<int>(i % 15);
+    if (!check_format(value, precision, stream_format(value, precision)))
+      return EXIT_FAILURE;
+    ++num_values;
+  }
+
+  // values of moderate magnitude with up to nine digits, which are frequently close to rounding ties:
+  std::uniform_real_distribution<double> mantissa(1.0, 10.0);
+  std::uniform_int_distribution<int>     exponent(-30, 30);
+  for (std::size_t i = 0; i < 200000; ++i)
+  {
+    double value = std::floor(mantissa(engine) * 1e8) / 1e8 * std::pow(10.0, exponent(engine));
+    int precision = 1 + static_cast<int>(i % 15);
+    char expected[64];
+    std::sprintf(expected, "%.*g", precision, value);
+    if (!check_format(value, precision, stream_format(value, precision)) || !check_format(value, precision, expected))
+      return EXIT_FAILURE;
+    ++num_values;
+  }
+
+  std::string special[] = { "0", "-0", "inf", "-inf", "100", "0.0001", "1e-05", "123456", "1.23457e+06", "4.98111e-10" };
+  double special_values[] = { 0.0, -0.0, 1e308 * 10.0, -1e308 * 10.0, 100.0, 1e-4, 1e-5, 123456.0, 1234567.0, 4.981105e-10 };
+  for (std::size_t i = 0; i < sizeof(special_values) / sizeof(double); ++i)
+    if (!check_format(special_values[i], 6, special[i]))
+      return EXIT_FAILURE;
+  if (!check_format(std::sqrt(-1.0), 6, stream_format(std::sqrt(-1.0), 6)))
+    return EXIT_FAILURE;
+
+  // The decimal separator does not depend on the locale of the C library:
+  if (std::setlocale(LC_NUMERIC, "de_DE.UTF-8") || std::setlocale(LC_NUMERIC, "de_DE") || std::setlocale(LC_NUMERIC, "German"))
+  {
+    bool success = check_format(0.5, 6, "0.5") && check_format(-1.25e-7, 6, "-1.25e-07");
+    std::setlocale(LC_NUMERIC, "C");
+    if (!success)
+      return EXIT_FAILURE;
+  }
+
+  std::cout << "* check_format_double(): " << num_values << " values match" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+/** @brief Reads all numbers of a text file, skipping comments */
+inline std::vector<double> read_ascii_file(std::string const & filename)
+{
+  std::ifstream file(filename.c_str());
+  if (!file)
+    throw viennashe::io::cannot_open_file_exception(filename);
+
+  std::vector<double> result;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.empty() || line[0] == '#')
+      continue;
+    std::istringstream ss(line);
+    double value;
+    while (ss >> value)
+      result.push_back(value);
+  }
+  return result;
+}
+
+inline std::vector<double> read_binary_file(std::string const & filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    throw viennashe::io::cannot_open_file_exception(filename);
+
+  std::stringstream ss;
+  ss << file.rdbuf();
+  std::string content = ss.str();
+
+  std::vector<double> result(content.size() / sizeof(double));
+  if (result.size() > 0)
+    std::memcpy(&(result[0]), content.data(), result.size() * sizeof(double));
+  return result;
+}
+
+
+int main()
+{
+  typedef viennagrid::quadrilateral_2d_mesh                     MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  if (check_format_double() != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 6.0e-7, 10,   //start at x=, length, points
+                               0.0, 6.0e-7,  2);  //start at y=, length, points
+  device.generate_mesh(generator_params);
+  init_device(device, generator_params.at(0).get_length_x(), 0.0, 0.0, 1e16, 1e16);
+
+  std::cout << "* main(): Computing SHE..." << std::endl;
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(true);
+  config.set_electron_equation(viennashe::EQUATION_SHE);
+  config.set_hole_equation(viennashe::EQUATION_SHE);
+  config.scattering().ionized_impurity().enabled(false);
+  config.energy_spacing(6.2 * viennashe::physics::constants::q / 1000.0);
+  config.nonlinear_solver().max_iters(1);
+
+  viennashe::simulator<DeviceType> she_simulator(device, config);
+  she_simulator.run();
+
+  std::cout << "* main(): Writing EDF..." << std::endl;
+  viennashe::io::gnuplot_edf_writer edf_writer;
+  edf_writer(device, viennashe::util::any_filter(), she_simulator.edf(viennashe::ELECTRON_TYPE_ID), "gnuplot_output_edf_ascii.dat");
+
+  edf_writer.format(viennashe::io::GNUPLOT_FORMAT_BINARY);
+  edf_writer(device, viennashe::util::any_filter(), she_simulator.edf(viennashe::ELECTRON_TYPE_ID), "gnuplot_output_edf_binary.dat");
+
+  std::vector<double> ascii_values  = read_ascii_file("gnuplot_output_edf_ascii.dat");
+  std::vector<double> binary_values = read_binary_file("gnuplot_output_edf_binary.dat");
+
+  if (ascii_values.size() != binary_values.size() || ascii_values.size() == 0 || ascii_values.size() % 5 != 0)
+  {
+    std::cerr << "* ERROR: Size mismatch: " << ascii_values.size() << " vs. " << binary_values.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (std::size_t i=0; i<ascii_values.size(); ++i)
+  {
+    if (!viennashe::testing::fuzzy_equal(ascii_values[i], binary_values[i], 1e-5)) // six significant digits in ASCII
+    {
+      std::cerr << "* ERROR: Value mismatch at entry " << i << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
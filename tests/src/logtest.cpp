@@ -20,6 +20,8 @@
 
 #include <cstdlib>
 #include <iostream>
+#include <thread>
+#include <vector>
 
 #include "viennashe/log/log.hpp"
 
@@ -35,6 +37,29 @@ struct my_key_disabled
   enum { enabled = false };
 };
 
+/** @brief Counts how often it got formatted. Used to check that suppressed messages are not formatted at all */
+struct format_counter
+{
+  static long count;
+};
+long format_counter::count = 0;
+
+std::ostream & operator<<(std::ostream & os, format_counter const &)
+{
+  ++format_counter::count;
+  return os << "(formatted)";
+}
+
+void log_from_thread(int thread_id)
+{
+  for (int i=0; i<100; ++i)
+  {
+    log::debug() << "thread " << thread_id << " NOT VISIBLE " << format_counter() << std::endl;
+    log::record<my_key_enabled>(log::logDEBUG, "thread_record").field("id", thread_id).field("value", format_counter());
+  }
+  log::info() << "thread " << thread_id << " VISIBLE " << std::endl;
+}
+
 int main()
 {
   std::cout << " ** BEGIN OF TEST **" << std::endl << std::endl;
@@ -57,6 +82,68 @@ int main()
   log::info<my_key_disabled>()  << "KEY: INFO  NOT VISIBLE " << std::endl;
   log::debug<my_key_disabled>() << "KEY: DEBUG NOT VISIBLE " << std::endl;
 
+  //
+  // Suppressed messages must not be formatted:
+  //
+  log::set_log_level(log::logINFO);
+  log::debug() << "DEBUG NOT VISIBLE " << format_counter() << std::endl;
+  log::debug<my_key_enabled>() << "KEY: DEBUG NOT VISIBLE " << format_counter() << std::endl;
+  log::error<my_key_disabled>() << "KEY: ERROR NOT VISIBLE " << format_counter() << std::endl;
+  log::record<my_key_disabled>(log::logERROR, "record_not_visible").field("value", format_counter());
+  if (format_counter::count != 0)
+  {
+    std::cerr << "* ERROR: Suppressed log messages got formatted " << format_counter::count << " times!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (log::is_enabled<log::logDEBUG>() || log::is_enabled<log::logERROR, my_key_disabled>())
+  {
+    std::cerr << "* ERROR: log::is_enabled() inconsistent with log level!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+#ifndef VIENNASHE_LOG_DISABLE
+  if (!log::is_enabled<log::logINFO, my_key_enabled>())
+  {
+    std::cerr << "* ERROR: log::is_enabled() inconsistent with log level!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  log::info() << "INFO VISIBLE " << format_counter() << std::endl;
+  if (format_counter::count != 1)
+  {
+    std::cerr << "* ERROR: Visible log message not formatted!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Structured records:
+  //
+  log::record(log::logINFO, "RECORD_VISIBLE").field("iteration", 3).field("norm", 1e-5).field("name", "with blanks");
+  log::record<my_key_enabled>(log::logINFO, "KEY: RECORD_VISIBLE").field("value", format_counter());
+  if (format_counter::count != 2)
+  {
+    std::cerr << "* ERROR: Visible log record not formatted!" << std::endl;
+    return EXIT_FAILURE;
+  }
+#endif
+
+  //
+  // Concurrent logging from several threads:
+  //
+  std::vector<std::thread> threads;
+  for (int i=0; i<4; ++i)
+    threads.push_back(std::thread(log_from_thread, i));
+  for (std::size_t i=0; i<threads.size(); ++i)
+    threads[i].join();
+
+  long expected_count = log::is_enabled<log::logINFO>() ? 2 : 0;
+  if (format_counter::count != expected_count)
+  {
+    std::cerr << "* ERROR: Suppressed log messages got formatted in threads!" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   std::cout << std::endl;
   std::cout << " ** END OF TEST **" << std::endl;
 
@@ -13,6 +13,7 @@
 =============================================================================== */
 
 #include <cstdlib>
+#include <vector>
 
 #include "tests/src/common.hpp"
 
@@ -20,11 +21,129 @@
 #include "viennashe/models/markovchain/chain.hpp"
 #include "viennashe/math/random.hpp"
 #include "viennashe/models/markovchain/ssa.hpp"
+#include "viennashe/models/markovchain/propensity_tree.hpp"
+#include "viennashe/models/markovchain/rate_table.hpp"
 
 /** \file markov_chains.cpp Contains tests for the markov chains, reaction rates and the SSA algorithm.
- *  \test Tests markov chains, primitive fixed reaction rates and the SSA algorithm
+ *  \test Tests markov chains, primitive fixed reaction rates, the rate table and the SSA algorithm
  */
 
+/** @brief A rate depending on an external parameter. Copies (clones) share the parameter. */
+struct scaled_rate : public viennashe::models::rate_base
+{
+  scaled_rate(double rate, double const * factor) : rate_(rate), factor_(factor) { }
+
+  virtual value_type value() const { return rate_ * (*factor_); }
+
+  virtual viennashe::models::rate_base * clone() const { return new scaled_rate(rate_, factor_); }
+
+private:
+  double rate_;
+  double const * factor_;
+};
+
+/** @brief Tests the selection of events in the propensity tree */
+void test_propensity_tree()
+{
+  std::vector<double> weights(5);
+  weights[0] = 1.0; weights[1] = 0.0; weights[2] = 2.0; weights[3] = -1.0; weights[4] = 4.0;
+
+  viennashe::models::propensity_tree tree(weights);
+
+  if (!viennashe::testing::fuzzy_equal(tree.total(), 7.0, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: propensity tree has the wrong total ", tree.total());
+  if (tree.find(0.0) != 0 || tree.find(0.999) != 0 || tree.find(1.0) != 2 || tree.find(2.5) != 2 || tree.find(3.0) != 4 || tree.find(6.999) != 4)
+    throw viennashe::invalid_value_exception("markov_chains-test: propensity tree selected the wrong event ", 0);
+  if (tree.find(7.0) != tree.size())
+    throw viennashe::invalid_value_exception("markov_chains-test: propensity tree selected an event beyond the total ", static_cast<double>(tree.find(7.0)));
+
+  tree.set(4, 0.0);
+  tree.set(1, 3.0);
+  if (!viennashe::testing::fuzzy_equal(tree.total(), 6.0, 1e-12) || !viennashe::testing::fuzzy_equal(tree.prefix_sum(2), 4.0, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: propensity tree update failed ", tree.total());
+  if (tree.find(1.5) != 1 || tree.find(5.5) != 2)
+    throw viennashe::invalid_value_exception("markov_chains-test: propensity tree selected the wrong event after update ", 0);
+}
+
+/** @brief Tests the rate table and the transition frequencies of the SSA on a chain with three states */
+void test_three_state_chain(viennashe::math::rand_generator_base<double> & rnd)
+{
+  double factor = 1.0;
+
+  viennashe::models::state_base s0(0, "state 0");
+  viennashe::models::state_base s1(1, "state 1");
+  viennashe::models::state_base s2(2, "state 2");
+
+  viennashe::models::chain mychain;
+  mychain.add_rate(s0, s1, scaled_rate(1.0, &factor));
+  mychain.add_rate(s0, s2, viennashe::models::const_rate(3.0));
+  mychain.add_rate(s1, s0, viennashe::models::const_rate(5.0));
+  mychain.add_rate(s2, s0, viennashe::models::const_rate(5.0));
+  mychain.add_rate(s2, s1, viennashe::models::const_rate(1e-12));
+
+  viennashe::models::ssa_solver ssa(mychain);
+  viennashe::models::rate_table const & table = ssa.rates();
+
+  if (table.num_states() != 3 || table.num_transitions() != 5)
+    throw viennashe::invalid_value_exception("markov_chains-test: rate table has the wrong size ", static_cast<double>(table.num_transitions()));
+  if (!viennashe::testing::fuzzy_equal(table.total_rate(0), 4.0, 1e-12) || !viennashe::testing::fuzzy_equal(table.total_rate(2), 5.0 + 1e-12, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: rate table has the wrong total rate ", table.total_rate(0));
+  if (table.rate(1, 2) != 0.0 || !viennashe::testing::fuzzy_equal(table.rate(2, 1), 1e-12, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: rate table has the wrong rate ", table.rate(2, 1));
+
+  // Transitions out of state 0 to state 1 should occur with probability 1/4
+  const std::size_t num_events = 40000;
+  std::size_t from_0 = 0;
+  std::size_t from_0_to_1 = 0;
+
+  for (std::size_t i = 0; i < 3; ++i)
+    mychain.get_state(i).occupancy(i == 0 ? 1.0 : 0.0);
+
+  std::size_t current = 0;
+  for (std::size_t n = 0; n < num_events; ++n)
+  {
+    ssa.solve(rnd);
+    std::size_t next = 0;
+    for (std::size_t i = 0; i < 3; ++i)
+      if (mychain.get_state(i).occupancy() == 1.0)
+        next = i;
+    if (current == 0)
+    {
+      ++from_0;
+      if (next == 1) ++from_0_to_1;
+    }
+    current = next;
+  }
+
+  const double ratio = static_cast<double>(from_0_to_1) / static_cast<double>(from_0);
+  std::cout << "P(0 -> 1) = " << ratio << " (expected 0.25)" << std::endl;
+  if (std::fabs(ratio - 0.25) > 0.02)
+    throw viennashe::invalid_value_exception("markov_chains-test: wrong transition frequency from state 0 to 1 ", ratio);
+
+  // Changed parameters are only seen after an update
+  factor = 3.0;
+  if (!viennashe::testing::fuzzy_equal(table.total_rate(0), 4.0, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: rate table updated without request ", table.total_rate(0));
+  ssa.update_rate(0, 1);
+  if (!viennashe::testing::fuzzy_equal(table.total_rate(0), 6.0, 1e-12) || !viennashe::testing::fuzzy_equal(table.rate(0, 1), 3.0, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: update of a single rate failed ", table.total_rate(0));
+  factor = 0.0;
+  ssa.update_rates();
+  if (!viennashe::testing::fuzzy_equal(table.total_rate(0), 3.0, 1e-12))
+    throw viennashe::invalid_value_exception("markov_chains-test: update of all rates failed ", table.total_rate(0));
+
+  // A disabled transition must never be selected
+  for (std::size_t i = 0; i < 3; ++i)
+    mychain.get_state(i).occupancy(i == 0 ? 1.0 : 0.0);
+  for (std::size_t n = 0; n < 1000; ++n)
+  {
+    const bool was_in_0 = (mychain.get_state(0).occupancy() == 1.0);
+    ssa.solve(rnd);
+    if (was_in_0 && mychain.get_state(1).occupancy() == 1.0)
+      throw viennashe::invalid_value_exception("markov_chains-test: transition with zero rate selected ", 0);
+  }
+}
+
 
 int main()
 {
@@ -112,6 +231,9 @@ Occupancy          0 |          1 |
   if (std::fabs(mychain.get_state(0).occupancy()) > 1e-10)
     throw viennashe::invalid_value_exception("markov_chains-test: The occupancy of state 0 should be 0. ", mychain.get_state(0).occupancy());
 
+  test_propensity_tree();
+  test_three_state_chain(rnd);
+
   std::cout << std::endl;
   std::cout << "Test finished successfully!" << std::endl;
 
@@ -0,0 +1,155 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <iostream>
+
+#include "tests/src/common.hpp"
+
+#include "viennashe/models/markovchain/reaction_rates.hpp"
+#include "viennashe/models/markovchain/chain.hpp"
+#include "viennashe/models/markovchain/ensemble.hpp"
+
+/** \file markov_ensemble.cpp Contains tests for the SSA solver for ensembles of Markov-Chains.
+ *  \test Compares the mean occupancies of an ensemble of two-state chains with the analytic solution,
+ *        checks per-instance rates, the independence of the results from the number of threads and ensembles of separate chains
+ */
+
+
+int main()
+{
+  typedef viennashe::models::ssa_ensemble::index_type index_type;
+
+  const double k01 = 2.0;
+  const double k10 = 1.0;
+
+  viennashe::models::state_base s0(0, "empty");
+  viennashe::models::state_base s1(1, "charged");
+
+  viennashe::models::chain template_chain;
+  template_chain.add_rate(s0, s1, viennashe::models::const_rate(k01));
+  template_chain.add_rate(s1, s0, viennashe::models::const_rate(k10));
+
+  //
+  // Test 1: Mean occupancies compared to the analytic solution p1(t) = k01/(k01+k10) (1 - exp(-(k01+k10) t))
+  //
+  const std::size_t num_instances = 4000;
+  const std::size_t num_bins      = 10;
+  const double      t_end         = 2.0;
+
+  viennashe::models::ssa_ensemble ensemble(template_chain, num_instances);
+  ensemble.seed(42);
+
+  std::vector<double> occupancies;
+  ensemble.mean_occupancies(t_end, num_bins, occupancies);
+
+  if (occupancies.size() != 2 * num_bins)
+    throw viennashe::invalid_value_exception("markov_ensemble-test: Wrong number of mean occupancies ", static_cast<double>(occupancies.size()));
+
+  const double ksum = k01 + k10;
+  const double h    = t_end / num_bins;
+  for (std::size_t k = 0; k < num_bins; ++k)
+  {
+    const double t0 = k * h;
+    const double t1 = t0 + h;
+    // bin average of p1(t)
+    const double expected = k01 / ksum * (1.0 - (std::exp(-ksum * t0) - std::exp(-ksum * t1)) / (ksum * h));
+
+    std::cout << "bin " << k << ": p1 = " << occupancies[2*k+1] << " (expected " << expected << ")" << std::endl;
+    if (std::fabs(occupancies[2*k+1] - expected) > 0.03)
+      throw viennashe::invalid_value_exception("markov_ensemble-test: Mean occupancy differs from the analytic solution in bin ", static_cast<double>(k));
+    if (!viennashe::testing::fuzzy_equal(occupancies[2*k] + occupancies[2*k+1], 1.0, 1e-9))
+      throw viennashe::invalid_value_exception("markov_ensemble-test: Mean occupancies do not sum up to one in bin ", static_cast<double>(k));
+  }
+
+  if (!viennashe::testing::fuzzy_equal(ensemble.time(), t_end, 1e-12))
+    throw viennashe::invalid_value_exception("markov_ensemble-test: Ensemble not advanced to the time horizon ", ensemble.time());
+
+  //
+  // Test 2: Per-instance rates. Odd instances cannot leave state 0
+  //
+  viennashe::models::ssa_ensemble trapped(template_chain, 100);
+  for (std::size_t i = 1; i < trapped.size(); i += 2)
+    trapped.set_rate(i, 0, 1, 0.0);
+
+  std::vector<index_type> trace;
+  trapped.sample_states(10.0, 20, trace);
+  std::size_t num_charged = 0;
+  for (std::size_t i = 0; i < trapped.size(); ++i)
+  {
+    for (std::size_t k = 0; k < 20; ++k)
+    {
+      if (i % 2 == 1 && trace[i * 20 + k] != 0)
+        throw viennashe::invalid_value_exception("markov_ensemble-test: Instance left a state without outgoing rates ", static_cast<double>(i));
+      if (i % 2 == 0 && trace[i * 20 + k] == 1)
+        ++num_charged;
+    }
+    if (trace[i * 20 + 19] != trapped.state(i))
+      throw viennashe::invalid_value_exception("markov_ensemble-test: Last sample differs from the final state of instance ", static_cast<double>(i));
+  }
+  if (num_charged == 0)
+    throw viennashe::invalid_value_exception("markov_ensemble-test: Instances with rates never changed their state ", 0);
+
+  //
+  // Test 3: Results do not depend on the number of threads
+  //
+  std::vector<index_type> trace_serial;
+  std::vector<index_type> trace_parallel;
+
+  viennashe::models::ssa_ensemble serial(template_chain, 1000);
+  serial.num_threads(1);
+  serial.seed(7);
+  serial.sample_states(1.0, 50, trace_serial);
+  serial.mean_occupancies(2.0, 5, occupancies);
+
+  std::vector<double> occupancies_parallel;
+  viennashe::models::ssa_ensemble parallel(template_chain, 1000);
+  parallel.num_threads(4);
+  parallel.seed(7);
+  parallel.sample_states(1.0, 50, trace_parallel);
+  parallel.mean_occupancies(2.0, 5, occupancies_parallel);
+
+  if (trace_serial != trace_parallel || occupancies != occupancies_parallel)
+    throw viennashe::invalid_value_exception("markov_ensemble-test: Results depend on the number of threads ", 4);
+
+  //
+  // Test 4: Ensemble of separate chains. The final states are written back to the chains
+  //
+  std::vector<viennashe::models::chain *> chains;
+  for (std::size_t i = 0; i < 10; ++i)
+  {
+    chains.push_back(new viennashe::models::chain());
+    chains.back()->add_rate(s0, s1, viennashe::models::const_rate(k01 * (i + 1)));
+    chains.back()->add_rate(s1, s0, viennashe::models::const_rate(k10));
+  }
+  viennashe::models::ssa_ensemble separate(chains);
+  separate.sample_states(1.0, 1, trace);
+
+  for (std::size_t i = 0; i < chains.size(); ++i)
+  {
+    if (!viennashe::testing::fuzzy_equal(separate.rates(i).rate(0, 1), k01 * (i + 1), 1e-12))
+      throw viennashe::invalid_value_exception("markov_ensemble-test: Wrong rate of a separate chain ", separate.rates(i).rate(0, 1));
+    if (chains[i]->get_state(trace[i]).occupancy() != 1.0 || chains[i]->get_state(1 - trace[i]).occupancy() != 0.0)
+      throw viennashe::invalid_value_exception("markov_ensemble-test: Final state not written back to chain ", static_cast<double>(i));
+    delete chains[i];
+  }
+
+  std::cout << std::endl;
+  std::cout << "Test finished successfully!" << std::endl;
+
+  return (EXIT_SUCCESS);
+}
@@ -0,0 +1,71 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#include "tests/src/mos1d_dg.hpp"
+#include "tests/src/performance.hpp"
+
+/** \file perf_mos1d_dg.cpp Performance regression test on the 1D MOS device with density gradient corrections.
+ *  \test Runs the drift-diffusion simulation with density gradient corrections of the mos1d_dg_n test and compares assembly and
+ *        solver times, iteration counts and system sizes against a stored baseline. Usage: perf_mos1d_dg-test [baseline-directory] [build-type]
+ */
+
+int main(int argc, char **argv)
+{
+  typedef viennagrid::line_1d_mesh        MeshType;
+  typedef viennashe::device<MeshType>     DeviceType;
+
+  std::cout << "* main(): Creating mesh ..." << std::endl;
+
+  DeviceType device;
+
+  mos1d_mesh_generator mosgen(1e-9, 0.01e-9, 1e-9, 0.05e-9, 100e-9, 1e-9);
+  device.generate_mesh(mosgen);
+
+  //                       ND     NA
+  init_device(device, 0.2, 1e8, 3e23 );
+
+  //
+  // Drift-diffusion with density gradient (same configuration as the mos1d_dg_n test)
+  //
+  std::cout << "* main(): Launching DD simulator..." << std::endl;
+  viennashe::config dd_cfg;
+  dd_cfg.with_holes(true);
+  dd_cfg.with_electrons(true);
+  dd_cfg.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.linear_solver().set(viennashe::solvers::linear_solver_ids::dense_linear_solver);
+  dd_cfg.nonlinear_solver().max_iters(30);
+  dd_cfg.nonlinear_solver().damping(0.6);
+  dd_cfg.quantum_correction(true);
+  dd_cfg.with_quantum_correction(true);
+
+  viennashe::simulator<DeviceType> dd_simulator(device, dd_cfg);
+  dd_simulator.run();
+
+  viennashe::testing::performance_record record;
+  record.add_profile("dd/", dd_simulator.profiler());
+
+  //
+  // Compare against baseline
+  //
+  if (!record.check(viennashe::testing::performance_baseline_file(argc, argv, "perf_mos1d_dg")))
+  {
+    std::cerr << "PERFORMANCE REGRESSION DETECTED" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "... \\o/ SUCCESS \\o/ ..." << std::endl;
+
+  return EXIT_SUCCESS;
+}
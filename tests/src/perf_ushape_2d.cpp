@@ -0,0 +1,102 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations:
+#include "viennagrid/config/default_configs.hpp"
+
+#include "tests/src/ushape_2d.hpp"
+#include "tests/src/performance.hpp"
+
+/** \file perf_ushape_2d.cpp Performance regression test on the U-shaped 2D device.
+ *  \test Runs the drift-diffusion and SHE simulations of the ushape_2d test and compares assembly, elimination and solver times,
+ *        iteration counts and system sizes against a stored baseline. Usage: perf_ushape_2d-test [baseline-directory] [build-type]
+ */
+
+int main(int argc, char **argv)
+{
+  typedef viennagrid::triangular_2d_mesh               MeshType;
+  typedef viennashe::device<MeshType>                  DeviceType;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+  device.load_mesh("../../tests/data/ushape2d/ushape125.mesh");
+  device.scale(1e-6);
+  init_device(device);
+
+  viennashe::testing::performance_record record;
+
+  //
+  // Drift-diffusion
+  //
+  std::cout << "* main(): Launching DD simulator..." << std::endl;
+  viennashe::config dd_cfg;
+  dd_cfg.with_electrons(true);
+  dd_cfg.with_holes(true);
+  dd_cfg.nonlinear_solver().max_iters(300);
+  dd_cfg.nonlinear_solver().damping(0.4);
+  viennashe::simulator<DeviceType> dd_simulator(device, dd_cfg);
+  dd_simulator.run();
+
+  record.add_profile("dd/", dd_simulator.profiler());
+
+  //
+  // SHE (same configuration as the ushape_2d test)
+  //
+  std::cout << "* main(): Launching SHE simulator..." << std::endl;
+  viennashe::config config;
+  config.set_electron_equation(viennashe::EQUATION_SHE);
+  config.with_electrons(true);
+  config.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+  config.with_holes(true);
+  config.nonlinear_solver().max_iters(40);
+  config.nonlinear_solver().damping(0.4);
+  config.max_expansion_order(1);
+  config.energy_spacing(31.0 * viennashe::physics::constants::q / 1000.0);
+  config.linear_solver().set(viennashe::solvers::linear_solver_ids::serial_linear_solver);
+
+  viennashe::simulator<DeviceType> she_simulator(device, config);
+  she_simulator.set_initial_guess(viennashe::quantity::potential(), dd_simulator.potential());
+  she_simulator.set_initial_guess(viennashe::quantity::electron_density(), dd_simulator.electron_density());
+  she_simulator.set_initial_guess(viennashe::quantity::hole_density(), dd_simulator.hole_density());
+  she_simulator.run();
+
+  record.add_profile("she/", she_simulator.profiler());
+  she_simulator.profiler().write_json("perf_ushape_2d_she_profile.json");
+
+  //
+  // Compare against baseline
+  //
+  if (!record.check(viennashe::testing::performance_baseline_file(argc, argv, "perf_ushape_2d")))
+  {
+    std::cerr << "PERFORMANCE REGRESSION DETECTED" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "****************************************************" << std::endl;
+  std::cout << "*           Test finished successfully             *" << std::endl;
+  std::cout << "****************************************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,233 @@
+#ifndef VIENNASHE_TESTS_PERFORMANCE_HPP
+#define VIENNASHE_TESTS_PERFORMANCE_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+/** @file tests/src/performance.hpp
+    @brief Contains the comparison of the timings and iteration counts of a simulation against stored baselines, used by the performance regression tests
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "viennashe/util/profiler.hpp"
+
+namespace viennashe
+{
+  namespace testing
+  {
+
+    /** @brief Timings only fail if they exceed the baseline by at least this many seconds, such that short phases do not fail due to timer noise */
+    static const double performance_timing_floor = 0.05;
+
+    /** @brief A named figure of a simulation together with the relative tolerance used when comparing it against the baseline.
+     *
+     * Timings only fail if they exceed the baseline by more than the tolerance and by more than performance_timing_floor,
+     * all other figures fail if they deviate in either direction.
+     */
+    struct performance_metric
+    {
+      std::string name;
+      double      value;
+      double      tolerance;
+      bool        is_timing;
+    };
+
+    /** @brief The figures of one or more simulations which are compared against a baseline file */
+    class performance_record
+    {
+      public:
+        /** @brief Adds a figure. Timings use the relative tolerance given by the environment variable VIENNASHE_PERFORMANCE_TOLERANCE (default: 0.5) */
+        void add(std::string const & name, double value, double tolerance, bool is_timing = false)
+        {
+          performance_metric m = { name, value, tolerance, is_timing };
+          metrics_.push_back(m);
+        }
+
+        void add_timing(std::string const & name, double seconds)
+        {
+          double tolerance = 0.5;
+          if (char const * env = std::getenv("VIENNASHE_PERFORMANCE_TOLERANCE"))
+            tolerance = std::atof(env);
+          add(name, seconds, tolerance, true);
+        }
+
+        /** @brief Adds the wall-clock times of the hot paths, the number of nonlinear iterations and the system sizes recorded by the profiler of a simulation
+         *
+         * @param prefix   Prepended to the name of each figure, e.g. "she/"
+         * @param prof     The profiler of the simulator after run()
+         */
+        void add_profile(std::string const & prefix, viennashe::util::profiler const & prof)
+        {
+          double iterations = calls(prof, "nonlinear_iteration");
+          add(prefix + "iterations", iterations, 0.1);
+
+          add_timing(prefix + "seconds/run",                  seconds(prof, "run"));
+          add_timing(prefix + "seconds/assemble",             seconds(prof, "assemble"));
+          add_timing(prefix + "seconds/elimination",          seconds(prof, "elimination"));
+          add_timing(prefix + "seconds/preconditioner_setup", seconds(prof, "preconditioner_setup"));
+          add_timing(prefix + "seconds/krylov_solve",         seconds(prof, "krylov_solve"));
+          add_timing(prefix + "seconds/solve",                seconds(prof, "solve"));
+
+          if (iterations > 0)
+          {
+            add(prefix + "unknowns_per_iteration", assembled(prof, "unknowns") / iterations, 0.01);
+            add(prefix + "nonzeros_per_iteration", assembled(prof, "nonzeros") / iterations, 0.01);
+          }
+        }
+
+        std::vector<performance_metric> const & metrics() const { return metrics_; }
+
+        /** @brief Writes the figures in the format of a baseline file: One line 'name value tolerance' per figure */
+        void write(std::string const & filename) const
+        {
+          std::ofstream stream(filename.c_str());
+          stream << "# name value tolerance\n";
+          stream << std::setprecision(9);
+          for (std::size_t i=0; i<metrics_.size(); ++i)
+            stream << metrics_[i].name << " " << metrics_[i].value << " " << metrics_[i].tolerance << "\n";
+        }
+
+        /** @brief Compares the figures against the baseline file. Returns true if there is no regression.
+         *
+         * If the environment variable VIENNASHE_UPDATE_PERFORMANCE_BASELINE is set, the current figures are written to the file and become the new baseline.
+         * A missing baseline file is an error, since a regression cannot be detected without it.
+         * Figures which are not in the baseline file are reported, but not checked.
+         */
+        bool check(std::string const & filename) const
+        {
+          if (std::getenv("VIENNASHE_UPDATE_PERFORMANCE_BASELINE"))
+          {
+            write(filename);
+            std::cout << "* check(): Baseline written to '" << filename << "'" << std::endl;
+            return true;
+          }
+
+          std::ifstream stream(filename.c_str());
+          if (!stream)
+          {
+            std::cerr << "* check(): Baseline '" << filename << "' not found. Run with VIENNASHE_UPDATE_PERFORMANCE_BASELINE=1 to record it." << std::endl;
+            return false;
+          }
+
+          std::vector<performance_metric> baseline;
+          std::string line;
+          while (std::getline(stream, line))
+          {
+            if (line.empty() || line[0] == '#')
+              continue;
+            std::istringstream iss(line);
+            performance_metric m = { "", 0, 0, false };
+            if (iss >> m.name >> m.value >> m.tolerance)
+              baseline.push_back(m);
+          }
+
+          bool ok = true;
+          std::cout << std::setw(40) << std::left << "# name" << std::setw(14) << "baseline" << std::setw(14) << "current" << "status" << std::endl;
+          for (std::size_t i=0; i<metrics_.size(); ++i)
+          {
+            performance_metric const & current = metrics_[i];
+
+            std::size_t j = 0;
+            for (; j<baseline.size(); ++j)
+              if (baseline[j].name == current.name)
+                break;
+
+            std::string status = "not in baseline";
+            if (j < baseline.size())
+            {
+              double reference = baseline[j].value;
+              double tol       = current.is_timing ? current.tolerance : baseline[j].tolerance;
+              double difference = current.value - reference;
+              double deviation  = difference / std::max(std::fabs(reference), 1e-300);
+
+              if (current.value == reference)
+                status = "ok";
+              else if (current.is_timing)
+                status = (deviation > tol && difference > performance_timing_floor) ? "REGRESSION"
+                       : ((deviation < -tol && -difference > performance_timing_floor) ? "ok (faster, consider updating the baseline)" : "ok");
+              else
+                status = (std::fabs(deviation) > tol) ? "CHANGED" : "ok";
+
+              if (status == "REGRESSION" || status == "CHANGED")
+                ok = false;
+              std::cout << std::setw(40) << std::left << current.name << std::setw(14) << reference << std::setw(14) << current.value << status << std::endl;
+            }
+            else
+              std::cout << std::setw(40) << std::left << current.name << std::setw(14) << "-" << std::setw(14) << current.value << status << std::endl;
+          }
+          std::cout << std::right;
+
+          return ok;
+        }
+
+      private:
+        static double seconds(viennashe::util::profiler const & prof, std::string const & name)
+        {
+          double result = 0;
+          for (std::size_t i=0; i<prof.phases().size(); ++i)
+            if (prof.phases()[i].name == name)
+              result += prof.phases()[i].seconds;
+          return result;
+        }
+
+        static double calls(viennashe::util::profiler const & prof, std::string const & name)
+        {
+          double result = 0;
+          for (std::size_t i=0; i<prof.phases().size(); ++i)
+            if (prof.phases()[i].name == name)
+              result += static_cast<double>(prof.phases()[i].calls);
+          return result;
+        }
+
+        /** @brief Sums up a counter over the assembly phases (the phase 'assemble' for Newton, its children for Gummel) */
+        static double assembled(viennashe::util::profiler const & prof, std::string const & counter)
+        {
+          double result = 0;
+          std::vector<viennashe::util::profiler::phase> const & phases = prof.phases();
+          for (std::size_t i=0; i<phases.size(); ++i)
+          {
+            bool is_assembly = (phases[i].name == "assemble")
+                            || (phases[i].parent != viennashe::util::profiler::no_parent && phases[phases[i].parent].name == "assemble");
+            if (!is_assembly)
+              continue;
+            for (std::size_t j=0; j<phases[i].counters.size(); ++j)
+              if (phases[i].counters[j].first == counter)
+                result += phases[i].counters[j].second;
+          }
+          return result;
+        }
+
+        std::vector<performance_metric> metrics_;
+    };
+
+    /** @brief Returns the name of the baseline file of a performance test in the directory passed as first command line argument (default: current directory) */
+    inline std::string performance_baseline_file(int argc, char **argv, std::string const & test_name)
+    {
+      std::string directory = (argc > 1) ? argv[1] : ".";
+      std::string suffix    = (argc > 2 && std::string(argv[2]).size() > 0) ? std::string("_") + argv[2] : "";
+      return directory + "/" + test_name + suffix + ".txt";
+    }
+
+  } // namespace testing
+} // namespace viennashe
+
+#endif /* VIENNASHE_TESTS_PERFORMANCE_HPP */
@@ -0,0 +1,306 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+#include "viennashe/util/profiler.hpp"
+#include "viennashe/she/memory_estimate.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file profiler.cpp Contains a test of the hierarchical phase profiler
+ *  \test Checks nesting, call counts and per-iteration records of the profiler, the memory accounting, the JSON and CSV reports, the hardware counters (if available),
+ *        that a drift-diffusion simulation records its phases and memory, and that the memory estimator bounds the memory accounted during simulations with Gummel's and Newton's method.
+ */
+
+/** @brief Checks the number of calls of a phase */
+inline bool check_calls(viennashe::util::profiler const & prof, std::string const & path, std::size_t expected)
+{
+  std::size_t index = prof.find(path);
+  if (index == viennashe::util::profiler::no_parent || prof.phases()[index].calls != expected)
+  {
+    std::cerr << "* ERROR: Phase '" << path << "' not found or wrong number of calls" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** @brief Checks that the memory accounted by the profiler of a simulator in each category does not exceed the estimate */
+inline bool check_memory_estimate(viennashe::util::profiler const & prof, viennashe::she::memory_estimate const & est)
+{
+  std::size_t index = prof.find("run");
+  if (index == viennashe::util::profiler::no_parent)
+    return false;
+
+  std::vector<std::pair<std::string, double> > const & peak = prof.phases()[index].peak_memory;
+  for (std::size_t i=0; i<peak.size(); ++i)
+  {
+    std::cout << "* check_memory_estimate(): " << peak[i].first << ": " << peak[i].second << " bytes, estimate: " << est(peak[i].first) << " bytes" << std::endl;
+    if (peak[i].second > est(peak[i].first))
+    {
+      std::cerr << "* ERROR: Memory of category '" << peak[i].first << "' exceeds the estimate" << std::endl;
+      return false;
+    }
+  }
+  if (prof.peak_memory() > est.total())
+  {
+    std::cerr << "* ERROR: Peak memory " << prof.peak_memory() << " exceeds the estimate " << est.total() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+int main()
+{
+  //
+  // Test 1: Nesting and aggregation
+  //
+  viennashe::util::profiler prof;
+  {
+    viennashe::util::profiler_activation active(prof);
+    prof.begin_run();
+    viennashe::util::profiler_scope outer("outer");
+    viennashe::util::tracked_memory quantities_memory("quantities", 1000);
+    for (std::size_t it = 1; it <= 3; ++it)
+    {
+      prof.set_iteration(it);
+      viennashe::util::profiler_scope inner("inner");
+      viennashe::util::profiler_scope a("a");
+      a.stop();
+      viennashe::util::profiler_scope b("b");
+      viennashe::util::tracked_memory matrix_memory("matrix");
+      matrix_memory.set(100.0 * static_cast<double>(it));
+    }
+  }
+  viennashe::util::profiler_scope inactive("inactive"); // no active profiler -> no-op
+  inactive.stop();
+
+  if (!check_calls(prof, "outer", 1) || !check_calls(prof, "outer/inner", 3) || !check_calls(prof, "outer/inner/a", 3) || !check_calls(prof, "outer/inner/b", 3))
+    return EXIT_FAILURE;
+  if (prof.phases().size() != 4 || prof.phases()[prof.find("outer/inner")].iterations.size() != 3)
+  {
+    std::cerr << "* ERROR: Unexpected phase tree or iteration records" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (prof.seconds("outer") < prof.seconds("outer/inner"))
+  {
+    std::cerr << "* ERROR: Parent phase shorter than child phase" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (prof.peak_memory() != 1300 || prof.peak_memory("outer") != 1300 || prof.peak_memory("outer/inner/a") != 1000
+      || prof.peak_memory("outer/inner/b", "matrix") != 300 || prof.peak_memory("outer/inner/b", "quantities") != 1000 || prof.memory() != 0)
+  {
+    std::cerr << "* ERROR: Wrong peak memory: " << prof.peak_memory("outer") << ", " << prof.peak_memory("outer/inner/a") << ", "
+              << prof.peak_memory("outer/inner/b", "matrix") << ", " << prof.memory() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::stringstream json, csv;
+  prof.write_json(json);
+  prof.write_csv(csv);
+  if (json.str().find("\"path\": \"outer/inner/b\"") == std::string::npos || csv.str().find("outer/inner,1,iteration,1,3,1,") == std::string::npos)
+  {
+    std::cerr << "* ERROR: Report incomplete. JSON: " << json.str() << std::endl << "CSV: " << csv.str() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Hardware counters: Recorded if available, otherwise the profiler must work as before
+  //
+  viennashe::util::profiler hw_prof;
+  {
+    viennashe::util::profiler_activation active(hw_prof);
+    bool available = hw_prof.enable_hardware_counters();
+    std::cout << "* main(): Hardware counters " << (available ? "available" : "not available: " + hw_prof.hardware_counters_error()) << std::endl;
+
+    double sum = 0;
+    {
+      viennashe::util::profiler_scope outer("outer");
+      for (std::size_t i=0; i<1000000; ++i)
+        sum += static_cast<double>(i % 7);
+      viennashe::util::profiler_scope inner("inner");
+      for (std::size_t i=0; i<100000; ++i)
+        sum += static_cast<double>(i % 5);
+    }
+    if (!check_calls(hw_prof, "outer", 1) || !check_calls(hw_prof, "outer/inner", 1) || sum <= 0)
+      return EXIT_FAILURE;
+
+    viennashe::util::hardware_counters probe;
+    if (probe.available(viennashe::util::HARDWARE_INSTRUCTIONS)
+        && (hw_prof.counter("outer", "instructions") <= 0 || hw_prof.counter("outer", "instructions") < hw_prof.counter("outer/inner", "instructions")))
+    {
+      std::cerr << "* ERROR: Inconsistent instruction counts: " << hw_prof.counter("outer", "instructions") << ", "
+                << hw_prof.counter("outer/inner", "instructions") << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!available && !hw_prof.phases()[hw_prof.find("outer")].counters.empty())
+    {
+      std::cerr << "* ERROR: Counters recorded although not available" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (!prof.phases()[prof.find("outer")].counters.empty())
+  {
+    std::cerr << "* ERROR: Hardware counters recorded although not enabled" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 2: Phases of a simulation
+  //
+  typedef viennagrid::line_1d_mesh                              MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 1e-6, 21);
+  device.generate_mesh(generator_params);
+  init_device(device, 1e-6);
+
+  std::cout << "* main(): Computing DD..." << std::endl;
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(false);
+  config.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  config.nonlinear_solver().max_iters(3);
+
+  viennashe::simulator<DeviceType> simulator(device, config);
+  simulator.run();
+
+  viennashe::util::profiler const & sim_prof = simulator.profiler();
+  std::string assemble_potential = "run/nonlinear_iteration/assemble/" + viennashe::quantity::potential();
+  if (!check_calls(sim_prof, "run", 1) || sim_prof.find(assemble_potential) == viennashe::util::profiler::no_parent
+      || sim_prof.find("run/nonlinear_iteration/solve") == viennashe::util::profiler::no_parent
+      || sim_prof.find("run/nonlinear_iteration/mapping") == viennashe::util::profiler::no_parent)
+  {
+    std::cerr << "* ERROR: Simulation phases missing" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (sim_prof.phases()[sim_prof.find("run/nonlinear_iteration")].calls != sim_prof.phases()[sim_prof.find("run/nonlinear_iteration/mapping")].calls)
+  {
+    std::cerr << "* ERROR: Inconsistent number of iterations" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (sim_prof.peak_memory(assemble_potential, "system_matrix") <= 0 || sim_prof.peak_memory("run") < sim_prof.peak_memory(assemble_potential))
+  {
+    std::cerr << "* ERROR: Memory of the system matrix not accounted" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  sim_prof.write_json("profiler_dd.json");
+  sim_prof.write_csv("profiler_dd.csv");
+
+  //
+  // Test 3: Memory estimator
+  //
+  viennashe::she::memory_estimate est_L1 = viennashe::she::estimate_memory(100, 101, 1, 50, 1);
+  viennashe::she::memory_estimate est_L3 = viennashe::she::estimate_memory(100, 101, 3, 50, 1);
+  viennashe::she::memory_estimate est_L3_coupled = viennashe::she::estimate_memory(100, 101, 3, 50, 2, true);
+  viennashe::she::memory_estimate est_L3_coupled_dd = viennashe::she::estimate_memory(100, 101, 3, 50, 2, true, 1, 3);
+  viennashe::she::memory_estimate est_dd = viennashe::she::estimate_memory(100, 101, 3, 0, 0, false, 1, 3);
+  if (est_L1.even_unknowns != 100 * 50 || est_L1.odd_unknowns != 101 * 50 * 3 || est_L1.system_matrix <= 0 || est_L1.she_quantities <= 0
+      || est_L3.total() <= est_L1.total() || est_L3_coupled.system_matrix <= est_L3.system_matrix
+      || est_L3_coupled_dd.spatial_unknowns != 300 || est_L3_coupled_dd.system_matrix <= est_L3_coupled.system_matrix
+      || est_L3_coupled_dd.solver_workspace <= est_L3_coupled.solver_workspace || est_L3_coupled_dd.eliminated_matrix != 0
+      || est_dd.num_energies != 0 || est_dd.system_matrix <= 0 || est_dd.system_matrix >= est_L3_coupled_dd.system_matrix
+      || est_L1("system_matrix") != est_L1.system_matrix || est_L1("") != est_L1.total())
+  {
+    std::cerr << "* ERROR: Inconsistent memory estimates" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  config.set_electron_equation(viennashe::EQUATION_SHE);
+  viennashe::she::memory_estimate est_device = viennashe::she::estimate_memory(device, config, 0.1);
+  if (est_device.even_unknowns != viennagrid::cells(device.mesh()).size() * est_device.num_energies || est_device.total() <= 0)
+  {
+    std::cerr << "* ERROR: Device memory estimate inconsistent" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "* main(): Estimated memory for SHE (L=" << config.max_expansion_order() << ", " << est_device.num_energies
+            << " energies): " << est_device.total() << " bytes" << std::endl;
+
+  // The estimate bounds the memory accounted during a SHE simulation with Gummel's method:
+  std::cout << "* main(): Computing SHE with Gummel's method..." << std::endl;
+  viennashe::config she_config;
+  she_config.with_electrons(true);
+  she_config.with_holes(false);
+  she_config.set_electron_equation(viennashe::EQUATION_SHE);
+  she_config.max_expansion_order(1);
+  she_config.nonlinear_solver().max_iters(2);
+
+  viennashe::simulator<DeviceType> she_simulator(device, she_config);
+  she_simulator.set_initial_guess(viennashe::quantity::potential(),        simulator.potential());
+  she_simulator.set_initial_guess(viennashe::quantity::electron_density(), simulator.electron_density());
+  she_simulator.run();
+
+  if (!check_memory_estimate(she_simulator.profiler(), viennashe::she::estimate_memory(device, she_config, 0.1)))
+    return EXIT_FAILURE;
+
+  // The same for Newton's method, where all quantities share a single system matrix.
+  // The SHE scattering operators are not available for Newton's method, hence the coupled system of drift-diffusion is run:
+  std::cout << "* main(): Computing DD with Newton's method..." << std::endl;
+  viennashe::config newton_config;
+  newton_config.with_electrons(true);
+  newton_config.with_holes(true);
+  newton_config.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  newton_config.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+  newton_config.nonlinear_solver().set(viennashe::solvers::nonlinear_solver_ids::newton_nonlinear_solver);
+  newton_config.nonlinear_solver().max_iters(3);
+
+  viennashe::simulator<DeviceType> newton_simulator(device, newton_config);
+  newton_simulator.run();
+
+  if (!check_memory_estimate(newton_simulator.profiler(), viennashe::she::estimate_memory(device, newton_config, 0.1)))
+    return EXIT_FAILURE;
+
+  viennashe::she::memory_estimate est_she_gummel = viennashe::she::estimate_memory(device, she_config, 0.1);
+  she_config.nonlinear_solver().set(viennashe::solvers::nonlinear_solver_ids::newton_nonlinear_solver);
+  viennashe::she::memory_estimate est_she_newton = viennashe::she::estimate_memory(device, she_config, 0.1);
+  if (est_she_newton.spatial_unknowns != viennagrid::cells(device.mesh()).size() || est_she_newton.system_matrix <= est_she_gummel.system_matrix)
+  {
+    std::cerr << "* ERROR: Potential not accounted in the coupled system of Newton's method" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+#!/usr/bin/env python
+##============================================================================
+##   Copyright (c) 2011-2014, Institute for Microelectronics,
+##                            Institute for Analysis and Scientific Computing,
+##                            TU Wien.
+##
+##                            -----------------
+##     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+##                            -----------------
+##
+##                    http://viennashe.sourceforge.net/
+##
+##   License:         MIT (X11), see file LICENSE in the base directory
+##===============================================================================
+
+## @file python_views.py Contains a test of the buffer views of the Python bindings
+## @test Checks the views on quantities and SHE coefficients against the simulator, their lifetime,
+##       the round trip of float64 buffers through set_initial_guess(), the rejection of byte-swapped buffers
+##       and the typed views on the arrays of a result file, which keep the file open.
+
+from __future__ import print_function
+
+import array
+import ctypes
+import gc
+import sys
+
+import pyviennashe as viennashe
+
+
+def fail(message):
+  print("* ERROR: " + message)
+  sys.exit(1)
+
+
+viennashe.initalize()
+
+SI_ID    = viennashe.get_silicon_id()[1]
+METAL_ID = viennashe.get_metal_id()[1]
+
+dev = viennashe.create_1d_device(1e-6, 21)
+num_cells = viennashe.get_num_cells(dev)[1]
+
+matids = [SI_ID] * num_cells
+matids[0] = METAL_ID
+matids[num_cells-1] = METAL_ID
+
+# doping passed as float64 buffers:
+viennashe.initalize_device(dev, matids, array.array('d', [1e24] * num_cells), array.array('d', [1e8] * num_cells))
+viennashe.set_contact_potential_cells(dev, [0, num_cells-1], [0.0, 0.2], 2)
+
+conf_dd = viennashe.create_config()
+viennashe.config_standard_dd(conf_dd)
+viennashe.set_nonlinear_solver_config(conf_dd, viennashe.nonlinear_solver_newton, 30, 1.0)
+
+sim = viennashe.create_simulator(dev, conf_dd)
+viennashe.run(sim)
+
+
+#
+# Test 1: The quantity view matches the values of the simulator
+#
+print("* Test 1: Quantity views")
+view, stride = viennashe.get_cell_based_quantity_view(sim, "Electrostatic potential")
+if view.format != 'd' or not view.readonly:
+  fail("Quantity view must be a read-only float64 view")
+if stride < 1 or len(view) != (num_cells - 1) * stride + 1:
+  fail("Quantity view has a wrong size: " + str(len(view)) + " with stride " + str(stride))
+potential = array.array('d', view)[::stride]
+if not potential[num_cells-2] > potential[1]:
+  fail("Potential view does not reflect the applied bias")
+
+try:
+  viennashe.get_cell_based_quantity_view(sim, "No such quantity")
+  fail("Invalid quantity name must raise KeyError")
+except KeyError:
+  pass
+
+
+#
+# Test 2: Views keep the simulator alive and block functions reallocating its storage
+#
+print("* Test 2: Lifetime of views")
+try:
+  viennashe.run(sim)
+  fail("run() must raise BufferError while views exist")
+except BufferError:
+  pass
+
+sim_tmp = viennashe.create_simulator(dev, conf_dd)
+viennashe.run(sim_tmp)
+view_tmp, stride_tmp = viennashe.get_cell_based_quantity_view(sim_tmp, "Electrostatic potential")
+del sim_tmp
+gc.collect()
+if array.array('d', view_tmp)[::stride_tmp] != potential:
+  fail("View must stay valid after the simulator object has been released")
+del view_tmp
+
+part = view[1:3]
+del view
+gc.collect()
+try:
+  viennashe.run(sim)
+  fail("run() must raise BufferError while a slice of a view exists")
+except BufferError:
+  pass
+del part
+gc.collect()
+viennashe.run(sim)
+
+
+#
+# Test 3: Round trip of the values through set_initial_guess() of another simulator
+#
+print("* Test 3: Round trip")
+sim2 = viennashe.create_simulator(dev, conf_dd)
+viennashe.set_initial_guess(sim2, "Electrostatic potential", array.array('d', potential))
+view2, stride2 = viennashe.get_cell_based_quantity_view(sim2, "Electrostatic potential")
+roundtrip = array.array('d', view2)[::stride2]
+for i in range(1, num_cells-1):  # the contacts carry the boundary values
+  if roundtrip[i] != potential[i]:
+    fail("Round trip of the potential failed at cell " + str(i))
+del view2
+
+
+#
+# Test 4: Float64 buffers need to be in native byte order
+#
+print("* Test 4: Buffer formats")
+native = (ctypes.c_double * num_cells)(*potential)
+viennashe.set_initial_guess(sim2, "Electrostatic potential", native)
+swapped_type = ctypes.c_double.__ctype_be__ if sys.byteorder == 'little' else ctypes.c_double.__ctype_le__
+swapped = (swapped_type * num_cells)(*potential)
+try:
+  viennashe.set_initial_guess(sim2, "Electrostatic potential", swapped)
+  fail("Byte-swapped buffer must be rejected")
+except ValueError:
+  pass
+try:
+  viennashe.set_initial_guess(sim2, "Electrostatic potential", array.array('f', potential))
+  fail("float32 buffer must be rejected")
+except ValueError:
+  pass
+
+
+#
+# Test 5: Views on the SHE coefficients
+#
+print("* Test 5: SHE coefficient views")
+conf_she = viennashe.create_config()
+viennashe.config_she_unipolar_n(conf_she)
+viennashe.set_nonlinear_solver_config(conf_she, viennashe.nonlinear_solver_gummel, 2, 0.5)
+sim_she = viennashe.create_simulator(dev, conf_she)
+viennashe.set_initial_guess_from_other_sim(sim_she, sim)
+viennashe.run(sim_she)
+
+size = viennashe.get_she_coefficients_size(sim_she, viennashe.electron_id)
+if size[1] != num_cells or size[2] == 0:
+  fail("Invalid dimensions of the SHE coefficients: " + str(size))
+found = False
+for index_H in range(size[2]):
+  coeffs = viennashe.get_she_coefficients_view(sim_she, viennashe.electron_id, num_cells // 2, index_H)
+  if coeffs.format != 'd' or not coeffs.readonly:
+    fail("SHE coefficient view must be a read-only float64 view")
+  if len(coeffs) > 0:
+    found = True
+    for c in coeffs:
+      if c != c:
+        fail("SHE coefficient view contains NaN")
+  del coeffs
+if not found:
+  fail("No (x,H)-node carries SHE coefficients")
+
+try:
+  viennashe.get_she_coefficients_view(sim_she, viennashe.electron_id, num_cells, 0)
+  fail("Invalid cell ID must raise IndexError")
+except IndexError:
+  pass
+
+
+#
+# Test 6: Views on the arrays of a result file
+#
+print("* Test 6: Result file views")
+if viennashe.write_result_file(sim, "python_views.vshe") != 0:
+  fail("Writing the result file failed")
+result_file = viennashe.open_result_file("python_views.vshe")
+vertices = viennashe.get_result_file_array_view(result_file, "mesh/vertices")
+cells    = viennashe.get_result_file_array_view(result_file, "mesh/cells")
+if vertices.format != 'd' or not vertices.readonly or vertices.itemsize != 8 or len(vertices) != num_cells + 1:
+  fail("Invalid view on a float64 array: " + vertices.format + ", " + str(len(vertices)) + " values")
+if cells.format != 'q' or not cells.readonly or cells.itemsize != 8 or len(cells) != 2 * num_cells:
+  fail("Invalid view on an int64 array: " + cells.format + ", " + str(len(cells)) + " values")
+if max(cells) != num_cells or min(cells) != 0:
+  fail("Invalid vertex indices in the view on the cells")
+
+try:
+  viennashe.get_result_file_array_view(result_file, "No such array")
+  fail("Invalid array name must raise KeyError")
+except KeyError:
+  pass
+
+try:
+  viennashe.close_result_file(result_file)
+  fail("close_result_file() must raise BufferError while views exist")
+except BufferError:
+  pass
+
+# the views keep the file mapped after the Python object has been released:
+del result_file
+gc.collect()
+if min(vertices) != 0.0 or not max(vertices) > 0.0:
+  fail("View must stay valid after the result file object has been released")
+del vertices
+del cells
+gc.collect()
+
+result_file = viennashe.open_result_file("python_views.vshe")
+viennashe.close_result_file(result_file)
+
+viennashe.finalize()
+
+print("* Tests OK!")
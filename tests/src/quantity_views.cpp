@@ -0,0 +1,297 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// C interface:
+#include "libviennashe/include/libviennashe.h"
+
+
+/** \file quantity_views.cpp Contains a test of the zero-copy views of libviennashe
+ *  \test Compares the views of viennashe_get_cell_based_quantity_view() and viennashe_get_she_coefficients_view() with the copies
+ *        returned by viennashe_get_cell_based_quantity() and viennashe_get_she_edf(), checks their layout and the rejection of invalid arguments.
+ */
+
+/** @brief Compares the view of a quantity solved for by the simulator with the copy from the quantity register */
+bool check_quantity_view(viennashe_simulator sim, viennashe_device dev, viennashe_quan_register reg, std::string const & name)
+{
+  viennashe_index_type num_cells = 0;
+  viennashe_get_num_cells(dev, &num_cells);
+
+  viennashe_quantity_view view;
+  if (viennashe_get_cell_based_quantity_view(sim, name.c_str(), &view) != 0)
+  {
+    std::cerr << "* ERROR: No view of '" << name << "'" << std::endl;
+    return false;
+  }
+  if (view.values == NULL || view.len != num_cells || view.stride < 1)
+  {
+    std::cerr << "* ERROR: View of '" << name << "' has length " << view.len << " and stride " << view.stride
+              << ", expected " << num_cells << " cells" << std::endl;
+    return false;
+  }
+
+  // The view refers to the storage of the simulator, thus a second view points to the same values:
+  viennashe_quantity_view view2;
+  viennashe_get_cell_based_quantity_view(sim, name.c_str(), &view2);
+  if (view2.values != view.values || view2.stride != view.stride)
+  {
+    std::cerr << "* ERROR: Views of '" << name << "' do not refer to the same storage" << std::endl;
+    return false;
+  }
+
+  double ** values = NULL;
+  viennashe_index_type * len = NULL;
+  viennashe_prealloc_cell_based_quantity(dev, &values, &len);
+  viennashe_get_cell_based_quantity(reg, name.c_str(), values, len);
+
+  bool success = true;
+  for (viennashe_index_type i = 0; i < num_cells; ++i)
+  {
+    if (len[i] != 1 || view.values[i * view.stride] != values[i][0])
+    {
+      std::cerr << "* ERROR: View of '" << name << "' differs from the copy on cell " << i << ": "
+                << view.values[i * view.stride] << " vs. " << values[i][0] << std::endl;
+      success = false;
+      break;
+    }
+  }
+
+  viennashe_free_cell_based_quantity(dev, &values, &len);
+  return success;
+}
+
+/** @brief Returns true if the number of even SHE coefficients is that of a full even expansion, i.e. (L+1)(L+2)/2 for an even order L */
+bool is_even_expansion_size(viennashe_index_type num)
+{
+  for (viennashe_index_type L = 0; (L+1)*(L+2)/2 <= num; L += 2)
+    if ((L+1)*(L+2)/2 == num)
+      return true;
+  return false;
+}
+
+
+int main()
+{
+  const long points_x = 21;
+  std::vector<viennashe_material_id> matids(points_x - 1);
+  std::vector<double>                Nd(points_x - 1, 1e24);
+  std::vector<double>                Na(points_x - 1, 1e8);
+  viennashe_index_type               bnd_cells[] = { 0, points_x - 2 };
+  double                             bnd_pot[]   = { 0.0, 0.2 };
+
+  for (long i = 0; i < points_x - 1; ++i)
+    viennashe_get_silicon_id(&matids[i]);
+  viennashe_get_metal_id(&matids[0]);
+  viennashe_get_metal_id(&matids[points_x - 2]);
+
+  viennashe_initalize();
+
+  viennashe_device dev = NULL;
+  viennashe_create_1d_device(&dev, 1e-6, points_x);
+  viennashe_initalize_device(dev, &matids[0], &Nd[0], &Na[0]);
+  viennashe_set_contact_potential_cells(dev, bnd_cells, bnd_pot, 2);
+
+  viennashe_index_type num_cells = 0;
+  viennashe_get_num_cells(dev, &num_cells);
+
+  //
+  // Test 1: Views of the quantities of a DD simulation
+  //
+  std::cout << "* main(): Computing DD..." << std::endl;
+  viennashe_config conf_dd = NULL;
+  viennashe_create_config(&conf_dd);
+  viennashe_config_standard_dd(conf_dd);
+  viennashe_set_nonlinear_solver_config(conf_dd, viennashe_nonlinear_solver_newton, 30, 1.0);
+
+  viennashe_simulator sim_dd = NULL;
+  viennashe_create_simulator(&sim_dd, dev, conf_dd);
+  viennashe_run(sim_dd);
+
+  viennashe_quan_register reg_dd = NULL;
+  viennashe_create_quantity_register(&reg_dd, sim_dd);
+
+  std::cout << "* main(): Checking quantity views..." << std::endl;
+  if (   !check_quantity_view(sim_dd, dev, reg_dd, "Electrostatic potential")
+      || !check_quantity_view(sim_dd, dev, reg_dd, "Electron density")
+      || !check_quantity_view(sim_dd, dev, reg_dd, "Hole density"))
+    return EXIT_FAILURE;
+
+  viennashe_quantity_view view;
+  if (viennashe_get_cell_based_quantity_view(sim_dd, "No such quantity", &view) != 2
+      || viennashe_get_cell_based_quantity_view(sim_dd, "Electric field", &view) != 2) // registered, but not stored as an array by the simulator
+  {
+    std::cerr << "* ERROR: Invalid quantity names not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (viennashe_get_cell_based_quantity_view(NULL, "Electrostatic potential", &view) != 1
+      || viennashe_get_cell_based_quantity_view(sim_dd, NULL, &view) != 2
+      || viennashe_get_cell_based_quantity_view(sim_dd, "Electrostatic potential", NULL) != 3)
+  {
+    std::cerr << "* ERROR: Invalid arguments of viennashe_get_cell_based_quantity_view() not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Without SHE there are no coefficients:
+  viennashe_index_type she_cells = 1;
+  viennashe_index_type she_energies = 1;
+  if (viennashe_get_she_coefficients_size(sim_dd, viennashe_electron_id, &she_cells, &she_energies) != 0 || she_cells != 0)
+  {
+    std::cerr << "* ERROR: DD simulation reports SHE coefficients" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 2: Views of the SHE coefficients
+  //
+  std::cout << "* main(): Computing SHE..." << std::endl;
+  viennashe_config conf_she = NULL;
+  viennashe_create_config(&conf_she);
+  viennashe_config_she_unipolar_n(conf_she);
+  viennashe_set_nonlinear_solver_config(conf_she, viennashe_nonlinear_solver_gummel, 2, 0.5);
+
+  viennashe_simulator sim_she = NULL;
+  viennashe_create_simulator(&sim_she, dev, conf_she);
+  viennashe_set_initial_guess_from_other_sim(sim_she, sim_dd);
+  viennashe_run(sim_she);
+
+  viennashe_quan_register reg_she = NULL;
+  viennashe_create_quantity_register(&reg_she, sim_she);
+
+  std::cout << "* main(): Checking SHE coefficient views..." << std::endl;
+  if (viennashe_get_she_coefficients_size(sim_she, viennashe_electron_id, &she_cells, &she_energies) != 0
+      || she_cells != num_cells || she_energies < 3)
+  {
+    std::cerr << "* ERROR: Invalid dimensions of the SHE coefficients: " << she_cells << " x " << she_energies << std::endl;
+    return EXIT_FAILURE;
+  }
+  viennashe_index_type hole_cells = 1;
+  viennashe_index_type hole_energies = 0;
+  if (viennashe_get_she_coefficients_size(sim_she, viennashe_hole_id, &hole_cells, &hole_energies) != 0 || hole_cells != 0)
+  {
+    std::cerr << "* ERROR: Holes solved with DD report SHE coefficients" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The EDF is the zeroth-order coefficient times Y_00:
+  std::vector<std::vector<double> > edf_energies(static_cast<std::size_t>(num_cells), std::vector<double>(static_cast<std::size_t>(she_energies)));
+  std::vector<std::vector<double> > edf_values(static_cast<std::size_t>(num_cells), std::vector<double>(static_cast<std::size_t>(she_energies)));
+  std::vector<double *>             edf_energies_ptr(static_cast<std::size_t>(num_cells));
+  std::vector<double *>             edf_values_ptr(static_cast<std::size_t>(num_cells));
+  std::vector<viennashe_index_type> edf_len(static_cast<std::size_t>(num_cells));
+  for (std::size_t i = 0; i < edf_values.size(); ++i)
+  {
+    edf_energies_ptr[i] = &(edf_energies[i][0]);
+    edf_values_ptr[i]   = &(edf_values[i][0]);
+  }
+  viennashe_get_she_edf(reg_she, viennashe_electron_id, &edf_energies_ptr[0], &edf_values_ptr[0], &edf_len[0]);
+
+  const double Y_00 = 1.0 / std::sqrt(4.0 * 3.1415926535897932384626433832795);
+  std::size_t nodes_with_coefficients = 0;
+  for (viennashe_index_type cell_id = 0; cell_id < num_cells; ++cell_id)
+  {
+    for (viennashe_index_type index_H = 0; index_H < she_energies; ++index_H)
+    {
+      const double * coefficients = NULL;
+      viennashe_index_type num_coefficients = 0;
+      if (viennashe_get_she_coefficients_view(sim_she, viennashe_electron_id, cell_id, index_H, &coefficients, &num_coefficients) != 0)
+      {
+        std::cerr << "* ERROR: No SHE coefficients on node (" << cell_id << ", " << index_H << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if ( (num_coefficients == 0) != (coefficients == NULL) || (num_coefficients > 0 && !is_even_expansion_size(num_coefficients)) )
+      {
+        std::cerr << "* ERROR: Invalid view of the SHE coefficients on node (" << cell_id << ", " << index_H << "): "
+                  << num_coefficients << " coefficients" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (viennashe_index_type i = 0; i < num_coefficients; ++i)
+      {
+        if (coefficients[i] != coefficients[i])
+        {
+          std::cerr << "* ERROR: SHE coefficient view contains NaN on node (" << cell_id << ", " << index_H << ")" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      if (num_coefficients > 0)
+        ++nodes_with_coefficients;
+
+      // viennashe_get_she_edf() returns the energies with index 1, ..., num_energies - 2:
+      if (index_H == 0 || index_H >= she_energies - 1)
+        continue;
+      const double edf = edf_values[static_cast<std::size_t>(cell_id)][static_cast<std::size_t>(index_H - 1)];
+      const double f_00 = (num_coefficients > 0) ? coefficients[0] * Y_00 : 0.0;
+      if (!viennashe::testing::fuzzy_equal(edf, f_00, 1e-12))
+      {
+        std::cerr << "* ERROR: SHE coefficient view differs from the EDF on node (" << cell_id << ", " << index_H << "): "
+                  << f_00 << " vs. " << edf << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  if (nodes_with_coefficients == 0)
+  {
+    std::cerr << "* ERROR: No (x,H)-node carries SHE coefficients" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const double * coefficients = NULL;
+  viennashe_index_type num_coefficients = 0;
+  if (viennashe_get_she_coefficients_view(sim_she, viennashe_electron_id, num_cells, 0, &coefficients, &num_coefficients) != 3
+      || viennashe_get_she_coefficients_view(sim_she, viennashe_electron_id, 0, she_energies, &coefficients, &num_coefficients) != 3
+      || viennashe_get_she_coefficients_view(sim_she, viennashe_hole_id, 0, 0, &coefficients, &num_coefficients) != 3)
+  {
+    std::cerr << "* ERROR: Invalid (x,H)-nodes not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (viennashe_get_she_coefficients_view(NULL, viennashe_electron_id, 0, 0, &coefficients, &num_coefficients) != 1
+      || viennashe_get_she_coefficients_view(sim_she, viennashe_electron_id, 0, 0, NULL, &num_coefficients) != 5
+      || viennashe_get_she_coefficients_view(sim_she, viennashe_electron_id, 0, 0, &coefficients, NULL) != 6
+      || viennashe_get_she_coefficients_size(NULL, viennashe_electron_id, &she_cells, &she_energies) != 1
+      || viennashe_get_she_coefficients_size(sim_she, viennashe_electron_id, NULL, &she_energies) != 3
+      || viennashe_get_she_coefficients_size(sim_she, viennashe_electron_id, &she_cells, NULL) != 4)
+  {
+    std::cerr << "* ERROR: Invalid arguments of the SHE coefficient functions not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennashe_free_quantity_register(reg_she);
+  viennashe_free_quantity_register(reg_dd);
+  viennashe_free_simulator(sim_she);
+  viennashe_free_simulator(sim_dd);
+  viennashe_free_config(conf_she);
+  viennashe_free_config(conf_dd);
+  viennashe_free_device(dev);
+
+  viennashe_finalize();
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 =============================================================================== */
 
 #include <cstdlib>
+#include <vector>
 
 #include "tests/src/common.hpp"
 
@@ -82,8 +83,95 @@ inline void test_merseinne_generator()
     if (!viennashe::testing::fuzzy_equal(r, values[i], 1e-7))
       throw viennashe::invalid_value_exception("random_numbers-test: 'Invalid' pseudo-random number found! ", r);
   }
+
+  // Setting the seed again restarts the sequence
+  rnd.seed(7);
+  for (long i = 0; i < 100; ++i)
+  {
+    const double r = rnd();
+    if (!viennashe::testing::fuzzy_equal(r, values[i], 1e-7))
+      throw viennashe::invalid_value_exception("random_numbers-test: Sequence not restarted by seed()! ", r);
+  }
 } // test_merseinne_generator
 
+/** @brief Tests the counter-based Philox4x32-10 RNG. Throws if the test fails */
+inline void test_philox_generator()
+{
+  viennashe::log::info() << "random_numbers-test: Testing Philox4x32-10 based generator ..." << std::endl;
+
+  typedef viennashe::math::philox_generator<double>  GeneratorType;
+
+  // Known answers of the reference implementation (Random123)
+  const uint32_t counters[3][4] = { { 0, 0, 0, 0 },
+                                    { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+                                    { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } };
+  const uint32_t keys[3][2]     = { { 0, 0 }, { 0xffffffff, 0xffffffff }, { 0xa4093822, 0x299f31d0 } };
+  const uint32_t results[3][4]  = { { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+                                    { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+                                    { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+  for (std::size_t i = 0; i < 3; ++i)
+  {
+    uint32_t result[4];
+    GeneratorType::philox4x32(counters[i], keys[i], result);
+    for (std::size_t j = 0; j < 4; ++j)
+      if (result[j] != results[i][j])
+        throw viennashe::invalid_value_exception("random_numbers-test: Philox4x32-10 differs from the known answer ", static_cast<double>(result[j]));
+  }
+
+  // The first block of stream 0 with seed 0 is the first known answer
+  GeneratorType rnd;
+  std::vector<double> sequence(1000);
+  for (std::size_t i = 0; i < sequence.size(); ++i)
+    sequence[i] = rnd();
+  for (std::size_t j = 0; j < 4; ++j)
+    if (sequence[j] != results[0][j] / 4294967296.0)
+      throw viennashe::invalid_value_exception("random_numbers-test: 'Invalid' pseudo-random number found! ", sequence[j]);
+
+  // Block generation yields the same sequence, also when starting within a block
+  GeneratorType block_rnd;
+  std::vector<double> block_sequence(sequence.size());
+  block_rnd.generate(&block_sequence[0], 3);
+  block_rnd.generate(&block_sequence[3], block_sequence.size() - 3);
+  if (block_sequence != sequence || block_rnd.position() != sequence.size())
+    throw viennashe::invalid_value_exception("random_numbers-test: Block generation differs from the sequence ", 0);
+
+  // Continuing at a position
+  GeneratorType seek_rnd;
+  seek_rnd.position(537);
+  if (seek_rnd() != sequence[537] || seek_rnd() != sequence[538])
+    throw viennashe::invalid_value_exception("random_numbers-test: Sequence continued at the wrong position ", 537);
+
+  // Streams are independent
+  GeneratorType other_stream = rnd.stream(1);
+  GeneratorType same_stream(0, 1);
+  std::size_t num_equal = 0;
+  for (std::size_t i = 0; i < sequence.size(); ++i)
+  {
+    const double r = other_stream();
+    if (r != same_stream())
+      throw viennashe::invalid_value_exception("random_numbers-test: Stream not reproducible ", r);
+    if (r == sequence[i])
+      ++num_equal;
+  }
+  if (num_equal > 0 || other_stream.stream_id() != 1)
+    throw viennashe::invalid_value_exception("random_numbers-test: Streams are not independent ", static_cast<double>(num_equal));
+
+  // Reseeding restarts the sequence; uniform distribution on [0,1)
+  rnd.seed(0);
+  double sum = 0;
+  for (std::size_t i = 0; i < 100000; ++i)
+  {
+    const double r = rnd();
+    if (i < sequence.size() && r != sequence[i])
+      throw viennashe::invalid_value_exception("random_numbers-test: Sequence not restarted by seed()! ", r);
+    if (r < 0.0 || r >= 1.0)
+      throw viennashe::invalid_value_exception("random_numbers-test: Pseudo-random number out of [0,1) ", r);
+    sum += r;
+  }
+  if (!viennashe::testing::fuzzy_equal(sum / 100000.0, 0.5, 0.01))
+    throw viennashe::invalid_value_exception("random_numbers-test: Wrong mean of pseudo-random numbers ", sum / 100000.0);
+} // test_philox_generator
+
 
 
 /*
@@ -97,6 +185,8 @@ int main()
 
   test_merseinne_generator();
 
+  test_philox_generator();
+
   viennashe::log::info() << "random_numbers-test: Finished!" << std::endl;
 
   return (EXIT_SUCCESS);
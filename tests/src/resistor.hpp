@@ -0,0 +1,95 @@
+#ifndef VIENNASHE_TESTS_RESISTOR_HPP
+#define VIENNASHE_TESTS_RESISTOR_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+/** @file tests/src/resistor.hpp
+    @brief Contains the device setup of the silicon resistor and the pn-junction along the x-axis, shared by the tests of the simulator and its outputs
+ */
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid includes:
+#include "viennagrid/algorithm/centroid.hpp"
+
+
+/** @brief Initalizes a silicon resistor with a homogeneous doping. The cells in the outer tenth of either side are contacts.
+*
+* @param device           The device class that is to be initalized
+* @param len_x            Length of the device
+* @param left_potential   Contact potential of the left contact
+* @param right_potential  Contact potential of the right contact
+* @param doping_n         Donor doping
+* @param doping_p         Acceptor doping
+*/
+template <typename DeviceType>
+void init_device(DeviceType & device, double len_x,
+                 double left_potential = 0.0, double right_potential = 0.1,
+                 double doping_n = 1e24, double doping_p = 1e8)
+{
+  typedef typename DeviceType::mesh_type           MeshType;
+
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  device.set_doping_n(doping_n);
+  device.set_doping_p(doping_p);
+  device.set_material(viennashe::materials::si());
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit  = cells.begin();
+                    cit != cells.end();
+                  ++cit)
+  {
+    if (viennagrid::centroid(*cit)[0] < 0.1 * len_x)
+      device.set_contact_potential(left_potential, *cit);
+    if (viennagrid::centroid(*cit)[0] > 0.9 * len_x)
+      device.set_contact_potential(right_potential, *cit);
+  }
+}
+
+/** @brief Initalizes a silicon pn-junction with an n-doped left half and a p-doped right half. The cells in the outer tenth of either side are contacts.
+*
+* @param device           The device class that is to be initalized
+* @param len_x            Length of the device
+* @param right_potential  Contact potential of the right contact. The left contact is at zero potential.
+*/
+template <typename DeviceType>
+void init_pn_device(DeviceType & device, double len_x, double right_potential)
+{
+  typedef typename DeviceType::mesh_type           MeshType;
+
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  device.set_material(viennashe::materials::si());
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit  = cells.begin();
+                    cit != cells.end();
+                  ++cit)
+  {
+    const double x = viennagrid::centroid(*cit)[0];
+    device.set_doping_n((x < 0.5 * len_x) ? 1e24 : 1e8,  *cit);
+    device.set_doping_p((x < 0.5 * len_x) ? 1e8  : 1e24, *cit);
+
+    if (x < 0.1 * len_x)
+      device.set_contact_potential(0.0, *cit);
+    if (x > 0.9 * len_x)
+      device.set_contact_potential(right_potential, *cit);
+  }
+}
+
+#endif /* VIENNASHE_TESTS_RESISTOR_HPP */
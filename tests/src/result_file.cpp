@@ -0,0 +1,205 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file result_file.cpp Contains a test of the native result file
+ *  \test Writes the results of a SHE simulation of a resistor to a result file, maps the file and compares all arrays with the quantities of the simulator.
+ */
+
+/** @brief Checks the size of an array in the result file */
+inline bool check_size(viennashe::io::result_file_reader const & reader, std::string const & name, std::size_t expected)
+{
+  if (!reader.has_array(name) || reader.size(name) != expected)
+  {
+    std::cerr << "* ERROR: Array '" << name << "' missing or of wrong size (expected " << expected << ")" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** @brief Compares the SHE coefficients of all cells or facets with the data in the result file */
+template <typename ElementContainerT, typename SHEQuantityT>
+bool check_she_coefficients(viennashe::io::result_file_reader const & reader, ElementContainerT const & elements, SHEQuantityT const & quan, std::string const & prefix)
+{
+  typedef typename viennagrid::result_of::iterator<ElementContainerT>::type   ElementIterator;
+
+  const std::size_t size_H = quan.get_value_H_size();
+  if (!check_size(reader, prefix + "_expansion_order", elements.size() * size_H)
+      || !check_size(reader, prefix + "_offsets", elements.size() * size_H + 1))
+    return false;
+
+  long long const * orders       = reader.data<long long>(prefix + "_expansion_order");
+  long long const * offsets      = reader.data<long long>(prefix + "_offsets");
+  double    const * coefficients = reader.data<double>(prefix + "_coefficients");
+
+  for (ElementIterator it = elements.begin(); it != elements.end(); ++it)
+  {
+    for (std::size_t index_H = 0; index_H < size_H; ++index_H)
+    {
+      std::size_t i = static_cast<std::size_t>(it->id().get()) * size_H + index_H;
+      if (orders[i] != static_cast<long long>(quan.get_expansion_order(*it, index_H)))
+      {
+        std::cerr << "* ERROR: Expansion order mismatch in '" << prefix << "' at entry " << i << std::endl;
+        return false;
+      }
+      for (long long j = offsets[i]; j < offsets[i+1]; ++j)
+      {
+        if (coefficients[j] != quan.get_values(*it, index_H)[j - offsets[i]])
+        {
+          std::cerr << "* ERROR: Coefficient mismatch in '" << prefix << "' at entry " << i << std::endl;
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+
+int main()
+{
+  typedef viennagrid::quadrilateral_2d_mesh                     MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  typedef viennagrid::result_of::const_cell_range<MeshType>::type    CellContainer;
+  typedef viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+  typedef viennagrid::result_of::const_facet_range<MeshType>::type   FacetContainer;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 6.0e-7, 10,   //start at x=, length, points
+                               0.0, 6.0e-7,  2);  //start at y=, length, points
+  device.generate_mesh(generator_params);
+  init_device(device, generator_params.at(0).get_length_x(), 0.0, 0.0, 1e16, 1e16);
+
+  std::cout << "* main(): Computing SHE..." << std::endl;
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(true);
+  config.set_electron_equation(viennashe::EQUATION_SHE);
+  config.set_hole_equation(viennashe::EQUATION_SHE);
+  config.scattering().ionized_impurity().enabled(false);
+  config.energy_spacing(6.2 * viennashe::physics::constants::q / 1000.0);
+  config.nonlinear_solver().max_iters(1);
+
+  viennashe::simulator<DeviceType> she_simulator(device, config);
+  she_simulator.run();
+
+  std::cout << "* main(): Writing result file..." << std::endl;
+  viennashe::io::write_result_file(device, she_simulator.quantities(), "result_file_resistor.vsr");
+
+  std::cout << "* main(): Reading result file..." << std::endl;
+  viennashe::io::result_file_reader reader("result_file_resistor.vsr");
+
+  CellContainer  cells(device.mesh());
+  FacetContainer facets(device.mesh());
+
+  //
+  // Mesh and device data
+  //
+  if (!check_size(reader, "mesh/vertices", 2 * viennagrid::vertices(device.mesh()).size())
+      || !check_size(reader, "mesh/cells", 4 * cells.size())
+      || !check_size(reader, "mesh/facets", 2 * facets.size())
+      || !check_size(reader, "mesh/cell_doping_n", cells.size()))
+    return EXIT_FAILURE;
+
+  //
+  // Spatial quantities
+  //
+  std::string potential_name = "quantity/" + viennashe::quantity::potential();
+  if (!check_size(reader, potential_name, cells.size()))
+    return EXIT_FAILURE;
+
+  double const * potential = reader.data<double>(potential_name);
+  double const * doping_n  = reader.data<double>("mesh/cell_doping_n");
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    std::size_t id = static_cast<std::size_t>(cit->id().get());
+    if (potential[id] != she_simulator.potential()(*cit) || doping_n[id] != device.get_doping_n(*cit))
+    {
+      std::cerr << "* ERROR: Potential or doping mismatch at cell " << id << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // SHE quantities
+  //
+  typedef viennashe::simulator<DeviceType>::SHETimeStepQuantitiesT::UnknownSHEQuantityType   SHEQuantityType;
+  SHEQuantityType const & edf = she_simulator.quantities().electron_distribution_function();
+  std::string prefix = "she/" + edf.get_name() + "/";
+
+  if (!check_size(reader, prefix + "energies", edf.get_value_H_size()))
+    return EXIT_FAILURE;
+  for (std::size_t index_H = 0; index_H < edf.get_value_H_size(); ++index_H)
+  {
+    if (reader.data<double>(prefix + "energies")[index_H] != edf.get_value_H(index_H))
+    {
+      std::cerr << "* ERROR: Energy mismatch at index " << index_H << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!check_she_coefficients(reader, cells, edf, prefix + "cell") || !check_she_coefficients(reader, facets, edf, prefix + "facet"))
+    return EXIT_FAILURE;
+
+  //
+  // Type mismatch must be detected
+  //
+  bool type_error = false;
+  try
+  {
+    reader.data<long long>(potential_name);
+  }
+  catch (viennashe::io::io_operation_unsupported_exception const &)
+  {
+    type_error = true;
+  }
+  if (!type_error)
+  {
+    std::cerr << "* ERROR: Type mismatch not detected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,259 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+
+/** \file schwarz_solver.cpp Contains a test of the overlapping Schwarz linear solver
+ *  \test Compares the SHE results obtained with the Schwarz solver (subdomains from the device segments and from graph partitioning)
+ *        with the default solver and checks the subdomains written by fill_schwarz_partition(), where segments without SHE unknowns are skipped.
+ */
+
+/** @brief Generates the mesh and initalizes the device: Oxide (0) | Contact (1) | n (2) | n (3) | Contact (4). The oxide carries no SHE unknowns. */
+template <typename DeviceType>
+void init_device(DeviceType & device)
+{
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0,    1e-8,   6);
+  generator_params.add_segment(1e-8,   1e-8,   6);
+  generator_params.add_segment(2e-8,   1.5e-7, 31);
+  generator_params.add_segment(1.7e-7, 1.5e-7, 31);
+  generator_params.add_segment(3.2e-7, 1e-8,   6);
+  device.generate_mesh(generator_params);
+
+  device.set_material(viennashe::materials::sio2(),  device.segment(0));
+  device.set_material(viennashe::materials::metal(), device.segment(1));
+  device.set_material(viennashe::materials::si(),    device.segment(2));
+  device.set_material(viennashe::materials::si(),    device.segment(3));
+  device.set_material(viennashe::materials::metal(), device.segment(4));
+
+  device.set_doping_n(1e24);
+  device.set_doping_p(1e8);
+
+  device.set_contact_potential(0.0, device.segment(1));
+  device.set_contact_potential(0.2, device.segment(4));
+}
+
+/** @brief Returns a SHE configuration for electrons with the given linear solver */
+viennashe::config she_config(long linear_solver_id)
+{
+  viennashe::config conf;
+  conf.with_electrons(true);
+  conf.with_holes(false);
+  conf.set_electron_equation(viennashe::EQUATION_SHE);
+  conf.max_expansion_order(1);
+  conf.nonlinear_solver().max_iters(3);
+  conf.linear_solver().set(linear_solver_id);
+  return conf;
+}
+
+/** @brief Runs a SHE simulation starting from the DD solution */
+template <typename SimulatorType>
+void run_she(SimulatorType & sim, SimulatorType const & dd_sim)
+{
+  sim.set_initial_guess(viennashe::quantity::potential(),        dd_sim.potential());
+  sim.set_initial_guess(viennashe::quantity::electron_density(), dd_sim.electron_density());
+  sim.run();
+}
+
+/** @brief Compares potential and electron density of two simulations on all cells */
+template <typename SimulatorType>
+bool compare_results(SimulatorType const & sim, SimulatorType const & ref_sim, std::string const & name)
+{
+  typedef typename SimulatorType::device_type                                 DeviceType;
+  typedef typename DeviceType::mesh_type                                      MeshType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type    CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+
+  CellContainer cells(sim.device().mesh());
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    if (   !viennashe::testing::fuzzy_equal(sim.potential()(*cit),        ref_sim.potential()(*cit),        1e-6)
+        || !viennashe::testing::fuzzy_equal(sim.electron_density()(*cit), ref_sim.electron_density()(*cit), 1e-4))
+    {
+      std::cerr << "* ERROR: Result of the Schwarz solver (" << name << ") differs from the default solver at cell " << *cit << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/** @brief Checks the subdomain IDs written by fill_schwarz_partition() for the even unknowns of the electron distribution function */
+template <typename SimulatorType>
+bool check_partition(SimulatorType const & sim)
+{
+  typedef typename SimulatorType::device_type                                     DeviceType;
+  typedef typename DeviceType::segment_type                                       SegmentType;
+  typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type     CellOnSegmentContainer;
+  typedef typename viennagrid::result_of::iterator<CellOnSegmentContainer>::type  CellOnSegmentIterator;
+  typedef typename SimulatorType::she_quantity_type                               SHEQuantityType;
+
+  DeviceType const & device = sim.device();
+  SHEQuantityType const & quan = sim.quantities().electron_distribution_function();
+  const std::size_t system_size = sim.last_iteration().electron_even_unknowns;
+
+  std::vector<long> partition(system_size, -1);
+  viennashe::she::fill_schwarz_partition(device, quan, system_size, partition);
+  if (partition.size() != system_size || system_size == 0)
+  {
+    std::cerr << "* ERROR: Schwarz partition has size " << partition.size() << ", expected " << system_size << std::endl;
+    return false;
+  }
+
+  // Each unknown is assigned to the subdomain of its segment, subdomain IDs are counted over segments with unknowns only:
+  std::vector<bool> covered(system_size, false);
+  long expected_id = 0;
+  for (std::size_t segment_id = 0; segment_id < device.segmentation().size(); ++segment_id)
+  {
+    bool has_unknowns = false;
+    CellOnSegmentContainer cells(device.segment(static_cast<long>(segment_id)));
+    for (CellOnSegmentIterator cit = cells.begin(); cit != cells.end(); ++cit)
+    {
+      for (std::size_t index_H = 0; index_H < quan.get_value_H_size(); ++index_H)
+      {
+        const long index = quan.get_unknown_index(*cit, index_H);
+        if (index < 0)
+          continue;
+
+        has_unknowns = true;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(quan.get_unknown_num(*cit, index_H)); ++i)
+        {
+          const std::size_t k = std::size_t(index) + i;
+          if (k >= system_size || partition[k] != expected_id)
+          {
+            std::cerr << "* ERROR: Unknown " << k << " on segment " << segment_id << " assigned to subdomain "
+                      << (k < system_size ? partition[k] : -1) << ", expected " << expected_id << std::endl;
+            return false;
+          }
+          covered[k] = true;
+        }
+      }
+    }
+
+    // the oxide carries no unknowns, the semiconductor segments do:
+    if ( (segment_id == 0 && has_unknowns) || ((segment_id == 2 || segment_id == 3) && !has_unknowns) )
+    {
+      std::cerr << "* ERROR: Unexpected SHE unknowns on segment " << segment_id << std::endl;
+      return false;
+    }
+
+    if (has_unknowns)
+      ++expected_id;
+  }
+
+  if (expected_id < 2)
+  {
+    std::cerr << "* ERROR: Only " << expected_id << " subdomains found" << std::endl;
+    return false;
+  }
+  for (std::size_t k = 0; k < system_size; ++k)
+  {
+    if (!covered[k])
+    {
+      std::cerr << "* ERROR: Unknown " << k << " not located on any segment" << std::endl;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+int main()
+{
+  typedef viennagrid::line_1d_mesh       MeshType;
+  typedef viennashe::device<MeshType>    DeviceType;
+  typedef viennashe::simulator<DeviceType> SimulatorType;
+
+  std::cout << viennashe::preamble() << std::endl;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+  init_device(device);
+
+  std::cout << "* main(): Computing DD..." << std::endl;
+  viennashe::config dd_conf;
+  dd_conf.with_electrons(true);
+  dd_conf.with_holes(false);
+  dd_conf.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  dd_conf.nonlinear_solver().max_iters(50);
+
+  SimulatorType dd_simulator(device, dd_conf);
+  dd_simulator.run();
+
+  //
+  // Test 1: Reference solution with the default solver
+  //
+  std::cout << "* main(): Computing SHE with the default solver..." << std::endl;
+  SimulatorType ref_simulator(device, she_config(viennashe::solvers::linear_solver_ids::serial_linear_solver));
+  run_she(ref_simulator, dd_simulator);
+
+  //
+  // Test 2: Schwarz solver with one subdomain per segment
+  //
+  std::cout << "* main(): Computing SHE with the Schwarz solver (segment partition)..." << std::endl;
+  viennashe::config segment_conf = she_config(viennashe::solvers::linear_solver_ids::schwarz_linear_solver);
+  segment_conf.linear_solver().schwarz_segment_partition(true);
+
+  SimulatorType segment_simulator(device, segment_conf);
+  run_she(segment_simulator, dd_simulator);
+
+  if (!compare_results(segment_simulator, ref_simulator, "segment partition"))
+    return EXIT_FAILURE;
+
+  std::cout << "* main(): Checking Schwarz partition..." << std::endl;
+  if (!check_partition(segment_simulator))
+    return EXIT_FAILURE;
+
+  //
+  // Test 3: Schwarz solver with subdomains from graph partitioning
+  //
+  std::cout << "* main(): Computing SHE with the Schwarz solver (graph partition)..." << std::endl;
+  viennashe::config graph_conf = she_config(viennashe::solvers::linear_solver_ids::schwarz_linear_solver);
+  graph_conf.linear_solver().schwarz_subdomains(3);
+  graph_conf.linear_solver().schwarz_overlap(2);
+
+  SimulatorType graph_simulator(device, graph_conf);
+  run_she(graph_simulator, dd_simulator);
+
+  if (!compare_results(graph_simulator, ref_simulator, "graph partition"))
+    return EXIT_FAILURE;
+
+  std::cout << "* main(): Tests OK!" << std::endl;
+  std::cout << std::endl;
+  std::cout << "*********************************************************" << std::endl;
+  std::cout << "*           ViennaSHE finished successfully             *" << std::endl;
+  std::cout << "*********************************************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file shared_device.cpp Contains a test of simulators sharing a device
+ *  \test Checks that simulators on a shared device with biases set per simulator reproduce a simulator on a device of its own,
+ *        run concurrently without modifying the device, and reject the lattice heat equation.
+ */
+
+/** @brief Sets the contact potential of the right contact for the simulator only */
+template <typename SimulatorType>
+void set_right_contact_potential(SimulatorType & sim, double len_x, double potential)
+{
+  typedef typename SimulatorType::device_type::mesh_type   MeshType;
+
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  CellContainer cells(sim.device().mesh());
+  for (CellIterator cit  = cells.begin();
+                    cit != cells.end();
+                  ++cit)
+  {
+    if (viennagrid::centroid(*cit)[0] > 0.9 * len_x)
+      sim.set_contact_potential(potential, *cit);
+  }
+}
+
+
+int main()
+{
+  typedef viennagrid::line_1d_mesh                              MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+  typedef viennashe::simulator<DeviceType>                      SimulatorType;
+
+  typedef viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  const double len_x = 1e-6;
+
+  std::cout << "* main(): Creating devices..." << std::endl;
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, len_x, 21);
+
+  DeviceType reference_device;
+  reference_device.generate_mesh(generator_params);
+  init_device(reference_device, len_x, 0.0, 0.1);
+
+  DeviceType shared_device;
+  shared_device.generate_mesh(generator_params);
+  init_device(shared_device, len_x, 0.0, 0.0);
+  viennashe::detail::smooth_doping_at_contacts(shared_device);
+
+  const std::vector<double> shared_doping_n = shared_device.doping_n();
+
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(false);
+  config.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  config.nonlinear_solver().max_iters(10);
+
+  //
+  // Test 1: Biases per simulator on a shared device, simulators running concurrently
+  //
+  std::cout << "* main(): Computing DD on a device of its own..." << std::endl;
+  SimulatorType reference_simulator(reference_device, config);
+  reference_simulator.run();
+
+  std::cout << "* main(): Computing DD concurrently on a shared device..." << std::endl;
+  SimulatorType biased_simulator(shared_device, config, viennashe::shared_device_tag());
+  SimulatorType unbiased_simulator(shared_device, config, viennashe::shared_device_tag());
+  set_right_contact_potential(biased_simulator, len_x, 0.1);
+
+  if (!biased_simulator.device_shared() || reference_simulator.device_shared())
+  {
+    std::cerr << "* ERROR: Sharing of the device not reported" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::thread biased_thread(&SimulatorType::run, &biased_simulator);
+  unbiased_simulator.run();
+  biased_thread.join();
+
+  bool bias_applied = false;
+  CellContainer cells(shared_device.mesh());
+  CellContainer reference_cells(reference_device.mesh());
+  for (std::size_t i=0; i<cells.size(); ++i)
+  {
+    if (!viennashe::testing::fuzzy_equal(biased_simulator.potential().get_value(cells[i]), reference_simulator.potential().get_value(reference_cells[i]), 1e-8))
+    {
+      std::cerr << "* ERROR: Potential with bias set on the simulator differs from the reference at cell " << i << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (std::fabs(biased_simulator.potential().get_value(cells[i]) - unbiased_simulator.potential().get_value(cells[i])) > 0.05)
+      bias_applied = true;
+  }
+  if (!bias_applied)
+  {
+    std::cerr << "* ERROR: Bias set on the simulator affects the other simulator on the device" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    if (shared_device.get_doping_n(*cit) != shared_doping_n.at(std::size_t(cit->id().get()))
+        || (shared_device.has_contact_potential(*cit) && shared_device.get_contact_potential(*cit) != 0.0))
+    {
+      std::cerr << "* ERROR: Shared device modified by a simulator" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // Test 2: The bias is kept when advancing in time
+  //
+  biased_simulator.advance_in_time();
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    if (viennagrid::centroid(*cit)[0] > 0.9 * len_x
+        && !viennashe::testing::fuzzy_equal(biased_simulator.quantities().get_unknown_quantity(viennashe::quantity::potential()).get_boundary_value(*cit),
+                                            reference_simulator.quantities().get_unknown_quantity(viennashe::quantity::potential()).get_boundary_value(reference_cells[std::size_t(cit->id().get())]),
+                                            1e-10))
+    {
+      std::cerr << "* ERROR: Bias set on the simulator lost when advancing in time" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // Test 3: The lattice heat equation is not available on a shared device
+  //
+  std::cout << "* main(): Checking the lattice heat equation on a shared device..." << std::endl;
+  unbiased_simulator.config().with_hde(true);
+  try
+  {
+    unbiased_simulator.run();
+    std::cerr << "* ERROR: Lattice heat equation accepted on a shared device" << std::endl;
+    return EXIT_FAILURE;
+  }
+  catch (viennashe::unavailable_feature_exception const &) {}
+
+  //
+  // Test 4: SHE coupling matrices are computed once and shared between simulators
+  //
+  std::cout << "* main(): Checking the sharing of the SHE coupling matrices..." << std::endl;
+  std::shared_ptr<viennashe::she::coupling_matrices const> coupling = reference_simulator.coupling_matrices();
+  if (!coupling || coupling != reference_simulator.coupling_matrices() || coupling->max_expansion_order() != config.max_expansion_order())
+  {
+    std::cerr << "* ERROR: SHE coupling matrices recomputed by the simulator" << std::endl;
+    return EXIT_FAILURE;
+  }
+  biased_simulator.set_coupling_matrices(coupling);
+  if (biased_simulator.coupling_matrices() != coupling)
+  {
+    std::cerr << "* ERROR: Shared SHE coupling matrices not used by the simulator" << std::endl;
+    return EXIT_FAILURE;
+  }
+  biased_simulator.config().max_expansion_order(config.max_expansion_order() + 2);
+  if (biased_simulator.coupling_matrices()->max_expansion_order() != config.max_expansion_order() + 2)
+  {
+    std::cerr << "* ERROR: SHE coupling matrices not recomputed for a different expansion order" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << std::endl;
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+// C interface:
+#include "libviennashe/include/libviennashe.h"
+
+
+/** \file simulator_callback.cpp Contains a test of the iteration callback of the simulator
+ *  \test Checks the states reported to the iteration callback, the cancellation by the callback, and the same through
+ *        viennashe_set_iteration_callback() and viennashe_get_iteration_info() of libviennashe.
+ */
+
+/** @brief Iteration callback, which records the reported iterations and cancels the simulation after a given number of iterations */
+struct cancel_after_iterations
+{
+  cancel_after_iterations(std::size_t n, std::vector<viennashe::nonlinear_iteration_info> & reported) : n_(n), reported_(&reported) {}
+
+  bool operator()(viennashe::nonlinear_iteration_info const & info) const
+  {
+    reported_->push_back(info);
+    return info.iteration >= n_;
+  }
+
+  std::size_t n_;
+  std::vector<viennashe::nonlinear_iteration_info> * reported_;
+};
+
+/** @brief User data of the C iteration callback: The reported iterations and the iteration after which the simulation is cancelled (0 for none) */
+struct c_callback_data
+{
+  c_callback_data() : cancel_after(0) {}
+
+  viennashe_index_type                  cancel_after;
+  std::vector<viennashe_iteration_info> reported;
+};
+
+/** @brief C iteration callback, which records the reported iterations and cancels the simulation as given by the user data */
+extern "C" int record_and_cancel(const viennashe_iteration_info * info, void * user_data)
+{
+  c_callback_data * data = static_cast<c_callback_data *>(user_data);
+  data->reported.push_back(*info);
+  return (data->cancel_after > 0 && info->iteration >= data->cancel_after) ? 1 : 0;
+}
+
+
+int main()
+{
+  typedef viennagrid::line_1d_mesh                              MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  //
+  // Test 1: Iteration callback of the simulator
+  //
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 1e-6, 21);
+  device.generate_mesh(generator_params);
+  init_device(device, 1e-6);
+
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(false);
+  config.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  config.nonlinear_solver().max_iters(20);
+  config.nonlinear_solver().tolerance(1e-30);
+
+  std::cout << "* main(): Computing DD with iteration callback..." << std::endl;
+  std::vector<viennashe::nonlinear_iteration_info> reported;
+
+  viennashe::simulator<DeviceType> cancelled_simulator(device, config);
+  cancelled_simulator.set_iteration_callback(cancel_after_iterations(2, reported));
+  cancelled_simulator.run();
+
+  if (reported.size() != 2 || !cancelled_simulator.cancelled() || cancelled_simulator.last_iteration().iteration != 2
+      || reported[0].iteration != 1 || reported[0].max_iterations != 20 || reported[0].residual_norm <= 0
+      || reported[0].unknowns == 0 || reported[0].electron_even_unknowns != 0
+      || reported[1].elapsed_seconds < reported[0].elapsed_seconds)
+  {
+    std::cerr << "* ERROR: Iteration callback not invoked as expected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Without callback the simulation is not cancelled:
+  cancelled_simulator.set_iteration_callback(viennashe::simulator<DeviceType>::iteration_callback_type());
+  cancelled_simulator.run();
+  if (reported.size() != 2 || cancelled_simulator.cancelled() || cancelled_simulator.last_iteration().iteration == 0)
+  {
+    std::cerr << "* ERROR: Removed iteration callback still in effect" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Test 2: Iteration callback and iteration info of libviennashe
+  //
+  std::cout << "* main(): Computing DD with iteration callback of libviennashe..." << std::endl;
+
+  const long points_x = 21;
+  std::vector<viennashe_material_id> matids(points_x - 1);
+  std::vector<double>                Nd(points_x - 1, 1e24);
+  std::vector<double>                Na(points_x - 1, 1e8);
+  viennashe_index_type               bnd_cells[] = { 0, points_x - 2 };
+  double                             bnd_pot[]   = { 0.0, 0.1 };
+
+  for (long i = 0; i < points_x - 1; ++i)
+    viennashe_get_silicon_id(&matids[i]);
+  viennashe_get_metal_id(&matids[0]);
+  viennashe_get_metal_id(&matids[points_x - 2]);
+
+  viennashe_initalize();
+
+  viennashe_device dev = NULL;
+  viennashe_config conf = NULL;
+  viennashe_create_1d_device(&dev, 1e-6, points_x);
+  viennashe_initalize_device(dev, &matids[0], &Nd[0], &Na[0]);
+  viennashe_set_contact_potential_cells(dev, bnd_cells, bnd_pot, 2);
+
+  viennashe_create_config(&conf);
+  viennashe_config_standard_dd(conf);
+  viennashe_set_nonlinear_solver_config(conf, viennashe_nonlinear_solver_gummel, 10, 0.5);
+
+  viennashe_simulator sim = NULL;
+  viennashe_create_simulator(&sim, dev, conf);
+
+  // All members are zero before the first run:
+  viennashe_iteration_info info;
+  libviennashe_bool cancelled = libviennashe_true;
+  if (viennashe_get_iteration_info(sim, &info, &cancelled) != 0 || info.iteration != 0 || info.num_unknowns != 0 || cancelled)
+  {
+    std::cerr << "* ERROR: Iteration info before the first run not empty" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (viennashe_get_iteration_info(NULL, &info, NULL) != 1 || viennashe_get_iteration_info(sim, NULL, NULL) != 2
+      || viennashe_set_iteration_callback(NULL, record_and_cancel, NULL) != 1)
+  {
+    std::cerr << "* ERROR: Invalid arguments not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // A nonzero return value of the callback cancels the simulation:
+  c_callback_data data;
+  data.cancel_after = 3;
+  viennashe_set_iteration_callback(sim, record_and_cancel, &data);
+  if (viennashe_run(sim) != 0)
+  {
+    std::cerr << "* ERROR: Cancelled simulation reported as failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (data.reported.size() != 3 || data.reported[0].iteration != 1 || data.reported[2].iteration != 3
+      || data.reported[0].max_iterations != 10 || data.reported[0].num_unknowns == 0 || data.reported[0].residual_norm <= 0
+      || data.reported[0].electron_even_unknowns != 0 || data.reported[0].hole_even_unknowns != 0
+      || data.reported[2].elapsed_seconds < data.reported[0].elapsed_seconds)
+  {
+    std::cerr << "* ERROR: C iteration callback not invoked as expected" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The iteration info is the state reported to the callback in the last iteration:
+  if (viennashe_get_iteration_info(sim, &info, &cancelled) != 0 || !cancelled || info.iteration != 3
+      || info.residual_norm != data.reported[2].residual_norm || info.num_unknowns != data.reported[2].num_unknowns
+      || info.converged)
+  {
+    std::cerr << "* ERROR: Iteration info does not match the last reported iteration" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (viennashe_get_iteration_info(sim, &info, NULL) != 0)
+  {
+    std::cerr << "* ERROR: Iteration info without cancellation flag failed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // The callback is removed with NULL, the next run is not cancelled:
+  viennashe_set_iteration_callback(sim, NULL, NULL);
+  if (viennashe_run(sim) != 0 || viennashe_get_iteration_info(sim, &info, &cancelled) != 0
+      || cancelled || info.iteration == 0 || data.reported.size() != 3)
+  {
+    std::cerr << "* ERROR: Removed C iteration callback still in effect" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  viennashe_free_simulator(sim);
+  viennashe_free_config(conf);
+  viennashe_free_device(dev);
+
+  viennashe_finalize();
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
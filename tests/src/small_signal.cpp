@@ -0,0 +1,222 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+
+/** \file small_signal.cpp Contains a test of the small-signal (AC) analysis on a one-dimensional pn-diode
+ *  \test Compares the junction capacitance of a reverse biased pn-diode with the analytic depletion capacitance
+ *        and the low-frequency conductance of a forward biased pn-diode with the derivative of the DC current.
+ */
+
+const double doping_n = 1e23;
+const double doping_p = 1e23;
+
+/** @brief Generates the mesh and initalizes the pn-diode: Contact (0) | n (1) | p (2) | Contact (3) */
+template <typename DeviceType>
+void init_device(DeviceType & device, double voltage_p)
+{
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0,      1e-8,  6);
+  generator_params.add_segment(1e-8,   2.5e-7, 126);
+  generator_params.add_segment(2.6e-7, 2.5e-7, 126);
+  generator_params.add_segment(5.1e-7,   1e-8,  6);
+  device.generate_mesh(generator_params);
+
+  device.set_material(viennashe::materials::metal(), device.segment(0));
+  device.set_material(viennashe::materials::si(),    device.segment(1));
+  device.set_material(viennashe::materials::si(),    device.segment(2));
+  device.set_material(viennashe::materials::metal(), device.segment(3));
+
+  device.set_doping_n(doping_n, device.segment(1));
+  device.set_doping_p(1e9,      device.segment(1));
+  device.set_doping_n(1e9,      device.segment(2));
+  device.set_doping_p(doping_p, device.segment(2));
+
+  device.set_contact_potential(0.0,       device.segment(0));
+  device.set_contact_potential(voltage_p, device.segment(3));
+}
+
+/** @brief Returns a DD configuration with electrons and holes and Newton's method */
+viennashe::config dd_config()
+{
+  viennashe::config dd_cfg;
+  dd_cfg.with_electrons(true);
+  dd_cfg.with_holes(true);
+  dd_cfg.set_electron_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.set_hole_equation(viennashe::EQUATION_CONTINUITY);
+  dd_cfg.nonlinear_solver().set(viennashe::solvers::nonlinear_solver_ids::newton_nonlinear_solver);
+  dd_cfg.nonlinear_solver().max_iters(50);
+  dd_cfg.nonlinear_solver().damping(1.0);
+  return dd_cfg;
+}
+
+/** @brief Returns the small-signal configuration with the two contacts of the diode at the given frequency */
+viennashe::small_signal_config ss_config(double frequency)
+{
+  viennashe::small_signal_config ss_conf;
+  ss_conf.add_contact(0, 1);
+  ss_conf.add_contact(3, 2);
+  ss_conf.add_frequency(frequency);
+  return ss_conf;
+}
+
+/** @brief Returns the potential in the cell of the given segment with the smallest (or largest) coordinate */
+template <typename SimulatorType>
+double potential_at_end(SimulatorType const & sim, long segment_id, bool left_end)
+{
+  typedef typename SimulatorType::device_type                                 DeviceType;
+  typedef typename DeviceType::segment_type                                   SegmentType;
+  typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+
+  CellContainer cells(sim.device().segment(segment_id));
+  CellIterator end_cell = cells.begin();
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    const double x = viennagrid::centroid(*cit)[0];
+    if ( (left_end && x < viennagrid::centroid(*end_cell)[0]) || (!left_end && x > viennagrid::centroid(*end_cell)[0]) )
+      end_cell = cit;
+  }
+  return sim.quantities().get_unknown_quantity(viennashe::quantity::potential()).get_value(*end_cell);
+}
+
+/** @brief Returns the DC current into the p-side contact, extracted in the same way as by the small-signal analysis */
+template <typename SimulatorType>
+double dc_current_p(SimulatorType const & sim, viennashe::small_signal_config const & ss_conf)
+{
+  std::vector<double> currents, charges;
+  viennashe::detail::small_signal_terminal_response(sim.device(), sim.config(), ss_conf, sim.quantities(), currents, charges);
+  return currents[1];
+}
+
+int main()
+{
+  typedef viennagrid::line_1d_mesh       MeshType;
+  typedef viennashe::device<MeshType>    DeviceType;
+
+  std::cout << viennashe::preamble() << std::endl;
+
+  //
+  // Test 1: Junction capacitance at reverse bias vs. depletion approximation
+  //
+  std::cout << "* main(): Computing reverse biased pn-diode..." << std::endl;
+  {
+    DeviceType device;
+    init_device(device, -1.0);
+
+    viennashe::simulator<DeviceType> simulator(device, dd_config());
+    simulator.run();
+
+    const double f = 1e3;
+    viennashe::small_signal_result result = viennashe::small_signal_analysis(simulator, ss_config(f));
+
+    // junction voltage (built-in plus reverse bias) from the potentials in the neutral regions:
+    const double VT = viennashe::physics::get_thermal_potential(300.0);
+    const double junction_voltage = potential_at_end(simulator, 1, true) - potential_at_end(simulator, 2, false);
+    const double eps = viennashe::materials::si::permittivity();
+    const double C_ref = std::sqrt(viennashe::physics::constants::q * eps * doping_n * doping_p
+                                   / (2.0 * (doping_n + doping_p) * (junction_voltage - 2.0 * VT)));
+
+    std::cout << "* main(): Junction voltage: " << junction_voltage << " V" << std::endl;
+    std::cout << "* main(): C_00 = " << result.capacitance(0, 0, 0) << ", C_01 = " << result.capacitance(0, 0, 1)
+              << ", analytic: " << C_ref << " F/m^2" << std::endl;
+
+    if (!viennashe::testing::fuzzy_equal(result.capacitance(0, 0, 0), C_ref, 0.05))
+    {
+      std::cerr << "* ERROR: Junction capacitance does not match the depletion capacitance!" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!viennashe::testing::fuzzy_equal(result.capacitance(0, 0, 1), -result.capacitance(0, 0, 0), 0.01))
+    {
+      std::cerr << "* ERROR: Capacitance matrix is not consistent with charge neutrality!" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (std::fabs(result.conductance(0, 0, 0)) > 1e-3 * 2.0 * viennashe::math::constants::pi * f * C_ref)
+    {
+      std::cerr << "* ERROR: Reverse biased pn-diode shows a conductance of " << result.conductance(0, 0, 0) << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // Test 2: Low-frequency conductance at forward bias vs. derivative of the DC current
+  //
+  std::cout << "* main(): Computing forward biased pn-diode..." << std::endl;
+  {
+    const double V  = 0.4;
+    const double dV = 1e-3;
+
+    DeviceType device;
+    init_device(device, V);
+
+    viennashe::small_signal_config ss_conf = ss_config(1.0);
+
+    viennashe::simulator<DeviceType> simulator(device, dd_config());
+    simulator.run();
+    viennashe::small_signal_result result = viennashe::small_signal_analysis(simulator, ss_conf);
+
+    DeviceType device_plus;
+    init_device(device_plus, V + dV);
+    viennashe::simulator<DeviceType> simulator_plus(device_plus, dd_config());
+    simulator_plus.run();
+
+    DeviceType device_minus;
+    init_device(device_minus, V - dV);
+    viennashe::simulator<DeviceType> simulator_minus(device_minus, dd_config());
+    simulator_minus.run();
+
+    const double G_ref = (dc_current_p(simulator_plus, ss_conf) - dc_current_p(simulator_minus, ss_conf)) / (2.0 * dV);
+
+    std::cout << "* main(): G_11 = " << result.conductance(0, 1, 1) << ", DC: " << G_ref << " S/m^2" << std::endl;
+
+    if (!viennashe::testing::fuzzy_equal(result.conductance(0, 1, 1), G_ref, 0.02))
+    {
+      std::cerr << "* ERROR: Low-frequency conductance does not match the derivative of the DC current!" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!viennashe::testing::fuzzy_equal(result.conductance(0, 0, 1), -result.conductance(0, 1, 1), 0.02))
+    {
+      std::cerr << "* ERROR: Conductance matrix is not consistent with current conservation!" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::cout << "* main(): Tests OK!" << std::endl;
+  std::cout << std::endl;
+  std::cout << "*********************************************************" << std::endl;
+  std::cout << "*           ViennaSHE finished successfully             *" << std::endl;
+  std::cout << "*********************************************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -23,13 +23,14 @@
 #include "viennashe/math/spherical_harmonics.hpp"
 #include "viennashe/math/integrator.hpp"
 
+#include "viennashe/math/linalg_util.hpp"
 #include "viennashe/she/harmonics_coupling.hpp"
 
 #include <math.h>
 
 
 /** \file spherical_harmonics.cpp Contains test for the spherical harmonics implementation
- *  \test Tests the orthogonality of spherical harmonics
+ *  \test Tests the orthogonality of spherical harmonics and the evaluation of all spherical harmonics at once
  */
 
 
@@ -42,6 +43,9 @@
 //up to which order coupling matrices shall be computed (values of 5 and above may take very long...)
 #define COUPLING_DEGREE  3
 
+//up to which order the evaluation of all spherical harmonics at once shall be checked
+#define TABLE_DEGREE  24
+
 class AssocLegendreTester
 {
   public:
@@ -78,6 +82,37 @@ class SphericalHarmonicTester
 };
 
 
+/** @brief Computes the nodes and weights of the Gauss-Legendre rule with n points on [-1, 1] by Newton's method */
+inline void gauss_legendre(std::size_t n, std::vector<double> & nodes, std::vector<double> & weights)
+{
+  const double pi = 3.1415926535897932384626433832795;
+  nodes.resize(n);
+  weights.resize(n);
+  for (std::size_t i=0; i<n; ++i)
+  {
+    double x = cos(pi * (i + 0.75) / (n + 0.5));
+    double dp = 0;
+    for (int iter=0; iter<100; ++iter)
+    {
+      double p0 = 1.0;
+      double p1 = x;
+      for (std::size_t k=2; k<=n; ++k)
+      {
+        const double p2 = ((2.0*k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+        p0 = p1;
+        p1 = p2;
+      }
+      dp = n * (x * p1 - p0) / (x*x - 1.0);
+      const double dx = p1 / dp;
+      x -= dx;
+      if (std::abs(dx) < 1e-15)
+        break;
+    }
+    nodes[i]   = x;
+    weights[i] = 2.0 / ((1.0 - x*x) * dp * dp);
+  }
+}
+
 inline void fuzzy_check(double is, double should, std::string message)
 {
   const double tol = 1e-7;  //tolerance
@@ -202,6 +237,91 @@ int main()
     } //for m
   } // for l
 
+  std::cout << "Test 5: Evaluation of all spherical harmonics at once up to degree " << SH_DEGREE + 7 << std::endl;
+  {
+    viennashe::math::spherical_harmonics_evaluator evaluator(SH_DEGREE + 7);
+    std::vector<double> values;
+    const double angles[4][2] = { {0.0, 0.0}, {0.3, 1.1}, {1.5, 4.0}, {pi, 5.9} };
+    for (std::size_t k=0; k<4; ++k)
+    {
+      evaluator(angles[k][0], angles[k][1], values);
+      for (viennashe::math::spherical_harmonics_iterator it(SH_DEGREE + 7, viennashe::math::ALL_HARMONICS_ITERATION_ID); it.valid(); ++it)
+      {
+        const double expected_result = viennashe::math::SphericalHarmonic(static_cast<int>(it.index1()), static_cast<int>(it.index2()))(angles[k][0], angles[k][1]);
+        if (std::abs(values[std::size_t(*it)] - expected_result) > 1e-12 * std::max(1.0, std::abs(expected_result)))
+        {
+          std::cerr << "Failed at: Evaluating Y(" << it.index1() << "," << it.index2() << ") at (" << angles[k][0] << ", " << angles[k][1] << ")" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+    }
+  }
+
+  std::cout << "Test 6: Orthonormality of tabulated spherical harmonics up to degree " << TABLE_DEGREE << std::endl;
+  {
+    // Gauss-Legendre in cos(theta) and the trapezoidal rule in phi are exact for products of spherical harmonics up to degree TABLE_DEGREE
+    std::vector<double> x, weights;
+    gauss_legendre(TABLE_DEGREE + 1, x, weights);
+    std::vector<double> thetas(x.size());
+    for (std::size_t i=0; i<x.size(); ++i)
+      thetas[i] = acos(x[i]);
+    std::vector<double> phis(2 * TABLE_DEGREE + 1);
+    for (std::size_t j=0; j<phis.size(); ++j)
+      phis[j] = 2.0 * pi * j / phis.size();
+
+    const viennashe::math::spherical_harmonics_table table(TABLE_DEGREE, thetas, phis);
+
+    std::vector<double> gram(table.size() * table.size(), 0.0);
+    for (std::size_t i=0; i<thetas.size(); ++i)
+    {
+      for (std::size_t j=0; j<phis.size(); ++j)
+      {
+        double const * Y = table.values(i, j);
+        const double w = weights[i] * 2.0 * pi / phis.size();
+        for (std::size_t a=0; a<table.size(); ++a)
+          for (std::size_t b=0; b<table.size(); ++b)
+            gram[a * table.size() + b] += w * Y[a] * Y[b];
+      }
+    }
+    for (std::size_t a=0; a<table.size(); ++a)
+    {
+      for (std::size_t b=0; b<table.size(); ++b)
+      {
+        if (std::abs(gram[a * table.size() + b] - ((a == b) ? 1.0 : 0.0)) > 1e-10)
+        {
+          std::cerr << "Failed at: Orthonormality of tabulated spherical harmonics " << a << " and " << b << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+    }
+  }
+
+  std::cout << "Test 7: Coupling matrices by batched quadrature compared to the precomputed ones up to degree 7" << std::endl;
+  for (int L=1; L <= 7; L += 2)
+  {
+    typedef viennashe::math::dense_matrix<double>   MatrixType;
+    const std::size_t size = std::size_t((L+1)*(L+1));
+
+    std::vector<MatrixType> precomputed(6, MatrixType(size, size));
+    std::vector<MatrixType> batched(6, MatrixType(size, size));
+    for (std::size_t k=0; k<6; ++k)
+      for (std::size_t i=0; i<size; ++i)
+        for (std::size_t j=0; j<size; ++j)
+          precomputed[k](i, j) = batched[k](i, j) = 0.0;
+
+    viennashe::she::fill_coupling_matrices(precomputed[0], precomputed[1], precomputed[2], precomputed[3], precomputed[4], precomputed[5], L);
+    viennashe::she::fill_coupling_matrices_batched(batched[0], batched[1], batched[2], batched[3], batched[4], batched[5], L);
+
+    for (std::size_t k=0; k<6; ++k)
+      for (std::size_t i=0; i<size; ++i)
+        for (std::size_t j=0; j<size; ++j)
+          if (std::abs(batched[k](i, j) - precomputed[k](i, j)) > 1e-7) // the precomputed values are accurate to about 1e-8
+          {
+            std::cerr << "Failed at: Coupling matrix " << k << " of degree " << L << " at (" << i << ", " << j << "): "
+                      << batched[k](i, j) << " instead of " << precomputed[k](i, j) << std::endl;
+            exit(EXIT_FAILURE);
+          }
+  }
 
   std::cout << "*******************************" << std::endl;
   std::cout << "* Test finished successfully! *" << std::endl;
@@ -0,0 +1,142 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+
+#include "tests/src/common.hpp"
+
+#include "viennashe/math/integrator.hpp"
+#include "viennashe/math/tensor_quadrature.hpp"
+
+/** \file tensor_quadrature.cpp Contains tests for the batched adaptive tensor-product quadrature
+ *  \test Tests Gauss-Legendre rules, the batched quadrature of several components sharing the same nodes and its adaptivity
+ */
+
+/** @brief Three components: a polynomial, a smooth trigonometric function and a sharply peaked Gaussian */
+struct test_integrand
+{
+  std::size_t num_components() const { return 3; }
+
+  void operator()(std::size_t num_points, double const * x, double const * y, double * values) const
+  {
+    for (std::size_t k=0; k<num_points; ++k)
+    {
+      values[k]                  = x[k]*x[k]*x[k] * y[k]*y[k];
+      values[num_points + k]     = std::sin(x[k]) * std::cos(y[k]);
+      values[2 * num_points + k] = std::exp(-400.0 * ((x[k] - 0.3)*(x[k] - 0.3) + (y[k] - 0.6)*(y[k] - 0.6)));
+    }
+  }
+};
+
+/** @brief A scalar integrand as used with integrate2D() */
+struct scalar_integrand
+{
+  double operator()(double x, double y) const { return std::sin(x) * std::cos(y); }
+};
+
+inline void check(double is, double should, double tol, std::string const & message)
+{
+  if (std::fabs(is - should) > tol)
+  {
+    std::cerr << "Failed at: " << message << ": " << is << " instead of " << should << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main()
+{
+  const double pi = 3.1415926535897932384626433832795;
+
+  std::cout << "Test 1: Gauss-Legendre rules" << std::endl;
+  for (std::size_t n=1; n<=20; ++n)
+  {
+    std::shared_ptr<viennashe::math::gauss_legendre_rule const> rule = viennashe::math::get_gauss_legendre_rule(n);
+    if (viennashe::math::get_gauss_legendre_rule(n) != rule || rule->size() != n)
+    {
+      std::cerr << "Failed at: Gauss-Legendre rule not cached" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // exact for polynomials up to degree 2n-1
+    for (std::size_t degree=0; degree < 2*n; ++degree)
+    {
+      double sum = 0;
+      for (std::size_t i=0; i<n; ++i)
+        sum += rule->weights()[i] * std::pow(rule->nodes()[i], static_cast<double>(degree));
+      check(sum, (degree % 2 == 0) ? 2.0 / (degree + 1.0) : 0.0, 1e-13, "Gauss-Legendre rule");
+    }
+  }
+
+  std::cout << "Test 2: Several components sharing the same nodes" << std::endl;
+  viennashe::math::tensor_quadrature_2d quadrature(5);
+  quadrature.tolerance(1e-12, 1e-12);
+
+  std::vector<double> results;
+  quadrature.integrate(0.0, 1.0, 0.0, 1.0, test_integrand(), results);
+
+  const double peak = pi / 400.0 / 4.0 * (std::erf(20.0 * 0.7) + std::erf(20.0 * 0.3)) * (std::erf(20.0 * 0.4) + std::erf(20.0 * 0.6));
+  check(results[0], 1.0 / 12.0, 1e-14, "polynomial");
+  check(results[1], (1.0 - std::cos(1.0)) * std::sin(1.0), 1e-12, "trigonometric");
+  check(results[2], peak, 1e-12, "peaked");
+
+  for (std::size_t c=0; c<3; ++c)
+    if (quadrature.errors()[c] > std::max(1e-12, 1e-12 * std::fabs(results[c])))
+    {
+      std::cerr << "Failed at: Error estimate above tolerance for component " << c << std::endl;
+      return EXIT_FAILURE;
+    }
+
+  // The cells partition the rectangle and their integrals sum up to the result
+  double area = 0;
+  double sum  = 0;
+  for (std::size_t i=0; i<quadrature.cells().size(); ++i)
+  {
+    viennashe::math::tensor_quadrature_cell const & cell = quadrature.cells()[i];
+    area += (cell.b1 - cell.a1) * (cell.b2 - cell.a2);
+    sum  += cell.values[2];
+  }
+  check(area, 1.0, 1e-14, "area of cells");
+  check(sum, results[2], 1e-15, "sum over cells");
+  std::cout << "  " << quadrature.cells().size() << " cells, " << quadrature.num_evaluations() << " evaluations" << std::endl;
+
+  std::cout << "Test 3: Refinement stops at the maximum number of cells" << std::endl;
+  quadrature.max_cells(16);
+  quadrature.integrate(0.0, 1.0, 0.0, 1.0, test_integrand(), results);
+  if (quadrature.cells().size() > 16)
+  {
+    std::cerr << "Failed at: Maximum number of cells exceeded" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test 4: Scalar integrands compared to integrate2D()" << std::endl;
+  viennashe::math::tensor_quadrature_2d scalar_quadrature;
+  scalar_integrand f;
+  scalar_quadrature.integrate(0.0, pi, 0.0, 0.5 * pi, viennashe::math::make_batched_integrand(f), results);
+  const double reference = viennashe::math::integrate2D(0.0, pi, 0.0, 0.5 * pi, f, viennashe::math::IntAdaptiveRule< viennashe::math::IntGauss<5> >());
+  check(results[0], 2.0, 1e-10, "scalar integrand");
+  check(results[0], reference, 1e-6, "scalar integrand compared to integrate2D()");
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
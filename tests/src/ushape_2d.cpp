@@ -27,45 +27,14 @@
 // ViennaGrid default configurations:
 #include "viennagrid/config/default_configs.hpp"
 
+#include "tests/src/ushape_2d.hpp"
+
 /** \file ushape_2d.cpp Tests charge conservation in a U-shaped configuration.
  *  \test Tests charge conservation on a block of silicon with two contacts. The current is expected to flow in a U-shaped config
  */
 
 
 
-/** @brief Initalizes the device. Is typically modified by the user according to his/her needs.
-*
-* Can also be replaced by a reader that grabs all parameters from an external file
-*
-* @param device The device class that is to be initalized
-*/
-template <typename DeviceType>
-void init_device(DeviceType & device)
-{
-  typedef typename DeviceType::segment_type          SegmentType;
-
-  SegmentType const & contact_left  = device.segment(1);
-  SegmentType const & oxide         = device.segment(2);
-  SegmentType const & contact_right = device.segment(3);
-  SegmentType const & body          = device.segment(4);
-
-  device.set_material(viennashe::materials::si(), body);
-
-  device.set_material(viennashe::materials::hfo2(), oxide);
-
-  device.set_material(viennashe::materials::metal(), contact_left);
-  device.set_material(viennashe::materials::metal(), contact_right);
-
-  device.set_doping_n(1e24, body);
-  device.set_doping_p(1e8,  body);
-
-
-  // Set contact potentials
-  device.set_contact_potential(0.0, contact_left);
-  device.set_contact_potential(0.5, contact_right);
-
-}
-
 int main()
 {
   typedef viennagrid::triangular_2d_mesh               MeshType;
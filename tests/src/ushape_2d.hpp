@@ -0,0 +1,58 @@
+#ifndef VIENNASHE_TESTS_USHAPE_2D_HPP
+#define VIENNASHE_TESTS_USHAPE_2D_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+/** @file tests/src/ushape_2d.hpp
+    @brief Contains the device setup of the U-shaped 2D test, shared by the charge conservation test and the performance test
+ */
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+
+/** @brief Initalizes the device. Is typically modified by the user according to his/her needs.
+*
+* Can also be replaced by a reader that grabs all parameters from an external file
+*
+* @param device The device class that is to be initalized
+*/
+template <typename DeviceType>
+void init_device(DeviceType & device)
+{
+  typedef typename DeviceType::segment_type          SegmentType;
+
+  SegmentType const & contact_left  = device.segment(1);
+  SegmentType const & oxide         = device.segment(2);
+  SegmentType const & contact_right = device.segment(3);
+  SegmentType const & body          = device.segment(4);
+
+  device.set_material(viennashe::materials::si(), body);
+
+  device.set_material(viennashe::materials::hfo2(), oxide);
+
+  device.set_material(viennashe::materials::metal(), contact_left);
+  device.set_material(viennashe::materials::metal(), contact_right);
+
+  device.set_doping_n(1e24, body);
+  device.set_doping_p(1e8,  body);
+
+
+  // Set contact potentials
+  device.set_contact_potential(0.0, contact_left);
+  device.set_contact_potential(0.5, contact_right);
+
+}
+
+#endif /* VIENNASHE_TESTS_USHAPE_2D_HPP */
@@ -0,0 +1,473 @@
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+#if defined(_MSC_VER)
+  // Disable name truncation warning obtained in Visual Studio
+  #pragma warning(disable:4503)
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "viennashe/forwards.h"
+
+#include "tests/src/common.hpp"
+
+// ViennaSHE includes:
+#include "viennashe/core.hpp"
+
+// ViennaGrid default configurations and centroid() algorithm:
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+
+#include "tests/src/resistor.hpp"
+
+
+/** \file vtk_output.cpp Contains a test of the binary VTK output
+ *  \test Writes the distribution function of a resistor as ASCII, appended binary and (if available) zlib-compressed VTK files and checks that all contain the same data.
+ *        Checks the energy slabs and cut planes written for the distribution function of a three-dimensional device.
+ */
+
+typedef std::map<std::string, std::vector<double> >   data_array_map;
+
+/** @brief Returns the value of the XML attribute 'name' in the tag 'tag', or an empty string if not present */
+inline std::string get_attribute(std::string const & tag, std::string const & name)
+{
+  std::string::size_type pos = tag.find(" " + name + "=\"");
+  if (pos == std::string::npos)
+    return "";
+  pos += name.size() + 3;
+  return tag.substr(pos, tag.find("\"", pos) - pos);
+}
+
+/** @brief Decodes a single binary value of the given VTK type */
+inline double decode_value(char const * data, std::string const & type)
+{
+  if (type == "UInt8")   { unsigned char v; std::memcpy(&v, data, sizeof(v)); return v; }
+  if (type == "Int32")   { int v;           std::memcpy(&v, data, sizeof(v)); return v; }
+  if (type == "Float32") { float v;         std::memcpy(&v, data, sizeof(v)); return v; }
+  double v; std::memcpy(&v, data, sizeof(v)); return v;
+}
+
+inline std::size_t type_size(std::string const & type)
+{
+  if (type == "UInt8")   return 1;
+  if (type == "Int32")   return 4;
+  if (type == "Float32") return 4;
+  return 8;
+}
+
+/** @brief Decodes a (possibly compressed) block of appended data, starting at 'data' */
+inline std::string decode_block(char const * data, bool compressed)
+{
+  typedef unsigned long long  header_type;
+  header_type h0;
+  std::memcpy(&h0, data, sizeof(header_type));
+
+  if (!compressed)
+    return std::string(data + sizeof(header_type), static_cast<std::size_t>(h0));
+
+#ifdef VIENNASHE_HAVE_ZLIB
+  header_type block_size, last_size;
+  std::memcpy(&block_size, data +     sizeof(header_type), sizeof(header_type));
+  std::memcpy(&last_size,  data + 2 * sizeof(header_type), sizeof(header_type));
+
+  std::string result;
+  char const * compressed_data = data + (3 + h0) * sizeof(header_type);
+  for (header_type i=0; i<h0; ++i)
+  {
+    header_type csize;
+    std::memcpy(&csize, data + (3 + i) * sizeof(header_type), sizeof(header_type));
+
+    std::vector<Bytef> buffer(static_cast<std::size_t>(block_size));
+    uLongf size = static_cast<uLongf>(block_size);
+    if (uncompress(&(buffer[0]), &size, reinterpret_cast<Bytef const *>(compressed_data), static_cast<uLong>(csize)) != Z_OK)
+      throw std::runtime_error("decode_block(): uncompress failed");
+    if (i+1 == h0 && last_size > 0 && size != last_size)
+      throw std::runtime_error("decode_block(): inconsistent size of last block");
+
+    result.append(reinterpret_cast<char const *>(&(buffer[0])), size);
+    compressed_data += csize;
+  }
+  return result;
+#else
+  throw std::runtime_error("decode_block(): zlib not available");
+#endif
+}
+
+/** @brief Reads all DataArrays of a VTK XML file written by ViennaSHE. Unnamed arrays (point coordinates) are stored as 'Points' */
+inline data_array_map read_vtk_file(std::string const & filename)
+{
+  std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+  if (!file)
+    throw viennashe::io::cannot_open_file_exception(filename);
+
+  std::stringstream ss;
+  ss << file.rdbuf();
+  std::string content = ss.str();
+
+  bool compressed = (content.find("vtkZLibDataCompressor") != std::string::npos);
+
+  std::string::size_type appended_pos = content.find("<AppendedData");
+  if (appended_pos != std::string::npos)
+    appended_pos = content.find("_", appended_pos) + 1;
+
+  data_array_map result;
+  std::string::size_type pos = 0;
+  while ( (pos = content.find("<DataArray ", pos)) < appended_pos )
+  {
+    std::string::size_type tag_end = content.find(">", pos);
+    std::string tag = content.substr(pos, tag_end - pos);
+
+    std::string name = get_attribute(tag, "Name");
+    if (name.empty())
+      name = "Points";
+    std::string type = get_attribute(tag, "type");
+
+    std::vector<double> & values = result[name];
+    if (get_attribute(tag, "format") == "ascii")
+    {
+      std::string::size_type data_end = content.find("</DataArray>", tag_end);
+      std::istringstream data(content.substr(tag_end + 1, data_end - tag_end - 1));
+      double value;
+      while (data >> value)
+        values.push_back(value);
+    }
+    else
+    {
+      std::size_t offset = static_cast<std::size_t>(std::atol(get_attribute(tag, "offset").c_str()));
+      std::string block = decode_block(content.data() + appended_pos + offset, compressed);
+      for (std::size_t i=0; i<block.size(); i += type_size(type))
+        values.push_back(decode_value(block.data() + i, type));
+    }
+
+    pos = tag_end;
+  }
+
+  return result;
+}
+
+/** @brief Compares the data arrays of two VTK files */
+inline int compare_vtk_files(std::string const & file_ref, std::string const & file_other)
+{
+  data_array_map ref   = read_vtk_file(file_ref);
+  data_array_map other = read_vtk_file(file_other);
+
+  if (ref.size() != other.size() || ref.size() == 0)
+  {
+    std::cerr << "* ERROR: Number of data arrays mismatch: " << ref.size() << " vs. " << other.size() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  for (data_array_map::const_iterator it = ref.begin(); it != ref.end(); ++it)
+  {
+    std::vector<double> const & v_ref   = it->second;
+    std::vector<double> const & v_other = other[it->first];
+    if (v_ref.size() != v_other.size())
+    {
+      std::cerr << "* ERROR: Size of data array '" << it->first << "' mismatch: " << v_ref.size() << " vs. " << v_other.size() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    for (std::size_t i=0; i<v_ref.size(); ++i)
+    {
+      if (!viennashe::testing::fuzzy_equal(v_other[i], v_ref[i], 1e-5)) // ASCII output uses six significant digits
+      {
+        std::cerr << "* ERROR: Entry " << i << " of data array '" << it->first << "' in " << file_other << " mismatch" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << "* compare_vtk_files(): " << file_other << " matches " << file_ref << " (" << ref.size() << " data arrays)" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+
+
+/** @brief Creates a structured hexahedral mesh of a cuboid with a single segment. Points are numbered lexicographically, as are the vertices of each hexahedron. */
+template <typename DeviceType>
+void generate_cuboid(DeviceType & device, double len_x, std::size_t nx, std::size_t ny, std::size_t nz)
+{
+  const double h = len_x / static_cast<double>(nx - 1);
+
+  std::vector<double> points;
+  for (std::size_t k=0; k<nz; ++k)
+    for (std::size_t j=0; j<ny; ++j)
+      for (std::size_t i=0; i<nx; ++i)
+      {
+        points.push_back(static_cast<double>(i) * h);
+        points.push_back(static_cast<double>(j) * h);
+        points.push_back(static_cast<double>(k) * h);
+      }
+
+  std::vector<unsigned long> cells;
+  for (std::size_t k=0; k+1<nz; ++k)
+    for (std::size_t j=0; j+1<ny; ++j)
+      for (std::size_t i=0; i+1<nx; ++i)
+        for (std::size_t dk=0; dk<2; ++dk)
+          for (std::size_t dj=0; dj<2; ++dj)
+            for (std::size_t di=0; di<2; ++di)
+              cells.push_back(static_cast<unsigned long>(((k + dk) * ny + (j + dj)) * nx + (i + di)));
+
+  viennashe::util::device_from_flat_array_generator<unsigned long> generator(&(points[0]), &(cells[0]), NULL,
+                                                                             static_cast<unsigned long>(points.size() / 3),
+                                                                             static_cast<unsigned long>(cells.size() / 8));
+  device.generate_mesh(generator);
+}
+
+/** @brief Returns the number of data sets listed in a VTK collection (.pvd) file */
+inline std::size_t count_data_sets(std::string const & filename)
+{
+  std::ifstream file(filename.c_str());
+  if (!file)
+    throw viennashe::io::cannot_open_file_exception(filename);
+
+  std::size_t num = 0;
+  std::string line;
+  while (std::getline(file, line))
+    if (line.find("<DataSet ") != std::string::npos)
+      ++num;
+  return num;
+}
+
+/** @brief Checks the energy slabs and the cut plane written for the distribution function of a three-dimensional device */
+template <typename DeviceType, typename SHEQuantityType>
+int check_slices_3d(DeviceType const & device, viennashe::config const & conf, SHEQuantityType const & quan, double len_x)
+{
+  typedef typename DeviceType::mesh_type                                          MeshType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type        CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type           CellIterator;
+
+  const std::size_t num_cells    = viennagrid::cells(device.mesh()).size();
+  const std::size_t num_vertices = viennagrid::vertices(device.mesh()).size();
+  const std::size_t num_energies = quan.get_value_H_size();
+  const std::string df_name      = quan.get_name() + " (DF)";
+
+  //
+  // Energy slabs for every second energy, cut plane through the second layer of cells:
+  //
+  viennashe::io::she_vtk_writer<DeviceType> writer;
+  writer.energy_stride(2);
+  writer.add_cut_plane(0, 0.15 * len_x);
+  writer(device, conf, quan, "vtk_output_edf_3d");
+
+  if (count_data_sets("vtk_output_edf_3d_main.pvd") != (num_energies + 1) / 2)
+  {
+    std::cerr << "* ERROR: Collection file of the energy slabs lists " << count_data_sets("vtk_output_edf_3d_main.pvd")
+              << " data sets, expected " << (num_energies + 1) / 2 << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::size_t nodes_with_unknowns = 0;
+  for (std::size_t index_H = 0; index_H < num_energies; index_H += 2)
+  {
+    std::stringstream ss;
+    ss << "vtk_output_edf_3d_H" << index_H << ".vtu";
+    data_array_map slab = read_vtk_file(ss.str());
+
+    if (slab[df_name].size() != num_cells || slab["Points"].size() != 3 * num_vertices || slab["connectivity"].size() != 8 * num_cells
+        || slab["types"].size() != num_cells || slab["types"][0] != 12)   // VTK_hexahedron
+    {
+      std::cerr << "* ERROR: Energy slab " << ss.str() << " has wrong size" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    CellContainer cells(device.mesh());
+    for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+    {
+      const bool has_unknowns = (quan.get_unknown_index(*cit, index_H) > -1);
+      const double df = has_unknowns ? quan.get_values(*cit, index_H)[0] : 0;
+      if (slab[df_name][static_cast<std::size_t>(cit->id().get())] != df)
+      {
+        std::cerr << "* ERROR: Energy slab " << ss.str() << " mismatch at cell " << cit->id().get() << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (has_unknowns)
+        ++nodes_with_unknowns;
+    }
+  }
+  if (nodes_with_unknowns == 0)
+  {
+    std::cerr << "* ERROR: Energy slabs do not contain the distribution function" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // All cells with centroid at x = 0.15 * len_x, i.e. in the second layer, are intersected by the cut plane:
+  std::size_t num_points = 0;
+  CellContainer cells(device.mesh());
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    if (std::fabs(viennagrid::centroid(*cit)[0] - 0.15 * len_x) > 0.01 * len_x)
+      continue;
+    for (std::size_t index_H = 0; index_H < num_energies; ++index_H)
+      if (quan.get_unknown_index(*cit, index_H) > -1)
+        ++num_points;
+  }
+
+  data_array_map cut = read_vtk_file("vtk_output_edf_3d_cut0.vtu");
+  if (num_points == 0 || cut[df_name].size() != num_points || cut["Points"].size() != 3 * num_points || cut["types"].size() != num_points)
+  {
+    std::cerr << "* ERROR: Cut plane has " << cut[df_name].size() << " points, expected " << num_points << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  //
+  // Selected energies only, as ASCII:
+  //
+  viennashe::io::she_vtk_writer<DeviceType> writer_selected;
+  writer_selected.format(viennashe::io::VTK_FORMAT_ASCII);
+  writer_selected.add_energy_index(2);
+  writer_selected(device, conf, quan, "vtk_output_edf_3d_ascii");
+
+  if (count_data_sets("vtk_output_edf_3d_ascii_main.pvd") != 1)
+  {
+    std::cerr << "* ERROR: Collection file of the selected energy lists more than one data set" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (compare_vtk_files("vtk_output_edf_3d_H2.vtu", "vtk_output_edf_3d_ascii_H2.vtu") != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  viennashe::io::she_vtk_writer<DeviceType> writer_invalid;
+  writer_invalid.add_energy_index(num_energies);
+  try
+  {
+    writer_invalid(device, conf, quan, "vtk_output_edf_3d_invalid");
+    std::cerr << "* ERROR: Energy index out of range not rejected" << std::endl;
+    return EXIT_FAILURE;
+  }
+  catch (viennashe::invalid_value_exception const &) {}
+
+  return EXIT_SUCCESS;
+}
+
+
+int main()
+{
+  typedef viennagrid::quadrilateral_2d_mesh                     MeshType;
+  typedef viennashe::device<MeshType>                           DeviceType;
+
+  std::cout << "* main(): Creating device..." << std::endl;
+  DeviceType device;
+
+  viennashe::util::device_generation_config generator_params;
+  generator_params.add_segment(0.0, 6.0e-7, 10,   //start at x=, length, points
+                               0.0, 6.0e-7,  2);  //start at y=, length, points
+  device.generate_mesh(generator_params);
+  init_device(device, generator_params.at(0).get_length_x(), 0.0, 0.0, 1e16, 1e16);
+
+  std::cout << "* main(): Computing SHE..." << std::endl;
+  viennashe::config config;
+  config.with_electrons(true);
+  config.with_holes(true);
+  config.set_electron_equation(viennashe::EQUATION_SHE);
+  config.set_hole_equation(viennashe::EQUATION_SHE);
+  config.scattering().ionized_impurity().enabled(false);
+  config.energy_spacing(6.2 * viennashe::physics::constants::q / 1000.0);
+  config.nonlinear_solver().max_iters(1);
+
+  viennashe::simulator<DeviceType> she_simulator(device, config);
+  she_simulator.run();
+
+  //
+  // Distribution function in (x, H)-space:
+  //
+  std::cout << "* main(): Writing SHE result..." << std::endl;
+  viennashe::io::she_vtk_writer<DeviceType> edf_writer;
+
+  edf_writer.format(viennashe::io::VTK_FORMAT_ASCII);
+  edf_writer(device, she_simulator.config(), she_simulator.quantities().electron_distribution_function(), "vtk_output_edf_ascii");
+
+  edf_writer.format(viennashe::io::VTK_FORMAT_BINARY);
+  edf_writer(device, she_simulator.config(), she_simulator.quantities().electron_distribution_function(), "vtk_output_edf_binary");
+
+  if (compare_vtk_files("vtk_output_edf_ascii.vtu", "vtk_output_edf_binary.vtu") != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+
+#ifdef VIENNASHE_HAVE_ZLIB
+  edf_writer.format(viennashe::io::VTK_FORMAT_BINARY_ZLIB);
+  edf_writer(device, she_simulator.config(), she_simulator.quantities().electron_distribution_function(), "vtk_output_edf_zlib");
+
+  if (compare_vtk_files("vtk_output_edf_ascii.vtu", "vtk_output_edf_zlib.vtu") != EXIT_SUCCESS)
+    return EXIT_FAILURE;
+#endif
+
+  //
+  // Macroscopic quantity in x-space:
+  //
+  viennashe::io::write_quantity_to_VTK_file(she_simulator.potential(), device, "vtk_output_potential_binary", "potential", viennashe::io::VTK_FORMAT_BINARY);
+
+  data_array_map potential = read_vtk_file("vtk_output_potential_binary.vtu");
+  if (potential["potential"].size() != viennagrid::cells(device.mesh()).size()
+      || potential["Points"].size() != 3 * viennagrid::vertices(device.mesh()).size()
+      || potential["connectivity"].size() != 4 * viennagrid::cells(device.mesh()).size())
+  {
+    std::cerr << "* ERROR: Binary output of potential has wrong size" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  typedef viennagrid::result_of::const_cell_range<MeshType>::type   CellContainer;
+  typedef viennagrid::result_of::iterator<CellContainer>::type      CellIterator;
+
+  CellContainer cells(device.mesh());
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    if (potential["potential"][static_cast<std::size_t>(cit->id().get())] != she_simulator.potential()(*cit))
+    {
+      std::cerr << "* ERROR: Binary output of potential mismatch at cell " << cit->id().get() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  //
+  // Distribution function of a three-dimensional device, written as energy slabs and cut planes:
+  //
+  std::cout << "* main(): Computing SHE on a three-dimensional device..." << std::endl;
+  {
+    typedef viennashe::device<viennagrid::hexahedral_3d_mesh>     DeviceType3d;
+
+    const double len_x = 6.0e-7;
+    DeviceType3d device_3d;
+    generate_cuboid(device_3d, len_x, 11, 3, 3);
+    init_device(device_3d, len_x, 0.0, 0.0, 1e16, 1e16);
+
+    viennashe::config config_3d;
+    config_3d.with_electrons(true);
+    config_3d.with_holes(false);
+    config_3d.set_electron_equation(viennashe::EQUATION_SHE);
+    config_3d.scattering().ionized_impurity().enabled(false);
+    config_3d.energy_spacing(31.0 * viennashe::physics::constants::q / 1000.0);
+    config_3d.nonlinear_solver().max_iters(1);
+
+    viennashe::simulator<DeviceType3d> simulator_3d(device_3d, config_3d);
+    simulator_3d.run();
+
+    std::cout << "* main(): Writing SHE result of the three-dimensional device..." << std::endl;
+    if (check_slices_3d(device_3d, simulator_3d.config(), simulator_3d.quantities().electron_distribution_function(), len_x) != EXIT_SUCCESS)
+      return EXIT_FAILURE;
+  }
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
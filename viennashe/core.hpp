@@ -23,6 +23,7 @@
 #include "viennashe/config.hpp"
 #include "viennashe/device.hpp"
 #include "viennashe/simulator.hpp"
+#include "viennashe/small_signal.hpp"
 #include "viennashe/physics/constants.hpp"
 #include "viennashe/util/generate_device.hpp"
 #include "viennashe/util/misc.hpp"
@@ -208,6 +208,9 @@ namespace viennashe
     /** @brief Internal tag used for the specification of a CPU-based multi-threaded linear solver */
     class parallel_linear_solver_tag {};
 
+    /** @brief Internal tag used for the specification of a CPU-based multi-threaded linear solver with overlapping Schwarz preconditioner */
+    class schwarz_linear_solver_tag {};
+
     /** @brief Internal tag used for the specification of a CPU-based PETSC solver */
     class petsc_linear_solver_tag {};
 
@@ -20,11 +20,17 @@
 */
 
 #include "viennashe/io/add_to_writer.hpp"
+#include "viennashe/io/async_writer.hpp"
+#include "viennashe/io/column_writer.hpp"
+#include "viennashe/io/device_cache.hpp"
 #include "viennashe/io/device_reader_vtk.hpp"
 #include "viennashe/io/gnuplot_writer.hpp"
 #include "viennashe/io/gnuplot_writer_edf.hpp"
 #include "viennashe/io/initial_guess_writer.hpp"
+#include "viennashe/io/mapped_file.hpp"
+#include "viennashe/io/result_file.hpp"
 #include "viennashe/io/she_vtk_writer.hpp"
 #include "viennashe/io/vector.hpp"
+#include "viennashe/io/vtk_data_array.hpp"
 
 #endif
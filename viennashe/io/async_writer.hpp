@@ -0,0 +1,295 @@
+#ifndef VIENNASHE_IO_ASYNC_WRITER_HPP
+#define VIENNASHE_IO_ASYNC_WRITER_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <deque>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <type_traits>
+
+// viennagrid
+#include "viennagrid/mesh/mesh.hpp"
+
+// viennashe
+#include "viennashe/config.hpp"
+#include "viennashe/log/log.hpp"
+#include "viennashe/io/gnuplot_writer.hpp"
+#include "viennashe/io/gnuplot_writer_edf.hpp"
+#include "viennashe/io/she_vtk_writer.hpp"
+#include "viennashe/she/df_wrappers.hpp"
+#include "viennashe/util/filter.hpp"
+
+/** @file viennashe/io/async_writer.hpp
+    @brief Provides a background writer service, which formats and writes snapshots of simulation results while the simulation continues.
+*/
+
+namespace viennashe
+{
+  namespace io
+  {
+
+    /** @brief A writer service with a single background thread and a bounded job queue.
+     *
+     * Jobs are functors without arguments. They must only refer to data which is not modified until the job has finished,
+     * hence the convenience routines below take snapshots (copies) of the quantities to be written.
+     * submit() blocks if the queue is full, so that at most 'max_pending_jobs' snapshots are held in memory.
+     * Exceptions thrown by a job are rethrown by the next call to submit() or flush().
+     */
+    class async_writer
+    {
+      public:
+        typedef std::function<void()>   job_type;
+
+        explicit async_writer(std::size_t max_pending_jobs = 2)
+          : max_pending_jobs_(max_pending_jobs > 0 ? max_pending_jobs : 1), busy_(false), shutdown_(false)
+        {
+          thread_ = std::thread(&async_writer::worker_loop, this);
+        }
+
+        /** @brief Waits for all pending jobs and stops the background thread. Errors of pending jobs are logged, but not thrown. */
+        ~async_writer()
+        {
+          try
+          {
+            flush();
+          }
+          catch (std::exception const & e)
+          {
+            log::error() << "* async_writer::~async_writer(): Pending output failed: " << e.what() << std::endl;
+          }
+
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            shutdown_ = true;
+          }
+          job_available_.notify_one();
+          thread_.join();
+        }
+
+        /** @brief Adds a job to the queue. Blocks if the queue is full. */
+        void submit(job_type job)
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          rethrow_error();
+          slot_available_.wait(lock, [this]{ return jobs_.size() < max_pending_jobs_; });
+          jobs_.push_back(std::move(job));
+          lock.unlock();
+          job_available_.notify_one();
+        }
+
+        /** @brief Waits until all jobs submitted so far have been completed. Rethrows the first error of a failed job. */
+        void flush()
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          idle_.wait(lock, [this]{ return jobs_.empty() && !busy_; });
+          rethrow_error();
+        }
+
+        /** @brief Returns the number of jobs which are either queued or in progress */
+        std::size_t pending_jobs() const
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          return jobs_.size() + (busy_ ? 1 : 0);
+        }
+
+        std::size_t max_pending_jobs() const { return max_pending_jobs_; }
+
+      private:
+        async_writer(async_writer const &);
+        async_writer & operator=(async_writer const &);
+
+        /** @brief Rethrows (and clears) a stored error. Must be called with the mutex held. */
+        void rethrow_error()
+        {
+          if (error_)
+          {
+            std::exception_ptr e = error_;
+            error_ = std::exception_ptr();
+            std::rethrow_exception(e);
+          }
+        }
+
+        void worker_loop()
+        {
+          while (true)
+          {
+            job_type job;
+            {
+              std::unique_lock<std::mutex> lock(mutex_);
+              job_available_.wait(lock, [this]{ return shutdown_ || !jobs_.empty(); });
+              if (jobs_.empty()) // shutdown requested and nothing left to do
+                return;
+
+              job = std::move(jobs_.front());
+              jobs_.pop_front();
+              busy_ = true;
+            }
+            slot_available_.notify_one();
+
+            try
+            {
+              job();
+            }
+            catch (...)
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              if (!error_)
+                error_ = std::current_exception();
+            }
+
+            {
+              std::lock_guard<std::mutex> lock(mutex_);
+              busy_ = false;
+            }
+            idle_.notify_all();
+          }
+        }
+
+        std::size_t               max_pending_jobs_;
+        std::deque<job_type>      jobs_;
+        bool                      busy_;
+        bool                      shutdown_;
+        std::exception_ptr        error_;
+
+        mutable std::mutex        mutex_;
+        std::condition_variable   job_available_;
+        std::condition_variable   slot_available_;
+        std::condition_variable   idle_;
+        std::thread               thread_;
+    };
+
+
+    namespace detail
+    {
+      /** @brief Accessor for a snapshot of a cell quantity, stored by cell ID */
+      template <typename ValueT>
+      class cell_quantity_snapshot
+      {
+        public:
+          typedef ValueT   value_type;
+
+          cell_quantity_snapshot(std::shared_ptr<const std::vector<ValueT> > values) : values_(values) {}
+
+          template <typename CellT>
+          value_type const & operator()(CellT const & cell) const { return values_->at(static_cast<std::size_t>(cell.id().get())); }
+
+        private:
+          std::shared_ptr<const std::vector<ValueT> > values_;
+      };
+    }
+
+
+    /** @brief Writes the SHE quantity (typically the distribution function) in (x, H)-space in the background. See she_vtk_writer.
+     *
+     * @param service     The writer service
+     * @param writer      The VTK writer including its options (format, segments, debug quantities). Copied.
+     * @param device      The device. Must not be modified until the job has finished (e.g. by calling service.flush()).
+     * @param conf        The simulator configuration. Copied.
+     * @param quan        The SHE quantity. Copied.
+     * @param filename    Name of the file to be written to
+     */
+    template <typename DeviceType, typename SHEQuantityT>
+    void write_she_vtk_async(async_writer & service,
+                             she_vtk_writer<DeviceType> const & writer,
+                             DeviceType const & device,
+                             viennashe::config const & conf,
+                             SHEQuantityT const & quan,
+                             std::string const & filename)
+    {
+      std::shared_ptr<she_vtk_writer<DeviceType> > writer_copy(new she_vtk_writer<DeviceType>(writer));
+      std::shared_ptr<const viennashe::config>     conf_copy(new viennashe::config(conf));
+      std::shared_ptr<const SHEQuantityT>          quan_copy(new SHEQuantityT(quan));
+      DeviceType const * device_ptr = &device;
+
+      service.submit([writer_copy, conf_copy, quan_copy, device_ptr, filename]()
+                     {
+                       (*writer_copy)(*device_ptr, *conf_copy, *quan_copy, filename);
+                     });
+    }
+
+    /** @brief Writes a quantity on all cells for gnuplot in the background. The quantity is evaluated on all cells before this function returns. See gnuplot_writer.
+     *
+     * @param service     The writer service
+     * @param quan        An accessor for a cell quantity (returning either double or std::vector<double>)
+     * @param device      The device. Must not be modified until the job has finished (e.g. by calling service.flush()).
+     * @param filename    Name of the file to be written to
+     */
+    template <typename DeviceType, typename AccessorType>
+    void write_cell_quantity_for_gnuplot_async(async_writer & service,
+                                               AccessorType const & quan,
+                                               DeviceType const & device,
+                                               std::string const & filename)
+    {
+      typedef typename DeviceType::mesh_type                                        MeshType;
+      typedef typename viennagrid::result_of::cell<MeshType>::type                  CellType;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+      typedef typename std::decay<decltype(quan(std::declval<CellType const &>()))>::type   ValueType;
+
+      CellContainer cells(device.mesh());
+      std::shared_ptr<std::vector<ValueType> > values(new std::vector<ValueType>(cells.size()));
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        (*values)[static_cast<std::size_t>(cit->id().get())] = quan(*cit);
+
+      detail::cell_quantity_snapshot<ValueType> snapshot(values);
+      DeviceType const * device_ptr = &device;
+
+      service.submit([snapshot, device_ptr, filename]()
+                     {
+                       gnuplot_writer()(*device_ptr, viennashe::util::any_filter(), snapshot, filename);
+                     });
+    }
+
+    /** @brief Writes the energy distribution function at the cells accepted by the filter for gnuplot in the background. See gnuplot_edf_writer.
+     *
+     * @param service     The writer service
+     * @param device      The device. Must not be modified until the job has finished (e.g. by calling service.flush()).
+     * @param cell_filter A cell filter, which returns true for all cells to be written. Copied.
+     * @param conf        The simulator configuration. Copied.
+     * @param quan        The SHE quantity. Copied.
+     * @param filename    Name of the file to be written to
+     */
+    template <typename DeviceType, typename CellFilterType, typename SHEQuantityT>
+    void write_edf_for_gnuplot_async(async_writer & service,
+                                     DeviceType const & device,
+                                     CellFilterType const & cell_filter,
+                                     viennashe::config const & conf,
+                                     SHEQuantityT const & quan,
+                                     std::string const & filename)
+    {
+      std::shared_ptr<const viennashe::config>     conf_copy(new viennashe::config(conf));
+      std::shared_ptr<const SHEQuantityT>          quan_copy(new SHEQuantityT(quan));
+      DeviceType const * device_ptr = &device;
+
+      service.submit([conf_copy, quan_copy, device_ptr, cell_filter, filename]()
+                     {
+                       viennashe::she::edf_wrapper<DeviceType, SHEQuantityT> edf(*conf_copy, *quan_copy);
+                       gnuplot_edf_writer()(*device_ptr, cell_filter, edf, filename);
+                     });
+    }
+
+  } //namespace io
+} //namespace viennashe
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef VIENNASHE_IO_COLUMN_WRITER_HPP
+#define VIENNASHE_IO_COLUMN_WRITER_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/log/log.hpp"
+#include "viennashe/io/exception.hpp"
+
+/** @file viennashe/io/column_writer.hpp
+    @brief A buffered writer for column-oriented data files (as read by Gnuplot), either as text or as raw binary records.
+*/
+
+namespace viennashe
+{
+  namespace io
+  {
+
+    /** @brief Output formats of the column writer */
+    enum gnuplot_format_id
+    {
+      GNUPLOT_FORMAT_ASCII,     ///< Text with one row per line, blocks separated by two empty lines
+      GNUPLOT_FORMAT_BINARY     ///< Raw records of 64-bit floating point numbers, to be read with 'binary format="%Ndouble"'
+    };
+
+    namespace detail
+    {
+      /** @brief Converts a double to text in the format of printf("%.*g"), which is also the format of std::ostream with the same precision.
+       *
+       * The decimal separator is always '.', regardless of the locale of the C library.
+       *
+       * @param value      The value
+       * @param precision  Number of significant digits, 1 to 15
+       * @param buffer     Output buffer with at least 32 characters. Not null-terminated.
+       * @return           Number of characters written
+       */
+      inline std::size_t format_double(double value, int precision, char * buffer)
+      {
+        char text[32];
+        int length = std::snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (length <= 0)
+          return 0;
+        std::size_t num_chars = std::min<std::size_t>(static_cast<std::size_t>(length), sizeof(text) - 1);
+
+        const char decimal_point = std::localeconv()->decimal_point[0];
+        for (std::size_t i=0; i<num_chars; ++i)
+          buffer[i] = (text[i] == decimal_point) ? '.' : text[i];
+        return num_chars;
+      }
+    }
+
+
+    /** @brief Writes rows of floating point values to a file through a large buffer.
+     *
+     * In ASCII mode, values in a row are separated by a blank, rows by a newline and blocks by two empty lines (Gnuplot 'index').
+     * In binary mode each row is a record of 64-bit floating point numbers and comments as well as block separators are dropped.
+     * All rows must then have the same number of columns, see gnuplot_binary_format().
+     */
+    class column_writer
+    {
+      public:
+        column_writer(std::string const & filename, gnuplot_format_id format = GNUPLOT_FORMAT_ASCII, std::size_t buffer_size = 1 << 20)
+          : filename_(filename),
+            stream_(filename.c_str(), std::ios::out | std::ios::binary),
+            format_(format), precision_(6),
+            columns_(0), current_columns_(0), rows_(0), closed_(false)
+        {
+          if (!stream_)
+            throw cannot_open_file_exception(filename);
+          buffer_.reserve(buffer_size > 64 ? buffer_size : 64);
+        }
+
+        ~column_writer()
+        {
+          try
+          {
+            close();
+          }
+          catch (std::exception const & e)
+          {
+            log::error() << "* column_writer::~column_writer(): " << e.what() << std::endl;
+          }
+        }
+
+        gnuplot_format_id format() const { return format_; }
+
+        /** @brief Number of significant digits in ASCII mode (default: 6, as std::ostream) */
+        int  precision() const { return precision_; }
+        void precision(int p) { precision_ = (p < 1) ? 1 : ((p > 15) ? 15 : p); }
+
+        /** @brief Number of columns per row (determined by the first row) */
+        std::size_t columns() const { return columns_; }
+        std::size_t rows() const { return rows_; }
+
+        /** @brief Appends a value to the current row */
+        column_writer & operator<<(double value)
+        {
+          reserve(32);
+          if (format_ == GNUPLOT_FORMAT_BINARY)
+          {
+            char const * bytes = reinterpret_cast<char const *>(&value);
+            buffer_.insert(buffer_.end(), bytes, bytes + sizeof(double));
+          }
+          else
+          {
+            char text[32];
+            if (current_columns_ > 0)
+              buffer_.push_back(' ');
+            buffer_.insert(buffer_.end(), text, text + detail::format_double(value, precision_, text));
+          }
+          ++current_columns_;
+          return *this;
+        }
+
+        /** @brief Terminates the current row */
+        void end_row()
+        {
+          if (rows_ == 0)
+            columns_ = current_columns_;
+          else if (format_ == GNUPLOT_FORMAT_BINARY && current_columns_ != columns_)
+            throw io_operation_unsupported_exception("column_writer: Inconsistent number of columns in binary file '" + filename_ + "'");
+
+          if (format_ == GNUPLOT_FORMAT_ASCII)
+          {
+            reserve(1);
+            buffer_.push_back('\n');
+          }
+          current_columns_ = 0;
+          ++rows_;
+        }
+
+        /** @brief Terminates the current block by empty lines: One empty line separates scans (e.g. for splot), two separate data sets (Gnuplot 'index'). Ignored in binary mode. */
+        void end_block(std::size_t empty_lines = 2)
+        {
+          if (format_ == GNUPLOT_FORMAT_ASCII)
+            write_text(std::string(empty_lines, '\n'));
+        }
+
+        /** @brief Writes a comment line. Ignored in binary mode. */
+        void comment(std::string const & text)
+        {
+          if (format_ == GNUPLOT_FORMAT_ASCII)
+            write_text("#" + text + "\n");
+        }
+
+        /** @brief Returns the Gnuplot binary format specifier for the records written so far, e.g. '%5double' */
+        std::string gnuplot_binary_format() const
+        {
+          std::stringstream ss;
+          ss << "%" << columns_ << "double";
+          return ss.str();
+        }
+
+        /** @brief Flushes the buffer and closes the file. Called by the destructor if not called explicitly. */
+        void close()
+        {
+          if (closed_)
+            return;
+          closed_ = true;
+
+          flush_buffer();
+          stream_.close();
+          if (stream_.fail())
+            throw io_operation_unsupported_exception("column_writer::close(): Writing to '" + filename_ + "' failed");
+        }
+
+      private:
+        column_writer(column_writer const &);
+        column_writer & operator=(column_writer const &);
+
+        void write_text(std::string const & text)
+        {
+          reserve(text.size());
+          buffer_.insert(buffer_.end(), text.begin(), text.end());
+        }
+
+        /** @brief Makes sure that 'num_bytes' can be appended without reallocation, flushing the buffer if necessary */
+        void reserve(std::size_t num_bytes)
+        {
+          if (buffer_.size() + num_bytes > buffer_.capacity())
+            flush_buffer();
+        }
+
+        void flush_buffer()
+        {
+          if (buffer_.size() > 0)
+            stream_.write(&(buffer_[0]), static_cast<std::streamsize>(buffer_.size()));
+          buffer_.clear();
+        }
+
+        std::string         filename_;
+        std::ofstream       stream_;
+        std::vector<char>   buffer_;
+        gnuplot_format_id   format_;
+        int                 precision_;
+        std::size_t         columns_;
+        std::size_t         current_columns_;
+        std::size_t         rows_;
+        bool                closed_;
+    };
+
+  } //namespace io
+} //namespace viennashe
+
+#endif
@@ -0,0 +1,552 @@
+#ifndef VIENNASHE_IO_DEVICE_CACHE_HPP
+#define VIENNASHE_IO_DEVICE_CACHE_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+
+// viennagrid
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/mesh/element_creation.hpp"
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/log/log.hpp"
+#include "viennashe/io/exception.hpp"
+#include "viennashe/io/log_keys.h"
+#include "viennashe/io/result_file.hpp"
+#include "viennashe/io/device_reader_vtk.hpp"
+#include "viennashe/util/hash.hpp"
+
+/** @file viennashe/io/device_cache.hpp
+    @brief A binary cache for devices (mesh, segmentation, materials, doping, contacts) in order to avoid parsing mesh files on every run.
+
+    The cache is a native result file (see result_file.hpp), which is memory-mapped when read.
+    It records modification time, size and a hash of the source file and is only used if all of them match.
+*/
+
+namespace viennashe
+{
+  namespace io
+  {
+
+    /** @brief Identifies the content of a source file: modification time, size and a 64-bit FNV-1a hash of the content */
+    struct file_fingerprint
+    {
+      file_fingerprint() : mtime(0), size(0), hash(0) {}
+
+      long long mtime;
+      long long size;
+      long long hash;
+    };
+
+    namespace detail
+    {
+      inline bool file_exists(std::string const & filename)
+      {
+        struct stat file_stat;
+        return ::stat(filename.c_str(), &file_stat) == 0;
+      }
+    }
+
+    /** @brief Computes the fingerprint of a file. The content is read in blocks, but not parsed. */
+    inline file_fingerprint compute_file_fingerprint(std::string const & filename)
+    {
+      struct stat file_stat;
+      if (::stat(filename.c_str(), &file_stat) != 0)
+        throw cannot_open_file_exception(filename);
+
+      std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+      if (!stream)
+        throw cannot_open_file_exception(filename);
+
+      file_fingerprint result;
+      result.mtime = static_cast<long long>(file_stat.st_mtime);
+      result.size  = static_cast<long long>(file_stat.st_size);
+
+      unsigned long long hash = 14695981039346656037ULL;
+      std::vector<char> buffer(1 << 16);
+      while (stream)
+      {
+        stream.read(&(buffer[0]), static_cast<std::streamsize>(buffer.size()));
+        hash = viennashe::util::fnv1a_hash(&(buffer[0]), static_cast<std::size_t>(stream.gcount()), hash);
+      }
+      result.hash = static_cast<long long>(hash);
+
+      return result;
+    }
+
+
+    /** @brief Writes the device to a cache file.
+     *
+     * The following arrays are written (cells and vertices ordered by ID):
+     *   - cache/source: modification time, size and hash of the source file, and a hash of 'loader_tag'
+     *   - mesh/vertices, mesh/cells
+     *   - segmentation/ids, segmentation/offsets, segmentation/cells: The cells of each segment in compressed row format
+     *   - device/material, device/doping_n, device/doping_p, device/contact_mask, device/contact_potential, device/temperature, device/fixed_charge
+     *
+     * Trap levels are not cached. The file is written to a temporary file first and renamed afterwards, so that an interrupted write never leaves a valid-looking cache behind.
+     *
+     * @param device           The device
+     * @param cache_filename   Name of the cache file
+     * @param source_filename  Name of the mesh file the device was loaded from. May be empty, in which case the cache is never considered outdated.
+     * @param loader_tag       An arbitrary string describing how the source file was interpreted (e.g. the VTK keys used for doping). The cache is only used if the tag matches.
+     */
+    template <typename DeviceType>
+    void write_device_cache(DeviceType const & device,
+                            std::string const & cache_filename,
+                            std::string const & source_filename = "",
+                            std::string const & loader_tag = "")
+    {
+      typedef typename DeviceType::mesh_type                                        MeshType;
+      typedef typename DeviceType::segment_type                                     SegmentType;
+      typedef typename viennagrid::result_of::segmentation<MeshType>::type          SegmentationType;
+      typedef typename viennagrid::result_of::cell<MeshType>::type                  CellType;
+      typedef typename viennagrid::result_of::point<MeshType>::type                 PointType;
+
+      typedef typename viennagrid::result_of::const_vertex_range<MeshType>::type    VertexContainer;
+      typedef typename viennagrid::result_of::iterator<VertexContainer>::type       VertexIterator;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+      typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type   CellOnSegmentContainer;
+      typedef typename viennagrid::result_of::iterator<CellOnSegmentContainer>::type  CellOnSegmentIterator;
+
+      log::info<log_device_cache>() << "* write_device_cache(): Writing device cache '" << cache_filename << "'" << std::endl;
+
+      std::string tmp_filename = cache_filename + ".tmp";
+      {
+        result_file_writer writer(tmp_filename);
+
+        //
+        // Source validation data
+        //
+        file_fingerprint fingerprint;
+        if (!source_filename.empty())
+          fingerprint = compute_file_fingerprint(source_filename);
+
+        std::vector<long long> source(4);
+        source[0] = fingerprint.mtime;
+        source[1] = fingerprint.size;
+        source[2] = fingerprint.hash;
+        source[3] = static_cast<long long>(viennashe::util::fnv1a_hash(loader_tag));
+        writer.add_array("cache/source", source);
+
+        //
+        // Mesh
+        //
+        VertexContainer vertices(device.mesh());
+        CellContainer   cells(device.mesh());
+
+        const std::size_t dim = static_cast<std::size_t>(PointType::dim);
+        std::vector<double> coordinates(vertices.size() * dim);
+        for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit)
+          for (std::size_t i=0; i<dim; ++i)
+            coordinates[static_cast<std::size_t>(vit->id().get()) * dim + i] = viennagrid::point(*vit)[i];
+        writer.add_array("mesh/vertices", coordinates, dim);
+
+        detail::write_element_vertices<CellType>(writer, cells, "mesh/cells");
+
+        //
+        // Segmentation
+        //
+        std::vector<long long> segment_ids;
+        std::vector<long long> segment_offsets(1, 0);
+        std::vector<long long> segment_cells;
+        for (typename SegmentationType::const_iterator seg_it  = device.segmentation().begin();
+                                                       seg_it != device.segmentation().end();
+                                                     ++seg_it)
+        {
+          segment_ids.push_back(seg_it->id());
+          CellOnSegmentContainer cells_on_segment(*seg_it);
+          for (CellOnSegmentIterator cit = cells_on_segment.begin(); cit != cells_on_segment.end(); ++cit)
+            segment_cells.push_back(cit->id().get());
+          segment_offsets.push_back(static_cast<long long>(segment_cells.size()));
+        }
+        writer.add_array("segmentation/ids",     segment_ids);
+        writer.add_array("segmentation/offsets", segment_offsets);
+        writer.add_array("segmentation/cells",   segment_cells);
+
+        //
+        // Device data
+        //
+        std::vector<long long> material(cells.size());
+        std::vector<long long> contact_mask(cells.size());
+        std::vector<double>    contact_potential(cells.size(), -1000.0);
+        std::vector<double>    temperature(cells.size());
+        std::vector<double>    fixed_charge(cells.size());
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          std::size_t id = static_cast<std::size_t>(cit->id().get());
+          material[id]     = device.get_material(*cit);
+          contact_mask[id] = device.has_contact_potential(*cit) ? 1 : 0;
+          if (contact_mask[id])
+            contact_potential[id] = device.get_contact_potential(*cit);
+          temperature[id]  = device.get_lattice_temperature(*cit);
+          fixed_charge[id] = device.get_fixed_charge(*cit);
+        }
+        writer.add_array("device/material",          material);
+        writer.add_array("device/doping_n",          device.doping_n());
+        writer.add_array("device/doping_p",          device.doping_p());
+        writer.add_array("device/contact_mask",      contact_mask);
+        writer.add_array("device/contact_potential", contact_potential);
+        writer.add_array("device/temperature",       temperature);
+        writer.add_array("device/fixed_charge",      fixed_charge);
+
+        writer.close();
+      }
+
+      std::remove(cache_filename.c_str());
+      if (std::rename(tmp_filename.c_str(), cache_filename.c_str()) != 0)
+        throw cannot_open_file_exception(cache_filename);
+    }
+
+
+    namespace detail
+    {
+      /** @brief Checks the element type and the size of an array of a device cache. Throws io_operation_unsupported_exception if they do not match. */
+      template <typename T>
+      T const * device_cache_array(result_file_reader const & reader, std::string const & name, std::size_t expected_size)
+      {
+        T const * values = reader.data<T>(name);
+        if (reader.size(name) != expected_size)
+          throw io_operation_unsupported_exception("device cache: Invalid size of array '" + name + "' in '" + reader.filename() + "'");
+        return values;
+      }
+
+      /** @brief Checks sizes and index ranges of all arrays of a device cache, such that loading the cache cannot access data out of bounds.
+       *
+       * Throws io_operation_unsupported_exception if the cache is truncated or inconsistent.
+       */
+      inline void check_device_cache(result_file_reader const & reader, std::size_t dim, std::size_t vertices_per_cell)
+      {
+        std::string const & filename = reader.filename();
+
+        //
+        // Mesh
+        //
+        if (reader.size("mesh/vertices") % dim != 0 || reader.size("mesh/cells") % vertices_per_cell != 0)
+          throw io_operation_unsupported_exception("device cache: Incomplete mesh in '" + filename + "'");
+
+        const std::size_t num_vertices = reader.size("mesh/vertices") / dim;
+        const std::size_t num_cells    = reader.size("mesh/cells") / vertices_per_cell;
+
+        device_cache_array<double>(reader, "mesh/vertices", num_vertices * dim);
+        long long const * cells = device_cache_array<long long>(reader, "mesh/cells", num_cells * vertices_per_cell);
+        for (std::size_t i=0; i<num_cells * vertices_per_cell; ++i)
+          if (cells[i] < 0 || static_cast<unsigned long long>(cells[i]) >= num_vertices)
+            throw io_operation_unsupported_exception("device cache: Vertex index out of range in '" + filename + "'");
+
+        //
+        // Segmentation
+        //
+        const std::size_t num_segments = reader.size("segmentation/ids");
+        long long const * segment_ids     = device_cache_array<long long>(reader, "segmentation/ids",     num_segments);
+        long long const * segment_offsets = device_cache_array<long long>(reader, "segmentation/offsets", num_segments + 1);
+        long long const * segment_cells   = device_cache_array<long long>(reader, "segmentation/cells",   reader.size("segmentation/cells"));
+
+        // non-decreasing offsets from zero to the number of entries, hence all ranges are within segmentation/cells:
+        bool valid_offsets = (segment_offsets[0] == 0 && static_cast<unsigned long long>(segment_offsets[num_segments]) == reader.size("segmentation/cells"));
+        for (std::size_t s=0; s<num_segments; ++s)
+          valid_offsets = valid_offsets && (segment_offsets[s] <= segment_offsets[s+1]);
+        if (!valid_offsets)
+          throw io_operation_unsupported_exception("device cache: Invalid segment offsets in '" + filename + "'");
+
+        std::vector<bool> has_segment(num_cells, false);
+        for (std::size_t s=0; s<num_segments; ++s)
+        {
+          if (segment_ids[s] < 0 || segment_ids[s] > std::numeric_limits<int>::max())
+            throw io_operation_unsupported_exception("device cache: Invalid segment ID in '" + filename + "'");
+
+          for (long long j = segment_offsets[s]; j < segment_offsets[s+1]; ++j)
+          {
+            if (segment_cells[j] < 0 || static_cast<unsigned long long>(segment_cells[j]) >= num_cells)
+              throw io_operation_unsupported_exception("device cache: Cell index out of range in '" + filename + "'");
+            has_segment[static_cast<std::size_t>(segment_cells[j])] = true;
+          }
+        }
+        for (std::size_t i=0; i<num_cells; ++i)
+          if (!has_segment[i])
+            throw io_operation_unsupported_exception("device cache: Cell without segment in '" + filename + "'");
+
+        //
+        // Device data
+        //
+        device_cache_array<long long>(reader, "device/material",          num_cells);
+        device_cache_array<double>   (reader, "device/doping_n",          num_cells);
+        device_cache_array<double>   (reader, "device/doping_p",          num_cells);
+        device_cache_array<long long>(reader, "device/contact_mask",      num_cells);
+        device_cache_array<double>   (reader, "device/contact_potential", num_cells);
+        device_cache_array<double>   (reader, "device/temperature",       num_cells);
+        device_cache_array<double>   (reader, "device/fixed_charge",      num_cells);
+      }
+
+      /** @brief Mesh generator, which creates the mesh and the segmentation from a (memory-mapped) device cache. The cache must have passed check_device_cache(). */
+      class mesh_generator_cache
+      {
+        public:
+          mesh_generator_cache(result_file_reader const & reader) : reader_(reader) {}
+
+          template <typename MeshT, typename SegmentationT>
+          void operator()(MeshT & mesh, SegmentationT & seg) const
+          {
+            typedef typename viennagrid::result_of::point<MeshT>::type    PointType;
+            typedef typename viennagrid::result_of::vertex<MeshT>::type   VertexType;
+            typedef typename viennagrid::result_of::cell<MeshT>::type     CellType;
+            typedef typename viennagrid::result_of::cell_tag<MeshT>::type CellTag;
+            typedef typename viennagrid::result_of::handle<MeshT, viennagrid::vertex_tag>::type   VertexHandleType;
+
+            const std::size_t dim               = static_cast<std::size_t>(PointType::dim);
+            const std::size_t vertices_per_cell = static_cast<std::size_t>(viennagrid::boundary_elements<CellTag, viennagrid::vertex_tag>::num);
+
+            const std::size_t num_vertices = reader_.size("mesh/vertices") / dim;
+            const std::size_t num_cells    = reader_.size("mesh/cells") / vertices_per_cell;
+
+            double    const * coordinates = reader_.data<double>("mesh/vertices");
+            long long const * cells       = reader_.data<long long>("mesh/cells");
+
+            for (std::size_t i=0; i<num_vertices; ++i)
+            {
+              PointType p;
+              for (std::size_t j=0; j<dim; ++j)
+                p[j] = coordinates[i * dim + j];
+              viennagrid::make_vertex_with_id(mesh, typename VertexType::id_type(i), p);
+            }
+
+            // The first segment a cell belongs to creates the cell, further segments only add it:
+            long long const * segment_ids     = reader_.data<long long>("segmentation/ids");
+            long long const * segment_offsets = reader_.data<long long>("segmentation/offsets");
+            long long const * segment_cells   = reader_.data<long long>("segmentation/cells");
+            const std::size_t num_segments    = reader_.size("segmentation/ids");
+
+            std::vector<long long> first_segment(num_cells, -1);
+            for (std::size_t s=0; s<num_segments; ++s)
+            {
+              seg[static_cast<int>(segment_ids[s])]; // create segment, even if empty
+              for (long long j = segment_offsets[s]; j < segment_offsets[s+1]; ++j)
+                if (first_segment[static_cast<std::size_t>(segment_cells[j])] < 0)
+                  first_segment[static_cast<std::size_t>(segment_cells[j])] = segment_ids[s];
+            }
+
+            viennagrid::static_array<VertexHandleType, viennagrid::boundary_elements<CellTag, viennagrid::vertex_tag>::num> cell_vertex_handles;
+            for (std::size_t i=0; i<num_cells; ++i)
+            {
+              for (std::size_t j=0; j<vertices_per_cell; ++j)
+                cell_vertex_handles[j] = viennagrid::vertices(mesh).handle_at(static_cast<std::size_t>(cells[i * vertices_per_cell + j]));
+
+              viennagrid::make_element_with_id<CellType>(seg[static_cast<int>(first_segment[i])],
+                                                         cell_vertex_handles.begin(),
+                                                         cell_vertex_handles.end(),
+                                                         typename CellType::id_type(i));
+            }
+
+            for (std::size_t s=0; s<num_segments; ++s)
+            {
+              for (long long j = segment_offsets[s]; j < segment_offsets[s+1]; ++j)
+              {
+                std::size_t cell_id = static_cast<std::size_t>(segment_cells[j]);
+                if (first_segment[cell_id] != segment_ids[s])
+                  viennagrid::add(seg[static_cast<int>(segment_ids[s])], viennagrid::cells(mesh)[cell_id]);
+              }
+            }
+          }
+
+        private:
+          result_file_reader const & reader_;
+      };
+    }
+
+    /** @brief Loads a device from a cache file written by write_device_cache().
+     *
+     * @param device           The device to initialize
+     * @param cache_filename   Name of the cache file
+     * @param source_filename  Name of the mesh file the cache was created from. If not empty, the cache is only used if modification time, size and hash of this file match.
+     * @param loader_tag       Must match the tag passed to write_device_cache()
+     * @return True if the device was loaded from the cache, false if the cache does not exist, is outdated or invalid.
+     *         All arrays are checked before the device is modified, hence the device is left untouched whenever false is returned.
+     *
+     * Errors after the device has been modified (e.g. out of memory) leave the device in an undefined state. They are propagated instead of returning false,
+     * since a device cannot be replaced as a whole (its segmentation refers to its mesh) and a fallback loader must not run on a partially loaded device.
+     */
+    template <typename DeviceType>
+    bool read_device_cache(DeviceType & device,
+                           std::string const & cache_filename,
+                           std::string const & source_filename = "",
+                           std::string const & loader_tag = "")
+    {
+      typedef typename DeviceType::mesh_type                                        MeshType;
+      typedef typename viennagrid::result_of::point<MeshType>::type                 PointType;
+      typedef typename viennagrid::result_of::cell_tag<MeshType>::type              CellTag;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+      if (!detail::file_exists(cache_filename))
+        return false;
+
+      std::unique_ptr<result_file_reader> reader;
+      try
+      {
+        reader.reset(new result_file_reader(cache_filename));
+
+        //
+        // Validation
+        //
+        if (!reader->has_array("cache/source") || reader->size("cache/source") != 4)
+        {
+          log::warning() << "* read_device_cache(): '" << cache_filename << "' is not a device cache. Ignoring." << std::endl;
+          return false;
+        }
+
+        long long const * source = reader->data<long long>("cache/source");
+        if (source[3] != static_cast<long long>(viennashe::util::fnv1a_hash(loader_tag)))
+        {
+          log::info<log_device_cache>() << "* read_device_cache(): Cache '" << cache_filename << "' was created with different settings." << std::endl;
+          return false;
+        }
+
+        if (!source_filename.empty())
+        {
+          file_fingerprint fingerprint = compute_file_fingerprint(source_filename);
+          if (fingerprint.mtime != source[0] || fingerprint.size != source[1] || fingerprint.hash != source[2])
+          {
+            log::info<log_device_cache>() << "* read_device_cache(): Cache '" << cache_filename << "' is outdated." << std::endl;
+            return false;
+          }
+        }
+
+        const std::size_t dim               = static_cast<std::size_t>(PointType::dim);
+        const std::size_t vertices_per_cell = static_cast<std::size_t>(viennagrid::boundary_elements<CellTag, viennagrid::vertex_tag>::num);
+        if (reader->entry("mesh/vertices").components != dim || reader->entry("mesh/cells").components != vertices_per_cell)
+        {
+          log::warning() << "* read_device_cache(): Cache '" << cache_filename << "' holds a different mesh type. Ignoring." << std::endl;
+          return false;
+        }
+
+        detail::check_device_cache(*reader, dim, vertices_per_cell);
+      }
+      catch (std::exception const & e)
+      {
+        log::warning() << "* read_device_cache(): Unable to use cache '" << cache_filename << "': " << e.what() << std::endl;
+        return false;
+      }
+
+      //
+      // Mesh and segmentation
+      //
+      log::info<log_device_cache>() << "* read_device_cache(): Loading device from cache '" << cache_filename << "'" << std::endl;
+      detail::mesh_generator_cache generator(*reader);
+      device.load_device(generator);
+
+      //
+      // Device data
+      //
+      long long const * material          = reader->data<long long>("device/material");
+      double    const * doping_n          = reader->data<double>("device/doping_n");
+      double    const * doping_p          = reader->data<double>("device/doping_p");
+      long long const * contact_mask      = reader->data<long long>("device/contact_mask");
+      double    const * contact_potential = reader->data<double>("device/contact_potential");
+      double    const * temperature       = reader->data<double>("device/temperature");
+      double    const * fixed_charge      = reader->data<double>("device/fixed_charge");
+
+      CellContainer cells(device.mesh());
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      {
+        std::size_t id = static_cast<std::size_t>(cit->id().get());
+        device.set_material(static_cast<long>(material[id]), *cit);
+        device.set_doping_n(doping_n[id], *cit);
+        device.set_doping_p(doping_p[id], *cit);
+        if (contact_mask[id])
+          device.set_contact_potential(contact_potential[id], *cit);
+        device.set_lattice_temperature(temperature[id], *cit);
+        device.set_fixed_charge(*cit, fixed_charge[id]);
+      }
+
+      return true;
+    }
+
+
+    /** @brief Loads a device through the cache: If a valid cache exists, it is used. Otherwise the loader is called and a new cache is written.
+     *
+     * @param device           The device to initialize
+     * @param source_filename  Name of the mesh file
+     * @param loader           A functor taking the device, which initializes the device from the mesh file
+     * @param loader_tag       A string describing the settings of the loader (see write_device_cache())
+     * @param cache_filename   Name of the cache file. Defaults to source_filename + ".cache"
+     * @return True if the device was loaded from the cache. The loader is only called if the device is untouched, see read_device_cache().
+     */
+    template <typename DeviceType, typename LoaderT>
+    bool load_device_cached(DeviceType & device,
+                            std::string const & source_filename,
+                            LoaderT loader,
+                            std::string const & loader_tag = "",
+                            std::string cache_filename = "")
+    {
+      if (cache_filename.empty())
+        cache_filename = source_filename + ".cache";
+
+      if (read_device_cache(device, cache_filename, source_filename, loader_tag))
+        return true;
+
+      loader(device);
+
+      try
+      {
+        write_device_cache(device, cache_filename, source_filename, loader_tag);
+      }
+      catch (std::exception const & e)
+      {
+        log::warning() << "* load_device_cached(): Unable to write cache '" << cache_filename << "': " << e.what() << std::endl;
+      }
+      return false;
+    }
+
+    /** @brief Loads a mesh file (netgen .mesh or VTK) through the cache. Only the mesh and the segmentation are taken from the file, see device::load_mesh(). */
+    template <typename DeviceType>
+    bool load_mesh_cached(DeviceType & device, std::string const & filename, std::string const & cache_filename = "")
+    {
+      return load_device_cached(device, filename, [&filename](DeviceType & d) { d.load_mesh(filename); }, "load_mesh", cache_filename);
+    }
+
+    /** @brief Reads a device from a VTK file through the cache. See read_device_vtk(). Throws if the VTK file cannot be read. */
+    template <typename DeviceType>
+    bool read_device_vtk_cached(DeviceType & device,
+                                std::string const & filename,
+                                std::string const & doping_n_key,
+                                std::string const & doping_p_key,
+                                std::string const & material_key,
+                                std::string const & cache_filename = "")
+    {
+      return load_device_cached(device,
+                                filename,
+                                [&](DeviceType & d)
+                                {
+                                  if (!read_device_vtk(d, filename, doping_n_key, doping_p_key, material_key))
+                                    throw io_operation_unsupported_exception("read_device_vtk_cached(): Unable to read device from '" + filename + "'");
+                                },
+                                "read_device_vtk:" + doping_n_key + ":" + doping_p_key + ":" + material_key,
+                                cache_filename);
+    }
+
+  } // namespace io
+} // namespace viennashe
+
+#endif
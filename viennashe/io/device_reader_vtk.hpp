@@ -381,7 +381,7 @@ namespace viennashe
     template < typename DeviceType >
     void read_device_vtk(DeviceType & device, const std::string filename)
     {
-      read_device(device, filename, "doping_n", "doping_p", "material");
+      read_device_vtk(device, filename, "doping_n", "doping_p", "material");
     } // read_device
 
   } // io
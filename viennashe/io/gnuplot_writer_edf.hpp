@@ -20,6 +20,7 @@
 #include <math.h>
 #include <fstream>
 #include <iostream>
+#include <map>
 
 // viennagrid
 #include "viennagrid/mesh/mesh.hpp"
@@ -29,7 +30,9 @@
 #include "viennashe/forwards.h"
 #include "viennashe/config.hpp"
 #include "viennashe/physics/constants.hpp"
+#include "viennashe/log/log.hpp"
 #include "viennashe/io/exception.hpp"
+#include "viennashe/io/column_writer.hpp"
 
 /** @file viennashe/io/gnuplot_writer_edf.hpp
     @brief Writes the energy distribution function to a file which can be processed by Gnuplot.
@@ -40,9 +43,20 @@ namespace viennashe
   namespace io
   {
 
-    /** @brief Writes the energy distribution function to a file which can be processed by Gnuplot. Works for 1d, 2d and 3d only. */
+    /** @brief Writes the energy distribution function to a file which can be processed by Gnuplot. Works for 1d, 2d and 3d only.
+     *
+     * Output is buffered and formatted by a column_writer. In binary mode the blank lines separating cells are omitted.
+     */
     struct gnuplot_edf_writer
     {
+      gnuplot_edf_writer(gnuplot_format_id format = GNUPLOT_FORMAT_ASCII) : format_(format), precision_(6) {}
+
+      gnuplot_format_id format() const { return format_; }
+      void format(gnuplot_format_id f) { format_ = f; }
+
+      /** @brief Number of significant digits in ASCII mode */
+      int  precision() const { return precision_; }
+      void precision(int p) { precision_ = p; }
 
       /** @brief Triggers the write process
        *
@@ -58,6 +72,7 @@ namespace viennashe
                       const std::string filename) const
       {
         typedef typename DeviceType::mesh_type            MeshType;
+        typedef typename viennagrid::result_of::point<MeshType>::type                PointType;
         typedef typename viennagrid::result_of::const_cell_range<MeshType> ::type    CellContainer;
         typedef typename viennagrid::result_of::iterator<CellContainer>::type        CellIterator;
         typedef typename EDFWrapperT::she_quantity_type         she_quantity_type;
@@ -65,11 +80,7 @@ namespace viennashe
         she_quantity_type        const & quan       = edf.quan();
         //dispersion_relation_type const & dispersion = edf.dispersion_relation();
 
-        std::map<std::pair<double, double>, double > values; //key is x-coordinate, value is velocity
-        std::ofstream writer(filename.c_str());
-
-        if ( !writer )
-          throw cannot_open_file_exception(filename);
+        std::map<std::pair<double, double>, double > values; //key is (y-coordinate, kinetic energy)
 
         //iterate over edges:
         CellContainer cells(device.mesh());
@@ -77,7 +88,8 @@ namespace viennashe
               cit != cells.end();
               ++cit )
         {
-          if ( viennagrid::centroid(*cit)[0] != coordinate_x )
+          PointType centroid = viennagrid::centroid(*cit);
+          if ( centroid[0] != coordinate_x )
             continue;
 
           for ( std::size_t index_H = 1; index_H < quan.get_value_H_size() - 1; ++index_H )
@@ -85,10 +97,12 @@ namespace viennashe
             const long index = quan.get_unknown_index(*cit, index_H);
             const double eps = quan.get_kinetic_energy(*cit, index_H);
             if ( index > -1 )
-              values[std::make_pair(viennagrid::centroid(*cit)[1], eps)] = edf(*cit, eps, index_H);
+              values[std::make_pair(centroid[1], eps)] = edf(*cit, eps, index_H);
           }
         }
 
+        column_writer writer(filename, format_);
+        writer.precision(precision_);
 
         //now stream values to file:
         double last_x = -1.0;
@@ -99,10 +113,11 @@ namespace viennashe
           double x_coord = it->first.first;
           if ( x_coord < last_x || x_coord > last_x )
           {
-            writer << std::endl;
+            writer.end_block(1);
             last_x = x_coord;
           }
-          writer << it->first.first << " " << it->first.second << " " << it->second << std::endl;
+          writer << it->first.first << it->first.second << it->second;
+          writer.end_row();
         }
 
         writer.close();
@@ -120,7 +135,7 @@ namespace viennashe
       void operator()(DeviceType const & device,
                       CellFilterType const & cell_filter,
                       EDFWrapperT const & edf,
-                      const std::string filename)
+                      const std::string filename) const
       {
         typedef typename DeviceType::mesh_type   MeshType;
 
@@ -134,12 +149,8 @@ namespace viennashe
         she_quantity_type        const & quan       = edf.quan();
         dispersion_relation_type const & dispersion = edf.dispersion_relation();
 
-        std::ofstream writer(filename.c_str());
-
-        if ( !writer )
-        {
-          throw viennashe::io::cannot_open_file_exception(filename);
-        }
+        column_writer writer(filename, format_);
+        writer.precision(precision_);
 
         CellContainer cells(device.mesh());
         for ( CellIterator cit = cells.begin();
@@ -149,6 +160,8 @@ namespace viennashe
           // filter vertices
           if ( !cell_filter(*cit) ) continue;
 
+          PointType centroid = viennagrid::centroid(*cit);
+
           //write values at point
           for ( std::size_t index_H = 1;
                 index_H < quan.get_value_H_size() - 1;
@@ -159,17 +172,27 @@ namespace viennashe
             const double energy = quan.get_kinetic_energy(*cit, index_H);
             if ( index > -1 && energy > 0 )
             {
-              for (std::size_t i = 0; i < static_cast<std::size_t>(PointType::dim); ++i) writer << viennagrid::centroid(*cit)[i] << " ";
-              writer << (energy / viennashe::physics::constants::q) << " "
-                     << edf(*cit, energy, index_H) << " "
-                     << dispersion.density_of_states(energy)
-                     << std::endl;
+              for (std::size_t i = 0; i < static_cast<std::size_t>(PointType::dim); ++i)
+                writer << centroid[i];
+              writer << (energy / viennashe::physics::constants::q)
+                     << edf(*cit, energy, index_H)
+                     << dispersion.density_of_states(energy);
+              writer.end_row();
             }
           } // for index_H
-          writer << std::endl << std::endl; // for gnuplot block index
+          writer.end_block(); // for gnuplot block index
         } // for vertices
+
+        writer.close();
+
+        if (format_ == GNUPLOT_FORMAT_BINARY)
+          log::info() << "* gnuplot_edf_writer(): Wrote " << writer.rows() << " records to '" << filename
+                      << "', read with: binary format=\"" << writer.gnuplot_binary_format() << "\"" << std::endl;
       } // operator()
 
+    private:
+      gnuplot_format_id format_;
+      int               precision_;
     };
 
   } //namespace io
@@ -17,13 +17,18 @@
 
 
 /** @file viennashe/io/initial_guess_writer.hpp
-    @brief A writer function for writing the initial guess to an output file
+    @brief Writer functions for the initial guess (VTK or binary), and a reader for binary initial guess files.
 */
 
 #include <vector>
+#include <sstream>
 #include "viennagrid/accessor.hpp"
 #include "viennagrid/io/vtk_writer.hpp"
 
+#include "viennashe/io/exception.hpp"
+#include "viennashe/io/vector.hpp"
+#include "viennashe/util/hash.hpp"
+
 namespace viennashe
 {
   namespace io
@@ -54,6 +59,77 @@ namespace viennashe
       my_vtk_writer(mesh, key);
     }
 
+
+    /**
+     * @brief Writes a quantity given on the cells of a device to a binary vector file, which can be used as initial guess by read_initial_guess_binary()
+     * @param device         The device
+     * @param quan_acc       An accessor returning the value for a cell, e.g. simulator.potential()
+     * @param quantity_name  The name of the quantity in the simulator, e.g. viennashe::quantity::potential()
+     * @param filename       The filename
+     */
+    template<typename DeviceT, typename QuantityAccessorT>
+    void write_initial_guess_binary(DeviceT const & device, QuantityAccessorT const & quan_acc, std::string const & quantity_name, std::string const & filename)
+    {
+      typedef typename DeviceT::mesh_type                                           MeshType;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+      CellContainer cells(device.mesh());
+      std::vector<double> values(cells.size());
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        values.at(static_cast<std::size_t>(cit->id().get())) = quan_acc(*cit);
+
+      write_vector_to_binary_file(values, filename, quantity_name, viennashe::util::mesh_hash(device.mesh()));
+    }
+
+    namespace detail
+    {
+      /** @brief Accessor returning the value of a cell from a memory-mapped vector, indexed by the cell ID */
+      class mapped_cell_accessor
+      {
+        public:
+          explicit mapped_cell_accessor(mapped_vector const & vec) : data_(vec.data()) {}
+
+          template <typename CellT>
+          double operator()(CellT const & cell) const { return data_[static_cast<std::size_t>(cell.id().get())]; }
+
+          template <typename CellT>
+          double at(CellT const & cell) const { return this->operator()(cell); }
+
+        private:
+          double const * data_;
+      };
+    }
+
+    /**
+     * @brief Sets the initial guess of a simulator from a binary file written by write_initial_guess_binary().
+     *
+     * The file is memory-mapped and the values are passed to simulator.set_initial_guess() without parsing.
+     * The quantity is identified by the name stored in the file.
+     *
+     * @param simulator  The simulator
+     * @param filename   The filename
+     * @return           The name of the quantity for which the initial guess was set
+     */
+    template<typename SimulatorT>
+    std::string read_initial_guess_binary(SimulatorT & simulator, std::string const & filename)
+    {
+      mapped_vector vec(filename);
+
+      if (vec.mesh_hash() != viennashe::util::mesh_hash(simulator.device().mesh()))
+        throw io_operation_unsupported_exception("read_initial_guess_binary(): Mesh of file '" + filename + "' does not match the device");
+
+      if (vec.size() != viennagrid::cells(simulator.device().mesh()).size())
+      {
+        std::stringstream ss;
+        ss << "read_initial_guess_binary(): Number of values in file '" << filename << "' (" << vec.size() << ") does not match the number of cells";
+        throw io_operation_unsupported_exception(ss.str());
+      }
+
+      simulator.set_initial_guess(vec.name(), detail::mapped_cell_accessor(vec));
+      return vec.name();
+    }
+
   } // io
 } // viennashe
 
@@ -26,6 +26,12 @@ namespace viennashe
   {
     /** @brief Tag class for logging inside the she_vtk_writer */
     struct log_she_vtk_writer { enum { enabled = true }; };
+
+    /** @brief Tag class for logging inside the native result file writer and reader */
+    struct log_result_file { enum { enabled = true }; };
+
+    /** @brief Tag class for logging inside the device cache */
+    struct log_device_cache { enum { enabled = true }; };
   }
 
 } // namespace viennashe
@@ -0,0 +1,114 @@
+#ifndef VIENNASHE_IO_MAPPED_FILE_HPP
+#define VIENNASHE_IO_MAPPED_FILE_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+  #include <fstream>
+  #include <iterator>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+// viennashe
+#include "viennashe/io/exception.hpp"
+
+/** @file viennashe/io/mapped_file.hpp
+    @brief Read-only memory mapping of a whole file, used by the binary readers.
+*/
+
+namespace viennashe
+{
+  namespace io
+  {
+
+    /** @brief A read-only view of the content of a file. The file is memory-mapped (read into memory on Windows). */
+    class mapped_file
+    {
+      public:
+        explicit mapped_file(std::string const & filename) : filename_(filename), data_(NULL), size_(0)
+        {
+#ifdef _WIN32
+          std::ifstream stream(filename.c_str(), std::ios::in | std::ios::binary);
+          if (!stream)
+            throw cannot_open_file_exception(filename);
+          buffer_.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+          size_ = buffer_.size();
+          data_ = size_ ? &(buffer_[0]) : NULL;
+#else
+          int fd = ::open(filename.c_str(), O_RDONLY);
+          if (fd < 0)
+            throw cannot_open_file_exception(filename);
+
+          struct stat file_stat;
+          if (::fstat(fd, &file_stat) != 0)
+          {
+            ::close(fd);
+            throw cannot_open_file_exception(filename);
+          }
+          size_ = static_cast<std::size_t>(file_stat.st_size);
+
+          if (size_ > 0)
+          {
+            void * ptr = ::mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr == MAP_FAILED)
+            {
+              ::close(fd);
+              throw cannot_open_file_exception(filename);
+            }
+            data_ = static_cast<char const *>(ptr);
+          }
+          ::close(fd);
+#endif
+        }
+
+        ~mapped_file()
+        {
+#ifndef _WIN32
+          if (data_)
+            ::munmap(const_cast<char *>(data_), size_);
+#endif
+        }
+
+        std::string const & filename() const { return filename_; }
+
+        /** @brief Returns the content of the file. Valid for the lifetime of this object. */
+        char const * data() const { return data_; }
+
+        std::size_t size() const { return size_; }
+
+      private:
+        mapped_file(mapped_file const &);
+        mapped_file & operator=(mapped_file const &);
+
+        std::string         filename_;
+        char const *        data_;
+        std::size_t         size_;
+#ifdef _WIN32
+        std::vector<char>   buffer_;
+#endif
+    };
+
+  } // namespace io
+} // namespace viennashe
+
+#endif
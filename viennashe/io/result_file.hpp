@@ -0,0 +1,462 @@
+#ifndef VIENNASHE_IO_RESULT_FILE_HPP
+#define VIENNASHE_IO_RESULT_FILE_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+
+// viennagrid
+#include "viennagrid/mesh/mesh.hpp"
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/io/exception.hpp"
+#include "viennashe/io/log_keys.h"
+#include "viennashe/io/mapped_file.hpp"
+#include "viennashe/log/log.hpp"
+#include "viennashe/she/she_quantity.hpp"
+
+/** @file viennashe/io/result_file.hpp
+    @brief Native binary result file: A header, a sequence of 64-byte aligned arrays (chunks), and an index. Can be memory-mapped for zero-copy access.
+
+    Layout (all integers little endian, as written by the host):
+      - Header (64 bytes): magic "VSHERES", version, byte order mark, number of arrays, offset of the index
+      - Arrays, each starting at a multiple of 64 bytes
+      - Index: one result_file_index_entry (128 bytes) per array
+*/
+
+namespace viennashe
+{
+  namespace io
+  {
+
+    /** @brief Element types of arrays in a result file */
+    enum result_file_type_id
+    {
+      RESULT_FILE_INVALID = 0,
+      RESULT_FILE_FLOAT64 = 1,
+      RESULT_FILE_INT64   = 2
+    };
+
+    /** @brief Version of the result file format */
+    static const unsigned int result_file_version = 1;
+
+    /** @brief The file header of a result file */
+    struct result_file_header
+    {
+      char               magic[8];          // "VSHERES\0"
+      unsigned int       version;
+      unsigned int       byte_order_mark;   // 0x01020304 as written by the host
+      unsigned long long num_arrays;
+      unsigned long long index_offset;
+      char               reserved[32];
+    };
+
+    /** @brief An entry in the index of a result file */
+    struct result_file_index_entry
+    {
+      char               name[88];
+      unsigned int       type;              // result_file_type_id
+      unsigned int       components;        // Number of values per item, e.g. the spatial dimension for coordinates
+      unsigned long long size;              // Total number of values
+      unsigned long long offset;            // Byte offset of the data from the beginning of the file
+      unsigned long long bytes;
+      unsigned long long reserved;
+    };
+
+    namespace detail
+    {
+      template <typename T> struct result_file_type;
+      template <> struct result_file_type<double>    { enum { value = RESULT_FILE_FLOAT64 }; };
+      template <> struct result_file_type<long long> { enum { value = RESULT_FILE_INT64 }; };
+
+      inline std::size_t result_file_type_size(unsigned int type) { return (type == RESULT_FILE_FLOAT64 || type == RESULT_FILE_INT64) ? 8 : 0; }
+    }
+
+    /** @brief Writes arrays to a result file one after another. Only the index is kept in memory. */
+    class result_file_writer
+    {
+      public:
+        static const std::size_t alignment = 64;
+
+        explicit result_file_writer(std::string const & filename) : filename_(filename), stream_(filename.c_str(), std::ios::out | std::ios::binary), offset_(0), closed_(false)
+        {
+          if (!stream_)
+            throw cannot_open_file_exception(filename);
+
+          result_file_header header;
+          std::memset(&header, 0, sizeof(header));
+          write_raw(reinterpret_cast<char const *>(&header), sizeof(header)); // placeholder, rewritten by close()
+        }
+
+        ~result_file_writer()
+        {
+          if (!closed_)
+          {
+            try { close(); }
+            catch (std::exception const & e) { log::error() << "* result_file_writer::~result_file_writer(): " << e.what() << std::endl; }
+          }
+        }
+
+        /** @brief Writes an array (chunk) with the given name
+         *
+         * @param name         Name of the array. At most 87 characters.
+         * @param values       The values
+         * @param components   Number of values per item (e.g. coordinates per point)
+         */
+        template <typename T>
+        void add_array(std::string const & name, std::vector<T> const & values, std::size_t components = 1)
+        {
+          if (closed_)
+            throw io_operation_unsupported_exception("result_file_writer::add_array(): File '" + filename_ + "' already closed");
+          if (name.size() >= sizeof(result_file_index_entry().name))
+            throw io_operation_unsupported_exception("result_file_writer::add_array(): Array name too long: " + name);
+          if (index_map_.count(name))
+            throw io_operation_unsupported_exception("result_file_writer::add_array(): Duplicate array name: " + name);
+
+          pad_to_alignment();
+
+          result_file_index_entry entry;
+          std::memset(&entry, 0, sizeof(entry));
+          std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+          entry.type       = static_cast<unsigned int>(detail::result_file_type<T>::value);
+          entry.components = static_cast<unsigned int>(components);
+          entry.size       = values.size();
+          entry.offset     = offset_;
+          entry.bytes      = values.size() * sizeof(T);
+
+          if (values.size() > 0)
+            write_raw(reinterpret_cast<char const *>(&(values[0])), values.size() * sizeof(T));
+
+          index_map_[name] = index_.size();
+          index_.push_back(entry);
+        }
+
+        /** @brief Writes the index and the final header. Called by the destructor if not called explicitly. */
+        void close()
+        {
+          if (closed_)
+            return;
+          closed_ = true;
+
+          pad_to_alignment();
+          result_file_header header;
+          std::memset(&header, 0, sizeof(header));
+          std::memcpy(header.magic, "VSHERES", 8);
+          header.version         = result_file_version;
+          header.byte_order_mark = 0x01020304;
+          header.num_arrays      = index_.size();
+          header.index_offset    = offset_;
+
+          if (index_.size() > 0)
+            write_raw(reinterpret_cast<char const *>(&(index_[0])), index_.size() * sizeof(result_file_index_entry));
+
+          stream_.seekp(0);
+          stream_.write(reinterpret_cast<char const *>(&header), sizeof(header));
+          stream_.close();
+          if (stream_.fail())
+            throw io_operation_unsupported_exception("result_file_writer::close(): Writing to '" + filename_ + "' failed");
+        }
+
+      private:
+        void write_raw(char const * data, std::size_t num_bytes)
+        {
+          stream_.write(data, static_cast<std::streamsize>(num_bytes));
+          offset_ += num_bytes;
+        }
+
+        void pad_to_alignment()
+        {
+          static const char zeros[alignment] = { 0 };
+          if (offset_ % alignment)
+            write_raw(zeros, alignment - offset_ % alignment);
+        }
+
+        std::string                              filename_;
+        std::ofstream                            stream_;
+        std::size_t                              offset_;
+        bool                                     closed_;
+        std::vector<result_file_index_entry>     index_;
+        std::map<std::string, std::size_t>       index_map_;
+    };
+
+
+    /** @brief Read-only view of a result file. The file is memory-mapped (read into memory on Windows), so that arrays can be accessed without copies. */
+    class result_file_reader
+    {
+      public:
+        explicit result_file_reader(std::string const & filename) : file_(filename), data_(file_.data()), size_(file_.size())
+        {
+          read_index();
+        }
+
+        std::string const & filename() const { return file_.filename(); }
+
+        std::size_t num_arrays() const { return index_.size(); }
+
+        /** @brief Returns the index entry of the i-th array */
+        result_file_index_entry const & entry(std::size_t i) const { return *(index_.at(i)); }
+
+        bool has_array(std::string const & name) const { return index_map_.find(name) != index_map_.end(); }
+
+        /** @brief Returns the index entry of the array with the given name */
+        result_file_index_entry const & entry(std::string const & name) const
+        {
+          std::map<std::string, std::size_t>::const_iterator it = index_map_.find(name);
+          if (it == index_map_.end())
+            throw io_operation_unsupported_exception("result_file_reader: No array '" + name + "' in file '" + filename() + "'");
+          return *(index_[it->second]);
+        }
+
+        /** @brief Returns a pointer to the data of an array without copying. Valid for the lifetime of the reader. */
+        void const * raw_data(std::string const & name) const { return data_ + entry(name).offset; }
+
+        /** @brief Returns a typed pointer to the data of an array without copying. Throws if the type does not match. */
+        template <typename T>
+        T const * data(std::string const & name) const
+        {
+          if (entry(name).type != static_cast<unsigned int>(detail::result_file_type<T>::value))
+            throw io_operation_unsupported_exception("result_file_reader: Type mismatch for array '" + name + "'");
+          return reinterpret_cast<T const *>(raw_data(name));
+        }
+
+        /** @brief Returns the number of values of an array */
+        std::size_t size(std::string const & name) const { return static_cast<std::size_t>(entry(name).size); }
+
+      private:
+        result_file_reader(result_file_reader const &);
+        result_file_reader & operator=(result_file_reader const &);
+
+        void fail(std::string const & msg) const
+        {
+          throw io_operation_unsupported_exception("result_file_reader: " + msg + " in file '" + filename() + "'");
+        }
+
+        void read_index()
+        {
+          if (size_ < sizeof(result_file_header))
+            fail("File too small");
+
+          result_file_header const * header = reinterpret_cast<result_file_header const *>(data_);
+          if (std::memcmp(header->magic, "VSHERES", 8) != 0)
+            fail("Not a ViennaSHE result file");
+          if (header->byte_order_mark != 0x01020304)
+            fail("Byte order mismatch");
+          if (header->version != result_file_version)
+            fail("Unsupported version");
+          if (header->index_offset + header->num_arrays * sizeof(result_file_index_entry) > size_)
+            fail("Truncated index");
+
+          result_file_index_entry const * entries = reinterpret_cast<result_file_index_entry const *>(data_ + header->index_offset);
+          for (std::size_t i=0; i<header->num_arrays; ++i)
+          {
+            result_file_index_entry const & e = entries[i];
+            if (e.name[sizeof(e.name) - 1] != 0 || e.offset + e.bytes > size_ || e.bytes != e.size * detail::result_file_type_size(e.type))
+              fail("Corrupt index entry");
+            index_map_[std::string(e.name)] = index_.size();
+            index_.push_back(&e);
+          }
+        }
+
+        mapped_file                                       file_;
+        char const *                                      data_;
+        std::size_t                                       size_;
+        std::vector<result_file_index_entry const *>      index_;
+        std::map<std::string, std::size_t>                index_map_;
+    };
+
+
+    namespace detail
+    {
+      /** @brief Writes the SHE coefficients of either cells or facets of a SHE quantity in compressed row format (expansion orders, offsets, coefficients) */
+      template <typename ElementContainerT, typename SHEQuantityT>
+      void write_she_coefficients(result_file_writer & writer, ElementContainerT const & elements, SHEQuantityT const & quan, std::string const & prefix, bool even)
+      {
+        typedef typename viennagrid::result_of::iterator<ElementContainerT>::type   ElementIterator;
+
+        const std::size_t size_H = quan.get_value_H_size();
+
+        std::vector<long long> expansion_orders(elements.size() * size_H);
+        std::vector<long long> unknown_indices(elements.size() * size_H);
+        std::vector<long long> offsets(elements.size() * size_H + 1);
+        for (ElementIterator it = elements.begin(); it != elements.end(); ++it)
+        {
+          for (std::size_t index_H = 0; index_H < size_H; ++index_H)
+          {
+            std::size_t i = static_cast<std::size_t>(it->id().get()) * size_H + index_H;
+            long order = static_cast<long>(quan.get_expansion_order(*it, index_H));
+            expansion_orders[i] = order;
+            unknown_indices[i]  = quan.get_unknown_index(*it, index_H);
+            offsets[i+1]        = (order > 0) ? (even ? viennashe::she::even_unknowns_on_node(order) : viennashe::she::odd_unknowns_on_node(order)) : 0;
+          }
+        }
+        for (std::size_t i=1; i<offsets.size(); ++i)
+          offsets[i] += offsets[i-1];
+
+        std::vector<double> coefficients(static_cast<std::size_t>(offsets.back()));
+        for (ElementIterator it = elements.begin(); it != elements.end(); ++it)
+        {
+          for (std::size_t index_H = 0; index_H < size_H; ++index_H)
+          {
+            std::size_t i = static_cast<std::size_t>(it->id().get()) * size_H + index_H;
+            if (offsets[i+1] > offsets[i])
+              std::copy(quan.get_values(*it, index_H), quan.get_values(*it, index_H) + (offsets[i+1] - offsets[i]), coefficients.begin() + offsets[i]);
+          }
+        }
+
+        writer.add_array(prefix + "_expansion_order", expansion_orders, size_H);
+        writer.add_array(prefix + "_unknown_index",   unknown_indices,  size_H);
+        writer.add_array(prefix + "_offsets",         offsets);
+        writer.add_array(prefix + "_coefficients",    coefficients);
+      }
+
+      /** @brief Writes the vertex indices of all elements (ordered by element ID) */
+      template <typename ElementType, typename ElementContainerT>
+      void write_element_vertices(result_file_writer & writer, ElementContainerT const & elements, std::string const & name)
+      {
+        typedef typename viennagrid::result_of::iterator<ElementContainerT>::type            ElementIterator;
+        typedef typename viennagrid::result_of::const_vertex_range<ElementType>::type        VertexOnElementContainer;
+        typedef typename viennagrid::result_of::iterator<VertexOnElementContainer>::type     VertexOnElementIterator;
+
+        std::size_t vertices_per_element = 0;
+        if (elements.size() > 0)
+          vertices_per_element = VertexOnElementContainer(*elements.begin()).size();
+
+        std::vector<long long> vertex_indices(elements.size() * vertices_per_element);
+        for (ElementIterator it = elements.begin(); it != elements.end(); ++it)
+        {
+          std::size_t j = static_cast<std::size_t>(it->id().get()) * vertices_per_element;
+          VertexOnElementContainer vertices_on_element(*it);
+          for (VertexOnElementIterator vit = vertices_on_element.begin(); vit != vertices_on_element.end(); ++vit, ++j)
+            vertex_indices[j] = vit->id().get();
+        }
+        writer.add_array(name, vertex_indices, vertices_per_element);
+      }
+    }
+
+    /** @brief Writes mesh, device data, spatial quantities and the full SHE data of a time step to a native result file.
+     *
+     * Arrays written (cells, facets and vertices are ordered by their ID, SHE data by element ID first and energy index second):
+     *   - mesh/vertices, mesh/cells, mesh/facets, mesh/cell_material, mesh/cell_doping_n, mesh/cell_doping_p
+     *   - quantity/NAME for each spatial quantity (one value per cell)
+     *   - she/NAME/energies (total energies), she/NAME/cell_bandedge_shift, she/NAME/facet_bandedge_shift
+     *   - she/NAME/{cell,facet}_{expansion_order,unknown_index,offsets,coefficients}: The even (cells) and odd (facets) SHE coefficients.
+     *     The coefficients of element e at energy index_H are located at [offsets[e*num_energies + index_H], offsets[e*num_energies + index_H + 1]).
+     *
+     * @param device      The device
+     * @param quantities  The quantities of a time step, e.g. simulator.quantities()
+     * @param filename    Name of the file to be written to
+     */
+    template <typename DeviceType, typename TimeStepQuantitiesT>
+    void write_result_file(DeviceType const & device, TimeStepQuantitiesT const & quantities, std::string const & filename)
+    {
+      typedef typename DeviceType::mesh_type                                        MeshType;
+      typedef typename viennagrid::result_of::const_vertex_range<MeshType>::type    VertexContainer;
+      typedef typename viennagrid::result_of::iterator<VertexContainer>::type       VertexIterator;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type      CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+      typedef typename viennagrid::result_of::const_facet_range<MeshType>::type     FacetContainer;
+      typedef typename viennagrid::result_of::iterator<FacetContainer>::type        FacetIterator;
+      typedef typename viennagrid::result_of::point<MeshType>::type                 PointType;
+      typedef typename viennagrid::result_of::cell<MeshType>::type                  CellType;
+      typedef typename viennagrid::result_of::facet<MeshType>::type                 FacetType;
+
+      typedef typename TimeStepQuantitiesT::UnknownQuantityType       UnknownQuantityType;
+      typedef typename TimeStepQuantitiesT::UnknownSHEQuantityType    UnknownSHEQuantityType;
+
+      log::info<log_result_file>() << "* write_result_file(): Writing results to '" << filename << "'" << std::endl;
+
+      result_file_writer writer(filename);
+
+      VertexContainer vertices(device.mesh());
+      CellContainer   cells(device.mesh());
+      FacetContainer  facets(device.mesh());
+
+      //
+      // Mesh and device data
+      //
+      const std::size_t dim = static_cast<std::size_t>(PointType::dim);
+      std::vector<double> coordinates(vertices.size() * dim);
+      for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit)
+        for (std::size_t i=0; i<dim; ++i)
+          coordinates[static_cast<std::size_t>(vit->id().get()) * dim + i] = viennagrid::point(*vit)[i];
+      writer.add_array("mesh/vertices", coordinates, dim);
+
+      detail::write_element_vertices<CellType>(writer, cells,  "mesh/cells");
+      detail::write_element_vertices<FacetType>(writer, facets, "mesh/facets");
+
+      std::vector<long long> material(cells.size());
+      std::vector<double>    doping_n(cells.size());
+      std::vector<double>    doping_p(cells.size());
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      {
+        std::size_t id = static_cast<std::size_t>(cit->id().get());
+        material[id] = device.get_material(*cit);
+        doping_n[id] = device.get_doping_n(*cit);
+        doping_p[id] = device.get_doping_p(*cit);
+      }
+      writer.add_array("mesh/cell_material", material);
+      writer.add_array("mesh/cell_doping_n", doping_n);
+      writer.add_array("mesh/cell_doping_p", doping_p);
+
+      //
+      // Spatial quantities
+      //
+      for (std::size_t i=0; i<quantities.unknown_quantities().size(); ++i)
+      {
+        UnknownQuantityType const & quan = quantities.unknown_quantities()[i];
+        writer.add_array("quantity/" + quan.get_name(), quan.values());
+      }
+
+      //
+      // SHE quantities
+      //
+      for (std::size_t i=0; i<quantities.unknown_she_quantities().size(); ++i)
+      {
+        UnknownSHEQuantityType const & quan = quantities.unknown_she_quantities()[i];
+        std::string prefix = "she/" + quan.get_name() + "/";
+
+        std::vector<double> energies(quan.get_value_H_size());
+        for (std::size_t index_H = 0; index_H < energies.size(); ++index_H)
+          energies[index_H] = quan.get_value_H(index_H);
+        writer.add_array(prefix + "energies", energies);
+
+        std::vector<double> cell_shift(cells.size());
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+          cell_shift[static_cast<std::size_t>(cit->id().get())] = quan.get_bandedge_shift(*cit);
+        writer.add_array(prefix + "cell_bandedge_shift", cell_shift);
+
+        std::vector<double> facet_shift(facets.size());
+        for (FacetIterator fit = facets.begin(); fit != facets.end(); ++fit)
+          facet_shift[static_cast<std::size_t>(fit->id().get())] = quan.get_bandedge_shift(*fit);
+        writer.add_array(prefix + "facet_bandedge_shift", facet_shift);
+
+        detail::write_she_coefficients(writer, cells,  quan, prefix + "cell",  true);
+        detail::write_she_coefficients(writer, facets, quan, prefix + "facet", false);
+      }
+
+      writer.close();
+    }
+
+  } //namespace io
+} //namespace viennashe
+
+#endif
@@ -20,20 +20,26 @@
 #include <math.h>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <vector>
+#include <algorithm>
 
 // viennagrid
 #include "viennagrid/forwards.hpp"
 #include "viennagrid/mesh/mesh.hpp"
 #include "viennagrid/io/vtk_writer.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
 
 // viennashe
 #include "viennashe/forwards.h"
 #include "viennashe/config.hpp"
+#include "viennashe/exception.hpp"
+#include "viennashe/she/assemble_common.hpp"
 #include "viennashe/she/postproc/all.hpp"
 #include "viennashe/simulator_quantity.hpp"
 #include "viennashe/physics/constants.hpp"
 #include "viennashe/io/exception.hpp"
+#include "viennashe/io/vtk_data_array.hpp"
 #include "viennashe/materials/all.hpp"
 #include "viennashe/models/mobility.hpp"
 #include "viennashe/postproc/current_density.hpp"
@@ -224,24 +230,23 @@ namespace viennashe
 
 
       /** @brief Writes the VTK XML file header for the unstructured grid file format */
-      void writeHeader(std::ofstream & writer)
+      void writeHeader(std::ofstream & writer, detail::vtk_data_array_writer const & data_writer)
       {
-        writer << "<?xml version=\"1.0\"?>" << std::endl;
-        writer << "<VTKFile type=\"UnstructuredGrid\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+        data_writer.write_file_header(writer, "UnstructuredGrid");
         writer << " <UnstructuredGrid>" << std::endl;
       }
 
       /** @brief Implementation for writing the vertex coordinates in (x, H)-space */
       template <typename DeviceType, typename SegmentType, typename SHEQuantity>
-      void writePoints(DeviceType const & device, SegmentType const & segment, SHEQuantity const & quan, std::ofstream & writer)
+      void writePoints(DeviceType const & device, SegmentType const & segment, SHEQuantity const & quan, std::ofstream & writer, detail::vtk_data_array_writer & data_writer)
       {
         typedef typename viennagrid::result_of::const_vertex_range<SegmentType>::type   VertexContainer;
         typedef typename viennagrid::result_of::iterator<VertexContainer>::type         VertexIterator;
 
         (void)device;
         writer << "   <Points>" << std::endl;
-        writer << "    <DataArray type=\"Float32\" NumberOfComponents=\"3\" format=\"ascii\">" << std::endl;
 
+        std::vector<float> coordinates;
         VertexContainer vertices(segment);
         for (VertexIterator vit = vertices.begin();
             vit != vertices.end();
@@ -251,24 +256,23 @@ namespace viennashe
           {
             if (vertex_write_mask_[static_cast<std::size_t>(vit->id().get())].at(index_H) >= 0)
             {
-              writer << viennagrid::point(*vit)[0] << " ";
+              coordinates.push_back(static_cast<float>(viennagrid::point(*vit)[0]));
               if (viennagrid::point(*vit).size() == 1)
-                writer << "0 ";
+                coordinates.push_back(0);
               else
-                writer << viennagrid::point(*vit)[1] << " ";
-              writer << quan.get_value_H(index_H) << " ";
+                coordinates.push_back(static_cast<float>(viennagrid::point(*vit)[1]));
+              coordinates.push_back(static_cast<float>(quan.get_value_H(index_H)));
             }
           }
-          writer << std::endl;
         }
-        writer << std::endl;
-        writer << "    </DataArray>" << std::endl;
+        data_writer.write_data_array(writer, "NumberOfComponents=\"3\"", coordinates, 3);
+
         writer << "   </Points> " << std::endl;
       } //writePoints()
 
       /** @brief Implementation for writing the cells in (x, H)-space (derived from a mesh in x-space) */
       template <typename DeviceType, typename SegmentType, typename SHEQuantity>
-      void writeCells(DeviceType const & device, SegmentType const & segment, SHEQuantity const & quan, std::ofstream & writer)
+      void writeCells(DeviceType const & device, SegmentType const & segment, SHEQuantity const & quan, std::ofstream & writer, detail::vtk_data_array_writer & data_writer)
       {
         typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type     CellContainer;
         typedef typename viennagrid::result_of::iterator<CellContainer>::type           CellIterator;
@@ -277,9 +281,10 @@ namespace viennashe
         typedef typename viennagrid::result_of::iterator<VertexOnCellContainer>::type   VertexOnCellIterator;
 
         writer << "   <Cells> " << std::endl;
-        writer << "    <DataArray type=\"Int32\" Name=\"connectivity\" format=\"ascii\">" << std::endl;
         CellContainer cells(segment);
 
+        std::vector<int> connectivity;
+
         //write prisms:
         std::size_t num_cells = 0;
         for (std::size_t index_H = 0; index_H < quan.get_value_H_size() - 1; ++index_H)
@@ -297,24 +302,24 @@ namespace viennashe
 
             if (vertices_on_cell.size() == 2) //line segments need special treatment
             {
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H) << " ";
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H)));
 
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H_other) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H_other) << " ";
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H_other)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H_other)));
               ++num_cells;
             }
             else if (vertices_on_cell.size() == 4) //quadrilaterals need special treatment
             {
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[3].id().get())].at(index_H) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[2].id().get())].at(index_H) << " ";
-
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H_other) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H_other) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[3].id().get())].at(index_H_other) << " ";
-              writer << vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[2].id().get())].at(index_H_other) << " ";
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[3].id().get())].at(index_H)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[2].id().get())].at(index_H)));
+
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[0].id().get())].at(index_H_other)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[1].id().get())].at(index_H_other)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[3].id().get())].at(index_H_other)));
+              connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vertices_on_cell[2].id().get())].at(index_H_other)));
               ++num_cells;
             }
             else
@@ -323,44 +328,32 @@ namespace viennashe
                   vocit != vertices_on_cell.end();
                   ++vocit)
               {
-                writer << vertex_write_mask_[static_cast<std::size_t>(vocit->id().get())].at(index_H) << " ";
+                connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vocit->id().get())].at(index_H)));
               }
 
               for (VertexOnCellIterator vocit = vertices_on_cell.begin();
                   vocit != vertices_on_cell.end();
                   ++vocit)
               {
-                writer << vertex_write_mask_[static_cast<std::size_t>(vocit->id().get())].at(index_H_other) << " ";
+                connectivity.push_back(static_cast<int>(vertex_write_mask_[static_cast<std::size_t>(vocit->id().get())].at(index_H_other)));
               }
 
               ++num_cells;
             }
-             writer << std::endl;
            }
           }
 
-          writer << std::endl;
-          writer << "    </DataArray>" << std::endl;
+          const std::size_t vertices_per_cell = viennagrid::boundary_elements<CellTag, viennagrid::vertex_tag>::num * 2;
+          data_writer.write_data_array(writer, "Name=\"connectivity\"", connectivity, vertices_per_cell);
 
-          writer << "    <DataArray type=\"Int32\" Name=\"offsets\" format=\"ascii\">" << std::endl;
-          for (std::size_t offsets = 1;
-               offsets <= num_cells;
-               ++offsets)
-          {
-            writer << (offsets * viennagrid::boundary_elements<CellTag, viennagrid::vertex_tag>::num * 2) << " ";
-          }
-          writer << std::endl;
-          writer << "    </DataArray>" << std::endl;
+          std::vector<int> offsets(num_cells);
+          for (std::size_t i = 0; i < num_cells; ++i)
+            offsets[i] = static_cast<int>((i+1) * vertices_per_cell);
+          data_writer.write_data_array(writer, "Name=\"offsets\"", offsets);
+
+          std::vector<unsigned char> types(num_cells, static_cast<unsigned char>(result_of::she_vtk_type<CellTag>::value));
+          data_writer.write_data_array(writer, "Name=\"types\"", types);
 
-          writer << "    <DataArray type=\"UInt8\" Name=\"types\" format=\"ascii\">" << std::endl;
-          for (std::size_t offsets = 1;
-                offsets <= num_cells;
-                ++offsets)
-          {
-            writer << result_of::she_vtk_type<CellTag>::value << " ";
-          }
-          writer << std::endl;
-          writer << "    </DataArray>" << std::endl;
           writer << "   </Cells>" << std::endl;
       }
 
@@ -369,15 +362,17 @@ namespace viennashe
       void writePointData(DeviceType const & device,
                           SegmentType const & segment,
                           SHEQuantity const & quan,
-                          std::ofstream & writer, std::string name_in_file = "result")
+                          std::ofstream & writer,
+                          detail::vtk_data_array_writer & data_writer,
+                          std::string name_in_file = "result")
       {
         typedef typename viennagrid::result_of::const_vertex_range<SegmentType>::type   VertexContainer;
         typedef typename viennagrid::result_of::iterator<VertexContainer>::type         VertexIterator;
 
         (void)device;
         writer << "   <PointData Scalars=\"scalars\">" << std::endl;
-        writer << "    <DataArray type=\"Float64\" Name=\"" << name_in_file << "\" format=\"ascii\">" << std::endl;
 
+        std::vector<double> values;
         VertexContainer vertices(segment);
         for (VertexIterator vit = vertices.begin();
             vit != vertices.end();
@@ -387,13 +382,12 @@ namespace viennashe
           {
             if (vertex_write_mask_[vit->id().get()].at(index_H) >= 0)
             {
-              writer << quan.get_values(*vit, index_H)[0] << " ";
+              values.push_back(quan.get_values(*vit, index_H)[0]);
             }
           }
-          writer << std::endl;
         }
-        writer << std::endl;
-        writer << "    </DataArray>" << std::endl;
+        data_writer.write_data_array(writer, "Name=\"" + name_in_file + "\"", values, quan.get_value_H_size());
+
         writer << "   </PointData>"  << std::endl;
       } //writePointData
 
@@ -418,6 +412,7 @@ namespace viennashe
                               viennashe::config const & conf,
                               SHEQuantity const & quan,
                               std::ofstream & writer,
+                              detail::vtk_data_array_writer & data_writer,
                               quantity_ids quan_id)
       {
         typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type     CellContainer;
@@ -440,9 +435,8 @@ namespace viennashe
 
         typename viennashe::config::dispersion_relation_type dispersion = conf.dispersion_relation(quan.get_carrier_type_id());
 
-        writer << "    <DataArray type=\"Float64\" Name=\"Generalized " << quantity_name << "\" format=\"ascii\">" << std::endl;
-
         CellContainer cells(segment);
+        std::vector<double> values;
 
         //write prisms:
         for (std::size_t index_H = 0; index_H < quan.get_value_H_size() - 1; ++index_H)
@@ -494,11 +488,10 @@ namespace viennashe
             default: throw std::runtime_error("Internal error: Unknown quan_id in she_vtk_writer::writeCellDataArray()");
             }
 
-            writer << value << " ";
+            values.push_back(value);
           }
-          writer << std::endl;
         }
-        writer << "    </DataArray>" << std::endl;
+        data_writer.write_data_array(writer, "Name=\"Generalized " + quantity_name + "\"", values, 10);
       } //writeCellDataArray
 
       /** @brief Writes data defined on cells to file */
@@ -507,29 +500,32 @@ namespace viennashe
                          SegmentType const & segment,
                          viennashe::config const & conf,
                          SHEQuantity const & quan,
-                         std::ofstream & writer)
+                         std::ofstream & writer,
+                         detail::vtk_data_array_writer & data_writer)
       {
         writer << "   <CellData Scalars=\"scalars\">" << std::endl;
 
-        writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_GENERALIZED_DISTRIBUTION_FUNCTION);
-        writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_DISTRIBUTION_FUNCTION);
-        writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_DENSITY_OF_STATES);
-        writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_GROUP_VELOCITY);
-        writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_KINETIC_ENERGY);
-        writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_EXPANSION_ORDER);
+        writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_GENERALIZED_DISTRIBUTION_FUNCTION);
+        writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_DISTRIBUTION_FUNCTION);
+        writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_DENSITY_OF_STATES);
+        writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_GROUP_VELOCITY);
+        writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_KINETIC_ENERGY);
+        writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_EXPANSION_ORDER);
         if (with_debug_quantities())
         {
-          writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_UNKNOWN_INDEX);
-          writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_UNKNOWN_MASK);
-          writeCellDataArray(device, segment, conf, quan, writer, VIENNASHE_SHE_VTK_QUAN_UNKNOWN_NUM);
+          writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_UNKNOWN_INDEX);
+          writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_UNKNOWN_MASK);
+          writeCellDataArray(device, segment, conf, quan, writer, data_writer, VIENNASHE_SHE_VTK_QUAN_UNKNOWN_NUM);
         }
 
         writer << "   </CellData>"  << std::endl;
       } //writeCellData
 
-      void writeFooter(std::ofstream & writer)
+      /** @brief Closes the unstructured grid and writes the appended binary data (if any) */
+      void writeFooter(std::ofstream & writer, detail::vtk_data_array_writer const & data_writer)
       {
         writer << " </UnstructuredGrid>" << std::endl;
+        data_writer.write_appended_data(writer);
         writer << "</VTKFile>" << std::endl;
       }
 
@@ -557,12 +553,14 @@ namespace viennashe
                          SHEQuantityT const & quan,
                          std::string filename)
       {
-        std::ofstream writer(filename.c_str());
+        std::ofstream writer(filename.c_str(), (format_ == VTK_FORMAT_ASCII) ? std::ios::out : (std::ios::out | std::ios::binary));
 
         if (!writer)
           throw cannot_open_file_exception(filename);
 
-        writeHeader(writer);
+        detail::vtk_data_array_writer data_writer(format_);
+
+        writeHeader(writer, data_writer);
 
         long cell_num = get_cell_num(device, segment, quan); //important: get_cell_num() prior to get_point_num()!!
         long point_num = get_point_num(device, segment, quan);
@@ -574,20 +572,20 @@ namespace viennashe
               << "\">" << std::endl;
 
 
-        writePoints(device, segment, quan, writer);
+        writePoints(device, segment, quan, writer, data_writer);
         if ( (write_segments_ && segment_is_semiconductor_only(device, segment)) || !write_segments_)
-          writeCellData(device, segment, conf, quan, writer);
-        writeCells(device, segment, quan, writer);
+          writeCellData(device, segment, conf, quan, writer, data_writer);
+        writeCells(device, segment, quan, writer, data_writer);
 
         writer << "  </Piece>" << std::endl;
 
-        writeFooter(writer);
+        writeFooter(writer, data_writer);
 
       }
 
     public:
 
-      she_vtk_writer() : write_segments_(false), with_debug_quantities_(false) {}
+      she_vtk_writer() : write_segments_(false), with_debug_quantities_(false), format_(VTK_FORMAT_ASCII) {}
 
       /** @brief Triggers the write process
        *
@@ -664,10 +662,16 @@ namespace viennashe
       bool with_debug_quantities() const { return with_debug_quantities_; }
       void with_debug_quantities(bool b) { with_debug_quantities_ = b; }
 
+      /** @brief Returns the output format (ASCII, appended binary, or appended zlib-compressed binary) */
+      vtk_format_id format() const { return format_; }
+      /** @brief Sets the output format. Binary output is considerably smaller and faster to write than ASCII. */
+      void format(vtk_format_id f) { format_ = f; }
+
     private:
       std::vector<viennashe::she_index_vector_type>  vertex_write_mask_;
       bool write_segments_;
       bool with_debug_quantities_;
+      vtk_format_id format_;
 
     }; //she_vtk_writer
 
@@ -675,19 +679,412 @@ namespace viennashe
     ///////////////////// Convenience routines /////////////////////////////
 
 
-    /** @brief Compatibility overload in order to enable compilation for three-dimensional devices. No action if called. */
+    namespace result_of
+    {
+      /** @brief Meta function which translates element tags of the mesh in x-space to VTK type identifiers */
+      template <typename T>
+      struct vtk_type
+      {
+        typedef typename T::ERROR_NO_VTK_TYPE_FOR_THIS_ELEMENT_TYPE_AVAILABLE  error_type;
+      };
+
+      template <> struct vtk_type<viennagrid::simplex_tag<1> >     { enum{ value = 3 };  };  //VTK_line
+      template <> struct vtk_type<viennagrid::hypercube_tag<1> >   { enum{ value = 3 };  };  //VTK_line
+      template <> struct vtk_type<viennagrid::triangle_tag>        { enum{ value = 5 };  };  //VTK_triangle
+      template <> struct vtk_type<viennagrid::quadrilateral_tag>   { enum{ value = 9 };  };  //VTK_quad
+      template <> struct vtk_type<viennagrid::tetrahedron_tag>     { enum{ value = 10 }; };  //VTK_tetra
+      template <> struct vtk_type<viennagrid::hexahedron_tag>      { enum{ value = 12 }; };  //VTK_hexahedron
+    }
+
+    namespace detail
+    {
+      /** @brief Maps the local vertex index of a ViennaGrid cell to the VTK ordering (ViennaGrid uses tensor-product ordering for hypercubes) */
+      template <typename CellTagT>
+      std::size_t vtk_local_vertex_index(std::size_t i)
+      {
+        if (viennagrid::boundary_elements<CellTagT, viennagrid::vertex_tag>::num == 4 && CellTagT::dim == 2)
+        {
+          static const std::size_t permutation[4] = {0, 1, 3, 2};
+          return permutation[i];
+        }
+        if (viennagrid::boundary_elements<CellTagT, viennagrid::vertex_tag>::num == 8)
+        {
+          static const std::size_t permutation[8] = {0, 1, 3, 2, 4, 5, 7, 6};
+          return permutation[i];
+        }
+        return i;
+      }
+
+      /** @brief Writes the vertices of a mesh in x-space (ordered by vertex ID) as VTK Points */
+      template <typename MeshType>
+      void write_mesh_points(std::ostream & writer, vtk_data_array_writer & data_writer, MeshType const & mesh)
+      {
+        typedef typename viennagrid::result_of::const_vertex_range<MeshType>::type     VertexContainer;
+        typedef typename viennagrid::result_of::iterator<VertexContainer>::type        VertexIterator;
+
+        VertexContainer vertices(mesh);
+        std::vector<float> coordinates(3 * vertices.size());
+        for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit)
+        {
+          std::size_t id = static_cast<std::size_t>(vit->id().get());
+          for (std::size_t i=0; i<viennagrid::point(*vit).size(); ++i)
+            coordinates[3*id + i] = static_cast<float>(viennagrid::point(*vit)[i]);
+        }
+        writer << "   <Points>" << std::endl;
+        data_writer.write_data_array(writer, "NumberOfComponents=\"3\"", coordinates, 3);
+        writer << "   </Points>" << std::endl;
+      }
+
+      /** @brief Writes the cells of a mesh in x-space (ordered by cell ID) as VTK Cells */
+      template <typename MeshType>
+      void write_mesh_cells(std::ostream & writer, vtk_data_array_writer & data_writer, MeshType const & mesh)
+      {
+        typedef typename viennagrid::result_of::cell_tag<MeshType>::type               CellTag;
+        typedef typename viennagrid::result_of::const_cell_range<MeshType>::type       CellContainer;
+        typedef typename viennagrid::result_of::iterator<CellContainer>::type          CellIterator;
+        typedef typename viennagrid::result_of::cell<MeshType>::type                   CellType;
+        typedef typename viennagrid::result_of::const_vertex_range<CellType>::type     VertexOnCellContainer;
+
+        CellContainer cells(mesh);
+        const std::size_t vertices_per_cell = viennagrid::boundary_elements<CellTag, viennagrid::vertex_tag>::num;
+        std::vector<int> connectivity(vertices_per_cell * cells.size());
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          std::size_t id = static_cast<std::size_t>(cit->id().get());
+          VertexOnCellContainer vertices_on_cell(*cit);
+          for (std::size_t i=0; i<vertices_per_cell; ++i)
+            connectivity[vertices_per_cell * id + i] = static_cast<int>(vertices_on_cell[vtk_local_vertex_index<CellTag>(i)].id().get());
+        }
+
+        std::vector<int> offsets(cells.size());
+        for (std::size_t i=0; i<offsets.size(); ++i)
+          offsets[i] = static_cast<int>((i+1) * vertices_per_cell);
+
+        std::vector<unsigned char> types(cells.size(), static_cast<unsigned char>(result_of::vtk_type<CellTag>::value));
+
+        writer << "   <Cells>" << std::endl;
+        data_writer.write_data_array(writer, "Name=\"connectivity\"", connectivity, vertices_per_cell);
+        data_writer.write_data_array(writer, "Name=\"offsets\"", offsets);
+        data_writer.write_data_array(writer, "Name=\"types\"", types);
+        writer << "   </Cells>" << std::endl;
+      }
+
+      /** @brief Writes a single scalar quantity on the full mesh to a VTK XML unstructured grid file, using the given (typically binary) format.
+       *
+       * @param device         The device
+       * @param filename       Name of the file to be written to (without the .vtu extension)
+       * @param values         The data, indexed by vertex or cell ID
+       * @param name_in_file   The quantity name to be used in the VTK file
+       * @param on_vertices    If true, the data is written as PointData, otherwise as CellData
+       * @param format         The output format
+       */
+      template <typename DeviceType>
+      void write_mesh_data_to_vtu(DeviceType const & device,
+                                  std::string const & filename,
+                                  std::vector<double> const & values,
+                                  std::string const & name_in_file,
+                                  bool on_vertices,
+                                  vtk_format_id format)
+      {
+        std::string vtu_filename = filename + ".vtu";
+        std::ofstream writer(vtu_filename.c_str(), std::ios::out | std::ios::binary);
+        if (!writer)
+          throw cannot_open_file_exception(vtu_filename);
+
+        vtk_data_array_writer data_writer(format);
+
+        data_writer.write_file_header(writer, "UnstructuredGrid");
+        writer << " <UnstructuredGrid>" << std::endl;
+        writer << "  <Piece NumberOfPoints=\"" << viennagrid::vertices(device.mesh()).size() << "\" NumberOfCells=\"" << viennagrid::cells(device.mesh()).size() << "\">" << std::endl;
+
+        write_mesh_points(writer, data_writer, device.mesh());
+
+        writer << (on_vertices ? "   <PointData Scalars=\"scalars\">" : "   <CellData Scalars=\"scalars\">") << std::endl;
+        data_writer.write_data_array(writer, "Name=\"" + name_in_file + "\"", values, 10);
+        writer << (on_vertices ? "   </PointData>" : "   </CellData>") << std::endl;
+
+        write_mesh_cells(writer, data_writer, device.mesh());
+
+        writer << "  </Piece>" << std::endl;
+        writer << " </UnstructuredGrid>" << std::endl;
+        data_writer.write_appended_data(writer);
+        writer << "</VTKFile>" << std::endl;
+      }
+
+    } // namespace detail
+
+    /** @brief VTK writer for the distribution function on three-dimensional devices.
+     *
+     * The full (x, H)-space is four-dimensional and cannot be represented in VTK. Instead, the writer streams lower-dimensional slices,
+     * one file at a time, such that only data of the size of the mesh in x-space is held in memory:
+     *   - Energy slabs: For each selected total energy, the mesh in x-space with the distribution function as cell data is written to 'filename_H<index_H>.vtu'.
+     *     A collection file 'filename_main.pvd' uses the total energy (in eV) as time step, so that energies can be browsed in e.g. ParaView.
+     *     All energies are written by default. Use energy_stride() for downsampling or add_energy_index() for selecting individual energies.
+     *   - Cut planes: For each plane added with add_cut_plane(), all cells intersected by the plane are written as a point cloud
+     *     in (u, v, H)-space to 'filename_cut<plane index>.vtu', where u and v are the in-plane coordinates of the cell centroids.
+     *
+     * Binary appended data is written by default, see format().
+     */
     template < typename DeviceType >
     class she_vtk_writer<DeviceType, viennagrid::cartesian_cs<3> >
     {
+        typedef typename DeviceType::mesh_type                                          MeshType;
+        typedef typename viennagrid::result_of::cell<MeshType>::type                    CellType;
+        typedef typename viennagrid::result_of::const_cell_range<MeshType>::type        CellContainer;
+        typedef typename viennagrid::result_of::iterator<CellContainer>::type           CellIterator;
+        typedef typename viennagrid::result_of::const_vertex_range<CellType>::type      VertexOnCellContainer;
+        typedef typename viennagrid::result_of::iterator<VertexOnCellContainer>::type   VertexOnCellIterator;
+
+        /** @brief Returns the distribution function (or the generalized distribution function) on a cell at total energy index_H. Zero outside the bands. */
+        template <typename SHEQuantityT>
+        double get_df(viennashe::config const & conf, SHEQuantityT const & quan, CellType const & cell, std::size_t index_H, bool generalized) const
+        {
+          if (quan.get_unknown_index(cell, index_H) < 0)
+            return 0;
+
+          typename viennashe::config::dispersion_relation_type dispersion = conf.dispersion_relation(quan.get_carrier_type_id());
+          double value = quan.get_values(cell, index_H)[0];
+          bool value_is_generalized = (conf.she_discretization_type() == SHE_DISCRETIZATION_EVEN_ODD_ORDER_GENERALIZED_DF);
+          if (generalized == value_is_generalized)
+            return value;
+
+          double dos = viennashe::she::averaged_density_of_states(quan, dispersion, cell, index_H);
+          if (generalized)
+            return value * dos;
+          return (dos > 0) ? value / dos : 0;  //constant continuation of DF towards zero
+        }
+
+        /** @brief Writes the energy slab at total energy index index_H */
+        template <typename SHEQuantityT>
+        void write_energy_slab(DeviceType const & device,
+                               viennashe::config const & conf,
+                               SHEQuantityT const & quan,
+                               std::size_t index_H,
+                               std::string const & filename)
+        {
+          std::ofstream writer(filename.c_str(), (format_ == VTK_FORMAT_ASCII) ? std::ios::out : (std::ios::out | std::ios::binary));
+          if (!writer)
+            throw cannot_open_file_exception(filename);
+
+          detail::vtk_data_array_writer data_writer(format_);
+
+          CellContainer cells(device.mesh());
+          std::vector<double> df(cells.size());
+          std::vector<double> generalized_df(cells.size());
+          std::vector<double> kinetic_energy(cells.size());
+          for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+          {
+            std::size_t id = static_cast<std::size_t>(cit->id().get());
+            bool valid = viennashe::materials::is_semiconductor(device.get_material(*cit));
+            df[id]             = valid ? get_df(conf, quan, *cit, index_H, false) : 0;
+            generalized_df[id] = valid ? get_df(conf, quan, *cit, index_H, true)  : 0;
+            kinetic_energy[id] = valid ? quan.get_kinetic_energy(*cit, index_H)   : 0;
+          }
+
+          data_writer.write_file_header(writer, "UnstructuredGrid");
+          writer << " <UnstructuredGrid>" << std::endl;
+          writer << "  <Piece NumberOfPoints=\"" << viennagrid::vertices(device.mesh()).size() << "\" NumberOfCells=\"" << cells.size() << "\">" << std::endl;
+          detail::write_mesh_points(writer, data_writer, device.mesh());
+          writer << "   <CellData Scalars=\"scalars\">" << std::endl;
+          data_writer.write_data_array(writer, "Name=\"" + quan.get_name() + " (DF)\"", df, 10);
+          data_writer.write_data_array(writer, "Name=\"" + quan.get_name() + " (Generalized DF)\"", generalized_df, 10);
+          data_writer.write_data_array(writer, "Name=\"" + quan.get_name() + " (kinetic energy)\"", kinetic_energy, 10);
+          writer << "   </CellData>" << std::endl;
+          detail::write_mesh_cells(writer, data_writer, device.mesh());
+          writer << "  </Piece>" << std::endl;
+          writer << " </UnstructuredGrid>" << std::endl;
+          data_writer.write_appended_data(writer);
+          writer << "</VTKFile>" << std::endl;
+        }
+
+        /** @brief Writes the cells intersected by the plane x[axis] = coordinate as point cloud in (u, v, H)-space */
+        template <typename SHEQuantityT>
+        void write_cut_plane(DeviceType const & device,
+                             viennashe::config const & conf,
+                             SHEQuantityT const & quan,
+                             std::size_t axis,
+                             double coordinate,
+                             std::string const & filename)
+        {
+          std::ofstream writer(filename.c_str(), (format_ == VTK_FORMAT_ASCII) ? std::ios::out : (std::ios::out | std::ios::binary));
+          if (!writer)
+            throw cannot_open_file_exception(filename);
+
+          detail::vtk_data_array_writer data_writer(format_);
+
+          const std::size_t u_axis = (axis + 1) % 3;
+          const std::size_t v_axis = (axis + 2) % 3;
+
+          std::vector<float>  points;
+          std::vector<double> df;
+          std::vector<double> generalized_df;
+
+          CellContainer cells(device.mesh());
+          for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+          {
+            if (!viennashe::materials::is_semiconductor(device.get_material(*cit)))
+              continue;
+
+            // check whether plane intersects cell:
+            VertexOnCellContainer vertices_on_cell(*cit);
+            double x_min = viennagrid::point(*vertices_on_cell.begin())[axis];
+            double x_max = x_min;
+            for (VertexOnCellIterator vocit = vertices_on_cell.begin(); vocit != vertices_on_cell.end(); ++vocit)
+            {
+              x_min = std::min(x_min, viennagrid::point(*vocit)[axis]);
+              x_max = std::max(x_max, viennagrid::point(*vocit)[axis]);
+            }
+            if (coordinate < x_min || coordinate > x_max)
+              continue;
+
+            typename viennagrid::result_of::point<MeshType>::type centroid = viennagrid::centroid(*cit);
+            for (std::size_t index_H = 0; index_H < quan.get_value_H_size(); ++index_H)
+            {
+              if (quan.get_unknown_index(*cit, index_H) < 0)
+                continue;
+
+              points.push_back(static_cast<float>(centroid[u_axis]));
+              points.push_back(static_cast<float>(centroid[v_axis]));
+              points.push_back(static_cast<float>(quan.get_value_H(index_H)));
+              df.push_back(get_df(conf, quan, *cit, index_H, false));
+              generalized_df.push_back(get_df(conf, quan, *cit, index_H, true));
+            }
+          }
+
+          const std::size_t num_points = df.size();
+          std::vector<int> connectivity(num_points);
+          std::vector<int> offsets(num_points);
+          for (std::size_t i=0; i<num_points; ++i)
+          {
+            connectivity[i] = static_cast<int>(i);
+            offsets[i]      = static_cast<int>(i+1);
+          }
+          std::vector<unsigned char> types(num_points, 1); //VTK_vertex
+
+          data_writer.write_file_header(writer, "UnstructuredGrid");
+          writer << " <UnstructuredGrid>" << std::endl;
+          writer << "  <Piece NumberOfPoints=\"" << num_points << "\" NumberOfCells=\"" << num_points << "\">" << std::endl;
+          writer << "   <Points>" << std::endl;
+          data_writer.write_data_array(writer, "NumberOfComponents=\"3\"", points, 3);
+          writer << "   </Points>" << std::endl;
+          writer << "   <PointData Scalars=\"scalars\">" << std::endl;
+          data_writer.write_data_array(writer, "Name=\"" + quan.get_name() + " (DF)\"", df, 10);
+          data_writer.write_data_array(writer, "Name=\"" + quan.get_name() + " (Generalized DF)\"", generalized_df, 10);
+          writer << "   </PointData>" << std::endl;
+          writer << "   <Cells>" << std::endl;
+          data_writer.write_data_array(writer, "Name=\"connectivity\"", connectivity, 10);
+          data_writer.write_data_array(writer, "Name=\"offsets\"", offsets, 10);
+          data_writer.write_data_array(writer, "Name=\"types\"", types, 10);
+          writer << "   </Cells>" << std::endl;
+          writer << "  </Piece>" << std::endl;
+          writer << " </UnstructuredGrid>" << std::endl;
+          data_writer.write_appended_data(writer);
+          writer << "</VTKFile>" << std::endl;
+        }
+
+        static std::string short_filename(std::string const & filename)
+        {
+          std::string::size_type pos = filename.rfind("/");
+          if (pos == std::string::npos)
+            pos = filename.rfind("\\");   //A tribute to Windows
+          return (pos != std::string::npos) ? filename.substr(pos+1, filename.size()) : filename;
+        }
+
       public:
-        template <typename DataType>
+
+        she_vtk_writer() : energy_stride_(1), format_(VTK_FORMAT_BINARY) {}
+
+        /** @brief Triggers the write process
+         *
+         * @param device         The device (includes a ViennaGrid mesh) on which simulation is carried out
+         * @param conf           The simulator configuration
+         * @param quan           The SHE quantity in (x, H)-space to be written (typically the distribution function)
+         * @param filename       Base name of the files to be written to
+         */
+        template <typename SHEQuantityT>
         void operator()(DeviceType const & device,
-                        DataType const & data,
-                        std::string const & filename, std::string name_in_file = "result")
+                        viennashe::config const & conf,
+                        SHEQuantityT const & quan,
+                        std::string const & filename)
         {
-          (void)device; (void)data; (void)filename; (void)name_in_file;
-          log::warning() << "* she_vtk_writer::operator(): Cannot write distribution function for 3d devices. Skipping..." << std::endl;
+          //
+          // Energy slabs:
+          //
+          std::vector<std::size_t> energy_indices = energy_indices_;
+          if (energy_indices.empty())
+            for (std::size_t index_H = 0; index_H < quan.get_value_H_size(); index_H += energy_stride_)
+              energy_indices.push_back(index_H);
+
+          std::stringstream ss;
+          ss << filename << "_main.pvd";
+          std::ofstream pvd_writer(ss.str().c_str());
+          if (!pvd_writer)
+            throw cannot_open_file_exception(ss.str());
+
+          pvd_writer << "<?xml version=\"1.0\"?>" << std::endl;
+          pvd_writer << "<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+          pvd_writer << "<Collection>" << std::endl;
+
+          log::info<log_she_vtk_writer>() << "* she_vtk_writer::operator(): Writing " << energy_indices.size() << " energy slabs and "
+                                           << cut_plane_axes_.size() << " cut planes to '" << filename << "'" << std::endl;
+
+          for (std::size_t i=0; i<energy_indices.size(); ++i)
+          {
+            if (energy_indices[i] >= quan.get_value_H_size())
+              throw viennashe::invalid_value_exception("she_vtk_writer::operator(): Energy index out of range", static_cast<double>(energy_indices[i]));
+
+            ss.str("");
+            ss << filename << "_H" << energy_indices[i] << ".vtu";
+            write_energy_slab(device, conf, quan, energy_indices[i], ss.str());
+
+            pvd_writer << "    <DataSet timestep=\"" << quan.get_value_H(energy_indices[i]) / viennashe::physics::constants::q
+                       << "\" file=\"" << short_filename(ss.str()) << "\"/>" << std::endl;
+          }
+
+          pvd_writer << "  </Collection>" << std::endl;
+          pvd_writer << "</VTKFile>" << std::endl;
+
+          //
+          // Cut planes:
+          //
+          for (std::size_t i=0; i<cut_plane_axes_.size(); ++i)
+          {
+            ss.str("");
+            ss << filename << "_cut" << i << ".vtu";
+            write_cut_plane(device, conf, quan, cut_plane_axes_[i], cut_plane_coordinates_[i], ss.str());
+          }
+        }
+
+        /** @brief Writes every n-th total energy only. Ignored if energies are selected by add_energy_index(). */
+        std::size_t energy_stride() const { return energy_stride_; }
+        void energy_stride(std::size_t n)
+        {
+          if (n == 0)
+            throw viennashe::invalid_value_exception("she_vtk_writer::energy_stride(): Stride must be positive", 0);
+          energy_stride_ = n;
+        }
+
+        /** @brief Selects an individual total energy (by index) for output */
+        void add_energy_index(std::size_t index_H) { energy_indices_.push_back(index_H); }
+
+        /** @brief Adds a cut plane normal to the given coordinate axis (0: x, 1: y, 2: z) at the given coordinate */
+        void add_cut_plane(std::size_t axis, double coordinate)
+        {
+          if (axis > 2)
+            throw viennashe::invalid_value_exception("she_vtk_writer::add_cut_plane(): Invalid axis", static_cast<double>(axis));
+          cut_plane_axes_.push_back(axis);
+          cut_plane_coordinates_.push_back(coordinate);
         }
+
+        vtk_format_id format() const { return format_; }
+        void format(vtk_format_id f) { format_ = f; }
+
+      private:
+        std::size_t                 energy_stride_;
+        std::vector<std::size_t>    energy_indices_;
+        std::vector<std::size_t>    cut_plane_axes_;
+        std::vector<double>         cut_plane_coordinates_;
+        vtk_format_id               format_;
     };
 
     /** @brief Convenience routine for writing a single macroscopic quantity to a VTK file.
@@ -696,13 +1093,15 @@ namespace viennashe
      * @param device       The device (includes a ViennaGrid mesh) on which simulation is carried out
      * @param filename     Name of the file to be written to
      * @param name_in_file   The quantity name to be used in the VTK file
+     * @param format       The output format. ASCII output is written through the ViennaGrid writer (one file per segment), binary output into a single .vtu file.
      */
     template <typename QuantityType,
               typename DeviceType>
     void write_vertex_quantity_to_VTK_file(QuantityType const & quantity,
                                            DeviceType const & device,
                                            std::string filename,
-                                           std::string name_in_file = "viennashe_quantity")
+                                           std::string name_in_file = "viennashe_quantity",
+                                           vtk_format_id format = VTK_FORMAT_ASCII)
     {
       typedef typename DeviceType::mesh_type              MeshType;
 
@@ -725,6 +1124,12 @@ namespace viennashe
                 << filename
                 << "' (can be viewed with e.g. ParaView)" << std::endl;
 
+      if (format != VTK_FORMAT_ASCII)
+      {
+        detail::write_mesh_data_to_vtu(device, filename, vtk_data, name_in_file, true, format);
+        return;
+      }
+
       viennagrid::io::vtk_writer<MeshType> my_vtk_writer;
       my_vtk_writer.add_scalar_data_on_vertices(viennagrid::make_accessor<VertexType>(vtk_data), name_in_file);
       my_vtk_writer(mesh, device.segmentation(), filename);
@@ -737,13 +1142,15 @@ namespace viennashe
      * @param device       The device (includes a ViennaGrid mesh) on which simulation is carried out
      * @param filename     Name of the file to be written to
      * @param name_in_file   The quantity name to be used in the VTK file
+     * @param format       The output format. ASCII output is written through the ViennaGrid writer (one file per segment), binary output into a single .vtu file.
      */
     template <typename QuantityType,
               typename DeviceType>
     void write_cell_quantity_to_VTK_file(QuantityType const & quantity,
                                          DeviceType const & device,
                                          std::string filename,
-                                         std::string name_in_file = "viennashe_quantity")
+                                         std::string name_in_file = "viennashe_quantity",
+                                         vtk_format_id format = VTK_FORMAT_ASCII)
     {
       typedef typename DeviceType::mesh_type              MeshType;
 
@@ -766,6 +1173,12 @@ namespace viennashe
                 << filename
                 << "' (can be viewed with e.g. ParaView)" << std::endl;
 
+      if (format != VTK_FORMAT_ASCII)
+      {
+        detail::write_mesh_data_to_vtu(device, filename, vtk_data, name_in_file, false, format);
+        return;
+      }
+
       viennagrid::io::vtk_writer<MeshType> my_vtk_writer;
       my_vtk_writer.add_scalar_data_on_cells(viennagrid::make_accessor<CellType>(vtk_data), name_in_file);
       my_vtk_writer(mesh, device.segmentation(), filename);
@@ -824,9 +1237,10 @@ namespace viennashe
     void write_quantity_to_VTK_file(QuantityType const & quantity,
                                     DeviceType const & device,
                                     std::string filename,
-                                    std::string name_in_file = "viennashe_quantity")
+                                    std::string name_in_file = "viennashe_quantity",
+                                    vtk_format_id format = VTK_FORMAT_ASCII)
     {
-      write_cell_quantity_to_VTK_file(quantity, device, filename, name_in_file);
+      write_cell_quantity_to_VTK_file(quantity, device, filename, name_in_file, format);
     }
 
 
@@ -19,11 +19,15 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <cstring>
+#include <vector>
+#include <algorithm>
 
 #include "viennashe/io/exception.hpp"
+#include "viennashe/io/mapped_file.hpp"
 
 /** @file viennashe/io/vector.hpp
-    @brief Simple routines for reading a vector from file, or writing a vector to file.
+    @brief Simple routines for reading a vector from file, or writing a vector to file. Text and binary (memory-mappable) formats are supported.
 */
 
 namespace viennashe
@@ -84,6 +88,129 @@ namespace viennashe
     }
 
 
+
+    /** @brief Header of a binary vector file. The values (doubles in host byte order) follow directly after the header. */
+    struct vector_file_header
+    {
+      char               magic[8];          // "VSHEVEC\0"
+      unsigned int       version;
+      unsigned int       byte_order_mark;   // 0x01020304 as written by the host
+      unsigned long long size;              // Number of values
+      unsigned int       element_size;      // sizeof(double)
+      unsigned int       reserved;
+      unsigned long long mesh_hash;         // see viennashe::util::mesh_hash(), zero if not associated with a mesh
+      char               name[88];          // e.g. the quantity name, null-terminated
+    };
+
+    /** @brief Writes a vector to a binary file, which can be memory-mapped by mapped_vector
+     *
+     * @param vec        The vector
+     * @param filename   The filename
+     * @param name       A name stored along with the data (e.g. the quantity name). At most 87 characters.
+     * @param mesh_hash  A hash of the mesh the values are associated with, or zero
+     */
+    template <typename VectorType>
+    void write_vector_to_binary_file(VectorType const & vec,
+                                     const std::string & filename,
+                                     const std::string & name = "",
+                                     unsigned long long mesh_hash = 0)
+    {
+      if (name.size() >= sizeof(vector_file_header().name))
+        throw io_operation_unsupported_exception("write_vector_to_binary_file(): Name too long: " + name);
+
+      std::ofstream writer(filename.c_str(), std::ios::out | std::ios::binary);
+
+      if (!writer)
+        throw cannot_open_file_exception(filename);
+
+      vector_file_header header;
+      std::memset(&header, 0, sizeof(header));
+      std::memcpy(header.magic, "VSHEVEC", 8);
+      header.version         = 1;
+      header.byte_order_mark = 0x01020304;
+      header.size            = vec.size();
+      header.element_size    = sizeof(double);
+      header.mesh_hash       = mesh_hash;
+      std::strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+      writer.write(reinterpret_cast<char const *>(&header), sizeof(header));
+
+      std::vector<double> buffer(vec.size() < 65536 ? vec.size() : 65536);
+      for (std::size_t i = 0; i < vec.size(); i += buffer.size())
+      {
+        std::size_t num = std::min<std::size_t>(buffer.size(), vec.size() - i);
+        for (std::size_t j = 0; j < num; ++j)
+          buffer[j] = vec[i + j];
+        writer.write(reinterpret_cast<char const *>(&(buffer[0])), static_cast<std::streamsize>(num * sizeof(double)));
+      }
+
+      if (!writer)
+        throw io_operation_unsupported_exception("write_vector_to_binary_file(): Writing to '" + filename + "' failed");
+    }
+
+    /** @brief A memory-mapped binary vector file written by write_vector_to_binary_file(). The values are accessed without parsing or copying. */
+    class mapped_vector
+    {
+      public:
+        explicit mapped_vector(std::string const & filename) : file_(filename), header_(NULL)
+        {
+          if (file_.size() < sizeof(vector_file_header))
+            fail("File too small");
+
+          header_ = reinterpret_cast<vector_file_header const *>(file_.data());
+          if (std::memcmp(header_->magic, "VSHEVEC", 8) != 0)
+            fail("Not a ViennaSHE vector file");
+          if (header_->byte_order_mark != 0x01020304)
+            fail("Byte order mismatch");
+          if (header_->version != 1 || header_->element_size != sizeof(double))
+            fail("Unsupported version or element type");
+          if (header_->name[sizeof(header_->name) - 1] != 0)
+            fail("Corrupt header");
+          // compare by division, as size * sizeof(double) may overflow for a corrupt size:
+          if (header_->size > (file_.size() - sizeof(vector_file_header)) / sizeof(double))
+            throw premature_end_of_file_exception(filename);
+        }
+
+        std::size_t size() const { return static_cast<std::size_t>(header_->size); }
+
+        double const * data() const { return reinterpret_cast<double const *>(file_.data() + sizeof(vector_file_header)); }
+
+        double operator[](std::size_t i) const { return data()[i]; }
+
+        std::string name() const { return std::string(header_->name); }
+
+        unsigned long long mesh_hash() const { return header_->mesh_hash; }
+
+        std::string const & filename() const { return file_.filename(); }
+
+      private:
+        void fail(std::string const & msg) const
+        {
+          throw io_operation_unsupported_exception("mapped_vector: " + msg + " in file '" + file_.filename() + "'");
+        }
+
+        mapped_file                  file_;
+        vector_file_header const *   header_;
+    };
+
+    /** @brief Reads a vector from a binary file written by write_vector_to_binary_file()
+     *
+     * @param vec      The vector
+     * @param filename The filename
+     */
+    template <typename VectorType>
+    void read_vector_from_binary_file(VectorType & vec,
+                                      const std::string & filename)
+    {
+      mapped_vector file(filename);
+
+      vec.resize(file.size(), false);
+
+      double const * data = file.data();
+      for (std::size_t i = 0; i < file.size(); ++i)
+        vec[i] = data[i];
+    }
+
+
   } //namespace io
 }//namespace viennashe
 
@@ -0,0 +1,220 @@
+#ifndef VIENNASHE_IO_VTK_DATA_ARRAY_HPP
+#define VIENNASHE_IO_VTK_DATA_ARRAY_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <ostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef VIENNASHE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// viennashe
+#include "viennashe/io/exception.hpp"
+
+/** @file viennashe/io/vtk_data_array.hpp
+    @brief Writer for DataArray elements of VTK XML files, either inline as ASCII or as raw binary (optionally zlib-compressed) appended data.
+*/
+
+namespace viennashe
+{
+  namespace io
+  {
+
+    /** @brief Output formats of the VTK XML writers */
+    enum vtk_format_id
+    {
+      VTK_FORMAT_ASCII = 0,    /// Inline ASCII data (human-readable, large)
+      VTK_FORMAT_BINARY,       /// Appended raw binary data
+      VTK_FORMAT_BINARY_ZLIB   /// Appended raw binary data, zlib-compressed (requires VIENNASHE_HAVE_ZLIB)
+    };
+
+    namespace detail
+    {
+      /** @brief Metafunction returning the VTK type name of a C++ type */
+      template <typename T>
+      struct vtk_type_name;
+
+      template <> struct vtk_type_name<unsigned char> { static std::string get() { return "UInt8";   } };
+      template <> struct vtk_type_name<int>           { static std::string get() { return "Int32";   } };
+      template <> struct vtk_type_name<float>         { static std::string get() { return "Float32"; } };
+      template <> struct vtk_type_name<double>        { static std::string get() { return "Float64"; } };
+
+      /** @brief Writes a single ASCII value. Makes sure that UInt8 is written as a number rather than as a character. */
+      template <typename T>
+      void write_vtk_ascii_value(std::ostream & writer, T value) { writer << value; }
+
+      inline void write_vtk_ascii_value(std::ostream & writer, unsigned char value) { writer << static_cast<int>(value); }
+
+      /** @brief Returns true if the host uses little endian byte order */
+      inline bool is_little_endian()
+      {
+        const unsigned int one = 1;
+        return *reinterpret_cast<unsigned char const *>(&one) == 1;
+      }
+
+      /**
+       * @brief Writes the DataArray elements of a VTK XML file.
+       *
+       * In ASCII mode the data is written inline. In binary modes only the XML element with an offset is written,
+       * while the data is collected and emitted in the AppendedData section by write_appended_data().
+       * Each binary block is preceded by a UInt64 header holding the number of bytes (or the zlib block table).
+       */
+      class vtk_data_array_writer
+      {
+        public:
+          typedef unsigned long long   header_type;   // UInt64
+
+          explicit vtk_data_array_writer(vtk_format_id format) : format_(format)
+          {
+#ifndef VIENNASHE_HAVE_ZLIB
+            if (format_ == VTK_FORMAT_BINARY_ZLIB)
+              throw io_operation_unsupported_exception("vtk_data_array_writer: zlib-compressed output requires ViennaSHE to be built with VIENNASHE_HAVE_ZLIB");
+#endif
+          }
+
+          vtk_format_id format() const { return format_; }
+
+          /** @brief Writes the XML prolog and the opening VTKFile element */
+          void write_file_header(std::ostream & writer, std::string const & file_type) const
+          {
+            writer << "<?xml version=\"1.0\"?>" << std::endl;
+            if (format_ == VTK_FORMAT_ASCII)
+            {
+              writer << "<VTKFile type=\"" << file_type << "\" version=\"0.1\" byte_order=\"LittleEndian\">" << std::endl;
+              return;
+            }
+
+            writer << "<VTKFile type=\"" << file_type << "\" version=\"1.0\" byte_order=\"" << (is_little_endian() ? "LittleEndian" : "BigEndian") << "\""
+                   << " header_type=\"UInt64\"";
+            if (format_ == VTK_FORMAT_BINARY_ZLIB)
+              writer << " compressor=\"vtkZLibDataCompressor\"";
+            writer << ">" << std::endl;
+          }
+
+          /**
+           * @brief Writes a DataArray element
+           *
+           * @param writer           The output stream
+           * @param attributes       Further XML attributes such as Name or NumberOfComponents
+           * @param values           The data
+           * @param values_per_line  Number of values per line in ASCII mode (zero for a single line)
+           */
+          template <typename T>
+          void write_data_array(std::ostream & writer,
+                                std::string const & attributes,
+                                std::vector<T> const & values,
+                                std::size_t values_per_line = 0)
+          {
+            writer << "    <DataArray type=\"" << vtk_type_name<T>::get() << "\" " << attributes;
+
+            if (format_ == VTK_FORMAT_ASCII)
+            {
+              writer << " format=\"ascii\">" << std::endl;
+              for (std::size_t i=0; i<values.size(); ++i)
+              {
+                write_vtk_ascii_value(writer, values[i]);
+                writer << " ";
+                if (values_per_line > 0 && (i+1) % values_per_line == 0)
+                  writer << std::endl;
+              }
+              writer << std::endl;
+              writer << "    </DataArray>" << std::endl;
+            }
+            else
+            {
+              writer << " format=\"appended\" offset=\"" << appended_.size() << "\"/>" << std::endl;
+              append_block(values.size() ? reinterpret_cast<char const *>(&(values[0])) : NULL, values.size() * sizeof(T));
+            }
+          }
+
+          /** @brief Writes the AppendedData section (no-op in ASCII mode). Needs to be called after the closing tag of the data set. */
+          void write_appended_data(std::ostream & writer) const
+          {
+            if (format_ == VTK_FORMAT_ASCII)
+              return;
+
+            writer << " <AppendedData encoding=\"raw\">" << std::endl;
+            writer << "  _";
+            writer.write(appended_.data(), static_cast<std::streamsize>(appended_.size()));
+            writer << std::endl;
+            writer << " </AppendedData>" << std::endl;
+          }
+
+        private:
+          void append_header(header_type value)
+          {
+            appended_.append(reinterpret_cast<char const *>(&value), sizeof(header_type));
+          }
+
+          void append_block(char const * data, std::size_t num_bytes)
+          {
+            if (format_ == VTK_FORMAT_BINARY)
+            {
+              append_header(header_type(num_bytes));
+              if (num_bytes > 0)
+                appended_.append(data, num_bytes);
+              return;
+            }
+
+#ifdef VIENNASHE_HAVE_ZLIB
+            // Header: [number of blocks, uncompressed block size, size of last partial block, compressed block sizes]
+            const std::size_t block_size = 32768;
+            const std::size_t num_blocks = (num_bytes + block_size - 1) / block_size;
+            const std::size_t last_size  = num_bytes % block_size;
+
+            std::vector<header_type> header(3 + num_blocks);
+            header[0] = num_blocks;
+            header[1] = block_size;
+            header[2] = last_size;
+
+            std::string compressed_data;
+            std::vector<Bytef> buffer(compressBound(static_cast<uLong>(block_size)));
+            for (std::size_t i=0; i<num_blocks; ++i)
+            {
+              const std::size_t current_size = std::min(block_size, num_bytes - i * block_size);
+              uLongf compressed_size = static_cast<uLongf>(buffer.size());
+              if (compress2(&(buffer[0]), &compressed_size,
+                            reinterpret_cast<Bytef const *>(data + i * block_size), static_cast<uLong>(current_size),
+                            Z_DEFAULT_COMPRESSION) != Z_OK)
+                throw io_operation_unsupported_exception("vtk_data_array_writer: zlib compression failed");
+
+              header[3 + i] = compressed_size;
+              compressed_data.append(reinterpret_cast<char const *>(&(buffer[0])), compressed_size);
+            }
+
+            for (std::size_t i=0; i<header.size(); ++i)
+              append_header(header[i]);
+            appended_.append(compressed_data);
+#else
+            (void)data; (void)num_bytes;
+            throw io_operation_unsupported_exception("vtk_data_array_writer: zlib-compressed output requires ViennaSHE to be built with VIENNASHE_HAVE_ZLIB");
+#endif
+          }
+
+          vtk_format_id format_;
+          std::string   appended_;
+      };
+
+    } // namespace detail
+
+  } //namespace io
+} //namespace viennashe
+
+#endif
@@ -21,6 +21,8 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <utility>
+#include <vector>
 #include <stdio.h>
 
 #include "viennashe/log/nullstream.hpp"
@@ -67,8 +69,103 @@ namespace viennashe
     /** @brief Getter for the global log level */
     inline log_levels log_level() { return viennashe::log::detail::modify_log_level(viennashe::log::logDEBUG, false); }
 
+    namespace detail
+    {
+      /** @brief Recycles the collector streams of the loggers of one thread.
+       *
+       * Every thread owns its own pool, hence acquiring and releasing a stream needs neither locks nor atomics.
+       * Loggers may nest (e.g. a logger streamed into another logger), so a pool rather than a single buffer is kept.
+       */
+      class log_buffer_pool
+      {
+        public:
+          ~log_buffer_pool()
+          {
+            for (std::size_t i=0; i<free_.size(); ++i)
+              delete free_[i];
+          }
+
+          std::ostringstream * acquire()
+          {
+            if (free_.empty())
+              return new std::ostringstream();
+
+            std::ostringstream * stream = free_.back();
+            free_.pop_back();
+            return stream;
+          }
+
+          /** @brief Returns the stream to the pool after resetting its content and formatting state */
+          void release(std::ostringstream * stream)
+          {
+            stream->str(std::string());
+            stream->clear();
+            stream->flags(std::ios_base::dec | std::ios_base::skipws);
+            stream->precision(6);
+            stream->width(0);
+            stream->fill(' ');
+            free_.push_back(stream);
+          }
+
+        private:
+          std::vector<std::ostringstream *> free_;
+      };
+
+      /** @brief Returns the collector stream pool of the calling thread */
+      inline log_buffer_pool & thread_log_buffers()
+      {
+        static thread_local log_buffer_pool pool;
+        return pool;
+      }
+
+      /** @brief Returns the stream handed out by logger::get() if the message is not printed. The stream is in a failed state, so everything streamed into it is dropped. */
+      inline std::ostringstream & discarded_log_stream()
+      {
+        static thread_local std::ostringstream stream;
+        stream.str(std::string());
+        stream.setstate(std::ios_base::badbit);
+        return stream;
+      }
+
+      /** @brief Writes a fully assembled log message with a single call to the output stream (normally std::cout) */
+      inline void write_log_message(log_levels level, std::string const & msg)
+      {
+        (void)level;
+  #ifdef VIENNASHE_LOG_ENABLE_FANCY_BASH
+        char const * color_begin = "";
+        char const * color_end   = "";
+        switch (level)
+        {
+          case log::logERROR:   color_begin = "\033[1;31m "; color_end = " \033[0m"; break;
+          case log::logWARNING: color_begin = "\033[1;33m "; color_end = " \033[0m"; break;
+          case log::logDEBUG:   color_begin = "\033[1;32m "; color_end = " \033[0m"; break;
+          default: break;
+        }
+    #ifdef VIENNASHE_LOG_ATOMIC
+        fprintf(level == log::logERROR ? stderr : stdout, "%s%s%s", color_begin, msg.c_str(), color_end);
+        fflush(level == log::logERROR ? stderr : stdout);
+    #else
+        (void)color_begin; (void)color_end;
+        std::cout.write(msg.data(), static_cast<std::streamsize>(msg.size()));
+    #endif
+  #else
+    #ifdef VIENNASHE_LOG_ATOMIC
+        fwrite(msg.data(), 1, msg.size(), stdout);
+        fflush(stdout);
+    #else
+        std::cout.write(msg.data(), static_cast<std::streamsize>(msg.size()));
+    #endif
+  #endif
+      }
+    } // namespace detail
+
     /**
      * @brief The Main logger class. Assembles output lines and writes them to std::cout upon destruction.
+     *
+     * The log level is checked once upon construction. If the message is not going to be printed, no collector stream
+     * is acquired and all arguments passed via operator<< are dropped without being formatted.
+     * Collector streams are taken from a per-thread pool, so loggers may be used concurrently from several threads.
+     *
      * @tparam enabled If false the logger class does the same as the nullstream ... nothing
      */
     template < bool enabled >
@@ -76,134 +173,102 @@ namespace viennashe
     {
       private:
         typedef std::ostringstream CollectorStreamType;
-        CollectorStreamType local_out;
 
         logger & operator=(const logger &) { return *this; }
 
         log_levels _messageLevel;
+        CollectorStreamType * local_out;
+
+        void init()
+        {
+#ifndef VIENNASHE_LOG_DISABLE
+          local_out = (this->_messageLevel <= log_level()) ? detail::thread_log_buffers().acquire() : NULL;
+#else
+          local_out = NULL;
+#endif
+        }
 
       public:
 
-        explicit logger() : _messageLevel(log_level()) {    }
+        explicit logger() : _messageLevel(log_level()) { init(); }
 
-        logger(log_levels level) : _messageLevel(level) {   }
+        logger(log_levels level) : _messageLevel(level) { init(); }
 
         /** @brief CTOR to log componentwise. Adds [component_name] to the start of every log-line */
         logger(const std::string & component_name) : _messageLevel(log_level())
         {
-          this->get() << "[" << component_name << "] ";
+          init();
+          *this << "[" << component_name << "] ";
         }
 
         /** @brief CTOR to log componentwise on a certain log-level. Adds [component_name] to the start of every log-line */
         logger(log_levels level, const std::string & component_name) : _messageLevel(level)
         {
-          this->get() << "[" << component_name << "] ";
+          init();
+          *this << "[" << component_name << "] ";
         }
 
-        logger(const logger & r) : _messageLevel(r._messageLevel){
-        	 if ( do_log() ){local_out.str(r.local_out.str());} // _messageLevel must have been copied already! C++7 change of policy
-//         if ( do_log() ){ get() << r.get()}; // _messageLevel must have been copied already!
+        logger(const logger & r) : _messageLevel(r._messageLevel), local_out(NULL)
+        {
+          if (r.local_out)
+          {
+            local_out = detail::thread_log_buffers().acquire();
+            *local_out << r.local_out->str();
+          }
         }
 
+        logger(logger && r) : _messageLevel(r._messageLevel), local_out(r.local_out) { r.local_out = NULL; }
+
         /** @brief Destructor. Does actually write the log-message to the output-stream (normally std::cout) */
         ~logger()
         {
-#ifndef VIENNASHE_LOG_DISABLE
-          if (this->do_log())
+          if (local_out)
           {
-  #ifdef VIENNASHE_LOG_ENABLE_FANCY_BASH
-            switch(_messageLevel)
-            {
-              case log::logERROR:
-              #ifdef VIENNASHE_LOG_ATOMIC
-                fprintf(stderr, "\033[1;31m %s \033[0m", get().str().c_str());
-                fflush(stderr);
-              #else
-                std::cout << get().str();
-              #endif
-                break;
-              case log::logWARNING:
-              #ifdef VIENNASHE_LOG_ATOMIC
-                fprintf(stdout, "\033[1;33m %s \033[0m", get().str().c_str());
-                fflush(stdout);
-              #else
-                std::cout << get().str();
-              #endif
-                break;
-              case log::logDEBUG:
-              #ifdef VIENNASHE_LOG_ATOMIC
-                fprintf(stdout, "\033[1;32m %s \033[0m", get().str().c_str());
-                fflush(stdout);
-              #else
-                std::cout << get().str();
-              #endif
-                break;
-              default:
-              #ifdef VIENNASHE_LOG_ATOMIC
-                fprintf(stdout, "%s", get().str().c_str());
-                fflush(stdout);
-              #else
-                std::cout << get().str();
-              #endif
-                break;
-            }
-  #else
-            #ifdef VIENNASHE_LOG_ATOMIC
-              fprintf(stdout, "%s", get().str().c_str());
-              fflush(stdout);
-            #else
-              std::cout << get().str();
-            #endif
-  #endif
+            detail::write_log_message(_messageLevel, local_out->str());
+            detail::thread_log_buffers().release(local_out);
           }
-#endif
         }
 
         /** @brief Returns true if the log-level is smaller than the globally set one. */
-        bool do_log() const { return (this->_messageLevel <= log_level()); }
+        bool do_log() const { return local_out != NULL; }
 
-        /** @brief Returns the collector stream to collect the output. */
-        CollectorStreamType       & get()       {  return local_out;   }
-        /** @brief Returns the collector stream to collect the output. */
-        CollectorStreamType const & get() const {  return local_out;   }
+        /** @brief Returns the collector stream. If the message is not printed, a stream discarding all input is returned. */
+        CollectorStreamType       & get()       { return local_out ? *local_out : detail::discarded_log_stream(); }
+        /** @brief Returns the collector stream. If the message is not printed, a stream discarding all input is returned. */
+        CollectorStreamType const & get() const { return local_out ? *local_out : detail::discarded_log_stream(); }
 
         /** @brief Generic shift left operator to print stuff via the logger. */
         template <typename T>
-        CollectorStreamType & operator<<(const T & x )
+        logger & operator<<(const T & x )
         {
-          if( do_log() ) { get() << x; }
-          return get();
+          if (local_out) { *local_out << x; }
+          return *this;
         }
 
         typedef std::ostream& (*ostream_manipulator)(std::ostream&);
-        CollectorStreamType & operator<<(ostream_manipulator pf)
-        {
-          if( do_log() ) { get() << pf ; }
-          return get();
-        }
-
-        CollectorStreamType & operator<<(std::string & x )
+        logger & operator<<(ostream_manipulator pf)
         {
-          if( do_log() ) { get() << x; }
-          return get();
+          if (local_out) { *local_out << pf; }
+          return *this;
         }
 
-        CollectorStreamType & operator<<(const std::string & x )
+        typedef std::ios_base& (*ios_base_manipulator)(std::ios_base&);
+        logger & operator<<(ios_base_manipulator pf)
         {
-          if( do_log() ) { get() << x; }
-          return get();
+          if (local_out) { *local_out << pf; }
+          return *this;
         }
 
-        CollectorStreamType & operator<<(const char * x )
+        logger & operator<<(const char * x )
         {
-          if( do_log() && x != 0) { get() << x; }
-          return get();
+          if (local_out && x != 0) { *local_out << x; }
+          return *this;
         }
 
-        CollectorStreamType & operator<<(logger & r )
+        logger & operator<<(const logger & r )
         {
-          if( do_log() ) { get() << r.get(); }
-          return get();
+          if (local_out && r.local_out) { *local_out << r.local_out->str(); }
+          return *this;
         }
     };
 
@@ -295,6 +360,92 @@ namespace viennashe
 
     } // namespace detail
 
+    /** @brief Returns true if a message on the given level would be printed.
+     *
+     * Allows to skip the computation of values which are only needed for log output, e.g.
+     * @code
+     *   if (log::is_enabled<log::logDEBUG>()) log::debug() << expensive_summary() << std::endl;
+     * @endcode
+     */
+    template < log_levels level >
+    bool is_enabled()
+    {
+#ifndef VIENNASHE_LOG_DISABLE
+      return level <= log_level();
+#else
+      return false;
+#endif
+    }
+
+    /** @brief Returns true if a message on the given level would be printed for the component identified by KeyTypeT.
+     *         If KeyTypeT::enabled is false, this is a compile time constant false. */
+    template < log_levels level, typename KeyTypeT >
+    bool is_enabled()
+    {
+      return KeyTypeT::enabled && is_enabled<level>();
+    }
+
+    /**
+     * @brief A structured log message consisting of an event name followed by key=value pairs, e.g.
+     *        'nonlinear_iteration iter=3 update_norm=1.2e-05'. The line is written upon destruction.
+     *
+     * Values are only formatted if the message is printed. String values containing blanks are quoted.
+     *
+     * @tparam enabled If false, all fields are discarded at compile time
+     */
+    template < bool enabled >
+    class log_record
+    {
+      public:
+        log_record(log_levels level, std::string const & event_name) : out_(level) { out_ << event_name; }
+
+        log_record(log_record && r) : out_(std::move(r.out_)) {}
+
+        ~log_record() { if (out_.do_log()) out_ << "\n"; }
+
+        /** @brief Appends the pair key=value to the record */
+        template < typename T >
+        log_record & field(std::string const & key, T const & value)
+        {
+          if (out_.do_log()) out_ << " " << key << "=" << value;
+          return *this;
+        }
+
+        log_record & field(std::string const & key, std::string const & value)
+        {
+          if (out_.do_log())
+          {
+            if (value.empty() || value.find_first_of(" \t=\"") != std::string::npos)
+              out_ << " " << key << "=\"" << value << "\"";
+            else
+              out_ << " " << key << "=" << value;
+          }
+          return *this;
+        }
+
+        log_record & field(std::string const & key, char const * value) { return field(key, std::string(value ? value : "")); }
+
+      private:
+        log_record(log_record const &);
+        log_record & operator=(log_record const &);
+
+        logger<enabled> out_;
+    };
+
+    /** @brief Starts a structured log message on the given log level */
+    inline log_record<true> record(log_levels level, std::string const & event_name)
+    {
+      return log_record<true>(level, event_name);
+    }
+
+    /** @brief Starts a structured log message on the given log level for a certain component.
+     *         If KeyTypeT::enabled is false no output will be generated. */
+    template < typename KeyTypeT >
+    log_record<KeyTypeT::enabled> record(log_levels level, std::string const & event_name)
+    {
+      return log_record<KeyTypeT::enabled>(level, event_name);
+    }
+
 #ifndef VIENNASHE_LOG_DISABLE
 
     /** @brief Used to log errors. The logging level is logERROR */
@@ -25,6 +25,9 @@ namespace viennashe
   /** @brief Configuration class for logging the SHE simulator */
   struct log_simulator { enum { enabled = true }; };
 
+  /** @brief Configuration class for logging the small-signal analysis */
+  struct log_small_signal { enum { enabled = true }; };
+
 } // namespace viennashe
 
 
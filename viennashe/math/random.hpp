@@ -17,6 +17,7 @@
 
 // std
 #include <cmath>
+#include <cstddef>
 #include <stdio.h>
 #include <stdint.h>
 
@@ -48,7 +49,9 @@ namespace viennashe
       virtual ValueT operator()()  = 0;
     };
 
-    /** @brief A pseudo-random number generator implementation based on std::rand() */
+    /** @brief A pseudo-random number generator implementation based on std::rand().
+     *         The state is global, hence the generator must not be used by several threads. Use philox_generator instead.
+     */
     template< typename ValueT = double>
     class std_rand_generator : public rand_generator_base<ValueT>
     {
@@ -85,10 +88,10 @@ namespace viennashe
       merseinne_twister_generator(unsigned int seed) : index_(N_ + 1), seed_(seed) { this->init(); }
 
       /**
-       * @brief Sets the seed of the pseudo-random number generator
+       * @brief Sets the seed of the pseudo-random number generator and restarts the sequence
        * @param s The seed to get reproduceable sequences of numbers
        */
-      void seed(unsigned int s) { seed_ = s; }
+      void seed(unsigned int s) { seed_ = s; index_ = N_ + 1; }
 
       /** @brief Returns a pseudo-random number using MT19937.
        *         Not const, since the internal state is being changed!
@@ -155,6 +158,163 @@ namespace viennashe
     };
 
 
+    /** @brief A counter-based pseudo-random number generator using Philox4x32-10,
+     *         cf. John K. Salmon, Mark A. Moraes, Ron O. Dror, David E. Shaw:
+     *         "Parallel random numbers: as easy as 1, 2, 3."
+     *         Proceedings of the International Conference for High Performance Computing, Networking, Storage and Analysis (SC'11), 2011
+     *
+     *  The n-th block of four 32 bit numbers is a bijection of the counter (n, stream) keyed by the seed, hence there is no state besides
+     *  the position in the sequence. Independent streams are obtained by stream() without jumping ahead, e.g. one per thread or per chain,
+     *  and position() allows to continue a stream at any point in O(1).
+     */
+    template< typename ValueT = double>
+    class philox_generator : public rand_generator_base<ValueT>
+    {
+    public:
+      /** @brief CTOR. Starts at the beginning of the given stream */
+      explicit philox_generator(uint64_t seed = 0, uint64_t stream = 0)
+        : seed_(seed), stream_(stream), position_(0), buffered_block_(0), buffered_(false) { }
+
+      /**
+       * @brief Sets the seed of the pseudo-random number generator and restarts the sequence
+       * @param s The seed to get reproduceable sequences of numbers
+       */
+      void seed(uint64_t s) { seed_ = s; position_ = 0; buffered_ = false; }
+
+      /** @brief Returns an independent generator with the same seed for the given stream id, starting at the beginning of the stream */
+      philox_generator stream(uint64_t id) const { return philox_generator(seed_, id); }
+
+      /** @brief Returns the stream id */
+      uint64_t stream_id() const { return stream_; }
+
+      /** @brief Returns the number of pseudo-random numbers generated so far */
+      uint64_t position() const { return position_; }
+
+      /** @brief Continues the sequence at the given position, i.e. after the given number of pseudo-random numbers */
+      void position(uint64_t n) { position_ = n; }
+
+      /** @brief Returns a pseudo-random number in [0,1) */
+      ValueT operator()()
+      {
+        const uint64_t block = position_ >> 2;
+        if (!buffered_ || buffered_block_ != block)
+        {
+          const uint32_t counter[4] = { static_cast<uint32_t>(block),   static_cast<uint32_t>(block >> 32),
+                                        static_cast<uint32_t>(stream_), static_cast<uint32_t>(stream_ >> 32) };
+          const uint32_t key[2]     = { static_cast<uint32_t>(seed_),   static_cast<uint32_t>(seed_ >> 32) };
+          philox4x32(counter, key, buffer_);
+          buffered_block_ = block;
+          buffered_       = true;
+        }
+        return to_unit(buffer_[position_++ & 3]);
+      }
+
+      /**
+       * @brief Fills the given array with the next n pseudo-random numbers in [0,1), i.e. the same values as n calls of operator()().
+       *        Whole blocks are computed several at a time without branches, which allows the compiler to vectorize the rounds.
+       */
+      void generate(ValueT * values, std::size_t n)
+      {
+        std::size_t i = 0;
+        for ( ; i < n && (position_ & 3); ++i)
+          values[i] = (*this)();
+
+        uint32_t bits[4 * lanes];
+        while (n - i >= 4 * lanes)
+        {
+          generate_blocks(position_ >> 2, bits);
+          for (std::size_t k = 0; k < 4 * lanes; ++k)
+            values[i + k] = to_unit(bits[k]);
+          i         += 4 * lanes;
+          position_ += 4 * lanes;
+        }
+
+        for ( ; i < n; ++i)
+          values[i] = (*this)();
+      }
+
+      /**
+       * @brief The Philox4x32-10 bijection
+       * @param counter The 128 bit counter
+       * @param key     The 64 bit key
+       * @param result  The resulting 128 bits
+       */
+      static void philox4x32(uint32_t const counter[4], uint32_t const key[2], uint32_t result[4])
+      {
+        uint32_t k0 = key[0];
+        uint32_t k1 = key[1];
+        for (std::size_t j = 0; j < 4; ++j)
+          result[j] = counter[j];
+
+        for (std::size_t r = 0; r < 10; ++r)
+        {
+          if (r > 0) { k0 += W0_; k1 += W1_; }
+          round(result[0], result[1], result[2], result[3], k0, k1);
+        }
+      }
+
+    private:
+      static const std::size_t lanes = 8; // blocks per batch in generate()
+
+      static const uint32_t M0_ = 0xD2511F53;
+      static const uint32_t M1_ = 0xCD9E8D57;
+      static const uint32_t W0_ = 0x9E3779B9;
+      static const uint32_t W1_ = 0xBB67AE85;
+
+      static ValueT to_unit(uint32_t value) { return (static_cast<ValueT>(value)) * (1.0/4294967296.0) /* * 1/2^32 */; }
+
+      static void round(uint32_t & c0, uint32_t & c1, uint32_t & c2, uint32_t & c3, uint32_t k0, uint32_t k1)
+      {
+        const uint64_t p0 = static_cast<uint64_t>(M0_) * c0;
+        const uint64_t p1 = static_cast<uint64_t>(M1_) * c2;
+        const uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        const uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c0 = n0;
+        c1 = static_cast<uint32_t>(p1);
+        c2 = n2;
+        c3 = static_cast<uint32_t>(p0);
+      }
+
+      /** @brief Computes 'lanes' consecutive blocks of the stream, stored consecutively in bits. Same as philox4x32() per block. */
+      void generate_blocks(uint64_t first_block, uint32_t * bits) const
+      {
+        uint32_t c0[lanes], c1[lanes], c2[lanes], c3[lanes];
+        for (std::size_t l = 0; l < lanes; ++l)
+        {
+          const uint64_t block = first_block + l;
+          c0[l] = static_cast<uint32_t>(block);
+          c1[l] = static_cast<uint32_t>(block >> 32);
+          c2[l] = static_cast<uint32_t>(stream_);
+          c3[l] = static_cast<uint32_t>(stream_ >> 32);
+        }
+
+        uint32_t k0 = static_cast<uint32_t>(seed_);
+        uint32_t k1 = static_cast<uint32_t>(seed_ >> 32);
+        for (std::size_t r = 0; r < 10; ++r)
+        {
+          if (r > 0) { k0 += W0_; k1 += W1_; }
+          for (std::size_t l = 0; l < lanes; ++l)
+            round(c0[l], c1[l], c2[l], c3[l], k0, k1);
+        }
+
+        for (std::size_t l = 0; l < lanes; ++l)
+        {
+          bits[4*l    ] = c0[l];
+          bits[4*l + 1] = c1[l];
+          bits[4*l + 2] = c2[l];
+          bits[4*l + 3] = c3[l];
+        }
+      }
+
+      uint64_t seed_;
+      uint64_t stream_;
+      uint64_t position_;
+      uint32_t buffer_[4];
+      uint64_t buffered_block_;
+      bool     buffered_;
+    };
+
+
     /** @brief A uniform distribution of random numbers */
     template <typename ResultT = int>
     class uniform_distribution
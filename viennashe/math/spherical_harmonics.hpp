@@ -18,6 +18,7 @@
 
 // std
 #include <math.h>
+#include <vector>
 
 // viennashe
 #include "viennashe/forwards.h"
@@ -69,22 +70,27 @@ namespace viennashe
         public:
             AssocLegendre(long n, long m) : n_(n), m_(m) {}
 
-            double operator()(double x) const //evaluation is carried out via a recursion formula
+            double operator()(double x) const //evaluation is carried out via the three-term recurrence in n, starting at P_m^m
             {
-                log::info<log_AssocLegendre>() << "AssocLegendre() with n=" << n_ << ", m=" << m_ << std::endl;
-
-                if (n_ == m_)
-                    return doublefactorial(2*n_ - 1) * pow(sqrt(1.0 - x*x), n_) * ( (n_ % 2 == 0) ? 1.0 : -1.0);
-                else if (m_ == (n_ - 1))
-                    return x * (2.0 * n_ - 1.0) * AssocLegendre(m_, m_)(x);
-                else if (n_ < m_)
+                if (n_ < m_)
                 {
                     log::error() << "Error in AssocLegendre: n<m" << std::endl;
                     return 0.0;
                 }
-                else
-                    return (  (2.0 * n_ - 1.0) * x * AssocLegendre(n_ - 1, m_)(x)
-                            - (n_ + m_ - 1.0)     * AssocLegendre(n_ - 2, m_)(x) ) / (n_ - m_);
+
+                double p_mm = doublefactorial(2*m_ - 1) * pow(sqrt(1.0 - x*x), m_) * ( (m_ % 2 == 0) ? 1.0 : -1.0);
+                if (n_ == m_)
+                    return p_mm;
+
+                double p_prev = p_mm;
+                double p      = x * (2.0 * m_ + 1.0) * p_mm;
+                for (long k = m_ + 2; k <= n_; ++k)
+                {
+                    const double p_next = ( (2.0 * k - 1.0) * x * p - (k + m_ - 1.0) * p_prev ) / (k - m_);
+                    p_prev = p;
+                    p      = p_next;
+                }
+                return p;
             }
 
         private:
@@ -94,6 +100,16 @@ namespace viennashe
 
 
 
+    /** @brief Compute the ratio of factorials a!/b! for a <= b without evaluating the factorials */
+    inline double factorial_ratio(long a, long b)
+    {
+        double result = 1;
+        for (long i=a+1; i<=b; ++i)
+            result /= i;
+
+        return result;
+    }
+
     /** @brief A spherical harmonic */
     class SphericalHarmonic
     {
@@ -101,7 +117,7 @@ namespace viennashe
             SphericalHarmonic(int n, int m) : n_(n), m_(m)
             {
               const double pi = 3.1415926535897932384626433832795;
-              normalisation = sqrt( (2.0*n_ + 1.0) * factorial(n_ - abs(m_)) / (2.0 * pi * factorial(n_ + abs(m_))));
+              normalisation = sqrt( (2.0*n_ + 1.0) * factorial_ratio(n_ - abs(m_), n_ + abs(m_)) / (2.0 * pi));
             }
 
             double operator()(double theta, double phi) const
@@ -206,6 +222,141 @@ namespace viennashe
 
 
 
+    /** @brief Evaluates all spherical harmonics Y_lm up to order Lmax (with the normalisation and phases of SphericalHarmonic) at once.
+     *
+     *  Uses the three-term recurrence of the normalised associated Legendre functions, which neither over- nor underflows for large orders,
+     *  and the recurrence of cos(m phi) and sin(m phi). The coefficients of the recurrence are computed once per evaluator.
+     *  The cost of an evaluation is O(Lmax^2), i.e. O(1) per spherical harmonic.
+     */
+    class spherical_harmonics_evaluator
+    {
+      public:
+        explicit spherical_harmonics_evaluator(long Lmax) : L_(Lmax), a_((Lmax+1)*(Lmax+1), 0.0), b_((Lmax+1)*(Lmax+1), 0.0)
+        {
+          for (long m = 0; m <= L_; ++m)
+          {
+            for (long l = m + 2; l <= L_; ++l)
+            {
+              a_[index(l, m)] = sqrt( (4.0*l*l - 1.0) / (double(l*l) - double(m*m)) );
+              b_[index(l, m)] = sqrt( (double((l-1)*(l-1)) - double(m*m)) / (4.0*(l-1)*(l-1) - 1.0) );
+            }
+          }
+        }
+
+        /** @brief Returns the maximum order */
+        long max_order() const { return L_; }
+
+        /** @brief Returns the number of spherical harmonics up to the maximum order, i.e. (Lmax+1)^2 */
+        std::size_t size() const { return static_cast<std::size_t>((L_+1)*(L_+1)); }
+
+        /** @brief Returns the position of Y_lm in the values, i.e. l*l + l + m (same as spherical_harmonics_iterator) */
+        static std::size_t index(long l, long m) { return static_cast<std::size_t>(l*l + l + m); }
+
+        /**
+         * @brief Evaluates all spherical harmonics
+         * @param theta  The polar angle
+         * @param phi    The azimuthal angle
+         * @param values Array of size() entries. values[index(l, m)] is set to Y_lm(theta, phi)
+         */
+        void operator()(double theta, double phi, double * values) const
+        {
+          const double pi = 3.1415926535897932384626433832795;
+          const double x  = cos(theta);
+          const double s  = sin(theta);
+
+          const double cos_phi = cos(phi);
+          const double sin_phi = sin(phi);
+          double cos_m_phi = 1.0;
+          double sin_m_phi = 0.0;
+
+          double p_mm = sqrt(1.0 / (2.0 * pi)); // normalised P_0^0
+          for (long m = 0; m <= L_; ++m)
+          {
+            if (m > 0)
+            {
+              p_mm *= -s * sqrt( (2.0*m + 1.0) / (2.0*m) );
+
+              const double c = cos_m_phi * cos_phi - sin_m_phi * sin_phi;
+              sin_m_phi      = sin_m_phi * cos_phi + cos_m_phi * sin_phi;
+              cos_m_phi      = c;
+            }
+
+            // Recurrence in l for fixed m:
+            double p_prev = 0.0;
+            double p      = p_mm;
+            for (long l = m; l <= L_; ++l)
+            {
+              if (l == m + 1)
+              {
+                p_prev = p;
+                p      = x * sqrt(2.0*m + 3.0) * p_mm;
+              }
+              else if (l > m + 1)
+              {
+                const double p_next = a_[index(l, m)] * (x * p - b_[index(l, m)] * p_prev);
+                p_prev = p;
+                p      = p_next;
+              }
+
+              if (m == 0)
+                values[index(l, 0)] = p / sqrt(2.0);
+              else
+              {
+                values[index(l,  m)] =  p * cos_m_phi;
+                values[index(l, -m)] = -p * sin_m_phi;
+              }
+            }
+          }
+        }
+
+        /** @brief Convenience overload, resizes the vector to size() */
+        void operator()(double theta, double phi, std::vector<double> & values) const
+        {
+          values.resize(this->size());
+          (*this)(theta, phi, &values[0]);
+        }
+
+      private:
+        long L_;
+        std::vector<double> a_;  // recurrence coefficients, indexed by index(l, m) for m >= 0
+        std::vector<double> b_;
+    };
+
+    /** @brief The values of all spherical harmonics up to order Lmax on a tensor-product grid of angles (theta_i, phi_j). */
+    class spherical_harmonics_table
+    {
+      public:
+        spherical_harmonics_table(long Lmax, std::vector<double> const & thetas, std::vector<double> const & phis)
+          : evaluator_(Lmax), thetas_(thetas), phis_(phis), values_(thetas.size() * phis.size() * evaluator_.size())
+        {
+          for (std::size_t i = 0; i < thetas_.size(); ++i)
+            for (std::size_t j = 0; j < phis_.size(); ++j)
+              evaluator_(thetas_[i], phis_[j], &values_[(i * phis_.size() + j) * evaluator_.size()]);
+        }
+
+        long max_order() const { return evaluator_.max_order(); }
+
+        std::vector<double> const & thetas() const { return thetas_; }
+        std::vector<double> const & phis()   const { return phis_; }
+
+        /** @brief Returns the number of spherical harmonics per grid point, i.e. (Lmax+1)^2 */
+        std::size_t size() const { return evaluator_.size(); }
+
+        /** @brief Returns the values of all spherical harmonics at (theta_i, phi_j), indexed by spherical_harmonics_evaluator::index(l, m) */
+        double const * values(std::size_t i, std::size_t j) const { return &values_[(i * phis_.size() + j) * evaluator_.size()]; }
+
+        /** @brief Returns Y_lm(theta_i, phi_j) */
+        double operator()(std::size_t i, std::size_t j, long l, long m) const { return values(i, j)[spherical_harmonics_evaluator::index(l, m)]; }
+
+      private:
+        spherical_harmonics_evaluator evaluator_;
+        std::vector<double> thetas_;
+        std::vector<double> phis_;
+        std::vector<double> values_;
+    };
+
+
+
     //Iteration over spherical harmonics indices:
 
 
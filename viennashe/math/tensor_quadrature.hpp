@@ -0,0 +1,368 @@
+#ifndef VIENNASHE_MATH_TENSOR_QUADRATURE_HPP
+#define VIENNASHE_MATH_TENSOR_QUADRATURE_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <cmath>
+#include <map>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/exception.hpp"
+
+/** @file viennashe/math/tensor_quadrature.hpp
+    @brief An adaptive tensor-product Gauss quadrature in two dimensions, which evaluates integrands on whole arrays of nodes.
+
+    In contrast to integrate2D() (cf. viennashe/math/integrator.hpp) an integrand is called once per batch of nodes
+    and may return several components sharing the same nodes, cf. tensor_quadrature_2d.
+*/
+
+namespace viennashe
+{
+  namespace math
+  {
+
+    /** @brief The nodes and weights of the Gauss-Legendre rule with n points on [-1, 1] */
+    class gauss_legendre_rule
+    {
+      public:
+        /** @brief Computes the nodes (ascending) and weights by Newton's method applied to the Legendre polynomial of degree n */
+        explicit gauss_legendre_rule(std::size_t n) : nodes_(n), weights_(n)
+        {
+          if (n == 0)
+            throw viennashe::invalid_value_exception("gauss_legendre_rule: The number of points must be positive, but is ", 0);
+
+          const double pi = 3.1415926535897932384626433832795;
+          for (std::size_t i = 0; i < (n + 1) / 2; ++i)
+          {
+            double x  = std::cos(pi * (i + 0.75) / (n + 0.5));
+            double dp = 1.0;
+            for (int iter = 0; iter < 100; ++iter)
+            {
+              double p0 = 1.0;
+              double p1 = x;
+              for (std::size_t k = 2; k <= n; ++k)
+              {
+                const double p2 = ((2.0*k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                p0 = p1;
+                p1 = p2;
+              }
+              dp = (n == 1) ? 1.0 : n * (x * p1 - p0) / (x*x - 1.0);
+              const double dx = p1 / dp;
+              x -= dx;
+              if (std::fabs(dx) < 1e-15)
+                break;
+            }
+            const double w = 2.0 / ((1.0 - x*x) * dp * dp);
+            nodes_[i]         = -x;
+            nodes_[n - 1 - i] =  x;
+            weights_[i]         = w;
+            weights_[n - 1 - i] = w;
+          }
+        }
+
+        std::size_t size() const { return nodes_.size(); }
+
+        std::vector<double> const & nodes()   const { return nodes_; }
+        std::vector<double> const & weights() const { return weights_; }
+
+      private:
+        std::vector<double> nodes_;
+        std::vector<double> weights_;
+    };
+
+    /** @brief Returns the Gauss-Legendre rule with n points. Rules are computed on first use and cached. Thread-safe. */
+    inline std::shared_ptr<gauss_legendre_rule const> get_gauss_legendre_rule(std::size_t n)
+    {
+      typedef std::map<std::size_t, std::shared_ptr<gauss_legendre_rule const> >   CacheType;
+
+      static std::mutex cache_mutex;
+      static CacheType  cache;
+
+      std::lock_guard<std::mutex> lock(cache_mutex);
+      CacheType::const_iterator it = cache.find(n);
+      if (it != cache.end())
+        return it->second;
+
+      std::shared_ptr<gauss_legendre_rule const> rule(new gauss_legendre_rule(n));
+      cache[n] = rule;
+      return rule;
+    }
+
+
+    /** @brief Adapts a scalar functor f(x1, x2) (e.g. the integrands used with integrate2D()) to the batched interface of tensor_quadrature_2d */
+    template <typename T>
+    class batched_integrand_adapter
+    {
+      public:
+        explicit batched_integrand_adapter(T const & func) : func_(func) {}
+
+        std::size_t num_components() const { return 1; }
+
+        void operator()(std::size_t num_points, double const * x1, double const * x2, double * values) const
+        {
+          for (std::size_t k = 0; k < num_points; ++k)
+            values[k] = func_(x1[k], x2[k]);
+        }
+
+      private:
+        T const & func_;
+    };
+
+    /** @brief Convenience function for creating a batched_integrand_adapter */
+    template <typename T>
+    batched_integrand_adapter<T> make_batched_integrand(T const & func) { return batched_integrand_adapter<T>(func); }
+
+
+    /** @brief A rectangular cell of the adaptive quadrature, holding the integrals and error estimates of all components */
+    struct tensor_quadrature_cell
+    {
+      double a1, b1, a2, b2;
+      std::vector<double> values;     // integrals over the cell, one per component
+      std::vector<double> errors;     // error estimates, one per component
+      std::vector<double> quadrants;  // integrals over the quadrants: quadrants[q * num_components + c]
+    };
+
+    /** @brief Adaptive tensor-product Gauss-Legendre quadrature of (possibly vector-valued) integrands over a rectangle
+     *
+     * An integrand provides
+     *   std::size_t num_components() const;
+     *   void operator()(std::size_t num_points, double const * x1, double const * x2, double * values) const;
+     * where values[c * num_points + k] is component c at the node (x1[k], x2[k]). An integrand is thus evaluated on whole arrays of nodes,
+     * which allows for vectorisation and for sharing computations (e.g. spherical harmonics) among components.
+     *
+     * The integral over a cell is computed by the n x n-point Gauss rule on each of its four quadrants, the error of a cell is estimated
+     * by the difference to the n x n-point rule on the whole cell. The cell with the largest error is refined (split into its quadrants)
+     * until the sum of the errors of each component is below max(absolute tolerance, relative tolerance * |integral|), or the maximum
+     * number of cells is reached. The quadrant integrals of a refined cell are reused, hence a refinement evaluates the 16 n^2 nodes
+     * of the quadrants of the new cells, which are passed to the integrand at once.
+     */
+    class tensor_quadrature_2d
+    {
+      public:
+        /** @brief CTOR. Uses the Gauss-Legendre rule with the given number of points per dimension */
+        explicit tensor_quadrature_2d(std::size_t points_per_dim = 5)
+          : rule_(get_gauss_legendre_rule(points_per_dim)), abs_tol_(1e-10), rel_tol_(1e-10), max_cells_(4096), num_evaluations_(0) {}
+
+        /** @brief Sets the absolute and the relative tolerance per component */
+        void tolerance(double abs_tol, double rel_tol) { abs_tol_ = abs_tol; rel_tol_ = rel_tol; }
+
+        /** @brief Sets the maximum number of cells. Refinement stops when the number is reached, even if the tolerance is not met. */
+        void max_cells(std::size_t num) { max_cells_ = std::max<std::size_t>(num, 1); }
+
+        /**
+         * @brief Integrates all components of the integrand over [a1, b1] x [a2, b2]
+         * @param results The integrals, one per component
+         */
+        template <typename IntegrandT>
+        void integrate(double a1, double b1, double a2, double b2, IntegrandT const & f, std::vector<double> & results)
+        {
+          const std::size_t num_comp = f.num_components();
+
+          cells_.clear();
+          num_evaluations_ = 0;
+
+          // root cell: the rule on the whole rectangle and on its quadrants
+          std::vector<double> coarse(num_comp, 0.0);
+          std::vector<double> quadrants(4 * num_comp, 0.0);
+          this->evaluate_rule(f, a1, b1, a2, b2, 1, &coarse[0]);
+          this->evaluate_rule(f, a1, b1, a2, b2, 2, &quadrants[0]);
+
+          std::priority_queue<std::pair<double, std::size_t> > queue;
+          cells_.push_back(make_cell(a1, b1, a2, b2, &coarse[0], &quadrants[0], num_comp));
+          queue.push(std::make_pair(max_error(cells_.back()), 0));
+
+          std::vector<double> total_values(cells_.back().values);
+          std::vector<double> total_errors(cells_.back().errors);
+
+          std::vector<double> subintegrals(16 * num_comp, 0.0);
+          while (!converged(total_values, total_errors) && cells_.size() + 3 <= max_cells_)
+          {
+            const std::size_t index = queue.top().second;
+            queue.pop();
+
+            // The quadrant integrals of the cell are the coarse integrals of the new cells, only the 4 x 4 subrectangles need to be evaluated
+            const tensor_quadrature_cell parent = cells_[index];
+            this->evaluate_rule(f, parent.a1, parent.b1, parent.a2, parent.b2, 4, &subintegrals[0]);
+
+            for (std::size_t c = 0; c < num_comp; ++c)
+            {
+              total_values[c] -= parent.values[c];
+              total_errors[c] -= parent.errors[c];
+            }
+
+            const double m1 = 0.5 * (parent.a1 + parent.b1);
+            const double m2 = 0.5 * (parent.a2 + parent.b2);
+            for (std::size_t qi = 0; qi < 2; ++qi)
+              for (std::size_t qj = 0; qj < 2; ++qj)
+              {
+                for (std::size_t i = 0; i < 2; ++i)
+                  for (std::size_t j = 0; j < 2; ++j)
+                    for (std::size_t c = 0; c < num_comp; ++c)
+                      quadrants[(i * 2 + j) * num_comp + c] = subintegrals[((2*qi + i) * 4 + (2*qj + j)) * num_comp + c];
+
+                const std::size_t q = qi * 2 + qj;
+                tensor_quadrature_cell cell = make_cell(qi ? m1 : parent.a1, qi ? parent.b1 : m1,
+                                                        qj ? m2 : parent.a2, qj ? parent.b2 : m2,
+                                                        &parent.quadrants[q * num_comp], &quadrants[0], num_comp);
+                for (std::size_t c = 0; c < num_comp; ++c)
+                {
+                  total_values[c] += cell.values[c];
+                  total_errors[c] += cell.errors[c];
+                }
+
+                const std::size_t new_index = (q == 0) ? index : cells_.size();
+                if (q == 0)
+                  cells_[index] = cell;
+                else
+                  cells_.push_back(cell);
+                queue.push(std::make_pair(max_error(cell), new_index));
+              }
+          }
+
+          // sum up again to avoid the rounding errors of the running totals
+          results.assign(num_comp, 0.0);
+          errors_.assign(num_comp, 0.0);
+          for (std::size_t i = 0; i < cells_.size(); ++i)
+            for (std::size_t c = 0; c < num_comp; ++c)
+            {
+              results[c] += cells_[i].values[c];
+              errors_[c] += cells_[i].errors[c];
+            }
+        }
+
+        /** @brief Returns the error estimates of the last integration, one per component */
+        std::vector<double> const & errors() const { return errors_; }
+
+        /** @brief Returns the cells of the last integration with their integrals and error estimates */
+        std::vector<tensor_quadrature_cell> const & cells() const { return cells_; }
+
+        /** @brief Returns the number of nodes the integrand has been evaluated at in the last integration */
+        std::size_t num_evaluations() const { return num_evaluations_; }
+
+      private:
+
+        static double max_error(tensor_quadrature_cell const & cell)
+        {
+          double err = 0;
+          for (std::size_t c = 0; c < cell.errors.size(); ++c)
+            err = std::max(err, cell.errors[c]);
+          return err;
+        }
+
+        bool converged(std::vector<double> const & values, std::vector<double> const & errors) const
+        {
+          for (std::size_t c = 0; c < values.size(); ++c)
+            if (errors[c] > std::max(abs_tol_, rel_tol_ * std::fabs(values[c])))
+              return false;
+          return true;
+        }
+
+        /** @brief Creates a cell from the integrals of the coarse rule and of the rule on its quadrants */
+        static tensor_quadrature_cell make_cell(double a1, double b1, double a2, double b2,
+                                                double const * coarse, double const * quadrants, std::size_t num_comp)
+        {
+          tensor_quadrature_cell cell;
+          cell.a1 = a1; cell.b1 = b1; cell.a2 = a2; cell.b2 = b2;
+          cell.values.assign(num_comp, 0.0);
+          cell.errors.assign(num_comp, 0.0);
+          cell.quadrants.assign(quadrants, quadrants + 4 * num_comp);
+          for (std::size_t c = 0; c < num_comp; ++c)
+          {
+            for (std::size_t q = 0; q < 4; ++q)
+              cell.values[c] += quadrants[q * num_comp + c];
+            cell.errors[c] = std::fabs(cell.values[c] - coarse[c]);
+          }
+          return cell;
+        }
+
+        /**
+         * @brief Applies the tensor-product rule on the rectangle split into parts x parts subrectangles with a single call of the integrand
+         * @param integrals The integrals over the subrectangles: integrals[(i * parts + j) * num_components + c]
+         *                  for subrectangle i in the first and j in the second variable
+         */
+        template <typename IntegrandT>
+        void evaluate_rule(IntegrandT const & f, double a1, double b1, double a2, double b2, std::size_t parts, double * integrals)
+        {
+          std::vector<double> const & nodes   = rule_->nodes();
+          std::vector<double> const & weights = rule_->weights();
+          const std::size_t n          = nodes.size();
+          const std::size_t per_part   = n * n;
+          const std::size_t num_points = parts * parts * per_part;
+          const std::size_t num_comp   = f.num_components();
+
+          const double h1 = (b1 - a1) / parts;
+          const double h2 = (b2 - a2) / parts;
+
+          x1_.resize(num_points);
+          x2_.resize(num_points);
+          w_.resize(num_points);
+          values_.resize(num_points * num_comp);
+
+          for (std::size_t i = 0; i < parts; ++i)
+            for (std::size_t j = 0; j < parts; ++j)
+            {
+              const std::size_t offset = (i * parts + j) * per_part;
+              const double mid1 = a1 + (i + 0.5) * h1;
+              const double mid2 = a2 + (j + 0.5) * h2;
+              for (std::size_t p = 0; p < n; ++p)
+                for (std::size_t q = 0; q < n; ++q)
+                {
+                  x1_[offset + p * n + q] = mid1 + 0.5 * h1 * nodes[p];
+                  x2_[offset + p * n + q] = mid2 + 0.5 * h2 * nodes[q];
+                  w_ [offset + p * n + q] = 0.25 * h1 * h2 * weights[p] * weights[q];
+                }
+            }
+
+          f(num_points, &x1_[0], &x2_[0], &values_[0]);
+          num_evaluations_ += num_points;
+
+          for (std::size_t part = 0; part < parts * parts; ++part)
+            for (std::size_t c = 0; c < num_comp; ++c)
+            {
+              double const * v = &values_[c * num_points + part * per_part];
+              double const * w = &w_[part * per_part];
+              double sum = 0;
+              for (std::size_t k = 0; k < per_part; ++k)
+                sum += w[k] * v[k];
+              integrals[part * num_comp + c] = sum;
+            }
+        }
+
+        std::shared_ptr<gauss_legendre_rule const> rule_;
+        double      abs_tol_;
+        double      rel_tol_;
+        std::size_t max_cells_;
+
+        std::vector<tensor_quadrature_cell> cells_;
+        std::vector<double> errors_;
+        std::size_t num_evaluations_;
+
+        // buffers for the nodes, weights and integrand values of a batch
+        std::vector<double> x1_;
+        std::vector<double> x2_;
+        std::vector<double> w_;
+        std::vector<double> values_;
+    };
+
+  } //namespace math
+} //namespace viennashe
+#endif
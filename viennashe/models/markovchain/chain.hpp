@@ -223,6 +223,24 @@ namespace viennashe
         }
       } // get_rate_matrix()
 
+      /**
+       * @brief Calls visitor(from, to, rate) for every rate in the chain, ordered by from-state and to-state
+       * @param visitor A functor accepting the ids of the states and a constant reference to the rate (rate_base)
+       */
+      template < typename VisitorT >
+      void for_each_rate(VisitorT & visitor) const
+      {
+        for (transition_map_type::const_iterator cit = chainmap_.begin();
+            cit != chainmap_.end(); ++cit)
+        {
+          for (rate_map_type::const_iterator rit = cit->second.begin();
+               rit != cit->second.end(); ++rit)
+          {
+            visitor(cit->first, rit->first, *(rit->second));
+          }
+        }
+      } // for_each_rate()
+
       /** @brief Prints the occupancies of each state in the chain onto screen (log::info). Usefull for debugging */
       void print_occupancies() const
       {
@@ -0,0 +1,377 @@
+#ifndef VIENNASHE_MODELS_MARKOVCHAIN_ENSEMBLE_HPP
+#define VIENNASHE_MODELS_MARKOVCHAIN_ENSEMBLE_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <stdint.h>
+
+// viennashe
+#include "viennashe/exception.hpp"
+#include "viennashe/models/exception.hpp"
+#include "viennashe/models/markovchain/exception.hpp"
+#include "viennashe/models/markovchain/chain.hpp"
+#include "viennashe/models/markovchain/rate_table.hpp"
+#include "viennashe/math/random.hpp"
+
+/** @file viennashe/models/markovchain/ensemble.hpp
+    @brief Contains an SSA solver for ensembles of independent Markov-Chains (e.g. many defects for RTN or BTI statistics)
+ */
+
+namespace viennashe
+{
+  namespace models
+  {
+
+    /** @brief Advances an ensemble of independent Markov-Chains by the SSA algorithm (cf. ssa_solver) to a common time horizon.
+     *
+     *  The instances are either given as separate chains or as a single chain (template), where the rates of each instance
+     *  can be set via set_rate(). The rates are compiled into rate tables (cf. rate_table) and evaluated on construction and by update_rates().
+     *  The current states of the instances are kept in a flat array, such that the occupancies of the chains are neither read nor written
+     *  while running, except for the initial states and the final states of separate chains.
+     *
+     *  The instances are distributed over worker threads. Each instance uses a random number stream of its own (philox_generator::stream()),
+     *  which is continued by the next run. Hence results are reproducible and independent of the number of threads.
+     */
+    class ssa_ensemble
+    {
+    public:
+      typedef viennashe::models::chain::index_type index_type;
+
+      /**
+       * @brief CTOR for an ensemble of separate chains. The chains are referenced and need to outlive the ensemble.
+       *        The initial state of each instance is the occupied state of the resp. chain (occupancy 1.0), or state 0 if there is none.
+       *        The final states are written back to the chains after each run.
+       */
+      explicit ssa_ensemble(std::vector<viennashe::models::chain *> const & chains)
+        : chains_(chains), positions_(chains.size(), 0), seed_(5489), time_(0), num_threads_(default_num_threads())
+      {
+        tables_.reserve(chains.size());
+        states_.reserve(chains.size());
+        for (std::size_t i = 0; i < chains.size(); ++i)
+        {
+          if (!chains[i])
+            throw viennashe::invalid_value_exception("ssa_ensemble: Chain is a null pointer at instance ", static_cast<double>(i));
+          tables_.push_back(viennashe::models::rate_table(*chains[i]));
+          states_.push_back(occupied_state(*chains[i]));
+        }
+      }
+
+      /**
+       * @brief CTOR for an ensemble of instances of the same chain (template), which is referenced and needs to outlive the ensemble.
+       *        All instances start with the occupied state of the template (occupancy 1.0), or state 0 if there is none.
+       *        Use set_rate() to assign rates per instance.
+       */
+      ssa_ensemble(viennashe::models::chain const & template_chain, std::size_t num_instances)
+        : tables_(num_instances, viennashe::models::rate_table(template_chain)),
+          states_(num_instances, occupied_state(template_chain)),
+          positions_(num_instances, 0), seed_(5489), time_(0), num_threads_(default_num_threads()) { }
+
+      /** @brief Returns the number of instances */
+      std::size_t size() const { return tables_.size(); }
+
+      /** @brief Returns the number of states of the given instance */
+      index_type num_states(std::size_t instance) const { return tables_.at(instance).num_states(); }
+
+      /** @brief Returns the (common) time of the ensemble, i.e. the sum of all durations of the previous runs */
+      double time() const { return time_; }
+
+      /** @brief Returns the current state of the given instance */
+      index_type state(std::size_t instance) const { return states_.at(instance); }
+
+      /** @brief Sets the current state of the given instance */
+      void set_state(std::size_t instance, index_type s)
+      {
+        if (s >= this->num_states(instance))
+          throw viennashe::models::invalid_state_exception("ssa_ensemble.set_state(): State does not exist!", s);
+        states_[instance] = s;
+      }
+
+      /** @brief Returns the rates of the given instance */
+      viennashe::models::rate_table const & rates(std::size_t instance) const { return tables_.at(instance); }
+
+      /** @brief Sets the rate of the given instance between the given states. Overwritten by update_rates(). */
+      void set_rate(std::size_t instance, index_type from, index_type to, double value) { tables_.at(instance).set(from, to, value); }
+
+      /** @brief Evaluates the rates of all instances again (rate_base::value()). Call this after changing parameters the rates depend on. */
+      void update_rates()
+      {
+        for (std::size_t i = 0; i < tables_.size(); ++i)
+          tables_[i].update();
+      }
+
+      /** @brief Sets the seed of the random number streams and restarts them */
+      void seed(uint64_t s) { seed_ = s; positions_.assign(positions_.size(), 0); }
+
+      /** @brief Returns the number of worker threads */
+      std::size_t num_threads() const { return num_threads_; }
+
+      /** @brief Sets the number of worker threads. Zero means one thread per hardware thread. */
+      void num_threads(std::size_t n) { num_threads_ = (n > 0) ? n : default_num_threads(); }
+
+      /**
+       * @brief Advances all instances to the given time and records the states at equidistant times.
+       * @param t_end       The time horizon in seconds. Needs to be larger than time().
+       * @param num_samples The number of samples per instance. Sample k is taken at time() + (k+1) * (t_end - time()) / num_samples,
+       *                    i.e. the last sample is the state at t_end.
+       * @param trace       The states. trace[instance * num_samples + k] is the state of the instance at sample k.
+       */
+      void sample_states(double t_end, std::size_t num_samples, std::vector<index_type> & trace)
+      {
+        check_horizon(t_end);
+        trace.resize(this->size() * num_samples);
+
+        const double t_begin = time_;
+        const double h       = (t_end - t_begin) / static_cast<double>(num_samples > 0 ? num_samples : 1);
+
+        this->run(t_end, [&](std::size_t /*chunk*/, std::size_t instance)
+        {
+          state_sampler sampler(t_begin, h, num_samples, t_end, trace.data() + instance * num_samples);
+          this->advance(instance, t_begin, t_end, sampler);
+        });
+      }
+
+      /**
+       * @brief Advances all instances to the given time and computes the mean occupancies of the states in equidistant time bins,
+       *        i.e. the fraction of time spent in a state averaged over all instances.
+       * @param t_end       The time horizon in seconds. Needs to be larger than time().
+       * @param num_bins    The number of time bins. Bin k covers [time() + k * h, time() + (k+1) * h) with h = (t_end - time()) / num_bins
+       * @param occupancies The mean occupancies. occupancies[k * num_states + s] is the mean occupancy of state s in bin k, where num_states
+       *                    is the maximum number of states of all instances.
+       */
+      void mean_occupancies(double t_end, std::size_t num_bins, std::vector<double> & occupancies)
+      {
+        check_horizon(t_end);
+
+        index_type num_states = 0;
+        for (std::size_t i = 0; i < tables_.size(); ++i)
+          num_states = std::max(num_states, tables_[i].num_states());
+
+        const double t_begin = time_;
+        const double h       = (t_end - t_begin) / static_cast<double>(num_bins > 0 ? num_bins : 1);
+
+        // Accumulate per chunk and sum the chunks in a fixed order, such that the result does not depend on the scheduling of the threads
+        std::vector<std::vector<double> > chunk_occupancies(num_chunks(), std::vector<double>(num_bins * num_states, 0.0));
+
+        this->run(t_end, [&](std::size_t chunk, std::size_t instance)
+        {
+          occupancy_binner binner(t_begin, h, num_bins, num_states, chunk_occupancies[chunk]);
+          this->advance(instance, t_begin, t_end, binner);
+        });
+
+        occupancies.assign(num_bins * num_states, 0.0);
+        for (std::size_t c = 0; c < chunk_occupancies.size(); ++c)
+          for (std::size_t k = 0; k < occupancies.size(); ++k)
+            occupancies[k] += chunk_occupancies[c][k];
+
+        const double scale = (this->size() > 0) ? 1.0 / static_cast<double>(this->size()) : 0.0;
+        for (std::size_t k = 0; k < occupancies.size(); ++k)
+          occupancies[k] *= scale;
+      }
+
+    private:
+
+      typedef viennashe::math::philox_generator<double>   generator_type;
+
+      /** @brief The number of instances handled by a worker at a time */
+      static std::size_t chunk_size() { return 64; }
+
+      std::size_t num_chunks() const { return (this->size() + chunk_size() - 1) / chunk_size(); }
+
+      static std::size_t default_num_threads()
+      {
+        const std::size_t n = std::thread::hardware_concurrency();
+        return (n > 0) ? n : 1;
+      }
+
+      static index_type occupied_state(viennashe::models::chain const & c)
+      {
+        for (index_type i = 0; i < c.size1(); ++i)
+          if (c.has_state(i) && c.get_state(i).occupancy() == 1.0)
+            return i;
+        return 0;
+      }
+
+      void check_horizon(double t_end) const
+      {
+        if (!(t_end > time_))
+          throw viennashe::invalid_value_exception("ssa_ensemble: The time horizon needs to be larger than the current time, but is ", t_end);
+      }
+
+      /** @brief Calls job(chunk, instance) for all instances on the worker threads, advances the time and writes back the states to the chains */
+      template <typename JobT>
+      void run(double t_end, JobT job)
+      {
+        std::atomic<std::size_t> next_chunk(0);
+        std::atomic<bool>        failed(false);
+        std::exception_ptr       error;
+        std::mutex               error_mutex;
+
+        auto worker = [&]()
+        {
+          try
+          {
+            for (std::size_t c = next_chunk++; c < num_chunks() && !failed; c = next_chunk++)
+              for (std::size_t i = c * chunk_size(); i < std::min((c+1) * chunk_size(), this->size()); ++i)
+                job(c, i);
+          }
+          catch (...)
+          {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error)
+              error = std::current_exception();
+            failed = true;
+          }
+        };
+
+        const std::size_t num_workers = std::min(num_threads_, num_chunks());
+        std::vector<std::thread> threads;
+        for (std::size_t t = 1; t < num_workers; ++t)
+          threads.push_back(std::thread(worker));
+        worker();
+        for (std::size_t t = 0; t < threads.size(); ++t)
+          threads[t].join();
+
+        if (error)
+          std::rethrow_exception(error);
+
+        time_ = t_end;
+
+        for (std::size_t i = 0; i < chains_.size(); ++i)
+          for (index_type s = 0; s < chains_[i]->size1(); ++s)
+            chains_[i]->get_state(s).occupancy(s == states_[i] ? 1.0 : 0.0);
+      }
+
+      /**
+       * @brief Advances a single instance from t_begin to t_end. Calls observer(state, t_from, t_to) for each time interval spent in a state.
+       *        An event beyond t_end is discarded, which is exact due to the lack of memory of Markov-Chains.
+       *        Instances in a state without outgoing rates (absorbing state) stay in this state.
+       */
+      template <typename ObserverT>
+      void advance(std::size_t instance, double t_begin, double t_end, ObserverT & observer)
+      {
+        generator_type rnd(seed_, instance);
+        rnd.position(positions_[instance]);
+        viennashe::models::rate_table const & table = tables_[instance];
+
+        index_type s = states_[instance];
+        double     t = t_begin;
+        while (true)
+        {
+          const double a0     = table.total_rate(s);
+          double       t_next = t_end;
+          index_type   next   = s;
+
+          if (a0 > 0.0)
+          {
+            double r1 = 1.0 - rnd();
+            { while (!r1) r1 = 1.0 - rnd(); } // Exclude 0.0
+            const double r2 = rnd();
+
+            const double dt = 1.0/a0 * std::log( 1.0/r1 );
+            if (t + dt < t_end)
+            {
+              t_next = t + dt;
+              next   = table.select(s, r2 * a0);
+              if (next >= table.num_states())
+                throw viennashe::models::model_evaluation_exception("ssa_ensemble: The SSA algorithm failed to find the next state!");
+            }
+          }
+
+          observer(s, t, t_next);
+          if (t_next >= t_end)
+            break;
+          t = t_next;
+          s = next;
+        }
+        states_[instance]    = s;
+        positions_[instance] = rnd.position();
+      }
+
+      /** @brief Records the state at equidistant sample times */
+      struct state_sampler
+      {
+        state_sampler(double t_begin, double h, std::size_t num_samples, double t_end, index_type * trace)
+          : t_begin_(t_begin), h_(h), num_samples_(num_samples), t_end_(t_end), trace_(trace), k_(0) { }
+
+        void operator()(index_type s, double /*t_from*/, double t_to)
+        {
+          for ( ; k_ < num_samples_; ++k_)
+          {
+            const double t_sample = (k_ + 1 < num_samples_) ? t_begin_ + static_cast<double>(k_ + 1) * h_ : t_end_;
+            if (t_sample >= t_to && t_to < t_end_)
+              break;
+            trace_[k_] = s;
+          }
+        }
+
+        double        t_begin_;
+        double        h_;
+        std::size_t   num_samples_;
+        double        t_end_;
+        index_type  * trace_;
+        std::size_t   k_;
+      };
+
+      /** @brief Accumulates the time spent in each state per time bin (normalized to the bin width) */
+      struct occupancy_binner
+      {
+        occupancy_binner(double t_begin, double h, std::size_t num_bins, index_type num_states, std::vector<double> & occupancies)
+          : t_begin_(t_begin), h_(h), num_bins_(num_bins), num_states_(num_states), occupancies_(occupancies) { }
+
+        void operator()(index_type s, double t_from, double t_to)
+        {
+          if (num_bins_ == 0)
+            return;
+
+          std::size_t k = static_cast<std::size_t>((t_from - t_begin_) / h_);
+          for ( ; k < num_bins_; ++k)
+          {
+            const double bin_begin = t_begin_ + static_cast<double>(k) * h_;
+            const double bin_end   = bin_begin + h_;
+            const double overlap   = std::min(t_to, bin_end) - std::max(t_from, bin_begin);
+            if (overlap > 0.0)
+              occupancies_[k * num_states_ + s] += overlap / h_;
+            if (t_to <= bin_end)
+              break;
+          }
+        }
+
+        double                t_begin_;
+        double                h_;
+        std::size_t           num_bins_;
+        index_type            num_states_;
+        std::vector<double> & occupancies_;
+      };
+
+      std::vector<viennashe::models::chain *>      chains_;
+      std::vector<viennashe::models::rate_table>   tables_;
+      std::vector<index_type>                      states_;
+      std::vector<uint64_t>                        positions_;  // positions in the random number streams
+
+      uint64_t      seed_;
+      double        time_;
+      std::size_t   num_threads_;
+    };
+
+  } // namespace models
+} // namespace viennashe
+
+#endif /* VIENNASHE_MODELS_MARKOVCHAIN_ENSEMBLE_HPP */
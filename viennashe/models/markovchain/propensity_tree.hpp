@@ -0,0 +1,126 @@
+#ifndef VIENNASHE_MODELS_MARKOVCHAIN_PROPENSITY_TREE_HPP
+#define VIENNASHE_MODELS_MARKOVCHAIN_PROPENSITY_TREE_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <vector>
+#include <cstddef>
+
+/** @file viennashe/models/markovchain/propensity_tree.hpp
+    @brief Contains a sum tree for the selection of events proportional to their propensities (rates) in logarithmic time
+ */
+
+namespace viennashe
+{
+  namespace models
+  {
+
+    /** @brief A sum tree (binary indexed tree) over non-negative weights.
+     *
+     *  Setting a weight, computing a prefix sum and selecting the index i with prefix_sum(i) <= u < prefix_sum(i+1)
+     *  take O(log n) operations. Negative weights are treated as zero, i.e. the resp. events are never selected.
+     */
+    class propensity_tree
+    {
+    public:
+      typedef std::size_t size_type;
+
+      propensity_tree() {}
+
+      /** @brief Builds the tree from the given weights in O(n) */
+      explicit propensity_tree(std::vector<double> const & weights) { this->assign(weights); }
+
+      /** @brief Replaces all weights in O(n). Also removes rounding errors accumulated by set() */
+      void assign(std::vector<double> const & weights)
+      {
+        weights_.resize(weights.size());
+        tree_.assign(weights.size() + 1, 0.0);
+        for (size_type i = 0; i < weights.size(); ++i)
+        {
+          weights_[i] = (weights[i] > 0.0) ? weights[i] : 0.0;
+          tree_[i+1] += weights_[i];
+          const size_type parent = (i+1) + lowbit(i+1);
+          if (parent < tree_.size())
+            tree_[parent] += tree_[i+1];
+        }
+      }
+
+      /** @brief Returns the number of weights */
+      size_type size() const { return weights_.size(); }
+
+      /** @brief Returns the i-th weight */
+      double weight(size_type i) const { return weights_.at(i); }
+
+      /** @brief Sets the i-th weight in O(log n) */
+      void set(size_type i, double w)
+      {
+        if (w < 0.0) w = 0.0;
+        const double delta = w - weights_.at(i);
+        weights_[i] = w;
+        for (size_type k = i + 1; k < tree_.size(); k += lowbit(k))
+          tree_[k] += delta;
+      }
+
+      /** @brief Returns the sum of the weights 0, ..., k-1 in O(log n) */
+      double prefix_sum(size_type k) const
+      {
+        double sum = 0;
+        for ( ; k > 0; k -= lowbit(k))
+          sum += tree_[k];
+        return sum;
+      }
+
+      /** @brief Returns the sum of all weights */
+      double total() const { return this->prefix_sum(this->size()); }
+
+      /**
+       * @brief Selects an index proportional to the weights in O(log n)
+       * @param u A value in [0, total())
+       * @return The index i with prefix_sum(i) <= u < prefix_sum(i+1). Indices with zero weight are never returned,
+       *         except for size() if u >= total() (e.g. due to rounding)
+       */
+      size_type find(double u) const
+      {
+        size_type pos = 0;
+        size_type mask = 1;
+        while (2 * mask < tree_.size())
+          mask *= 2;
+
+        for ( ; mask > 0; mask /= 2)
+        {
+          const size_type next = pos + mask;
+          if (next < tree_.size() && tree_[next] <= u)
+          {
+            pos = next;
+            u  -= tree_[next];
+          }
+        }
+        // guard against rounding in the partial sums: never return an index with zero weight
+        while (pos < weights_.size() && weights_[pos] <= 0.0)
+          ++pos;
+        return pos;
+      }
+
+    private:
+      static size_type lowbit(size_type k) { return k & (~k + 1); }
+
+      std::vector<double> weights_;
+      std::vector<double> tree_; // one-based
+    };
+
+  } // namespace models
+} // namespace viennashe
+
+#endif /* VIENNASHE_MODELS_MARKOVCHAIN_PROPENSITY_TREE_HPP */
@@ -0,0 +1,193 @@
+#ifndef VIENNASHE_MODELS_MARKOVCHAIN_RATE_TABLE_HPP
+#define VIENNASHE_MODELS_MARKOVCHAIN_RATE_TABLE_HPP
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <vector>
+#include <algorithm>
+
+// viennashe
+#include "viennashe/models/markovchain/exception.hpp"
+#include "viennashe/models/markovchain/reaction_rates.hpp"
+#include "viennashe/models/markovchain/chain.hpp"
+#include "viennashe/models/markovchain/propensity_tree.hpp"
+
+/** @file viennashe/models/markovchain/rate_table.hpp
+    @brief Contains a flat (compressed row) table of the rates of a Markov-Chain for the SSA algorithm (cf. viennashe/models/markovchain/ssa.hpp)
+ */
+
+namespace viennashe
+{
+  namespace models
+  {
+
+    /** @brief The rates of a Markov-Chain compiled into flat arrays (compressed row storage, one row per from-state)
+     *         with a propensity tree per row.
+     *
+     *  The rate objects (rate_base) are referenced, hence the chain must outlive the table. Rates are evaluated by update(),
+     *  changes of the structure of the chain (added states or rates) require a new call to compile().
+     *  The total rate out of a state, the selection of a transition and the update of a single rate take O(log n),
+     *  where n is the number of transitions out of the state.
+     */
+    class rate_table
+    {
+    public:
+      typedef viennashe::models::chain::index_type index_type;
+
+      rate_table() : row_begin_(1, 0) { }
+
+      /** @brief CTOR. Compiles the given chain, cf. compile() */
+      explicit rate_table(viennashe::models::chain const & c) : row_begin_(1, 0) { this->compile(c); }
+
+      /**
+       * @brief Compiles the structure of the chain and evaluates all rates
+       * @param c The chain. The states need to have the ids 0, ..., c.size1()-1
+       */
+      void compile(viennashe::models::chain const & c)
+      {
+        const index_type num_states = c.size1();
+        for (index_type i = 0; i < num_states; ++i)
+          if (!c.has_state(i))
+            throw viennashe::models::invalid_state_exception("rate_table.compile(): State does not exist!", i);
+
+        csr_builder builder(num_states);
+        c.for_each_rate(builder);
+
+        row_begin_.swap(builder.row_begin);
+        to_.swap(builder.to);
+        rates_.swap(builder.rates);
+
+        // count -> offsets
+        for (index_type i = 0; i < num_states; ++i)
+          row_begin_[i+1] += row_begin_[i];
+
+        this->update();
+      }
+
+      /** @brief Returns the number of states */
+      index_type num_states() const { return row_begin_.size() - 1; }
+
+      /** @brief Returns the number of transitions (non-zero entries of the rate matrix) */
+      std::size_t num_transitions() const { return to_.size(); }
+
+      /** @brief Evaluates all rates (rate_base::value()). Call this after changing parameters the rates depend on. */
+      void update()
+      {
+        trees_.resize(this->num_states());
+        std::vector<double> values;
+        for (index_type i = 0; i < this->num_states(); ++i)
+        {
+          values.resize(row_begin_[i+1] - row_begin_[i]);
+          for (std::size_t k = row_begin_[i]; k < row_begin_[i+1]; ++k)
+            values[k - row_begin_[i]] = rates_[k]->value();
+          trees_[i].assign(values);
+        }
+      }
+
+      /** @brief Evaluates the rate between the given states only. Takes O(log n) instead of O(number of transitions) for update() */
+      void update(index_type from, index_type to)
+      {
+        const std::size_t k = this->find_entry(from, to);
+        if (k >= to_.size())
+          throw viennashe::models::invalid_state_exception("rate_table.update(): There is no rate between the given states!", to);
+        trees_[from].set(k - row_begin_[from], rates_[k]->value());
+      }
+
+      /** @brief Sets the rate between the given states to the given value instead of evaluating the rate object. Overwritten by the next update(). */
+      void set(index_type from, index_type to, double value)
+      {
+        const std::size_t k = this->find_entry(from, to);
+        if (k >= to_.size())
+          throw viennashe::models::invalid_state_exception("rate_table.set(): There is no rate between the given states!", to);
+        trees_[from].set(k - row_begin_[from], value);
+      }
+
+      /** @brief Returns the rate between the given states as evaluated by the last update (zero for non-existent or negative rates) */
+      double rate(index_type from, index_type to) const
+      {
+        const std::size_t k = this->find_entry(from, to);
+        return (k < to_.size()) ? trees_[from].weight(k - row_begin_[from]) : 0.0;
+      }
+
+      /** @brief Returns the sum of all rates out of the given state */
+      double total_rate(index_type from) const { return trees_.at(from).total(); }
+
+      /**
+       * @brief Selects a transition out of the given state with a probability proportional to its rate
+       * @param from The state
+       * @param u    A value in [0, total_rate(from)), i.e. a random number in [0,1) times total_rate(from)
+       * @return The to-state of the transition. num_states() if there is no transition with a positive rate
+       */
+      index_type select(index_type from, double u) const
+      {
+        propensity_tree const & tree = trees_.at(from);
+        std::size_t k = tree.find(u);
+        if (k >= tree.size()) // u >= total due to rounding: take the last transition with a positive rate
+        {
+          while (k > 0 && tree.weight(k-1) <= 0.0) --k;
+          if (k == 0)
+            return this->num_states();
+          --k;
+        }
+        return to_[row_begin_[from] + k];
+      }
+
+    private:
+
+      /** @brief Collects the rates of a chain row by row (for_each_rate() visits the rates ordered by from-state and to-state) */
+      struct csr_builder
+      {
+        csr_builder(index_type num_states) : row_begin(num_states + 1, 0) { }
+
+        void operator()(index_type from, index_type to_state, rate_base const & r)
+        {
+          if (from + 1 >= row_begin.size())
+            throw viennashe::models::invalid_state_exception("rate_table.compile(): State does not exist!", from);
+          if (to_state + 1 >= row_begin.size())
+            throw viennashe::models::invalid_state_exception("rate_table.compile(): State does not exist!", to_state);
+
+          row_begin[from + 1] += 1;
+          to.push_back(to_state);
+          rates.push_back(&r);
+        }
+
+        std::vector<std::size_t>         row_begin;
+        std::vector<index_type>          to;
+        std::vector<rate_base const *>   rates;
+      };
+
+      /** @brief Returns the position of the rate between the given states in the flat arrays, num_transitions() if there is none */
+      std::size_t find_entry(index_type from, index_type to) const
+      {
+        if (from >= this->num_states())
+          throw viennashe::models::invalid_state_exception("rate_table: State does not exist!", from);
+
+        std::vector<index_type>::const_iterator row_end = to_.begin() + static_cast<std::ptrdiff_t>(row_begin_[from+1]);
+        std::vector<index_type>::const_iterator it      = std::lower_bound(to_.begin() + static_cast<std::ptrdiff_t>(row_begin_[from]), row_end, to);
+        if (it == row_end || *it != to)
+          return to_.size();
+        return static_cast<std::size_t>(it - to_.begin());
+      }
+
+      std::vector<std::size_t>        row_begin_;  // offsets of the rows in to_ and rates_
+      std::vector<index_type>         to_;         // to-states, sorted within each row
+      std::vector<rate_base const *>  rates_;      // the rates of the chain
+      std::vector<propensity_tree>    trees_;      // evaluated rates, one tree per row
+    };
+
+  } // namespace models
+} // namespace viennashe
+
+#endif /* VIENNASHE_MODELS_MARKOVCHAIN_RATE_TABLE_HPP */
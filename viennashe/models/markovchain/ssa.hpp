@@ -21,6 +21,7 @@
 
 #include "viennashe/models/markovchain/reaction_rates.hpp"
 #include "viennashe/models/markovchain/chain.hpp"
+#include "viennashe/models/markovchain/rate_table.hpp"
 #include "viennashe/math/random.hpp"
 
 #include "viennashe/math/linalg_util.hpp"
@@ -40,6 +41,10 @@ namespace viennashe
      *         and the occupancies p_i of the states are being changed.
      *         The resp. occupancies can either be 1.0 (occupied) or 0 (unoccupied)!
      *         The solver additionally guarantees that sum_i p_i = 1.0, i.e. only one state is occupied at a time !
+     *
+     *         The rates are compiled into a flat rate table (cf. rate_table) on construction, such that an event takes O(log n) operations,
+     *         where n is the number of transitions out of the occupied state. Call update_rates() or update_rate() after changing
+     *         parameters the rates depend on. Changes of the structure of the chain require a new solver.
      */
     class ssa_solver
     {
@@ -47,7 +52,7 @@ namespace viennashe
       typedef viennashe::models::chain::index_type index_type;
 
       /** @brief CTOR. */
-      ssa_solver(viennashe::models::chain & c) : chain_(c), dt_(0) { }
+      ssa_solver(viennashe::models::chain & c) : chain_(c), rates_(c), occupied_(c.size1()), dt_(0) { }
 
       /** @brief Returns the last time step dt in seconds */
       double delta_t() const { return dt_; }
@@ -78,6 +83,7 @@ namespace viennashe
           chain_.get_state(j).occupancy(0.0);
         // Set the lucky occupancy to 1
         chain_.get_state(i).occupancy(1.0);
+        occupied_ = i;
       }
 
       /**
@@ -88,7 +94,8 @@ namespace viennashe
       double solve(viennashe::math::rand_generator_base<double> & rnd)
       {
         double dt = 0;
-        const double a0 = this->sum_rates();
+        const index_type i = this->occupied_state();
+        const double a0 = (i < rates_.num_states()) ? rates_.total_rate(i) : 0.0;
 
         if (a0 <= 0.0)
           throw viennashe::models::model_evaluation_exception("ssa.solve(): The sum of rates is zero or negative!");
@@ -99,58 +106,47 @@ namespace viennashe
 
         dt = 1.0/a0 * std::log( 1.0/r1 );
 
-        double sum = 0;
-        index_type i = 0;
-        index_type j = 0;
-        for (i = 0; i < chain_.size1(); ++i)
-        {
-          if(chain_.get_state(i).occupancy() != 1.0) continue;
-
-          for (j = 0; j < chain_.size2(); ++j)
-          {
-            const double kij = chain_.get_rate(i, j);
-
-            if (kij <= 0.0) continue; // skip non-existent rates
+        const index_type j = rates_.select(i, r2 * a0);
 
-            const double pij = kij / a0;
-            sum += pij;
-            if (r2 <= sum) break; // we found the transition
-          }
-          if (r2 <= sum) break; // we found the transition
-        }
-
-        if (i >= chain_.size1())
+        if (j >= rates_.num_states())
           throw viennashe::models::model_evaluation_exception("ssa.solve(): The SSA algorithm failed to find the next state!");
 
-        chain_.get_state(j).occupancy(1.0);
         chain_.get_state(i).occupancy(0.0);
+        chain_.get_state(j).occupancy(1.0);
+        occupied_ = j;
 
         this->dt_ = dt; // Cache delta time
         return this->delta_t();
       }
 
+      /** @brief Evaluates all rates of the chain again. Call this after changing parameters the rates depend on. */
+      void update_rates() { rates_.update(); }
+
+      /** @brief Evaluates the rate between the given states again, cf. update_rates() */
+      void update_rate(index_type from, index_type to) { rates_.update(from, to); }
+
+      /** @brief Returns the table of rates as evaluated by the last update */
+      viennashe::models::rate_table const & rates() const { return this->rates_; }
+
       viennashe::models::chain const &  chain() const { return this->chain_;  }
 
     private:
 
-      double sum_rates() const
+      /** @brief Returns the occupied state. Scans the chain only if the occupancies have been changed from outside of the solver */
+      index_type occupied_state()
       {
-        double sum = 0;
-        for (index_type i = 0; i < chain_.size1(); ++i)
-        {
-          if(chain_.get_state(i).occupancy() != 1.0) continue;
-
-          for (index_type j = 0; j < chain_.size2(); ++j)
-          {
-            const double kij = chain_.get_rate(i, j);
-            if (kij <= 0.0) continue;
-            sum += kij;
-          }
-        }
-        return sum;
+        if (occupied_ < chain_.size1() && chain_.get_state(occupied_).occupancy() == 1.0)
+          return occupied_;
+
+        for (occupied_ = 0; occupied_ < chain_.size1(); ++occupied_)
+          if (chain_.get_state(occupied_).occupancy() == 1.0)
+            break;
+        return occupied_;
       }
 
       viennashe::models::chain & chain_;
+      viennashe::models::rate_table rates_;
+      index_type occupied_;
       double dt_;
     };
 
@@ -23,8 +23,11 @@
 #include "viennashe/she/scattering/assemble_ee_scattering.hpp"
 #include "viennashe/she/assemble_traps.hpp"
 
+#include "viennashe/exception.hpp"
 #include "viennashe/log/log.hpp"
 #include "viennashe/she/log_keys.h"
+#include "viennashe/util/memory.hpp"
+#include "viennashe/util/profiler.hpp"
 
 #include "viennashe/postproc/electric_field.hpp"
 
@@ -37,6 +40,10 @@ namespace viennashe
   namespace she
   {
 
+    /** @brief Assembles the SHE equations for the given SHE quantity
+     *
+     * @param coupling   The coupling matrices for the maximum expansion order of 'conf', usually computed once per simulator (cf. simulator::she_coupling_matrices())
+     */
     template <typename DeviceType,
               typename TimeStepQuantitiesT,
               typename VertexT,
@@ -48,6 +55,7 @@ namespace viennashe
                    TimeStepQuantitiesT & quantities,
                    viennashe::config const & conf,
                    viennashe::she::unknown_she_quantity<VertexT, EdgeT> const & quan,
+                   viennashe::she::coupling_matrices const & coupling,
                    MatrixType & A,
                    VectorType & b,
                    bool use_timedependence, bool quan_valid)
@@ -106,38 +114,35 @@ namespace viennashe
           scatter_op_out(i,i) += 1.0;
         scatter_op_in(0,0) += 1.0;
 
-        //// preprocessing: compute coefficients a_{l,m}^{l',m'} and b_{l,m}^{l',m'}
-        std::size_t Lmax = static_cast<std::size_t>(conf.max_expansion_order());            //maximum expansion order
-        std::size_t coupling_rows = static_cast<std::size_t>((Lmax+1) * (Lmax+1));
-        std::size_t coupling_cols = coupling_rows;
+        //// coefficients a_{l,m}^{l',m'} and b_{l,m}^{l',m'}, precomputed for the simulator
+        if (coupling.max_expansion_order() != conf.max_expansion_order())
+          throw viennashe::invalid_value_exception("she::assemble(): Coupling matrices computed for a different maximum expansion order", static_cast<double>(coupling.max_expansion_order()));
 
-        log::debug<log_assemble_all>() << "* assemble_all(): Computing coupling matrices..." << std::endl;
-        CouplingMatrixType identity(coupling_rows, coupling_cols);
-        for (std::size_t i=0; i<coupling_rows; ++i)
-          for (std::size_t j=0; j<coupling_cols; ++j)
-            identity(i,j) = (i == j) ? 1.0 : 0.0;
+        CouplingMatrixType const & identity = coupling.identity();
 
-        CouplingMatrixType a_x(coupling_rows, coupling_cols);
-        CouplingMatrixType a_y(coupling_rows, coupling_cols);
-        CouplingMatrixType a_z(coupling_rows, coupling_cols);
+        CouplingMatrixType const & a_x = coupling.a_x();
+        CouplingMatrixType const & a_y = coupling.a_y();
+        CouplingMatrixType const & a_z = coupling.a_z();
 
+        CouplingMatrixType const & b_x = coupling.b_x();
+        CouplingMatrixType const & b_y = coupling.b_y();
+        CouplingMatrixType const & b_z = coupling.b_z();
 
-        CouplingMatrixType b_x(coupling_rows, coupling_cols);
-        CouplingMatrixType b_y(coupling_rows, coupling_cols);
-        CouplingMatrixType b_z(coupling_rows, coupling_cols);
+        CouplingMatrixType const & a_x_transposed = coupling.a_x_transposed();
+        CouplingMatrixType const & a_y_transposed = coupling.a_y_transposed();
+        CouplingMatrixType const & a_z_transposed = coupling.a_z_transposed();
 
-        //note: interchanged coordinates
-        fill_coupling_matrices(a_x, a_y, a_z,
-                               b_x, b_y, b_z,
-                               static_cast<int>(Lmax));
+        CouplingMatrixType const & b_x_transposed = coupling.b_x_transposed();
+        CouplingMatrixType const & b_y_transposed = coupling.b_y_transposed();
+        CouplingMatrixType const & b_z_transposed = coupling.b_z_transposed();
 
-        CouplingMatrixType a_x_transposed = a_x.trans();
-        CouplingMatrixType a_y_transposed = a_y.trans();
-        CouplingMatrixType a_z_transposed = a_z.trans();
-
-        CouplingMatrixType b_x_transposed = b_x.trans();
-        CouplingMatrixType b_y_transposed = b_y.trans();
-        CouplingMatrixType b_z_transposed = b_z.trans();
+        using viennashe::util::memory_bytes;
+        viennashe::util::tracked_memory coupling_matrices_memory("coupling_matrices",
+                                                                 memory_bytes(scatter_op_in) + memory_bytes(scatter_op_out) + memory_bytes(identity)
+                                                                 + memory_bytes(a_x) + memory_bytes(a_y) + memory_bytes(a_z)
+                                                                 + memory_bytes(b_x) + memory_bytes(b_y) + memory_bytes(b_z)
+                                                                 + memory_bytes(a_x_transposed) + memory_bytes(a_y_transposed) + memory_bytes(a_z_transposed)
+                                                                 + memory_bytes(b_x_transposed) + memory_bytes(b_y_transposed) + memory_bytes(b_z_transposed));
 
         if (log_assemble_all::enabled && log_assemble_all::debug)
         {
@@ -216,6 +221,7 @@ namespace viennashe
         if (quan_valid && conf.scattering().electron_electron() && conf.with_electrons())
         {
           log::debug<log_assemble_all>() << "assemble(): Electron electron scattering is ENABLED!" << std::endl;
+          viennashe::util::profiler_scope ee_scattering_scope("ee_scattering");
           assemble_ee_scattering(device, conf, quan, old_quan, A, b);
         }
 
@@ -223,6 +229,7 @@ namespace viennashe
         // Step 1: Assemble on even nodes
         //
         log::debug<log_assemble_all>() << "* assemble_all(): Even unknowns..." << std::endl;
+        viennashe::util::profiler_scope even_scope("even_unknowns");
 
         CellContainer cells(mesh);
         for (CellIterator cit = cells.begin();
@@ -312,7 +319,9 @@ namespace viennashe
         //
         // Step 2: Assemble on odd 'nodes' (i.e. facets). TODO: Resolve code duplication w.r.t. above
         //
+        even_scope.stop();
         log::info<log_assemble_all>() << "* assemble_all(): Odd unknowns..." << std::endl;
+        viennashe::util::profiler_scope odd_scope("odd_unknowns");
 
         FacetContainer facets(mesh);
         for (FacetIterator fit = facets.begin();
@@ -391,12 +400,14 @@ namespace viennashe
           }
 
         } //for facets
+        odd_scope.stop();
 
 
         // Assemble traps on cells (to be integrated into the assembly above):
         if (conf.with_traps())
         {
           log::debug<log_assemble_all>() << "assemble(): Assembly for traps ..." << std::endl;
+          viennashe::util::profiler_scope traps_scope("traps");
           viennashe::she::assemble_traps(device, quantities, conf, quan, A, b);
         }
 
@@ -422,6 +433,30 @@ namespace viennashe
 */
 
     }
+
+    /** @brief Convenience overload computing the coupling matrices for the maximum expansion order of 'conf' on the fly. Prefer passing them in when assembling repeatedly. */
+    template <typename DeviceType,
+              typename TimeStepQuantitiesT,
+              typename VertexT,
+              typename EdgeT,
+              typename MatrixType,
+              typename VectorType>
+    void assemble( DeviceType & device,
+                   TimeStepQuantitiesT & old_quantities,
+                   TimeStepQuantitiesT & quantities,
+                   viennashe::config const & conf,
+                   viennashe::she::unknown_she_quantity<VertexT, EdgeT> const & quan,
+                   MatrixType & A,
+                   VectorType & b,
+                   bool use_timedependence, bool quan_valid)
+    {
+      viennashe::util::profiler_scope coupling_matrices_scope("coupling_matrices");
+      viennashe::she::coupling_matrices coupling(conf.max_expansion_order());
+      coupling_matrices_scope.stop();
+
+      viennashe::she::assemble(device, old_quantities, quantities, conf, quan, coupling, A, b, use_timedependence, quan_valid);
+    }
+
   } //namespace she
 } //namespace viennashe
 
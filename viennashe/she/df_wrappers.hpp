@@ -16,6 +16,7 @@
 =============================================================================== */
 
 #include <cmath>
+#include <vector>
 
 #include "viennashe/forwards.h"
 #include "viennashe/physics/constants.hpp"
@@ -367,6 +368,7 @@ namespace viennashe
     /** @brief A convenience wrapper for evaluating the full distribution function.
      * Note: Evaluations are quite costly. If you wish to evaluate integrals over the distribution function,
      * you should definitely consider the use of SHE expansion coefficients as well as the orthogonality relations for spherical harmonics.
+     * The values of the spherical harmonics are buffered in the wrapper, so a single wrapper must not be evaluated concurrently.
      *
      * @tparam DeviceType      The device type on which to evaluate the distribution function
      * @tparam VectorType      Vector type used for the SHE result vector.
@@ -393,7 +395,9 @@ namespace viennashe
                    viennashe::config const & conf,
                    SHEQuantityT const & quan)
         : she_unknown_(quan),
-          interpolated_she_df_(device, conf, quan) {}
+          interpolated_she_df_(device, conf, quan),
+          Y_evaluator_(conf.max_expansion_order()),
+          Y_values_(Y_evaluator_.size()) {}
 
         /** @brief Returns the energy distribution function for electrons in one valley on a vertex:
          *
@@ -427,14 +431,19 @@ namespace viennashe
           std::size_t index_H = detail::find_best_H(she_unknown_, cell, kinetic_energy, index_H_guess);
           std::size_t L = she_unknown_.get_expansion_order(cell, index_H);
 
+          // The index of Y_lm does not depend on the maximum order, so the values up to the maximum expansion order serve any L up to it:
+          if (static_cast<long>(L) > Y_evaluator_.max_order())
+          {
+            Y_evaluator_ = viennashe::math::spherical_harmonics_evaluator(static_cast<long>(L));
+            Y_values_.resize(Y_evaluator_.size());
+          }
+          Y_evaluator_(theta, phi, &(Y_values_[0]));
+
           double result = 0;
           for (std::size_t l=0; l <= L; ++l)
           {
             for (int m = -static_cast<int>(l); m <= static_cast<int>(l); ++m)
-            {
-              viennashe::math::SphericalHarmonic Y_lm(static_cast<int>(l),m);
-              result += interpolated_she_df_(cell, kinetic_energy, l, m, index_H) * Y_lm(theta, phi);
-            }
+              result += interpolated_she_df_(cell, kinetic_energy, l, m, index_H) * Y_values_[viennashe::math::spherical_harmonics_evaluator::index(static_cast<long>(l), m)];
           }
 
           return result;
@@ -442,6 +451,8 @@ namespace viennashe
 
         UnknownSHEType she_unknown_;
         interpolated_she_df_wrapper<DeviceType, SHEQuantityT>  interpolated_she_df_;
+        mutable viennashe::math::spherical_harmonics_evaluator Y_evaluator_;
+        mutable std::vector<double> Y_values_;   // values of all Y_lm at the last (theta, phi)
     };
 
 
@@ -17,11 +17,15 @@
 
 // std
 #include <math.h>
+#include <vector>
+#include <algorithm>
 
 // viennashe
 #include "viennashe/math/constants.hpp"
+#include "viennashe/math/linalg_util.hpp"
 #include "viennashe/math/spherical_harmonics.hpp"
 #include "viennashe/math/integrator.hpp"
+#include "viennashe/math/tensor_quadrature.hpp"
 #include "viennashe/physics/constants.hpp"
 
 #include "viennashe/log/log.hpp"
@@ -200,6 +204,70 @@ namespace viennashe
     };
 
 
+    ////////////////////////////// batched integrals ////////////////////////////////
+    //
+    //  All six components [vIntegrand_x, vIntegrand_y, vIntegrand_z, GammaIntegrand_x, GammaIntegrand_y, GammaIntegrand_z]
+    //  for use with viennashe::math::tensor_quadrature_2d
+    //
+
+    /** @brief The components of the velocity and Gamma coupling integrals (cf. vIntegrand_x, ..., GammaIntegrand_z) evaluated on arrays of angles.
+     *         The spherical harmonics and their derivatives are obtained from a single evaluation of all spherical harmonics per node.
+     */
+    class coupling_integrand
+    {
+        public:
+            coupling_integrand(int n, int m, int n1, int m1) : n_(n), m_(m), n1_(n1), m1_(m1), evaluator_(std::max(n, n1)) {}
+
+            std::size_t num_components() const { return 6; }
+
+            void operator()(std::size_t num_points, double const * theta, double const * phi, double * values) const
+            {
+                typedef viennashe::math::spherical_harmonics_evaluator    EvaluatorType;
+
+                std::vector<double> Y(evaluator_.size());
+                const double c_theta = (std::abs(m_) < n_) ? sqrt( (n_*n_ - m_*m_) * (2.0*n_ + 1.0) / (2.0*n_ - 1.0) ) : 0.0;
+
+                for (std::size_t k = 0; k < num_points; ++k)
+                {
+                    evaluator_(theta[k], phi[k], &Y[0]);
+
+                    const double cos_theta = cos(theta[k]);
+                    const double sin_theta = sin(theta[k]);
+                    const double cos_phi   = cos(phi[k]);
+                    const double sin_phi   = sin(phi[k]);
+
+                    const double Y_nm   = Y[EvaluatorType::index(n_, m_)];
+                    const double Y_n1m1 = Y[EvaluatorType::index(n1_, m1_)];
+
+                    // cf. SphericalHarmonic_dTheta and SphericalHarmonic_dPhi
+                    double Y_theta = 0.0;
+                    if (n_ > 0)
+                    {
+                        Y_theta = n_ * cos_theta * Y_nm;
+                        if (std::abs(m_) < n_)
+                            Y_theta -= c_theta * Y[EvaluatorType::index(n_ - 1, m_)];
+                        Y_theta /= sin_theta;
+                    }
+                    const double Y_phi = (m_ == 0) ? 0.0 : m_ * Y[EvaluatorType::index(n_, -m_)];
+
+                    values[0 * num_points + k] = Y_nm * sin_theta * cos_phi * Y_n1m1 * sin_theta;
+                    values[1 * num_points + k] = Y_nm * sin_theta * sin_phi * Y_n1m1 * sin_theta;
+                    values[2 * num_points + k] = Y_nm * cos_theta * Y_n1m1 * sin_theta;
+                    values[3 * num_points + k] = (Y_theta * cos_theta * cos_phi * sin_theta - Y_phi * sin_phi) * Y_n1m1;
+                    values[4 * num_points + k] = (Y_theta * cos_theta * sin_phi * sin_theta + Y_phi * cos_phi) * Y_n1m1;
+                    values[5 * num_points + k] = Y_theta * (-1.0) * sin_theta * Y_n1m1 * sin_theta;
+                }
+            }
+
+        private:
+            int n_;
+            int m_;
+            int n1_;
+            int m1_;
+            viennashe::math::spherical_harmonics_evaluator evaluator_;
+    };
+
+
     //////////// Coupling matrix filler ////////////////////
 
     /** @brief Assemble coupling coefficients a_{l,m}^{l',m'} and b_{l,m}^{l',m'} up to order l = L_max
@@ -276,6 +344,60 @@ namespace viennashe
     } //fill_coupling_matrices_impl
 
 
+    /** @brief Assemble coupling coefficients a_{l,m}^{l',m'} and b_{l,m}^{l',m'} up to order l = L_max.
+    *          Same as fill_coupling_matrices_impl(), but all six components are integrated at once by the batched adaptive quadrature.
+    *
+    * @param a_x   x-component of the coupling coefficient a_{l,m}^{l',m'}
+    * @param a_y   y-component of the coupling coefficient a_{l,m}^{l',m'}
+    * @param a_z   z-component of the coupling coefficient a_{l,m}^{l',m'}
+    * @param b_x   x-component of the coupling coefficient b_{l,m}^{l',m'}
+    * @param b_y   y-component of the coupling coefficient b_{l,m}^{l',m'}
+    * @param b_z   z-component of the coupling coefficient b_{l,m}^{l',m'}
+    * @param L_max Maximum spherical harmonics expansion order
+    */
+    template <typename MatrixType>
+    void fill_coupling_matrices_batched(MatrixType & a_x, MatrixType & a_y, MatrixType & a_z,
+                                        MatrixType & b_x, MatrixType & b_y, MatrixType & b_z, int L_max)
+    {
+      const double pi = viennashe::math::constants::pi;
+
+      viennashe::math::tensor_quadrature_2d quadrature(std::size_t(2 * L_max + 4)); // the integrands are smooth, hence a higher order pays off
+      quadrature.tolerance(1e-10, 1e-9);
+
+      MatrixType * matrices[6] = { &a_x, &a_y, &a_z, &b_x, &b_y, &b_z };
+      std::vector<double> results;
+
+      for (int l=0; l<=L_max; ++l)
+      {
+        for (int m=-l; m<=l; ++m)
+        {
+          std::size_t rowindex = std::size_t(l*l + l + m);
+
+          for (int lprime=0; lprime<=L_max; ++lprime)
+          {
+            if (abs(l - lprime) != 1)
+                continue;
+
+            for (int mprime=-lprime; mprime<=lprime; ++mprime)
+            {
+                if ( std::abs(std::abs(m) - std::abs(mprime)) > 1 )
+                    continue;
+
+                quadrature.integrate(0.0, pi, 0.0, 2.0 * pi, coupling_integrand(l, m, lprime, mprime), results);
+
+                std::size_t colindex = std::size_t(lprime * lprime + lprime + mprime);
+                for (std::size_t i=0; i<6; ++i)
+                  if ( fabs(results[i]) > 1e-8)
+                    (*matrices[i])(rowindex, colindex) += results[i];
+
+            } //for mprime
+          } //for lprime
+        } //for m
+      } // for l
+
+    } //fill_coupling_matrices_batched
+
+
     /** @brief Precomputed coupling matrix up to first order
      */
     template <typename MatrixType>
@@ -1061,18 +1183,83 @@ namespace viennashe
         fill_coupling_matrices_7(a_x, a_y, a_z, b_x, b_y, b_z);
       else
       {
-        // Above seventh order, compute on the fly (very slow!):
+        // Above seventh order, compute on the fly:
         log::info<log_fill_coupling_matrices>() << "* fill_coupling_matrices(): Warning: No precomputed coupling matrices available,"
                                                 << " computing on-the-fly (might take a while)..." << std::endl;
-        typedef viennashe::math::IntAdaptiveRule< viennashe::math::IntGauss<5> >   IntegrationRule;
-        fill_coupling_matrices_impl< IntegrationRule >(a_x, a_y, a_z,
-                                                       b_x, b_y, b_z,
-                                                       L_max);
+        fill_coupling_matrices_batched(a_x, a_y, a_z,
+                                       b_x, b_y, b_z,
+                                       L_max);
       }
 
     }
 
 
+    /** @brief The coupling matrices a_{l,m}^{l',m'} and b_{l,m}^{l',m'} up to a maximum expansion order, their transposes and the identity.
+     *
+     * Above seventh order the matrices are computed by numerical integration (cf. fill_coupling_matrices()), hence they are computed once per simulator
+     * rather than once per assembly, and are shared by all simulators on a prepared device of libviennashe.
+     * Not modified after construction, so concurrent assemblies may use the same object.
+     */
+    class coupling_matrices
+    {
+      public:
+        typedef viennashe::math::sparse_matrix<double>   matrix_type;
+
+        explicit coupling_matrices(long L_max)
+          : L_max_(L_max),
+            identity_(num_harmonics(L_max), num_harmonics(L_max)),
+            a_x_(num_harmonics(L_max), num_harmonics(L_max)), a_y_(num_harmonics(L_max), num_harmonics(L_max)), a_z_(num_harmonics(L_max), num_harmonics(L_max)),
+            b_x_(num_harmonics(L_max), num_harmonics(L_max)), b_y_(num_harmonics(L_max), num_harmonics(L_max)), b_z_(num_harmonics(L_max), num_harmonics(L_max))
+        {
+          for (std::size_t i=0; i<num_harmonics(L_max); ++i)
+            for (std::size_t j=0; j<num_harmonics(L_max); ++j)
+              identity_(i,j) = (i == j) ? 1.0 : 0.0;
+
+          //note: interchanged coordinates
+          fill_coupling_matrices(a_x_, a_y_, a_z_,
+                                 b_x_, b_y_, b_z_,
+                                 static_cast<int>(L_max));
+
+          a_x_transposed_ = a_x_.trans();
+          a_y_transposed_ = a_y_.trans();
+          a_z_transposed_ = a_z_.trans();
+
+          b_x_transposed_ = b_x_.trans();
+          b_y_transposed_ = b_y_.trans();
+          b_z_transposed_ = b_z_.trans();
+        }
+
+        /** @brief Returns the maximum expansion order the matrices have been computed for */
+        long max_expansion_order() const { return L_max_; }
+
+        matrix_type const & identity() const { return identity_; }
+
+        matrix_type const & a_x() const { return a_x_; }
+        matrix_type const & a_y() const { return a_y_; }
+        matrix_type const & a_z() const { return a_z_; }
+        matrix_type const & b_x() const { return b_x_; }
+        matrix_type const & b_y() const { return b_y_; }
+        matrix_type const & b_z() const { return b_z_; }
+
+        matrix_type const & a_x_transposed() const { return a_x_transposed_; }
+        matrix_type const & a_y_transposed() const { return a_y_transposed_; }
+        matrix_type const & a_z_transposed() const { return a_z_transposed_; }
+        matrix_type const & b_x_transposed() const { return b_x_transposed_; }
+        matrix_type const & b_y_transposed() const { return b_y_transposed_; }
+        matrix_type const & b_z_transposed() const { return b_z_transposed_; }
+
+      private:
+        static std::size_t num_harmonics(long L_max) { return static_cast<std::size_t>(L_max + 1) * static_cast<std::size_t>(L_max + 1); }
+
+        long L_max_;
+        matrix_type identity_;
+        matrix_type a_x_, a_y_, a_z_;
+        matrix_type b_x_, b_y_, b_z_;
+        matrix_type a_x_transposed_, a_y_transposed_, a_z_transposed_;
+        matrix_type b_x_transposed_, b_y_transposed_, b_z_transposed_;
+    };
+
+
   } //namespace she
 } //namespace viennashe
 #endif
@@ -15,6 +15,10 @@
    License:         MIT (X11), see file LICENSE in the base directory
 =============================================================================== */
 
+// std
+#include <vector>
+#include <algorithm>
+
 // viennashe
 #include "viennashe/forwards.h"
 #include "viennashe/she/eliminate.hpp"
@@ -27,6 +31,8 @@
 
 #include "viennashe/log/log.hpp"
 #include "viennashe/util/checks.hpp"
+#include "viennashe/util/memory.hpp"
+#include "viennashe/util/profiler.hpp"
 
 
 /** @file viennashe/she/linear_solver.hpp
@@ -82,6 +88,60 @@ namespace viennashe
       indices[indices.size()-1].second = system_size;
     }
 
+    /** @brief Writes the subdomain ID of each (even) unknown for the Schwarz preconditioner. Subdomains are given by the device segments.
+     *
+     * @param device       The device
+     * @param quan         The SHE quantity
+     * @param system_size  The number of (even) unknowns in the system
+     * @param partition    The subdomain ID for each unknown (output)
+     */
+    template <typename DeviceType,
+              typename SHEQuantity>
+    void fill_schwarz_partition(DeviceType const & device,
+                                SHEQuantity const & quan,
+                                std::size_t system_size,
+                                std::vector<long> & partition)
+    {
+      typedef typename DeviceType::mesh_type                                          MeshType;
+      typedef typename viennagrid::result_of::segmentation<MeshType>::type            SegmentationType;
+      typedef typename viennagrid::result_of::segment_handle<SegmentationType>::type  SegmentType;
+
+      typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type     CellOnSegmentContainer;
+      typedef typename viennagrid::result_of::iterator<CellOnSegmentContainer>::type  CellOnSegmentIterator;
+
+      partition.resize(system_size);
+      std::fill(partition.begin(), partition.end(), 0);
+
+      long segment_index = 0;
+      for (typename SegmentationType::const_iterator seg_it  = device.segmentation().begin();
+                                                     seg_it != device.segmentation().end();
+                                                   ++seg_it)
+      {
+        CellOnSegmentContainer cells(*seg_it);
+        if (cells.size() == 0)
+          continue;
+
+        bool has_unknowns = false;
+        for (CellOnSegmentIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          for (std::size_t index_H = 0; index_H < quan.get_value_H_size(); ++index_H)
+          {
+            const long index = quan.get_unknown_index(*cit, index_H);
+            if (index < 0)
+              continue;
+
+            for (std::size_t i=0; i < quan.get_unknown_num(*cit, index_H); ++i)
+              if (std::size_t(index) + i < system_size)
+                partition[std::size_t(index) + i] = segment_index;
+            has_unknowns = true;
+          }
+        }
+
+        if (has_unknowns) // only count segments with unknowns, so that subdomain IDs are contiguous
+          ++segment_index;
+      }
+    }
+
 
 
     /** @brief Public interface for solving the provided system of discretized SHE equations.
@@ -121,6 +181,9 @@ namespace viennashe
       //
 
       //log::info<log_linear_solver>() << "* solve(): Diagonalising odd unknowns... " << std::endl;
+      viennashe::util::profiler_scope elimination_scope("elimination");
+      elimination_scope.count("unknowns", static_cast<double>(full_matrix.size1()));
+      elimination_scope.count("nonzeros", static_cast<double>(full_matrix.nnz()));
       viennashe::she::diagonalise_odd2odd_coupling_matrix(full_matrix, full_rhs, reduced_unknowns);
 
       //log::debug<log_linear_solver>() << "Full matrix: " << viennashe::util::sparse_to_string(full_matrix) << std::endl;
@@ -129,6 +192,9 @@ namespace viennashe
       //log::info<log_linear_solver>() << "* solve(): Eliminating odd unknowns... " << std::endl;
       eliminate_odd_unknowns(full_matrix, full_rhs,
                             compressed_matrix, compressed_rhs);
+      viennashe::util::tracked_memory eliminated_matrix_memory("eliminated_matrix", viennashe::util::memory_bytes(compressed_matrix)
+                                                                                   + viennashe::util::memory_bytes(compressed_rhs));
+      elimination_scope.stop();
 
       //log::debug<log_linear_solver>() << "Reduced matrix: " << viennashe::util::sparse_to_string(compressed_matrix) << std::endl;
       //log::debug<log_linear_solver>() << "Reduced rhs: " << compressed_rhs << std::endl;
@@ -140,6 +206,7 @@ namespace viennashe
       //
       //viennashe::util::m_matrix_check(compressed_matrix);
 
+      viennashe::util::profiler_scope normalization_scope("normalization");
       std::vector<double> scaling_vector(compressed_matrix.size1(), 1.0);
       if (conf.scale())
       {
@@ -151,13 +218,19 @@ namespace viennashe
       // Normalize equation system (solver will be thankful)
       //
       VectorType scale_factors = viennashe::math::row_normalize_system(compressed_matrix, compressed_rhs);
+      normalization_scope.stop();
 
       //log::debug<log_linear_solver>() << "Reduced matrix: " << viennashe::util::sparse_to_string(compressed_matrix) << std::endl;
       //log::debug<log_linear_solver>() << "Reduced rhs: " << compressed_rhs << std::endl;
 
 
       // set up preconditioner information:
+      viennashe::util::profiler_scope linear_solver_scope("linear_solver");
+      linear_solver_scope.count("unknowns", static_cast<double>(compressed_matrix.size1()));
+      linear_solver_scope.count("nonzeros", static_cast<double>(compressed_matrix.nnz()));
       fill_block_indices(device, quan, compressed_rhs.size(), conf.block_preconditioner_boundaries());
+      if (conf.id() == viennashe::solvers::linear_solver_ids::schwarz_linear_solver && conf.schwarz_segment_partition())
+        fill_schwarz_partition(device, quan, compressed_rhs.size(), conf.schwarz_partition());
 
       //
       // Solve equation system
@@ -165,6 +238,7 @@ namespace viennashe
       VectorType compressed_result = viennashe::solvers::solve(compressed_matrix,
                                                                compressed_rhs,
                                                                conf);
+      linear_solver_scope.stop();
 
       //
       // Scale unknowns back:
@@ -178,10 +252,15 @@ namespace viennashe
       //
       // Recover full solution of even and odd unknowns
       //
+      viennashe::util::profiler_scope recovery_scope("recovery");
       VectorType she_result = recover_odd_unknowns(full_matrix, full_rhs, compressed_result);
+      recovery_scope.stop();
 
+      viennashe::util::profiler_scope residual_scope("residual");
+      residual_scope.count("nonzeros", static_cast<double>(full_matrix.nnz()));
       double relative_residual  = viennashe::math::norm_2(viennashe::math::subtract(viennashe::math::prod(full_matrix, she_result), full_rhs));
              relative_residual /= viennashe::math::norm_2(full_rhs);
+      residual_scope.stop();
       if (relative_residual > 1e-7)
         log::info<log_linear_solver>() << "* solve(): Relative linear solver residual of full system: " << relative_residual << std::endl;
 
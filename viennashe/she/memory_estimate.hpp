@@ -0,0 +1,281 @@
+#ifndef VIENNASHE_SHE_MEMORY_ESTIMATE_HPP
+#define VIENNASHE_SHE_MEMORY_ESTIMATE_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+// viennagrid
+#include "viennagrid/mesh/mesh.hpp"
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/config.hpp"
+#include "viennashe/physics/constants.hpp"
+#include "viennashe/she/she_quantity.hpp"
+#include "viennashe/util/memory.hpp"
+
+/** @file viennashe/she/memory_estimate.hpp
+    @brief Predicts the memory needed by a SHE simulation from the mesh size, the expansion order and the energy range before anything is allocated.
+*/
+
+namespace viennashe
+{
+  namespace she
+  {
+
+    /** @brief Predicted peak memory in bytes of the categories accounted by the profiler of the simulator (cf. viennashe::util::tracked_memory) */
+    struct memory_estimate
+    {
+      memory_estimate() : num_energies(0), even_unknowns(0), odd_unknowns(0), spatial_unknowns(0), nonzeros(0), reduced_nonzeros(0), spatial_nonzeros(0),
+                          system_matrix(0), eliminated_matrix(0), she_quantities(0), quantity_history(0), coupling_matrices(0), solver_workspace(0) {}
+
+      std::size_t num_energies;        ///< Number of discrete total energies per SHE quantity
+      std::size_t even_unknowns;       ///< Number of even unknowns per SHE quantity
+      std::size_t odd_unknowns;        ///< Number of odd unknowns per SHE quantity
+      std::size_t spatial_unknowns;    ///< Number of unknowns of all spatial quantities (potential, carrier densities of drift-diffusion, etc.)
+      double      nonzeros;            ///< Nonzeros of the system matrix per SHE quantity
+      double      reduced_nonzeros;    ///< Nonzeros of the system matrix after elimination of the odd unknowns per SHE quantity
+      double      spatial_nonzeros;    ///< Nonzeros of the rows of the spatial quantities in the system matrix (in the coupled system including the coupling to the SHE quantities)
+
+      double system_matrix;
+      double eliminated_matrix;
+      double she_quantities;
+      double quantity_history;
+      double coupling_matrices;
+      double solver_workspace;
+
+      /** @brief Returns the sum over all categories. Since not all data structures are alive at the same time, this is an upper bound of the peak. */
+      double total() const
+      {
+        return system_matrix + eliminated_matrix + she_quantities + quantity_history + coupling_matrices + solver_workspace;
+      }
+
+      /** @brief Returns the estimate of the category with the given name (as used by the profiler), or total() for an empty name */
+      double operator()(std::string const & category) const
+      {
+        if (category.empty())                   return total();
+        if (category == "system_matrix")        return system_matrix;
+        if (category == "eliminated_matrix")    return eliminated_matrix;
+        if (category == "she_quantities")       return she_quantities;
+        if (category == "quantity_history")     return quantity_history;
+        if (category == "coupling_matrices")    return coupling_matrices;
+        if (category == "solver_workspace")     return solver_workspace;
+        return 0;
+      }
+    };
+
+    /** @brief Estimates the memory of a SHE simulation. All (x,H)-nodes are assumed to carry unknowns up to order L, hence the result is an upper bound.
+     *
+     * With Gummel's method each quantity is solved separately, hence the largest of the systems is accounted.
+     * With Newton's method all spatial and SHE quantities are assembled into a single system matrix, which is passed to the linear solver without elimination of the odd unknowns.
+     *
+     * @param num_cells                Number of cells of the mesh
+     * @param num_facets               Number of facets of the mesh
+     * @param L                        Maximum expansion order
+     * @param num_energies             Number of discrete total energies per SHE quantity
+     * @param num_she_quantities       Number of SHE quantities (one for each carrier type solved with SHE)
+     * @param coupled_system           True if all quantities are assembled into a single system matrix (Newton), false otherwise (Gummel)
+     * @param num_timesteps            Number of time steps kept in the quantity history
+     * @param num_spatial_quantities   Number of spatial quantities with one unknown per cell (potential, carrier densities of drift-diffusion, etc.)
+     */
+    inline memory_estimate estimate_memory(std::size_t num_cells, std::size_t num_facets, long L, std::size_t num_energies,
+                                           std::size_t num_she_quantities, bool coupled_system = false, std::size_t num_timesteps = 1,
+                                           std::size_t num_spatial_quantities = 0)
+    {
+      typedef double        NumericType;
+
+      memory_estimate result;
+      if (num_cells == 0)
+        return result;
+      if (num_energies == 0)
+        num_she_quantities = 0;
+      if (num_she_quantities == 0 && num_spatial_quantities == 0)
+        return result;
+
+      const std::size_t even_per_node = static_cast<std::size_t>(even_unknowns_on_node(L));
+      const std::size_t odd_per_node  = static_cast<std::size_t>(odd_unknowns_on_node(L));
+      const std::size_t harmonics     = static_cast<std::size_t>((L+1) * (L+1));
+      const double facets_per_cell    = 2.0 * static_cast<double>(num_facets) / static_cast<double>(num_cells);
+      const double bytes_per_row      = sizeof(std::map<std::size_t, NumericType>);
+
+      // Coupling of a harmonic to the harmonics of neighboring order (l' = l +- 1, |m'| = |m| +- 1): at most 12 entries per row
+      const double coupling_per_row   = 12;
+      // Coupling after elimination (l' = l, l +- 2): at most 25 entries per row
+      const double reduced_coupling_per_row = 25;
+
+      result.num_energies     = (num_she_quantities > 0) ? num_energies : 0;
+      result.spatial_unknowns = num_spatial_quantities * num_cells;
+
+      // values, boundary data, masks, unknown indices and expansion orders on each (x,H)-node, band edge shifts on each x-node.
+      // The distribution functions of the carrier types not solved with SHE carry the data on the x-nodes only:
+      const double bytes_per_x_node    = sizeof(boundary_type_id) + sizeof(NumericType) + 2.0/8.0;
+      const double bytes_per_even_node = sizeof(std::vector<NumericType>) + static_cast<double>(even_per_node) * sizeof(NumericType)
+                                       + sizeof(NumericType) + sizeof(long) + sizeof(std::size_t) + 1.0/8.0;
+      const double bytes_per_odd_node  = sizeof(std::vector<NumericType>) + static_cast<double>(odd_per_node) * sizeof(NumericType)
+                                       + sizeof(NumericType) + sizeof(long) + sizeof(std::size_t) + 1.0/8.0;
+      const double bytes_per_quantity  = static_cast<double>(num_cells  * num_energies) * bytes_per_even_node
+                                       + static_cast<double>(num_facets * num_energies) * bytes_per_odd_node
+                                       + static_cast<double>(num_cells + num_facets) * bytes_per_x_node
+                                       + static_cast<double>(num_energies) * sizeof(NumericType);
+      const std::size_t num_other_quantities = (num_she_quantities < 2) ? 2 - num_she_quantities : 0;
+      result.she_quantities = static_cast<double>(num_she_quantities) * bytes_per_quantity
+                            + static_cast<double>(num_other_quantities * (num_cells + num_facets)) * bytes_per_x_node;
+
+      // previous time steps plus the copy of the current quantities transferred to the new H-space in each nonlinear iteration:
+      result.quantity_history = static_cast<double>(num_timesteps) * result.she_quantities;
+
+      //
+      // Spatial quantities: each row couples to all spatial quantities in the cell and its neighbors,
+      //                     in the coupled system also to the zeroth-order coefficients of the SHE quantities in the cell (Poisson equation)
+      //
+      const double spatial_rows = static_cast<double>(result.spatial_unknowns);
+      result.spatial_nonzeros = spatial_rows * ( coupled_system ? static_cast<double>(num_spatial_quantities) * (1.0 + facets_per_cell)
+                                                                  + static_cast<double>(num_she_quantities * num_energies)
+                                                                : 1.0 + facets_per_cell );
+
+      // Gummel: one spatial quantity per system matrix, load vector and solution vector
+      const double single_spatial_system = static_cast<double>(num_cells) * (bytes_per_row + 2 * sizeof(NumericType))
+                                         + static_cast<double>(num_cells) * (1.0 + facets_per_cell) * viennashe::util::sparse_matrix_bytes_per_nonzero<NumericType>();
+      const double single_spatial_workspace = 2.0 * viennashe::util::compressed_matrix_bytes<NumericType>(num_cells, static_cast<std::size_t>(static_cast<double>(num_cells) * (1.0 + facets_per_cell)))
+                                            + 10.0 * static_cast<double>(num_cells) * sizeof(NumericType);
+
+      if (num_she_quantities == 0)
+      {
+        if (coupled_system)
+        {
+          result.system_matrix    = spatial_rows * (bytes_per_row + 2 * sizeof(NumericType)) + result.spatial_nonzeros * viennashe::util::sparse_matrix_bytes_per_nonzero<NumericType>();
+          result.solver_workspace = 2.0 * viennashe::util::compressed_matrix_bytes<NumericType>(result.spatial_unknowns, static_cast<std::size_t>(result.spatial_nonzeros))
+                                  + 10.0 * spatial_rows * sizeof(NumericType);
+        }
+        else
+        {
+          result.system_matrix    = single_spatial_system;
+          result.solver_workspace = single_spatial_workspace;
+        }
+        return result;
+      }
+
+      //
+      // SHE quantities
+      //
+      result.even_unknowns = num_cells  * num_energies * even_per_node;
+      result.odd_unknowns  = num_facets * num_energies * odd_per_node;
+
+      // even rows: diagonal, inelastic scattering to energies +- hbar*omega, free streaming to the odd unknowns on the facets
+      // odd rows:  diagonal, free streaming to the even unknowns of the two cells sharing the facet
+      result.nonzeros         = static_cast<double>(result.even_unknowns) * (3.0 + facets_per_cell * std::min<double>(static_cast<double>(odd_per_node), coupling_per_row))
+                              + static_cast<double>(result.odd_unknowns)  * (1.0 + 2.0 * std::min<double>(static_cast<double>(even_per_node), coupling_per_row));
+      result.reduced_nonzeros = static_cast<double>(result.even_unknowns) * (3.0 + (facets_per_cell + 1.0) * std::min<double>(static_cast<double>(even_per_node), reduced_coupling_per_row));
+
+      const double she_rows     = static_cast<double>(result.even_unknowns + result.odd_unknowns);
+      const double reduced_rows = static_cast<double>(result.even_unknowns);
+
+      if (coupled_system)
+      {
+        // single system matrix of all quantities including load vector and solution vector:
+        const double rows     = static_cast<double>(num_she_quantities) * she_rows + spatial_rows;
+        const double nonzeros = static_cast<double>(num_she_quantities) * result.nonzeros + result.spatial_nonzeros;
+        result.system_matrix = rows * (bytes_per_row + 2 * sizeof(NumericType))
+                             + nonzeros * viennashe::util::sparse_matrix_bytes_per_nonzero<NumericType>();
+
+        // compressed copy of the full system, ILU factors of the same pattern, vectors of the Krylov solver:
+        result.solver_workspace = 2.0 * viennashe::util::compressed_matrix_bytes<NumericType>(static_cast<std::size_t>(rows), static_cast<std::size_t>(nonzeros))
+                                + 10.0 * rows * sizeof(NumericType);
+      }
+      else
+      {
+        // system matrix including load vector and solution vector:
+        result.system_matrix = std::max(she_rows * (bytes_per_row + 2 * sizeof(NumericType))
+                                        + result.nonzeros * viennashe::util::sparse_matrix_bytes_per_nonzero<NumericType>(),
+                                        (num_spatial_quantities > 0) ? single_spatial_system : 0.0);
+
+        // eliminated system including load vector, scaling vectors and result:
+        result.eliminated_matrix = reduced_rows * (bytes_per_row + 4 * sizeof(NumericType))
+                                 + result.reduced_nonzeros * viennashe::util::sparse_matrix_bytes_per_nonzero<NumericType>();
+
+        // compressed copy of the eliminated system, ILU factors of the same pattern, vectors of the Krylov solver:
+        result.solver_workspace = std::max(2.0 * viennashe::util::compressed_matrix_bytes<NumericType>(result.even_unknowns, static_cast<std::size_t>(result.reduced_nonzeros))
+                                           + 10.0 * reduced_rows * sizeof(NumericType),
+                                           (num_spatial_quantities > 0) ? single_spatial_workspace : 0.0);
+      }
+
+      // identity, scattering operators, a_x, a_y, a_z, b_x, b_y, b_z and their transposes:
+      result.coupling_matrices = static_cast<double>(harmonics) * 15.0 * sizeof(std::map<std::size_t, NumericType>)
+                               + (3.0 * static_cast<double>(harmonics) + 12.0 * static_cast<double>(harmonics) * std::min<double>(static_cast<double>(harmonics), coupling_per_row))
+                                 * viennashe::util::sparse_matrix_bytes_per_nonzero<NumericType>();
+
+      return result;
+    }
+
+    /** @brief Returns the number of discrete total energies which setup_energies() will use for a carrier type,
+     *         given the difference between the maximum and the minimum potential in the semiconductor (in Volt) */
+    inline std::size_t estimate_num_energies(viennashe::config const & conf, viennashe::carrier_type_id ctype, double potential_range)
+    {
+      double total_energy_range = conf.use_h_transformation()
+                                ? viennashe::physics::constants::q * potential_range + 2.0 * conf.energy_spacing() + conf.min_kinetic_energy_range(ctype)
+                                : conf.min_kinetic_energy_range(ctype);
+      return static_cast<std::size_t>(total_energy_range / conf.energy_spacing()) + 1;
+    }
+
+    /** @brief Estimates the memory of a SHE simulation on a device before anything is allocated.
+     *
+     * @param device           The device (only the mesh size is used)
+     * @param conf             The simulator configuration (expansion order, energy spacing, carrier types and their equations, nonlinear solver)
+     * @param potential_range  The expected difference between the maximum and the minimum potential in the semiconductor in Volt, e.g. the largest applied voltage plus the built-in potential
+     */
+    template <typename DeviceType>
+    memory_estimate estimate_memory(DeviceType const & device, viennashe::config const & conf, double potential_range)
+    {
+      std::size_t num_cells  = viennagrid::cells(device.mesh()).size();
+      std::size_t num_facets = viennagrid::facets(device.mesh()).size();
+
+      std::size_t num_she_quantities = 0;
+      std::size_t num_energies = 0;
+      if (conf.with_electrons() && conf.get_electron_equation() == EQUATION_SHE)
+      {
+        ++num_she_quantities;
+        num_energies = std::max(num_energies, estimate_num_energies(conf, ELECTRON_TYPE_ID, potential_range));
+      }
+      if (conf.with_holes() && conf.get_hole_equation() == EQUATION_SHE)
+      {
+        ++num_she_quantities;
+        num_energies = std::max(num_energies, estimate_num_energies(conf, HOLE_TYPE_ID, potential_range));
+      }
+
+      // potential, carrier densities solved with drift-diffusion, density gradient corrections, lattice temperature:
+      std::size_t num_spatial_quantities = 1;
+      if (conf.with_electrons() && conf.get_electron_equation() == EQUATION_CONTINUITY)
+        ++num_spatial_quantities;
+      if (conf.with_holes() && conf.get_hole_equation() == EQUATION_CONTINUITY)
+        ++num_spatial_quantities;
+      if (conf.quantum_correction())
+        num_spatial_quantities += 2;
+      if (conf.with_hde())
+        ++num_spatial_quantities;
+
+      bool coupled_system = (conf.nonlinear_solver().id() == viennashe::solvers::nonlinear_solver_ids::newton_nonlinear_solver);
+
+      return estimate_memory(num_cells, num_facets, conf.max_expansion_order(), num_energies, num_she_quantities, coupled_system, 1, num_spatial_quantities);
+    }
+
+  } //namespace she
+} //namespace viennashe
+
+#endif
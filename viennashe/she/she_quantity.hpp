@@ -26,6 +26,7 @@
 #include "viennagrid/mesh/mesh.hpp"
 
 #include "viennashe/forwards.h"
+#include "viennashe/util/memory.hpp"
 
 namespace viennashe
 {
@@ -186,6 +187,12 @@ namespace viennashe
             return 0;
         }
 
+        /** @brief Returns the coefficients on the (x,H)-node given by the ID of an element of the first type and the energy index. Empty if the node carries no coefficients. */
+        std::vector<ValueT> const & get_values_by_id(std::size_t elem_id, std::size_t index_H) const { return values1_.at(array_index(elem_id, index_H)); }
+
+        /** @brief Returns the number of elements of the first type (e.g. cells) the quantity is defined on */
+        std::size_t get_size1() const { return boundary_types1_.size(); }
+
         bool   get_expansion_adaption(AssociatedT1 const & elem) const   { return expansion_order_adaption_.at(get_id(elem)); }
         void   set_expansion_adaption(AssociatedT1 const & elem, bool b) {        expansion_order_adaption_.at(get_id(elem)) = b; }
 
@@ -229,6 +236,22 @@ namespace viennashe
           return num;
         }*/
 
+        /** @brief Returns the number of bytes held by the values, boundary data, masks and unknown indices of the quantity */
+        double memory_bytes() const
+        {
+          using viennashe::util::memory_bytes;
+          return memory_bytes(values1_) + memory_bytes(values2_)
+               + memory_bytes(values1_offsets_) + memory_bytes(values2_offsets_)
+               + memory_bytes(boundary_types1_) + memory_bytes(boundary_types2_)
+               + memory_bytes(boundary_values1_) + memory_bytes(boundary_values2_)
+               + memory_bytes(defined_but_unknown_mask1_) + memory_bytes(defined_but_unknown_mask2_)
+               + memory_bytes(spatial_mask1_) + memory_bytes(spatial_mask2_)
+               + memory_bytes(unknowns_indices1_) + memory_bytes(unknowns_indices2_)
+               + memory_bytes(expansion_order1_) + memory_bytes(expansion_order2_)
+               + memory_bytes(expansion_order_adaption_)
+               + memory_bytes(values_H_) + memory_bytes(bandedge_shift1_) + memory_bytes(bandedge_shift2_);
+        }
+
         // possible design flaws:
         bool get_logarithmic_damping() const { return log_damping_; }
         void set_logarithmic_damping(bool b) { log_damping_ = b; }
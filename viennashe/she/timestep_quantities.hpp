@@ -217,6 +217,15 @@ namespace viennashe
         UnknownSHEQuantityListType       & unknown_she_quantities()       { return unknown_she_quantities_; }
         UnknownSHEQuantityListType const & unknown_she_quantities() const { return unknown_she_quantities_; }
 
+        /** @brief Returns the number of bytes held by the SHE quantities (values, masks, unknown indices, etc.) */
+        double she_memory_bytes() const
+        {
+          double result = 0;
+          for (std::size_t i=0; i<unknown_she_quantities_.size(); ++i)
+            result += unknown_she_quantities_[i].memory_bytes();
+          return result;
+        }
+
         ////////////// Macroscopic quantities ////////////////////////
 
         /** @brief Returns the quantity identified by its name.
@@ -15,6 +15,13 @@
    License:         MIT (X11), see file LICENSE in the base directory
 =============================================================================== */
 
+// std
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
 // viennashe
 #include "viennashe/forwards.h"
 #include "viennashe/device.hpp"
@@ -45,6 +52,8 @@
 #include "viennashe/she/log_keys.h"
 
 #include "viennashe/util/timer.hpp"
+#include "viennashe/util/memory.hpp"
+#include "viennashe/util/profiler.hpp"
 #include "viennashe/util/checks.hpp"
 #include "viennashe/util/misc.hpp"
 #include "viennashe/util/smooth_doping.hpp"
@@ -215,6 +224,58 @@ namespace viennashe
       }
     }
 
+    /** @brief Passes the cancellation flag of the simulator to the linear solvers for the duration of a run. Clears the flag when the run ends. */
+    class solver_cancellation_scope
+    {
+      public:
+        solver_cancellation_scope(viennashe::solvers::linear_solver_config & conf, std::atomic<bool> & flag) : conf_(conf), flag_(flag)
+        {
+          conf_.cancellation_flag(&flag_);
+        }
+
+        ~solver_cancellation_scope()
+        {
+          conf_.cancellation_flag(NULL);
+          flag_ = false;
+        }
+
+      private:
+        solver_cancellation_scope(solver_cancellation_scope const &);
+        solver_cancellation_scope & operator=(solver_cancellation_scope const &);
+
+        viennashe::solvers::linear_solver_config & conf_;
+        std::atomic<bool> & flag_;
+    };
+
+    /** @brief Accessor for the Dirichlet boundary condition of the potential, which prefers the contact potentials set on the simulator
+     *         (cf. simulator::set_contact_potential()) over the ones of the device */
+    template <typename DeviceT>
+    class simulator_boundary_potential_accessor
+    {
+        typedef typename DeviceT::mesh_type     MeshType;
+
+      public:
+        typedef typename viennagrid::result_of::cell<MeshType>::type      cell_type;
+        typedef double    value_type;
+
+        simulator_boundary_potential_accessor(DeviceT const & d, std::map<std::size_t, double> const & contact_potentials)
+          : device_boundary_pot_(d), built_in_pot_(d), contact_potentials_(contact_potentials) {}
+
+        value_type operator()(cell_type const & c) const
+        {
+          std::map<std::size_t, double>::const_iterator it = contact_potentials_.find(std::size_t(c.id().get()));
+          if (it != contact_potentials_.end())
+            return it->second + built_in_pot_(c);
+
+          return device_boundary_pot_(c);
+        }
+
+      private:
+        boundary_potential_accessor<DeviceT>  device_boundary_pot_;
+        built_in_potential_accessor<DeviceT>  built_in_pot_;
+        std::map<std::size_t, double> const & contact_potentials_;
+    };
+
   } // namespace detail
 
 
@@ -666,6 +727,33 @@ namespace viennashe
     else                  update_quantity(device, unknown_quantity, conf.nonlinear_solver().damping(), x);
   }
 
+  /** @brief The state of the nonlinear solver after an iteration of simulator::run(), as passed to the iteration callback. */
+  struct nonlinear_iteration_info
+  {
+    nonlinear_iteration_info() : iteration(0), max_iterations(0),
+                                 residual_norm(0), potential_update_norm(0), total_update_norm(0),
+                                 iteration_seconds(0), elapsed_seconds(0),
+                                 unknowns(0), electron_even_unknowns(0), electron_odd_unknowns(0), hole_even_unknowns(0), hole_odd_unknowns(0),
+                                 converged(false) {}
+
+    std::size_t iteration;                ///< Number of the nonlinear iteration, starting with 1
+    std::size_t max_iterations;           ///< Maximum number of nonlinear iterations as given by the configuration
+    double      residual_norm;            ///< Norm of the residual (sum over all equations for Gummel)
+    double      potential_update_norm;    ///< Norm of the update of the potential
+    double      total_update_norm;        ///< Norm of the update of all quantities
+    double      iteration_seconds;        ///< Wall-clock time of this iteration
+    double      elapsed_seconds;          ///< Wall-clock time since run() was called
+    std::size_t unknowns;                 ///< Total number of unknowns of all quantities
+    std::size_t electron_even_unknowns;   ///< Even unknowns of the electron distribution function (zero if SHE is not used for electrons)
+    std::size_t electron_odd_unknowns;    ///< Odd unknowns of the electron distribution function
+    std::size_t hole_even_unknowns;       ///< Even unknowns of the hole distribution function (zero if SHE is not used for holes)
+    std::size_t hole_odd_unknowns;        ///< Odd unknowns of the hole distribution function
+    bool        converged;                ///< True if this is the last iteration, because the convergence criterion has been met
+  };
+
+  /** @brief Tag for the construction of simulators on a device shared with other simulators, cf. simulator::simulator(DeviceType &, viennashe::config const &, shared_device_tag) */
+  struct shared_device_tag {};
+
   /** @brief  Class for self-consistent SHE simulations.
    *
    * @tparam DeviceType      Type of the device the simulator is operating on
@@ -709,13 +797,32 @@ namespace viennashe
       typedef ResultQuantityType   electron_density_type;
       typedef ResultQuantityType       hole_density_type;
 
+      /** @brief Type of the callback invoked after each nonlinear iteration. Returning true cancels the simulation. */
+      typedef std::function<bool (nonlinear_iteration_info const &)>   iteration_callback_type;
+
 
       /** @brief Constructs the self-consistent simulator object
        *
        * @param device  The device
        * @param conf    A SHE configuation object
        */
-      simulator(DeviceType & device, viennashe::config const & conf = viennashe::config()) : p_device_(&device), config_(conf)
+      simulator(DeviceType & device, viennashe::config const & conf = viennashe::config()) : simulator(device, conf, false) {}
+
+      /** @brief Constructs the self-consistent simulator object on a device, which is shared with other simulators and not modified.
+       *
+       * The doping next to the contacts has to be smoothed once before (cf. viennashe::detail::smooth_doping_at_contacts()),
+       * biases differing from the contact potentials of the device are set with set_contact_potential().
+       * Simulators sharing a device may run concurrently. The lattice heat equation is not available, because it writes the lattice temperature to the device.
+       *
+       * @param device  The shared device
+       * @param conf    A SHE configuation object
+       */
+      simulator(DeviceType & device, viennashe::config const & conf, shared_device_tag) : simulator(device, conf, true) {}
+
+    private:
+
+      simulator(DeviceType & device, viennashe::config const & conf, bool shared_device)
+        : p_device_(&device), device_shared_(shared_device), config_(conf), cancelled_(false), cancel_requested_(false)
       {
         quantities_history_.push_back(SHETimeStepQuantitiesT());
 
@@ -729,7 +836,8 @@ namespace viennashe
         }
 
         // ensure doping in vicinity of contact is constant
-        detail::smooth_doping_at_contacts(device);
+        if (!shared_device)
+          detail::smooth_doping_at_contacts(device);
 
         // push quantities
         // (note that by default all values are 'known' default values, so one has to specify the unknown regions later):
@@ -856,6 +964,8 @@ namespace viennashe
         detail::set_boundary_for_material(device, quantities().unknown_she_quantities().back(), materials::checker(MATERIAL_CONDUCTOR_ID), BOUNDARY_DIRICHLET);
       }
 
+    public:
+
       /**
        * @brief Transfers the inital guess for the given quantity
        *
@@ -870,14 +980,97 @@ namespace viennashe
         transfer_provided_quantities(quan_acc, quantities().get_unknown_quantity(quan_name), cells);
       }
 
+      /** @brief Sets the contact potential of a cell for this simulator only. Overrides the contact potential of the device, which is not modified.
+       *
+       * Allows for simulators with different biases on a shared device. Takes effect on the boundary condition of the potential right away
+       * (the initial guess is not changed) and is kept by advance_in_time(). Has no effect on cells which are not conductors.
+       */
+      void set_contact_potential(double pot, CellType const & c)
+      {
+        contact_potentials_[std::size_t(c.id().get())] = pot;
+
+        if (viennashe::materials::is_conductor(device().get_material(c)))
+        {
+          UnknownQuantityType & potential = quantities().get_unknown_quantity(viennashe::quantity::potential());
+          potential.set_boundary_value(c, pot + built_in_potential_accessor<DeviceType>(device())(c));
+        }
+      }
+
+      /** @brief Sets the contact potential of all cells of a segment for this simulator only, cf. set_contact_potential(double, CellType const &) */
+      void set_contact_potential(double pot, typename DeviceType::segment_type const & seg)
+      {
+        typedef typename viennagrid::result_of::const_cell_range<typename DeviceType::segment_type>::type   CellOnSegmentContainer;
+        typedef typename viennagrid::result_of::iterator<CellOnSegmentContainer>::type                      CellOnSegmentIterator;
+
+        CellOnSegmentContainer cells_on_segment(seg);
+        for (CellOnSegmentIterator cit  = cells_on_segment.begin();
+                                   cit != cells_on_segment.end();
+                                 ++cit)
+          set_contact_potential(pot, *cit);
+      }
+
+      /** @brief Returns true if the simulator has been constructed on a device shared with other simulators (cf. shared_device_tag) */
+      bool device_shared() const { return device_shared_; }
+
+      /** @brief Hands precomputed SHE coupling matrices to the simulator, e.g. ones shared by several simulators. Matrices for a different maximum expansion order than the one configured are recomputed in run(). */
+      void set_coupling_matrices(std::shared_ptr<viennashe::she::coupling_matrices const> const & coupling) { coupling_matrices_ = coupling; }
+
+      /** @brief Returns the SHE coupling matrices for the configured maximum expansion order. Computed on first use and then reused for all assemblies of this simulator. */
+      std::shared_ptr<viennashe::she::coupling_matrices const> const & coupling_matrices()
+      {
+        if (!coupling_matrices_ || coupling_matrices_->max_expansion_order() != config().max_expansion_order())
+        {
+          viennashe::util::profiler_scope coupling_matrices_scope("coupling_matrices");
+          coupling_matrices_ = std::make_shared<viennashe::she::coupling_matrices const>(config().max_expansion_order());
+        }
+        return coupling_matrices_;
+      }
+
 
       /** @brief Launches the solver. Uses the built-in potential as initial guess for the potential and
        *         the doping concentration as the initial guess for carriers.
+       *
+       * Stops early if cancel() is called from another thread, see cancelled().
        */
       void run()
       {
+        detail::solver_cancellation_scope cancellation(config_.linear_solver(), cancel_requested_);
+        try
+        {
+          run_nonlinear_iterations();
+        }
+        catch (viennashe::solvers::cancelled_exception const &)
+        {
+          log::info<log_simulator>() << "* run(): Simulation cancelled in the linear solver of iteration " << (last_iteration().iteration + 1) << std::endl;
+          cancelled_ = true;
+        }
+      }
+
+    private:
+
+      /** @brief Carries out the nonlinear iterations of run() */
+      void run_nonlinear_iterations()
+      {
+        if (device_shared_ && config().with_hde())
+          throw viennashe::unavailable_feature_exception("simulator: The lattice heat equation is not available on a shared device, because it writes the lattice temperature to the device");
+
         const double use_newton = (config().nonlinear_solver().id() == viennashe::solvers::nonlinear_solver_ids::newton_nonlinear_solver);
 
+        viennashe::util::timer elapsed;
+        elapsed.start();
+
+        {
+          std::lock_guard<std::mutex> lock(progress_mutex_);
+          last_iteration_ = nonlinear_iteration_info();
+        }
+        cancelled_ = false;
+
+        viennashe::util::profiler_activation profiler_active(profiler_);
+        profiler_.begin_run();
+        viennashe::util::profiler_scope run_scope("run");
+        viennashe::util::tracked_memory she_quantities_memory("she_quantities");
+        viennashe::util::tracked_memory history_memory("quantity_history");
+
         detail::set_boundary_for_material(device(), quantities().unknown_she_quantities()[0], materials::checker(MATERIAL_CONDUCTOR_ID), BOUNDARY_DIRICHLET);
         detail::set_boundary_for_material(device(), quantities().unknown_she_quantities()[1], materials::checker(MATERIAL_CONDUCTOR_ID), BOUNDARY_DIRICHLET);
 
@@ -894,9 +1087,19 @@ namespace viennashe
 
         for (std::size_t nonlinear_iter = 1; nonlinear_iter <= this->config().nonlinear_solver().max_iters(); ++nonlinear_iter)
         {
-          viennashe::util::timer stopwatch,stopwatch2;
+          if (cancel_requested_)
+          {
+            log::info<log_simulator>() << "* run(): Simulation cancelled before iteration " << nonlinear_iter << std::endl;
+            cancelled_ = true;
+            break;
+          }
+
+          viennashe::util::timer stopwatch;
           stopwatch.start();
 
+          profiler_.set_iteration(nonlinear_iter);
+          viennashe::util::profiler_scope iteration_scope("nonlinear_iteration");
+
           // If this is the last iteration set update_no_damping
           if (nonlinear_iter == this->config().nonlinear_solver().max_iters())
             update_no_damping = true;
@@ -905,25 +1108,35 @@ namespace viennashe
           // write kinetic energy to device:
           //
           //log::debug<viennashe::she::log_she_solver>() << "* simulator(): Writing center of band gap to device..." << std::endl;
+          viennashe::util::profiler_scope setup_energies_scope("setup_energies");
           viennashe::she::setup_energies(this->device(), this->quantities(), this->config());
+          setup_energies_scope.stop();
 
           //
           // distribute SHE expansion orders over device
           //
           //log::debug<viennashe::she::log_she_solver>() << "* simulator(): Writing expansion orders to device (" << config().max_expansion_order() << ")... " << std::endl;
+          viennashe::util::profiler_scope expansion_orders_scope("expansion_orders");
           viennashe::she::distribute_expansion_orders(this->device(), this->quantities(), this->config());
+          she_quantities_memory.set(this->quantities().she_memory_bytes());
+          expansion_orders_scope.stop();
 
           //
           // write boundary conditions:
           //
           //log::debug<viennashe::she::log_she_solver>() << "* simulator(): Writing boundary conditions to device..." << std::endl;
+          viennashe::util::profiler_scope boundary_conditions_scope("boundary_conditions");
           viennashe::she::write_boundary_conditions(this->device(), this->quantities(), this->config());
+          boundary_conditions_scope.stop();
 
           //
           // Mapping of unknowns:
           //
+          viennashe::util::profiler_scope mapping_scope("mapping");
           viennashe::map_info_type map_info = viennashe::create_mapping(this->device(), this->quantities(), this->config());
+          mapping_scope.stop();
 
+          viennashe::util::profiler_scope transfer_scope("transfer");
           transferred_quantities = quantities(); //transfer kinetic energy and other information related to the (x,H)-space
           if ( quantities_history_.size() > 1 )
           {
@@ -939,6 +1152,12 @@ namespace viennashe
           //
           viennashe::transfer_quantity_to_device(this->device(), this->quantities(), this->config());
 
+          double history_bytes = transferred_quantities.she_memory_bytes();
+          for (std::size_t i=0; i+1 < quantities_history_.size(); ++i)
+            history_bytes += quantities_history_[i].she_memory_bytes();
+          history_memory.set(history_bytes);
+          transfer_scope.stop();
+
 
           if (nonlinear_iter == 1)
           {
@@ -1000,22 +1219,36 @@ namespace viennashe
             std::size_t total_number_of_unknowns = 0;
             for (viennashe::map_info_type::const_iterator it = map_info.begin(); it != map_info.end(); ++it)
               total_number_of_unknowns += (it->second).first + (it->second).second;   //sum of unknowns on vertices and edges
-            stopwatch2.start();
+            viennashe::util::profiler_scope assemble_scope("assemble");
             MatrixType A(total_number_of_unknowns, total_number_of_unknowns);
             VectorType b(total_number_of_unknowns);
+            viennashe::util::tracked_memory system_matrix_memory("system_matrix");
 
             // assemble spatial quantities:
             for (std::size_t i = 0; i < this->quantities().unknown_quantities().size(); ++i)
+            {
+              viennashe::util::profiler_scope quantity_scope(this->quantities().unknown_quantities()[i].get_name());
               viennashe::assemble(device(), this->quantities(), this->config(), this->quantities().unknown_quantities()[i], A, b);
+            }
 
             // assemble SHE quantities:
             for (std::size_t i = 0; i < this->quantities().unknown_she_quantities().size(); ++i)
-              viennashe::she::assemble(this->device(), transferred_quantities, this->quantities(), this->config(), this->quantities().unknown_she_quantities()[i], A, b,
+            {
+              viennashe::util::profiler_scope quantity_scope(this->quantities().unknown_she_quantities()[i].get_name());
+              viennashe::she::assemble(this->device(), transferred_quantities, this->quantities(), this->config(), this->quantities().unknown_she_quantities()[i], *this->coupling_matrices(), A, b,
                                         (quantities_history_.size() > 1), nonlinear_iter > 1);
-            log::info<log_simulator>() << " Assemble TIME:"  << std::fixed      << std::setprecision(3) << std::setw(8) << stopwatch.get() << std::endl;
+            }
+            assemble_scope.count("unknowns", static_cast<double>(total_number_of_unknowns));
+            assemble_scope.count("nonzeros", static_cast<double>(A.nnz()));
+            system_matrix_memory.set(viennashe::util::memory_bytes(A) + viennashe::util::memory_bytes(b));
+            assemble_scope.stop();
+
             //VectorType x = viennashe::she::solve(A, b, map_info);  //TODO: use this!
+            viennashe::util::profiler_scope solve_scope("solve");
             VectorType x = this->solve(A, b, true);
+            solve_scope.stop();
 
+            viennashe::util::profiler_scope update_scope("update");
             current_residual_norm += viennashe::math::norm_2(b);
 
             total_update_norm        = viennashe::get_total_update_norm_newton(this->device(), this->quantities(), x);
@@ -1031,16 +1264,29 @@ namespace viennashe
               std::size_t number_of_unknowns = map_info[quantities().unknown_quantities()[i].get_name()].first;
               if (number_of_unknowns == 0)
                 continue;
-              stopwatch2.start();
+              std::string const & quantity_name = this->quantities().unknown_quantities()[i].get_name();
+
+              viennashe::util::profiler_scope assemble_scope("assemble");
+              viennashe::util::profiler_scope assemble_quantity_scope(quantity_name);
               // System for this quantity only:
               MatrixType A(number_of_unknowns, number_of_unknowns);
               VectorType b(number_of_unknowns);
+              viennashe::util::tracked_memory system_matrix_memory("system_matrix");
 
               viennashe::assemble(this->device(), this->quantities(), this->config(), this->quantities().unknown_quantities()[i], A, b);
-              log::info<log_simulator>() << " Assemble TIME:"  << std::fixed      << std::setprecision(3) << std::setw(8) << stopwatch.get() << std::endl;
-
+              assemble_quantity_scope.count("unknowns", static_cast<double>(number_of_unknowns));
+              assemble_quantity_scope.count("nonzeros", static_cast<double>(A.nnz()));
+              system_matrix_memory.set(viennashe::util::memory_bytes(A) + viennashe::util::memory_bytes(b));
+              assemble_quantity_scope.stop();
+              assemble_scope.stop();
+
+              viennashe::util::profiler_scope solve_scope("solve");
+              viennashe::util::profiler_scope solve_quantity_scope(quantity_name);
               VectorType x = solve(A, b);
+              solve_quantity_scope.stop();
+              solve_scope.stop();
 
+              viennashe::util::profiler_scope update_scope("update");
               if (this->quantities().unknown_quantities()[i].get_name() == viennashe::quantity::potential())
               {
                 potential_norm_increment = viennashe::math::norm_2(x);
@@ -1059,18 +1305,31 @@ namespace viennashe
               std::size_t number_of_unknowns = quan_unknowns.first + quan_unknowns.second;
               if (number_of_unknowns == 0)
                 continue;
-              stopwatch2.start();
+              std::string const & quantity_name = this->quantities().unknown_she_quantities()[i].get_name();
+
+              viennashe::util::profiler_scope assemble_scope("assemble");
+              viennashe::util::profiler_scope assemble_quantity_scope(quantity_name);
               // System for this quantity only:
               MatrixType A(number_of_unknowns, number_of_unknowns);
               VectorType b(number_of_unknowns);
+              viennashe::util::tracked_memory system_matrix_memory("system_matrix");
 
               viennashe::she::assemble(device(), transferred_quantities, this->quantities(), this->config(),
-                                        this->quantities().unknown_she_quantities()[i], A, b,
+                                        this->quantities().unknown_she_quantities()[i], *this->coupling_matrices(), A, b,
                                         (quantities_history_.size() > 1), nonlinear_iter > 1);
-              log::info<log_simulator>() << " Assemble TIME:"  << std::fixed      << std::setprecision(3) << std::setw(8) << stopwatch.get() << std::endl;
-
+              assemble_quantity_scope.count("unknowns", static_cast<double>(number_of_unknowns));
+              assemble_quantity_scope.count("nonzeros", static_cast<double>(A.nnz()));
+              system_matrix_memory.set(viennashe::util::memory_bytes(A) + viennashe::util::memory_bytes(b));
+              assemble_quantity_scope.stop();
+              assemble_scope.stop();
+
+              viennashe::util::profiler_scope solve_scope("solve");
+              viennashe::util::profiler_scope solve_quantity_scope(quantity_name);
               VectorType x = viennashe::she::solve(this->device(), this->quantities().unknown_she_quantities()[i], this->config(), A, b, quan_unknowns.first);
+              solve_quantity_scope.stop();
+              solve_scope.stop();
 
+              viennashe::util::profiler_scope update_scope("update");
               current_residual_norm += viennashe::math::norm_2(b);
 
 
@@ -1102,6 +1361,36 @@ namespace viennashe
                                      << std::scientific << std::setprecision(3) << std::setw(9) << total_update_norm        << " | "
                                      << std::fixed      << std::setprecision(3) << std::setw(8) << stopwatch.get() << std::endl;
 
+          // Report progress:
+          nonlinear_iteration_info info;
+          info.iteration              = nonlinear_iter;
+          info.max_iterations         = this->config().nonlinear_solver().max_iters();
+          info.residual_norm          = current_residual_norm;
+          info.potential_update_norm  = potential_norm_increment;
+          info.total_update_norm      = total_update_norm;
+          info.iteration_seconds      = stopwatch.get();
+          info.elapsed_seconds        = elapsed.get();
+          info.unknowns               = 0;
+          for (viennashe::map_info_type::const_iterator it = map_info.begin(); it != map_info.end(); ++it)
+            info.unknowns += it->second.first + it->second.second;
+          info.electron_even_unknowns = map_info[viennashe::quantity::electron_distribution_function()].first;
+          info.electron_odd_unknowns  = map_info[viennashe::quantity::electron_distribution_function()].second;
+          info.hole_even_unknowns     = map_info[viennashe::quantity::hole_distribution_function()].first;
+          info.hole_odd_unknowns      = map_info[viennashe::quantity::hole_distribution_function()].second;
+          info.converged              = break_after_update || !current_residual_norm;
+
+          {
+            std::lock_guard<std::mutex> lock(progress_mutex_);
+            last_iteration_ = info;
+          }
+
+          if (iteration_callback_ && iteration_callback_(info) && !info.converged)
+          {
+            log::info<log_simulator>() << "* run(): Simulation cancelled by the iteration callback after iteration " << nonlinear_iter << std::endl;
+            cancelled_ = true;
+            break;
+          }
+
           // push every nonlinear iteration state:
           //quantities_history_.push_back(quantities());
 
@@ -1134,6 +1423,8 @@ namespace viennashe
 
       }
 
+    public:
+
 
       /** @brief Returns the controller object. Const version. */
       SHETimeStepQuantitiesT const & quantities() const { return quantities_history_.back(); }
@@ -1199,13 +1490,50 @@ namespace viennashe
       void advance_in_time()
       {
         quantities_history_.push_back(quantities());
-        detail::set_boundary_for_material(device(), quantities().get_unknown_quantity(viennashe::quantity::potential()), materials::checker(MATERIAL_CONDUCTOR_ID), boundary_potential_accessor<DeviceType>(device()), BOUNDARY_DIRICHLET);
+        detail::set_boundary_for_material(device(), quantities().get_unknown_quantity(viennashe::quantity::potential()), materials::checker(MATERIAL_CONDUCTOR_ID),
+                                          detail::simulator_boundary_potential_accessor<DeviceType>(device(), contact_potentials_), BOUNDARY_DIRICHLET);
       }
 
       // the following is for compatibility reasons:
       ResultQuantityType dg_pot_n() const { return quantities().dg_pot_n(); }
       ResultQuantityType dg_pot_p() const { return quantities().dg_pot_p(); }
 
+      /** @brief Returns the profiler, which records the time spent in the phases of run() as well as the peak memory of each phase.
+       *         Use write_json() or write_csv() for a report, or peak_memory() to query the peak memory of a phase. */
+      viennashe::util::profiler const & profiler() const { return profiler_; }
+      viennashe::util::profiler       & profiler()       { return profiler_; }
+
+      /** @brief Sets a callback, which is invoked after each nonlinear iteration of run() with the norms, timings and unknown counts of the iteration.
+       *
+       * If the callback returns true, run() stops after the current iteration and cancelled() returns true. Pass an empty function to remove the callback.
+       * The callback is invoked on the thread calling run(). Exceptions thrown by the callback are propagated to the caller of run().
+       */
+      void set_iteration_callback(iteration_callback_type const & callback) { iteration_callback_ = callback; }
+
+      /** @brief Returns the state of the last nonlinear iteration (of the current or the last call to run()). May be called from any thread. */
+      nonlinear_iteration_info last_iteration() const
+      {
+        std::lock_guard<std::mutex> lock(progress_mutex_);
+        return last_iteration_;
+      }
+
+      /** @brief Returns true if the last call to run() has been cancelled by the iteration callback or by cancel() */
+      bool cancelled() const { return cancelled_; }
+
+      /** @brief Requests cancellation of the current call to run(). May be called from any thread.
+       *
+       * run() returns at the next boundary of a nonlinear iteration or of an iteration of the Krylov solver, and cancelled() returns true.
+       * The quantities keep the state of the last completed update. The request is cleared when run() returns,
+       * a request made while run() is not in progress cancels the next call to run() right away (cf. clear_cancel_request()).
+       */
+      void cancel() { cancel_requested_ = true; }
+
+      /** @brief Withdraws a request made by cancel() which has not been served by run() yet */
+      void clear_cancel_request() { cancel_requested_ = false; }
+
+      /** @brief Returns true if cancel() has been called and the request has not been served by run() yet */
+      bool cancel_requested() const { return cancel_requested_; }
+
       /** @brief Returns the config object used by the simulator controller */
       viennashe::config const & config() const { return config_; }
       viennashe::config       & config()       { return config_; }
@@ -1264,13 +1592,22 @@ namespace viennashe
         }
 
         // Step 2: Normalize matrix rows:
+        viennashe::util::profiler_scope normalization_scope("normalization");
         VectorType scale_factors = viennashe::math::row_normalize_system(matrix, rhs);
+        normalization_scope.stop();
 
         // Step 3: Solve
+        viennashe::util::profiler_scope linear_solver_scope("linear_solver");
+        linear_solver_scope.count("unknowns", static_cast<double>(matrix.size1()));
+        linear_solver_scope.count("nonzeros", static_cast<double>(matrix.nnz()));
         VectorType update = viennashe::solvers::solve(matrix, rhs, config().linear_solver());
+        linear_solver_scope.stop();
         // Step 4: Check convergence:
+        viennashe::util::profiler_scope residual_scope("residual");
+        residual_scope.count("nonzeros", static_cast<double>(matrix.nnz()));
         double lin_sol_res = viennashe::math::norm_2(viennashe::math::subtract(viennashe::math::prod(matrix, update), rhs));
         lin_sol_res       /= viennashe::math::norm_2(rhs);
+        residual_scope.stop();
 
         if (lin_sol_res > 1e-3)
           log::warning() << "Warning: Linear solver shows only mild convergence! Residual: " << lin_sol_res << std::endl;
@@ -1540,10 +1877,21 @@ namespace viennashe
       } */
 
       DeviceType * p_device_;
+      bool device_shared_;
+      std::map<std::size_t, double> contact_potentials_;
       viennashe::config config_;
+      std::shared_ptr<viennashe::she::coupling_matrices const> coupling_matrices_;
 
       std::vector<SHETimeStepQuantitiesT> quantities_history_;
 
+      viennashe::util::profiler profiler_;
+
+      iteration_callback_type   iteration_callback_;
+      nonlinear_iteration_info  last_iteration_;
+      mutable std::mutex        progress_mutex_;
+      std::atomic<bool>         cancelled_;
+      std::atomic<bool>         cancel_requested_;
+
   }; //simulator
 
 } //namespace viennashe
@@ -0,0 +1,624 @@
+#ifndef VIENNASHE_SMALL_SIGNAL_HPP
+#define VIENNASHE_SMALL_SIGNAL_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <vector>
+#include <complex>
+#include <utility>
+#include <cmath>
+
+// viennashe
+#include "viennashe/forwards.h"
+#include "viennashe/exception.hpp"
+#include "viennashe/accessors.hpp"
+#include "viennashe/assemble.hpp"
+#include "viennashe/mapping.hpp"
+#include "viennashe/simulator.hpp"
+
+#include "viennashe/math/constants.hpp"
+#include "viennashe/math/linalg_util.hpp"
+#include "viennashe/materials/all.hpp"
+#include "viennashe/models/mobility.hpp"
+#include "viennashe/physics/physics.hpp"
+#include "viennashe/postproc/terminal_current.hpp"
+#include "viennashe/solvers/forwards.h"
+#include "viennashe/util/misc.hpp"
+#include "viennashe/util/dual_box_flux.hpp"
+
+#include "viennashe/log/log.hpp"
+#include "viennashe/log_keys.h"
+
+/** @file viennashe/small_signal.hpp
+    @brief Small-signal (AC) analysis around a converged steady state of the drift-diffusion simulator.
+
+    For each frequency f the linear system (J + i omega M) dx = db is solved, where J is the Newton Jacobian at the
+    operating point, M holds the storage terms of the continuity equations and db is the derivative of the load vector
+    with respect to the voltage applied at one of the contacts. The terminal admittances Y_kj are then obtained from
+    the linearized terminal currents (including the displacement current through the contact surface).
+*/
+
+namespace viennashe
+{
+
+  /** @brief Configuration of a small-signal analysis: frequencies, contacts and the finite-difference voltage step */
+  class small_signal_config
+  {
+    public:
+      typedef long                                      segment_id_type;
+      typedef std::pair<segment_id_type, segment_id_type>  contact_type;
+
+      small_signal_config() : voltage_perturbation_(1e-3), electron_mobility_(0.1430), hole_mobility_(0.0460) {}
+
+      /** @brief Adds a frequency (in Hertz) to the frequency sweep. Frequencies need to be positive. */
+      void add_frequency(double f)
+      {
+        if (f <= 0.0)
+          throw viennashe::invalid_value_exception("small_signal_config::add_frequency(): Frequency must be positive!", f);
+        frequencies_.push_back(f);
+      }
+
+      /** @brief Adds 'points_per_decade' logarithmically spaced frequencies in [f_min, f_max] to the frequency sweep */
+      void add_frequency_sweep(double f_min, double f_max, std::size_t points_per_decade)
+      {
+        if (f_min <= 0.0 || f_max < f_min)
+          throw viennashe::invalid_value_exception("small_signal_config::add_frequency_sweep(): Invalid frequency range!", f_min);
+        if (points_per_decade == 0)
+          throw viennashe::invalid_value_exception("small_signal_config::add_frequency_sweep(): Number of points per decade must be positive!", 0.0);
+
+        const std::size_t num_points = static_cast<std::size_t>(std::floor(std::log10(f_max / f_min) * static_cast<double>(points_per_decade) + 0.5)) + 1;
+        for (std::size_t i=0; i<num_points; ++i)
+          add_frequency(f_min * std::pow(10.0, static_cast<double>(i) / static_cast<double>(points_per_decade)));
+      }
+
+      std::vector<double> const & frequencies() const { return frequencies_; }
+
+      /** @brief Adds a contact given by the ID of the contact segment and the ID of the adjacent semiconductor segment */
+      void add_contact(segment_id_type contact_segment, segment_id_type semiconductor_segment)
+      {
+        contacts_.push_back(contact_type(contact_segment, semiconductor_segment));
+      }
+
+      std::vector<contact_type> const & contacts() const { return contacts_; }
+
+      /** @brief Returns the voltage step (in Volt) used for the finite-difference linearization with respect to the contact voltages */
+      double voltage_perturbation() const { return voltage_perturbation_; }
+      /** @brief Sets the voltage step (in Volt) used for the finite-difference linearization with respect to the contact voltages */
+      void voltage_perturbation(double dv)
+      {
+        if (dv <= 0.0)
+          throw viennashe::invalid_value_exception("small_signal_config::voltage_perturbation(): Voltage perturbation must be positive!", dv);
+        voltage_perturbation_ = dv;
+      }
+
+      /** @brief Returns the constant electron mobility used for the storage terms and the extraction of the terminal currents */
+      double electron_mobility() const { return electron_mobility_; }
+      void electron_mobility(double mu) { electron_mobility_ = mu; }
+
+      /** @brief Returns the constant hole mobility used for the storage terms and the extraction of the terminal currents */
+      double hole_mobility() const { return hole_mobility_; }
+      void hole_mobility(double mu) { hole_mobility_ = mu; }
+
+    private:
+      std::vector<double>        frequencies_;
+      std::vector<contact_type>  contacts_;
+      double voltage_perturbation_;
+      double electron_mobility_;
+      double hole_mobility_;
+  };
+
+
+  /** @brief The result of a small-signal analysis: One complex admittance matrix per frequency */
+  class small_signal_result
+  {
+    public:
+      typedef std::complex<double>   value_type;
+
+      small_signal_result(std::vector<double> const & freqs, std::size_t num_contacts)
+        : frequencies_(freqs), num_contacts_(num_contacts), admittances_(freqs.size() * num_contacts * num_contacts) {}
+
+      std::vector<double> const & frequencies() const { return frequencies_; }
+      std::size_t num_contacts() const { return num_contacts_; }
+
+      /** @brief Returns the admittance Y_ij (in Siemens, or Siemens per unit length/area in 2d/1d) at the frequency with index 'freq_index' */
+      value_type const & admittance(std::size_t freq_index, std::size_t i, std::size_t j) const { return admittances_.at(index(freq_index, i, j)); }
+      value_type       & admittance(std::size_t freq_index, std::size_t i, std::size_t j)       { return admittances_.at(index(freq_index, i, j)); }
+
+      /** @brief Returns the small-signal conductance G_ij = Re(Y_ij) */
+      double conductance(std::size_t freq_index, std::size_t i, std::size_t j) const { return admittance(freq_index, i, j).real(); }
+
+      /** @brief Returns the small-signal capacitance C_ij = Im(Y_ij) / omega */
+      double capacitance(std::size_t freq_index, std::size_t i, std::size_t j) const
+      {
+        return admittance(freq_index, i, j).imag() / (2.0 * viennashe::math::constants::pi * frequencies_.at(freq_index));
+      }
+
+    private:
+      std::size_t index(std::size_t freq_index, std::size_t i, std::size_t j) const { return (freq_index * num_contacts_ + i) * num_contacts_ + j; }
+
+      std::vector<double>      frequencies_;
+      std::size_t              num_contacts_;
+      std::vector<value_type>  admittances_;
+  };
+
+
+  namespace detail
+  {
+    /** @brief Returns the potential on a cell, taking Dirichlet boundary values into account */
+    template <typename QuantityT, typename CellT>
+    double small_signal_potential(QuantityT const & potential, CellT const & cell)
+    {
+      if (potential.get_boundary_type(cell) == BOUNDARY_DIRICHLET)
+        return potential.get_boundary_value(cell);
+      return potential.get_value(cell);
+    }
+
+    /**
+     * @brief Shifts the Dirichlet boundary values of the potential on a contact segment by dV
+     * @param device      The device
+     * @param quantities  The quantities holding the potential
+     * @param contact_id  The segment ID of the contact
+     * @param dV          The voltage shift
+     */
+    template <typename DeviceT>
+    void shift_contact_potential(DeviceT const & device,
+                                 viennashe::she::timestep_quantities<DeviceT> & quantities,
+                                 long contact_id,
+                                 double dV)
+    {
+      typedef typename DeviceT::segment_type                                      SegmentType;
+      typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+
+      typedef typename viennashe::she::timestep_quantities<DeviceT>::unknown_quantity_type   SpatialUnknownType;
+
+      SpatialUnknownType & potential = quantities.get_unknown_quantity(viennashe::quantity::potential());
+
+      CellContainer cells(device.segment(static_cast<typename DeviceT::segment_id_type>(contact_id)));
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      {
+        if (potential.get_boundary_type(*cit) != BOUNDARY_DIRICHLET)
+          continue;
+
+        potential.set_boundary_value(*cit, potential.get_boundary_value(*cit) + dV);
+        potential.set_value(*cit, potential.get_value(*cit) + dV);
+      }
+    }
+
+    /**
+     * @brief Adds 'scale * x' to all spatial unknowns, where x is indexed by the (Newton) mapping of the quantities
+     */
+    template <typename DeviceT, typename VectorType>
+    void add_small_signal_update(DeviceT const & device,
+                                 viennashe::she::timestep_quantities<DeviceT> & quantities,
+                                 VectorType const & x,
+                                 double scale)
+    {
+      typedef typename DeviceT::mesh_type                                         MeshType;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type    CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+
+      typedef typename viennashe::she::timestep_quantities<DeviceT>::unknown_quantity_type   SpatialUnknownType;
+
+      CellContainer cells(device.mesh());
+      for (std::size_t i=0; i<quantities.unknown_quantities().size(); ++i)
+      {
+        SpatialUnknownType & quan = quantities.unknown_quantities()[i];
+
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          const long index = quan.get_unknown_index(*cit);
+          if (index >= 0)
+            quan.set_value(*cit, quan.get_value(*cit) + scale * x[std::size_t(index)]);
+        }
+      }
+    }
+
+    /**
+     * @brief Assembles the storage (mass) matrix of the drift-diffusion system, which is consistent with the scaling of the continuity equations in assemble_dd().
+     *
+     * Only the carrier continuity equations carry a time derivative. Poisson's equation, the density gradient equations and the heat equation are treated quasi-statically.
+     *
+     * @param device      The device
+     * @param ss_conf     The small-signal configuration holding the carrier mobilities
+     * @param quantities  The quantities with a valid Newton mapping
+     * @param M           The mass matrix (diagonal, only nonzeros are written)
+     */
+    template <typename DeviceT, typename MatrixType>
+    void assemble_small_signal_mass(DeviceT const & device,
+                                    small_signal_config const & ss_conf,
+                                    viennashe::she::timestep_quantities<DeviceT> const & quantities,
+                                    MatrixType & M)
+    {
+      typedef typename DeviceT::mesh_type                                         MeshType;
+      typedef typename viennagrid::result_of::const_cell_range<MeshType>::type    CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+
+      typedef typename viennashe::she::timestep_quantities<DeviceT>::unknown_quantity_type   SpatialUnknownType;
+
+      CellContainer cells(device.mesh());
+      for (std::size_t i=0; i<quantities.unknown_quantities().size(); ++i)
+      {
+        SpatialUnknownType const & quan = quantities.unknown_quantities()[i];
+
+        // assemble_dd() uses Scharfetter-Gummel fluxes with unit mobility, i.e. the fluxes are VT / mu times the current densities,
+        // cf. scharfetter_gummel.hpp. Hence the storage term q dn/dt carries the same factor VT / mu.
+        // Electron rows are assembled as +div(J_n), hole rows as -div(J_p), hence the different signs:
+        double polarity = 0;
+        if (quan.get_name() == viennashe::quantity::electron_density())
+          polarity = -1.0 / ss_conf.electron_mobility();
+        else if (quan.get_name() == viennashe::quantity::hole_density())
+          polarity =  1.0 / ss_conf.hole_mobility();
+        else
+          continue;
+
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          const long index = quan.get_unknown_index(*cit);
+          if (index < 0)
+            continue;
+
+          const double VT = viennashe::physics::get_thermal_potential(device.get_lattice_temperature(*cit));
+          M(std::size_t(index), std::size_t(index)) = polarity * viennashe::physics::constants::q * VT * viennagrid::volume(*cit);
+        }
+      }
+    }
+
+    /** @brief Assembles the full Newton system for the given quantities. Returns the load vector, fills the Jacobian if A is not NULL. */
+    template <typename DeviceT, typename MatrixType>
+    std::vector<double> assemble_small_signal_system(DeviceT const & device,
+                                                     viennashe::she::timestep_quantities<DeviceT> & quantities,
+                                                     viennashe::config const & conf,
+                                                     std::size_t num_unknowns,
+                                                     MatrixType * A)
+    {
+      MatrixType A_dummy(A ? 1 : num_unknowns, A ? 1 : num_unknowns);
+      MatrixType & A_used = A ? *A : A_dummy;
+      std::vector<double> b(num_unknowns);
+
+      for (std::size_t i=0; i<quantities.unknown_quantities().size(); ++i)
+        viennashe::assemble(device, quantities, conf, quantities.unknown_quantities()[i], A_used, b);
+
+      return b;
+    }
+
+    /**
+     * @brief Returns the charge on a contact, obtained from the electric displacement field through the contact surface.
+     *
+     * The flux discretization is the same as in assemble_poisson(), hence the result is consistent with the potential solution.
+     */
+    template <typename DeviceT>
+    double contact_charge(DeviceT const & device,
+                          viennashe::she::timestep_quantities<DeviceT> const & quantities,
+                          long contact_id)
+    {
+      typedef typename DeviceT::mesh_type                                           MeshType;
+      typedef typename DeviceT::segment_type                                        SegmentType;
+
+      typedef typename viennagrid::result_of::point<MeshType>::type                 PointType;
+      typedef typename viennagrid::result_of::cell<MeshType>::type                  CellType;
+
+      typedef typename viennagrid::result_of::const_cell_range<SegmentType>::type   CellContainer;
+      typedef typename viennagrid::result_of::iterator<CellContainer>::type         CellIterator;
+
+      typedef typename viennagrid::result_of::const_facet_range<CellType>::type     FacetOnCellContainer;
+      typedef typename viennagrid::result_of::iterator<FacetOnCellContainer>::type  FacetOnCellIterator;
+
+      typedef typename viennashe::she::timestep_quantities<DeviceT>::unknown_quantity_type   SpatialUnknownType;
+
+      SpatialUnknownType const & potential = quantities.get_unknown_quantity(viennashe::quantity::potential());
+      viennashe::permittivity_accessor<DeviceT> permittivity(device);
+
+      double charge = 0;
+
+      CellContainer cells(device.segment(static_cast<typename DeviceT::segment_id_type>(contact_id)));
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      {
+        PointType centroid_cell = viennagrid::centroid(*cit);
+
+        FacetOnCellContainer facets(*cit);
+        for (FacetOnCellIterator focit = facets.begin(); focit != facets.end(); ++focit)
+        {
+          CellType const * other_cell_ptr = viennashe::util::get_other_cell_of_facet(device.mesh(), *focit, *cit);
+
+          if (!other_cell_ptr) continue;  // boundary of the simulation domain
+          if (viennashe::materials::is_conductor(device.get_material(*other_cell_ptr))) continue;  // still within the contact
+
+          PointType cell_connection = viennagrid::centroid(*other_cell_ptr) - centroid_cell;
+          PointType cell_connection_normalized = cell_connection / viennagrid::norm(cell_connection);
+          PointType facet_unit_normal = viennashe::util::outer_cell_normal_at_facet(*cit, *focit);
+
+          const double connection_len = viennagrid::norm_2(cell_connection);
+          const double weighted_interface_area = viennagrid::volume(*focit) * viennagrid::inner_prod(facet_unit_normal, cell_connection_normalized);
+
+          charge += permittivity(*other_cell_ptr) * weighted_interface_area / connection_len
+                    * (small_signal_potential(potential, *cit) - small_signal_potential(potential, *other_cell_ptr));
+        }
+      }
+
+      return charge;
+    }
+
+    /** @brief Evaluates the terminal currents (conduction current from the contact into the semiconductor) and the contact charges for all contacts */
+    template <typename DeviceT>
+    void small_signal_terminal_response(DeviceT const & device,
+                                        viennashe::config const & conf,
+                                        small_signal_config const & ss_conf,
+                                        viennashe::she::timestep_quantities<DeviceT> const & quantities,
+                                        std::vector<double> & currents,
+                                        std::vector<double> & charges)
+    {
+      typedef typename viennashe::she::timestep_quantities<DeviceT>::unknown_quantity_type   SpatialUnknownType;
+      typedef typename DeviceT::segment_id_type                                              SegmentIdType;
+
+      SpatialUnknownType const & potential = quantities.get_unknown_quantity(viennashe::quantity::potential());
+      SpatialUnknownType const & n_density = quantities.get_unknown_quantity(viennashe::quantity::electron_density());
+      SpatialUnknownType const & p_density = quantities.get_unknown_quantity(viennashe::quantity::hole_density());
+
+      currents.resize(ss_conf.contacts().size());
+      charges.resize(ss_conf.contacts().size());
+
+      for (std::size_t k=0; k<ss_conf.contacts().size(); ++k)
+      {
+        typename DeviceT::segment_type const & contact = device.segment(static_cast<SegmentIdType>(ss_conf.contacts()[k].first));
+        typename DeviceT::segment_type const & semi    = device.segment(static_cast<SegmentIdType>(ss_conf.contacts()[k].second));
+
+        currents[k] = 0;
+        if (conf.with_electrons())
+          currents[k] += viennashe::get_terminal_current(device, viennashe::ELECTRON_TYPE_ID, potential, n_density,
+                                                         viennashe::models::create_constant_mobility_model(device, ss_conf.electron_mobility()),
+                                                         semi, contact);
+        if (conf.with_holes())
+          currents[k] += viennashe::get_terminal_current(device, viennashe::HOLE_TYPE_ID, potential, p_density,
+                                                         viennashe::models::create_constant_mobility_model(device, ss_conf.hole_mobility()),
+                                                         semi, contact);
+
+        charges[k] = contact_charge(device, quantities, ss_conf.contacts()[k].first);
+      }
+    }
+
+    /**
+     * @brief Evaluates the linearized terminal response (currents and charges) along the direction x (plus a contact voltage step if contact_id >= 0)
+     *
+     * Central differences with the voltage step from the small-signal configuration are used.
+     */
+    template <typename DeviceT, typename VectorType>
+    void small_signal_directional_response(DeviceT const & device,
+                                           viennashe::config const & conf,
+                                           small_signal_config const & ss_conf,
+                                           viennashe::she::timestep_quantities<DeviceT> const & quantities,
+                                           VectorType const & x,
+                                           long contact_id,
+                                           std::vector<double> & delta_currents,
+                                           std::vector<double> & delta_charges)
+    {
+      const double dV = ss_conf.voltage_perturbation();
+
+      viennashe::she::timestep_quantities<DeviceT> quantities_plus  = quantities;
+      viennashe::she::timestep_quantities<DeviceT> quantities_minus = quantities;
+
+      add_small_signal_update(device, quantities_plus,  x,  dV);
+      add_small_signal_update(device, quantities_minus, x, -dV);
+      if (contact_id >= 0)
+      {
+        shift_contact_potential(device, quantities_plus,  contact_id,  dV);
+        shift_contact_potential(device, quantities_minus, contact_id, -dV);
+      }
+
+      std::vector<double> currents_plus, charges_plus, currents_minus, charges_minus;
+      small_signal_terminal_response(device, conf, ss_conf, quantities_plus,  currents_plus,  charges_plus);
+      small_signal_terminal_response(device, conf, ss_conf, quantities_minus, currents_minus, charges_minus);
+
+      delta_currents.resize(currents_plus.size());
+      delta_charges.resize(charges_plus.size());
+      for (std::size_t k=0; k<currents_plus.size(); ++k)
+      {
+        delta_currents[k] = (currents_plus[k] - currents_minus[k]) / (2.0 * dV);
+        delta_charges[k]  = (charges_plus[k]  - charges_minus[k])  / (2.0 * dV);
+      }
+    }
+
+    /**
+     * @brief Solves the complex system (J + i omega M)(x_r + i x_i) = db for several right hand sides db by means of the equivalent real system of twice the size:
+     *
+     *   [ J        -omega M ] [x_r]   [db]
+     *   [ omega M   J       ] [x_i] = [ 0]
+     *
+     * The system is assembled and normalized once, the linear solver sets up its factorization or preconditioner once for all right hand sides.
+     */
+    template <typename MatrixType, typename VectorType>
+    void solve_small_signal_system(MatrixType const & J,
+                                   MatrixType const & M,
+                                   double omega,
+                                   std::vector<VectorType> const & db,
+                                   viennashe::solvers::linear_solver_config const & solver_conf,
+                                   std::vector<VectorType> & x_real,
+                                   std::vector<VectorType> & x_imag)
+    {
+      typedef typename MatrixType::row_type          RowType;
+      typedef typename RowType::const_iterator       AlongRowIterator;
+
+      const std::size_t N = J.size1();
+
+      MatrixType A(2*N, 2*N);
+
+      for (std::size_t i=0; i<N; ++i)
+      {
+        RowType const & J_row = J.row(i);
+        for (AlongRowIterator iter = J_row.begin(); iter != J_row.end(); ++iter)
+        {
+          A(i,     iter->first)     = iter->second;
+          A(N + i, N + iter->first) = iter->second;
+        }
+
+        RowType const & M_row = M.row(i);
+        for (AlongRowIterator iter = M_row.begin(); iter != M_row.end(); ++iter)
+        {
+          A(i,     N + iter->first) = -omega * iter->second;
+          A(N + i, iter->first)     =  omega * iter->second;
+        }
+      }
+
+      // The scaling only depends on the matrix. The row scaling is obtained from a load vector of ones and applied to all right hand sides:
+      VectorType row_scale(2*N, 1.0);
+      VectorType scale_factors = viennashe::math::row_normalize_system(A, row_scale);
+
+      std::vector<VectorType> b(db.size(), VectorType(2*N));
+      for (std::size_t k=0; k<db.size(); ++k)
+        for (std::size_t i=0; i<N; ++i)
+          b[k][i] = db[k][i] * row_scale[i];
+
+      std::vector<VectorType> x = viennashe::solvers::solve(A, b, solver_conf);
+
+      x_real.resize(db.size());
+      x_imag.resize(db.size());
+      for (std::size_t k=0; k<db.size(); ++k)
+      {
+        double lin_sol_res = viennashe::math::norm_2(viennashe::math::subtract(viennashe::math::prod(A, x[k]), b[k]));
+        if (viennashe::math::norm_2(b[k]) > 0)
+          lin_sol_res /= viennashe::math::norm_2(b[k]);
+
+        if (lin_sol_res > 1e-3)
+          log::warning() << "Warning: Small-signal linear solver shows only mild convergence! Residual: " << lin_sol_res << std::endl;
+        if (lin_sol_res > 1)
+        {
+          log::error() << "ERROR: Small-signal linear solver failed to converge properly! Residual: " << lin_sol_res << std::endl;
+          throw viennashe::solver_failed_exception("Small-signal linear solver failed to converge properly!");
+        }
+
+        x_real[k].resize(N);
+        x_imag[k].resize(N);
+        for (std::size_t i=0; i<N; ++i)
+        {
+          x_real[k][i] = x[k][i]     * scale_factors[i];
+          x_imag[k][i] = x[k][N + i] * scale_factors[N + i];
+        }
+      }
+    }
+
+  } // namespace detail
+
+
+  /**
+   * @brief Runs a small-signal (AC) analysis around the steady state currently held by the simulator.
+   *
+   * The simulator needs to have converged (i.e. run() has been called) for the operating point of interest.
+   * The Jacobian is assembled from the drift-diffusion Newton equations, irrespective of the nonlinear solver used for the steady state.
+   * For each contact j the load vector is differentiated with respect to the contact voltage. For each requested frequency the complex system
+   * is set up once and solved for the load vectors of all contacts, and the admittance Y_kj = dI_k/dV_j + i omega dQ_k/dV_j is computed for all contacts k.
+   * Terminal currents use the same sign convention as get_terminal_current(), i.e. the current flowing from the contact into the semiconductor.
+   *
+   * @param sim      The simulator holding the converged steady state
+   * @param ss_conf  The small-signal configuration
+   * @return The admittance matrices for all frequencies
+   */
+  template <typename SimulatorT>
+  small_signal_result small_signal_analysis(SimulatorT const & sim, small_signal_config const & ss_conf)
+  {
+    typedef typename SimulatorT::device_type                         DeviceType;
+    typedef viennashe::she::timestep_quantities<DeviceType>         QuantitiesType;
+    typedef viennashe::math::sparse_matrix<double>                   MatrixType;
+    typedef std::vector<double>                                      VectorType;
+
+    DeviceType const & device = sim.device();
+
+    if (   (sim.config().with_electrons() && sim.config().get_electron_equation() != EQUATION_CONTINUITY)
+        || (sim.config().with_holes()     && sim.config().get_hole_equation()     != EQUATION_CONTINUITY))
+      throw viennashe::unavailable_feature_exception("small_signal_analysis(): Only drift-diffusion equations are supported!");
+
+    if (ss_conf.contacts().size() == 0)
+      throw viennashe::invalid_value_exception("small_signal_analysis(): No contacts specified!", 0.0);
+
+    small_signal_result result(ss_conf.frequencies(), ss_conf.contacts().size());
+
+    // Linearization is always with respect to the coupled (Newton) system:
+    viennashe::config newton_conf(sim.config());
+    newton_conf.nonlinear_solver().set(viennashe::solvers::nonlinear_solver_ids::newton_nonlinear_solver);
+
+    QuantitiesType quantities(sim.quantities());
+    viennashe::map_info_type map_info = viennashe::create_mapping(device, quantities, newton_conf);
+
+    std::size_t num_unknowns = 0;
+    for (viennashe::map_info_type::const_iterator it = map_info.begin(); it != map_info.end(); ++it)
+      num_unknowns += (it->second).first + (it->second).second;
+
+    log::info<log_small_signal>() << "* small_signal_analysis(): Number of unknowns: " << num_unknowns
+                                  << ", contacts: " << ss_conf.contacts().size()
+                                  << ", frequencies: " << ss_conf.frequencies().size() << std::endl;
+
+    MatrixType J(num_unknowns, num_unknowns);
+    detail::assemble_small_signal_system(device, quantities, newton_conf, num_unknowns, &J);
+
+    MatrixType M(num_unknowns, num_unknowns);
+    detail::assemble_small_signal_mass(device, ss_conf, quantities, M);
+
+    const double dV = ss_conf.voltage_perturbation();
+    const std::size_t num_contacts = ss_conf.contacts().size();
+
+    //
+    // Derivatives of the load vector with respect to the voltage at each contact j (b = -F, thus J dx = db):
+    //
+    std::vector<VectorType> db(num_contacts, VectorType(num_unknowns));
+    for (std::size_t j=0; j<num_contacts; ++j)
+    {
+      const long contact_j = ss_conf.contacts()[j].first;
+
+      QuantitiesType quantities_plus(quantities);
+      QuantitiesType quantities_minus(quantities);
+      detail::shift_contact_potential(device, quantities_plus,  contact_j,  dV);
+      detail::shift_contact_potential(device, quantities_minus, contact_j, -dV);
+
+      VectorType b_plus  = detail::assemble_small_signal_system<DeviceType, MatrixType>(device, quantities_plus,  newton_conf, num_unknowns, NULL);
+      VectorType b_minus = detail::assemble_small_signal_system<DeviceType, MatrixType>(device, quantities_minus, newton_conf, num_unknowns, NULL);
+
+      for (std::size_t i=0; i<num_unknowns; ++i)
+        db[j][i] = (b_plus[i] - b_minus[i]) / (2.0 * dV);
+    }
+
+    for (std::size_t f=0; f<ss_conf.frequencies().size(); ++f)
+    {
+      const double omega = 2.0 * viennashe::math::constants::pi * ss_conf.frequencies()[f];
+
+      // one system per frequency, solved for all contacts at once:
+      std::vector<VectorType> x_real, x_imag;
+      detail::solve_small_signal_system(J, M, omega, db, sim.config().linear_solver(), x_real, x_imag);
+
+      for (std::size_t j=0; j<num_contacts; ++j)
+      {
+        const long contact_j = ss_conf.contacts()[j].first;
+
+        std::vector<double> dI_real, dQ_real, dI_imag, dQ_imag;
+        detail::small_signal_directional_response(device, newton_conf, ss_conf, quantities, x_real[j], contact_j, dI_real, dQ_real);
+        detail::small_signal_directional_response(device, newton_conf, ss_conf, quantities, x_imag[j],        -1, dI_imag, dQ_imag);
+
+        for (std::size_t k=0; k<num_contacts; ++k)
+        {
+          // Y = dI + i omega dQ, with dI = dI_real + i dI_imag and dQ = dQ_real + i dQ_imag:
+          result.admittance(f, k, j) = std::complex<double>(dI_real[k] - omega * dQ_imag[k],
+                                                            dI_imag[k] + omega * dQ_real[k]);
+        }
+
+        log::info<log_small_signal>() << "* small_signal_analysis(): f = " << ss_conf.frequencies()[f]
+                                      << " Hz, contact " << contact_j << ": Y_jj = " << result.admittance(f, j, j) << std::endl;
+      }
+    }
+
+    return result;
+  }
+
+} //namespace viennashe
+
+#endif
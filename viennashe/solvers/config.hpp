@@ -17,6 +17,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 
 #include "viennashe/forwards.h"
 
@@ -45,7 +46,8 @@ namespace viennashe
           parallel_linear_solver,      /// multi-threaded solver (block ILUT)
           gpu_parallel_linear_solver, /// gpu-assisted solver (block ILUT)
           petsc_parallel_linear_solver, /// PETSC-assisted solver (Hypre AMG)
-	  petsc_parallel_AMGX_solver   /// gpu/PETSC-assisted solver
+	  petsc_parallel_AMGX_solver,   /// gpu/PETSC-assisted solver
+          schwarz_linear_solver        /// multi-threaded solver (overlapping Schwarz decomposition)
         };
     };
 
@@ -57,10 +59,13 @@ namespace viennashe
     {
       public:
         typedef std::vector<std::pair<std::size_t, std::size_t> > block_preconditioner_boundaries_container;
+        typedef std::vector<long> schwarz_partition_container;
 
         linear_solver_config()
             : id_(linear_solver_ids::serial_linear_solver), tol_(1e-13), max_iters_(
-                1000), ilut_entries_(60), ilut_drop_tol_(1e-4), do_scale_(true)
+                1000), ilut_entries_(60), ilut_drop_tol_(1e-4), do_scale_(true),
+                schwarz_subdomains_(0), schwarz_overlap_(1), schwarz_restricted_(true),
+                schwarz_segment_partition_(false), cancel_flag_(NULL)
         {
         }
 
@@ -90,6 +95,7 @@ namespace viennashe
             case parallel_linear_solver:
             case petsc_parallel_linear_solver:
             case petsc_parallel_AMGX_solver:
+            case schwarz_linear_solver:
 #ifdef VIENNASHE_HAVE_GPU_SOLVER
               case gpu_parallel_linear_solver:
 #endif
@@ -124,6 +130,10 @@ namespace viennashe
           {
             id_ = petsc_parallel_AMGX_solver;
           }
+          else if (solver_name == "schwarz_linear_solver")
+          {
+            id_ = schwarz_linear_solver;
+          }
 #ifdef VIENNASHE_HAVE_GPU_SOLVER
           else if (solver_name == "gpu_parallel_linear_solver")
           {
@@ -193,7 +203,79 @@ namespace viennashe
         {
           return block_precond_boundaries_;
         }
+
+        /** @brief Returns the number of subdomains of the Schwarz preconditioner. Zero means one subdomain per thread. */
+        std::size_t schwarz_subdomains() const
+        {
+          return schwarz_subdomains_;
+        }
+        /** @brief Sets the number of subdomains of the Schwarz preconditioner if no explicit partition is given. Zero means one subdomain per thread. */
+        void schwarz_subdomains(std::size_t num)
+        {
+          schwarz_subdomains_ = num;
+        }
+
+        /** @brief Returns the number of layers of neighboring unknowns added to each Schwarz subdomain */
+        std::size_t schwarz_overlap() const
+        {
+          return schwarz_overlap_;
+        }
+        /** @brief Sets the number of layers of neighboring unknowns added to each Schwarz subdomain */
+        void schwarz_overlap(std::size_t num)
+        {
+          schwarz_overlap_ = num;
+        }
+
+        /** @brief Returns whether the restricted additive Schwarz (RAS) variant is used (true) or the classical additive variant (false) */
+        bool schwarz_restricted() const
+        {
+          return schwarz_restricted_;
+        }
+        /** @brief Selects the restricted additive Schwarz (RAS) variant (true) or the classical additive variant (false) */
+        void schwarz_restricted(bool value)
+        {
+          schwarz_restricted_ = value;
+        }
+
+        /** @brief Returns whether the Schwarz subdomains are obtained from the device segments (true) or from a partitioning of the matrix graph (false) */
+        bool schwarz_segment_partition() const
+        {
+          return schwarz_segment_partition_;
+        }
+        /** @brief Selects whether the Schwarz subdomains are obtained from the device segments (true) or from a partitioning of the matrix graph (false) */
+        void schwarz_segment_partition(bool value)
+        {
+          schwarz_segment_partition_ = value;
+        }
+
+        /** @brief The subdomain ID of each unknown for the Schwarz preconditioner. If empty, a partitioning of the matrix graph is computed. */
+        schwarz_partition_container & schwarz_partition()
+        {
+          return schwarz_partition_;
+        }
+        schwarz_partition_container const & schwarz_partition() const
+        {
+          return schwarz_partition_;
+        }
         
+        /** @brief Sets a flag which is polled by the iterative solvers between Krylov iterations. Once the flag is set,
+         *         the solvers throw a cancelled_exception. NULL (default) disables cancellation. The flag is not owned.
+         */
+        void cancellation_flag(std::atomic<bool> const * flag)
+        {
+          cancel_flag_ = flag;
+        }
+        std::atomic<bool> const * cancellation_flag() const
+        {
+          return cancel_flag_;
+        }
+
+        /** @brief Returns true if cancellation of the solver has been requested through the cancellation flag */
+        bool cancel_requested() const
+        {
+          return cancel_flag_ != NULL && cancel_flag_->load();
+        }
+
         int getArgc() const
         {
           return argc;
@@ -229,6 +311,12 @@ namespace viennashe
         double ilut_drop_tol_;
         block_preconditioner_boundaries_container block_precond_boundaries_;
         bool do_scale_;
+        std::size_t schwarz_subdomains_;
+        std::size_t schwarz_overlap_;
+        bool schwarz_restricted_;
+        bool schwarz_segment_partition_;
+        schwarz_partition_container schwarz_partition_;
+        std::atomic<bool> const * cancel_flag_;
     };
 
     //
@@ -50,6 +50,17 @@ namespace viennashe
       virtual ~invalid_nonlinear_solver_exception() throw() {}
     };
 
+
+    /** @brief Exception thrown by the linear solvers if cancellation has been requested (cf. linear_solver_config::cancellation_flag())
+      *
+      */
+    class cancelled_exception : public std::runtime_error
+    {
+    public:
+      cancelled_exception() : std::runtime_error("* ViennaSHE: Solver cancelled.") {}
+      virtual ~cancelled_exception() throw() {}
+    };
+
   }
 }
 
@@ -40,6 +40,19 @@ namespace viennashe
           std::vector<double> const & b,
           linear_solver_config const & config);
 
+    /** @brief Public interface for solving a system of linear equations for several right hand sides.
+    *
+    * The factorization (dense solver) or the preconditioner (serial solver) is set up only once and reused for all right hand sides.
+    *
+    * @param A        The system matrix
+    * @param b        The load vectors
+    * @param config   Linear solver configuration object
+    */
+    std::vector<std::vector<double> >
+    solve(viennashe::math::sparse_matrix<double> & A,
+          std::vector<std::vector<double> > const & b,
+          linear_solver_config const & config);
+
 
     /** @brief Public interface for solving a system of linear equations using a dense matrix
     *
@@ -0,0 +1,156 @@
+#ifndef VIENNASHE_UTIL_HARDWARE_COUNTERS_HPP
+#define VIENNASHE_UTIL_HARDWARE_COUNTERS_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__) && !defined(VIENNASHE_DISABLE_HARDWARE_COUNTERS)
+  #define VIENNASHE_HAVE_PERF_EVENTS
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+/** @file viennashe/util/hardware_counters.hpp
+    @brief Reads hardware performance counters (cycles, instructions, last level cache misses, branch misses) of the calling thread via perf_event_open() on Linux.
+           Define VIENNASHE_DISABLE_HARDWARE_COUNTERS to compile without support.
+*/
+
+namespace viennashe
+{
+  namespace util
+  {
+
+    /** @brief The hardware events read by hardware_counters */
+    enum hardware_event_id
+    {
+      HARDWARE_CYCLES = 0,
+      HARDWARE_INSTRUCTIONS,
+      HARDWARE_LLC_MISSES,
+      HARDWARE_BRANCH_MISSES,
+      HARDWARE_EVENT_NUM
+    };
+
+    /** @brief Returns the name of a hardware event as used for the counters of the profiler */
+    inline char const * hardware_event_name(std::size_t id)
+    {
+      static char const * names[HARDWARE_EVENT_NUM] = { "cycles", "instructions", "llc_misses", "branch_misses" };
+      return (id < HARDWARE_EVENT_NUM) ? names[id] : "";
+    }
+
+    /** @brief Counts hardware events of the calling thread (user space only) from construction on.
+     *
+     * Each event is opened separately, so that events not supported by the CPU or the hypervisor are skipped individually.
+     * If no event can be opened (other operating systems, insufficient permissions as set by /proc/sys/kernel/perf_event_paranoid,
+     * or no performance monitoring unit), available() returns false and all values read are zero.
+     * Only the thread which constructed the object is measured, not threads spawned by it.
+     */
+    class hardware_counters
+    {
+      public:
+        hardware_counters()
+        {
+          for (std::size_t i=0; i<HARDWARE_EVENT_NUM; ++i)
+            fds_[i] = -1;
+          open();
+        }
+
+        ~hardware_counters()
+        {
+#ifdef VIENNASHE_HAVE_PERF_EVENTS
+          for (std::size_t i=0; i<HARDWARE_EVENT_NUM; ++i)
+            if (fds_[i] >= 0)
+              ::close(fds_[i]);
+#endif
+        }
+
+        /** @brief Returns true if at least one event is counted */
+        bool available() const
+        {
+          for (std::size_t i=0; i<HARDWARE_EVENT_NUM; ++i)
+            if (fds_[i] >= 0)
+              return true;
+          return false;
+        }
+
+        /** @brief Returns true if the given event is counted */
+        bool available(std::size_t id) const { return id < HARDWARE_EVENT_NUM && fds_[id] >= 0; }
+
+        /** @brief Returns the reason why events are not available, empty if all events are counted */
+        std::string const & error() const { return error_; }
+
+        /** @brief Reads the current values of all events. Values are extrapolated if the kernel multiplexes the counters. Unavailable events read zero. */
+        void read(double (&values)[HARDWARE_EVENT_NUM]) const
+        {
+          for (std::size_t i=0; i<HARDWARE_EVENT_NUM; ++i)
+          {
+            values[i] = 0;
+#ifdef VIENNASHE_HAVE_PERF_EVENTS
+            if (fds_[i] < 0)
+              continue;
+
+            unsigned long long buffer[3]; // value, time enabled, time running
+            if (::read(fds_[i], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer)) || buffer[2] == 0)
+              continue;
+            values[i] = static_cast<double>(buffer[0]);
+            if (buffer[2] < buffer[1])
+              values[i] *= static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]);
+#endif
+          }
+        }
+
+      private:
+        hardware_counters(hardware_counters const &);
+        hardware_counters & operator=(hardware_counters const &);
+
+        void open()
+        {
+#ifdef VIENNASHE_HAVE_PERF_EVENTS
+          static const unsigned long long configs[HARDWARE_EVENT_NUM] = { PERF_COUNT_HW_CPU_CYCLES,
+                                                                          PERF_COUNT_HW_INSTRUCTIONS,
+                                                                          PERF_COUNT_HW_CACHE_MISSES,
+                                                                          PERF_COUNT_HW_BRANCH_MISSES };
+          for (std::size_t i=0; i<HARDWARE_EVENT_NUM; ++i)
+          {
+            struct perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size           = sizeof(attr);
+            attr.type           = PERF_TYPE_HARDWARE;
+            attr.config         = configs[i];
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fds_[i] = static_cast<int>(::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[i] < 0)
+              error_ += std::string(error_.empty() ? "" : ", ") + hardware_event_name(i) + ": " + std::strerror(errno);
+          }
+#else
+          error_ = "Hardware counters are not supported on this platform";
+#endif
+        }
+
+        int          fds_[HARDWARE_EVENT_NUM];
+        std::string  error_;
+    };
+
+  } //namespace util
+} //namespace viennashe
+
+#endif
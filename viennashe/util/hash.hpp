@@ -0,0 +1,82 @@
+#ifndef VIENNASHE_UTIL_HASH_HPP
+#define VIENNASHE_UTIL_HASH_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <string>
+
+// viennagrid
+#include "viennagrid/mesh/mesh.hpp"
+
+// viennashe
+#include "viennashe/forwards.h"
+
+/** @file viennashe/util/hash.hpp
+    @brief Non-cryptographic hashes for detecting modified files and meshes.
+*/
+
+namespace viennashe
+{
+  namespace util
+  {
+    /** @brief 64-bit FNV-1a hash, which can be continued over several blocks of data by passing the previous result as 'hash' */
+    inline unsigned long long fnv1a_hash(char const * data, std::size_t num_bytes, unsigned long long hash = 14695981039346656037ULL)
+    {
+      for (std::size_t i=0; i<num_bytes; ++i)
+      {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+      }
+      return hash;
+    }
+
+    inline unsigned long long fnv1a_hash(std::string const & str)
+    {
+      return fnv1a_hash(str.data(), str.size());
+    }
+
+    /** @brief Returns a hash of the topology of a mesh: The number of vertices and the vertex IDs of all cells in the order of the cell IDs.
+     *
+     * Used to check that data stored per cell belongs to the mesh it is loaded onto. Coordinates are not included, so that scaled meshes match.
+     */
+    template <typename MeshT>
+    unsigned long long mesh_hash(MeshT const & mesh)
+    {
+      typedef typename viennagrid::result_of::cell<MeshT>::type                         CellType;
+      typedef typename viennagrid::result_of::const_cell_range<MeshT>::type             CellContainer;
+      typedef typename viennagrid::result_of::const_vertex_range<CellType>::type        VertexOnCellContainer;
+      typedef typename viennagrid::result_of::iterator<VertexOnCellContainer>::type     VertexOnCellIterator;
+
+      long long num_vertices = static_cast<long long>(viennagrid::vertices(mesh).size());
+      unsigned long long hash = fnv1a_hash(reinterpret_cast<char const *>(&num_vertices), sizeof(num_vertices));
+
+      CellContainer cells(mesh);
+      for (std::size_t i=0; i<cells.size(); ++i)
+      {
+        VertexOnCellContainer vertices_on_cell(cells[i]);
+        for (VertexOnCellIterator vocit = vertices_on_cell.begin(); vocit != vertices_on_cell.end(); ++vocit)
+        {
+          long long id = static_cast<long long>(vocit->id().get());
+          hash = fnv1a_hash(reinterpret_cast<char const *>(&id), sizeof(id), hash);
+        }
+      }
+      return hash;
+    }
+
+  } //namespace util
+} //namespace viennashe
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef VIENNASHE_UTIL_MEMORY_HPP
+#define VIENNASHE_UTIL_MEMORY_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <map>
+#include <vector>
+
+// viennashe
+#include "viennashe/math/linalg_util.hpp"
+
+/** @file viennashe/util/memory.hpp
+    @brief Functions returning the number of bytes held by the containers used in ViennaSHE. Used for memory accounting, cf. tracked_memory.
+*/
+
+namespace viennashe
+{
+  namespace util
+  {
+    /** @brief Returns the number of bytes allocated by a vector */
+    template <typename T>
+    double memory_bytes(std::vector<T> const & v)
+    {
+      return static_cast<double>(v.capacity()) * sizeof(T);
+    }
+
+    /** @brief Returns the number of bytes allocated by a vector of bits */
+    inline double memory_bytes(std::vector<bool> const & v)
+    {
+      return static_cast<double>(v.capacity()) / 8.0;
+    }
+
+    /** @brief Returns the number of bytes allocated by a vector of vectors, including the inner vectors */
+    template <typename T>
+    double memory_bytes(std::vector<std::vector<T> > const & v)
+    {
+      double result = static_cast<double>(v.capacity()) * sizeof(std::vector<T>);
+      for (std::size_t i=0; i<v.size(); ++i)
+        result += memory_bytes(v[i]);
+      return result;
+    }
+
+    /** @brief Returns the (approximate) number of bytes per nonzero of viennashe::math::sparse_matrix:
+     *         The entry itself plus the color and the three links of a node of the red-black tree of std::map */
+    template <typename NumericT>
+    double sparse_matrix_bytes_per_nonzero()
+    {
+      return static_cast<double>(sizeof(std::pair<const std::size_t, NumericT>) + 4 * sizeof(void *));
+    }
+
+    /** @brief Returns the (approximate) number of bytes held by a sparse matrix */
+    template <typename NumericT>
+    double memory_bytes(viennashe::math::sparse_matrix<NumericT> const & A)
+    {
+      return static_cast<double>(A.size1()) * sizeof(std::map<std::size_t, NumericT>)
+           + static_cast<double>(A.nnz())   * sparse_matrix_bytes_per_nonzero<NumericT>();
+    }
+
+    /** @brief Returns the number of bytes of a matrix in compressed sparse row format with 32-bit indices, as used by the linear solvers */
+    template <typename NumericT>
+    double compressed_matrix_bytes(std::size_t rows, std::size_t nonzeros)
+    {
+      return static_cast<double>(rows + 1) * sizeof(unsigned int) + static_cast<double>(nonzeros) * (sizeof(unsigned int) + sizeof(NumericT));
+    }
+
+  } //namespace util
+} //namespace viennashe
+
+#endif
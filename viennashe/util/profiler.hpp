@@ -0,0 +1,645 @@
+#ifndef VIENNASHE_UTIL_PROFILER_HPP
+#define VIENNASHE_UTIL_PROFILER_HPP
+
+/* ============================================================================
+   Copyright (c) 2011-2014, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+     ViennaSHE - The Vienna Spherical Harmonics Expansion Boltzmann Solver
+                            -----------------
+
+                    http://viennashe.sourceforge.net/
+
+   License:         MIT (X11), see file LICENSE in the base directory
+=============================================================================== */
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// viennashe
+#include "viennashe/io/exception.hpp"
+#include "viennashe/util/hardware_counters.hpp"
+
+/** @file viennashe/util/profiler.hpp
+    @brief A hierarchical profiler for the phases of a simulation (assembly, elimination, linear solver, etc.) with JSON and CSV reports.
+*/
+
+namespace viennashe
+{
+  namespace util
+  {
+
+    /** @brief Collects the wall-clock time spent in nested, named phases.
+     *
+     * Phases are entered and left through profiler_scope objects. A phase entered within another phase becomes its child,
+     * so the same name may appear at several places of the phase tree. The time is accumulated over all calls,
+     * and additionally per run and per nonlinear iteration as set by begin_run() and set_iteration().
+     * A call is attributed to the iteration which was current when the phase was entered.
+     *
+     * In addition, the bytes held by the main data structures are accounted per category (see tracked_memory).
+     * Each phase records the peak of the total as well as the peak of each category observed while the phase was active.
+     *
+     * Optionally, hardware events (cycles, instructions, last level cache misses, branch misses) of the thread entering the phases
+     * are accumulated in the counters of each phase, see enable_hardware_counters().
+     */
+    class profiler
+    {
+      public:
+        static const std::size_t no_parent = static_cast<std::size_t>(-1);
+
+        /** @brief Time spent in a phase during one nonlinear iteration of one run. Iteration 0 refers to the time outside of iterations. */
+        struct iteration_record
+        {
+          std::size_t run;
+          std::size_t iteration;
+          std::size_t calls;
+          double      seconds;
+        };
+
+        /** @brief A node of the phase tree */
+        struct phase
+        {
+          std::string                     name;
+          std::size_t                     parent;
+          std::size_t                     depth;
+          std::size_t                     calls;
+          double                          seconds;
+          double                          min_seconds;
+          double                          max_seconds;
+          std::vector<std::size_t>        children;
+          std::vector<iteration_record>   iterations;
+          std::vector<std::pair<std::string, double> >  counters;   ///< Work done in the phase, e.g. number of unknowns or nonzeros
+          double                          peak_bytes;                 ///< Peak of the total memory accounted while the phase was active
+          std::vector<std::pair<std::string, double> >  peak_memory;  ///< Peak of the memory of each category while the phase was active
+        };
+
+        profiler() : run_(0), iteration_(0), peak_bytes_(0), hardware_counters_enabled_(false) {}
+
+        /** @brief Discards all phases and records. Must not be called while a phase is active. */
+        void reset()
+        {
+          phases_.clear();
+          roots_.clear();
+          stack_.clear();
+          stack_iterations_.clear();
+          stack_hardware_.clear();
+          run_ = 0;
+          iteration_ = 0;
+          memory_.clear();
+          peak_bytes_ = 0;
+        }
+
+        /** @brief Starts a new run (e.g. a call to simulator::run()). Iterations are counted from zero again. */
+        void begin_run() { ++run_; iteration_ = 0; }
+
+        /** @brief Sets the current nonlinear iteration (starting at 1), to which subsequently entered phases are attributed */
+        void set_iteration(std::size_t it) { iteration_ = it; }
+
+        std::size_t run() const { return run_; }
+        std::size_t iteration() const { return iteration_; }
+
+        /** @brief Enters the phase with the given name within the current phase and returns its index. Usually called by profiler_scope. */
+        std::size_t enter(char const * name)
+        {
+          std::size_t parent = stack_.empty() ? no_parent : stack_.back();
+          std::size_t index = find_child(parent, name);
+          if (index == no_parent)
+            index = add_phase(parent, name);
+          stack_.push_back(index);
+          stack_iterations_.push_back(iteration_);
+          update_peak_memory(phases_[index]);
+          if (hardware_counters_enabled_)
+            read_hardware_counters();
+          return index;
+        }
+
+        /** @brief Leaves the phase with the given index, which must be the innermost active phase */
+        void leave(std::size_t index, double seconds)
+        {
+          if (stack_.empty() || stack_.back() != index)
+            return; // unbalanced call, e.g. after reset() -- ignore
+
+          if (!stack_hardware_.empty() && stack_hardware_.back().index == stack_.size() - 1)
+          {
+            hardware_sample start = stack_hardware_.back();
+            stack_hardware_.pop_back();
+
+            double values[HARDWARE_EVENT_NUM];
+            hardware_counters_->read(values);
+            for (std::size_t i=0; i<HARDWARE_EVENT_NUM; ++i)
+              if (hardware_counters_->available(i))
+                add_counter(index, hardware_event_name(i), values[i] - start.values[i]);
+          }
+
+          std::size_t iteration = stack_iterations_.back();
+          stack_.pop_back();
+          stack_iterations_.pop_back();
+
+          phase & p = phases_[index];
+          p.min_seconds = (p.calls == 0 || seconds < p.min_seconds) ? seconds : p.min_seconds;
+          p.max_seconds = (p.calls == 0 || seconds > p.max_seconds) ? seconds : p.max_seconds;
+          p.seconds += seconds;
+          ++p.calls;
+
+          if (p.iterations.empty() || p.iterations.back().run != run_ || p.iterations.back().iteration != iteration)
+          {
+            iteration_record record = { run_, iteration, 0, 0.0 };
+            p.iterations.push_back(record);
+          }
+          ++p.iterations.back().calls;
+          p.iterations.back().seconds += seconds;
+        }
+
+        /** @brief Adds a value to a named counter of a phase, e.g. the number of nonzeros processed. Used for throughput figures. */
+        void add_counter(std::size_t index, char const * name, double value)
+        {
+          std::vector<std::pair<std::string, double> > & counters = phases_.at(index).counters;
+          for (std::size_t i=0; i<counters.size(); ++i)
+          {
+            if (std::strcmp(counters[i].first.c_str(), name) == 0)
+            {
+              counters[i].second += value;
+              return;
+            }
+          }
+          counters.push_back(std::make_pair(std::string(name), value));
+        }
+
+        /** @brief Returns the value of a counter of the phase with the given path, zero if there is no such phase or counter */
+        double counter(std::string const & phase_path, std::string const & name) const
+        {
+          std::size_t index = find(phase_path);
+          if (index == no_parent)
+            return 0.0;
+          for (std::size_t i=0; i<phases_[index].counters.size(); ++i)
+            if (phases_[index].counters[i].first == name)
+              return phases_[index].counters[i].second;
+          return 0.0;
+        }
+
+        /** @brief Enables or disables the sampling of hardware events in each phase. Returns true if at least one event can be counted.
+         *
+         * The events are counted for the thread entering the phases, hence work done by other threads (e.g. in a parallel linear solver) is not included.
+         * If the counters are not available (see hardware_counters), the profiler records wall-clock times and memory only.
+         */
+        bool enable_hardware_counters(bool enable = true)
+        {
+          hardware_counters_enabled_ = enable;
+          if (!enable)
+            return false;
+          open_hardware_counters();
+          return hardware_counters_->available();
+        }
+
+        bool hardware_counters_enabled() const { return hardware_counters_enabled_; }
+
+        /** @brief Returns the reason why hardware events are not counted, empty if all events are available */
+        std::string hardware_counters_error() const
+        {
+          return hardware_counters_ ? hardware_counters_->error() : std::string("Hardware counters not enabled");
+        }
+
+        /** @brief Returns the instructions per cycle of the phase with the given path, zero if not recorded */
+        double instructions_per_cycle(std::string const & phase_path) const
+        {
+          double cycles = counter(phase_path, hardware_event_name(HARDWARE_CYCLES));
+          return (cycles > 0) ? counter(phase_path, hardware_event_name(HARDWARE_INSTRUCTIONS)) / cycles : 0.0;
+        }
+
+        /** @brief Changes the number of bytes currently held by a memory category (e.g. "system_matrix") by the given amount.
+         *         Negative values release memory. Usually called by tracked_memory. */
+        void add_memory(char const * category, double bytes)
+        {
+          std::size_t i = 0;
+          for (; i<memory_.size(); ++i)
+            if (std::strcmp(memory_[i].first.c_str(), category) == 0)
+              break;
+          if (i == memory_.size())
+            memory_.push_back(std::make_pair(std::string(category), 0.0));
+          memory_[i].second += bytes;
+
+          for (std::size_t j=0; j<stack_.size(); ++j)
+            update_peak_memory(phases_[stack_[j]]);
+          peak_bytes_ = std::max(peak_bytes_, memory());
+        }
+
+        /** @brief Returns the number of bytes currently held by a memory category */
+        double memory(std::string const & category) const
+        {
+          for (std::size_t i=0; i<memory_.size(); ++i)
+            if (memory_[i].first == category)
+              return memory_[i].second;
+          return 0.0;
+        }
+
+        /** @brief Returns the total number of bytes currently held by all memory categories */
+        double memory() const
+        {
+          double result = 0;
+          for (std::size_t i=0; i<memory_.size(); ++i)
+            result += memory_[i].second;
+          return result;
+        }
+
+        /** @brief Returns the peak of the total memory accounted since the last reset() */
+        double peak_memory() const { return peak_bytes_; }
+
+        /** @brief Returns the peak memory of the phase with the given path, either in total (empty category) or of a single category.
+         *         Zero if there is no such phase or category. */
+        double peak_memory(std::string const & phase_path, std::string const & category = std::string()) const
+        {
+          std::size_t index = find(phase_path);
+          if (index == no_parent)
+            return 0.0;
+          if (category.empty())
+            return phases_[index].peak_bytes;
+          for (std::size_t i=0; i<phases_[index].peak_memory.size(); ++i)
+            if (phases_[index].peak_memory[i].first == category)
+              return phases_[index].peak_memory[i].second;
+          return 0.0;
+        }
+
+        /** @brief Returns all phases. Children are always stored after their parents. */
+        std::vector<phase> const & phases() const { return phases_; }
+
+        /** @brief Returns the path of a phase, i.e. the names of all enclosing phases separated by '/' */
+        std::string path(std::size_t index) const
+        {
+          std::string result = phases_.at(index).name;
+          for (std::size_t p = phases_[index].parent; p != no_parent; p = phases_[p].parent)
+            result = phases_[p].name + "/" + result;
+          return result;
+        }
+
+        /** @brief Returns the index of the phase with the given path, or no_parent if there is no such phase */
+        std::size_t find(std::string const & phase_path) const
+        {
+          for (std::size_t i=0; i<phases_.size(); ++i)
+            if (path(i) == phase_path)
+              return i;
+          return no_parent;
+        }
+
+        /** @brief Returns the total time of the phase with the given path, zero if the phase was never entered */
+        double seconds(std::string const & phase_path) const
+        {
+          std::size_t index = find(phase_path);
+          return (index == no_parent) ? 0.0 : phases_[index].seconds;
+        }
+
+        /** @brief Returns the time of a phase not spent in any of its child phases */
+        double self_seconds(std::size_t index) const
+        {
+          double result = phases_.at(index).seconds;
+          for (std::size_t i=0; i<phases_[index].children.size(); ++i)
+            result -= phases_[phases_[index].children[i]].seconds;
+          return (result > 0) ? result : 0.0;
+        }
+
+        /** @brief Writes the report as JSON: For each phase the totals as well as the times per run and per iteration */
+        void write_json(std::ostream & stream) const
+        {
+          stream << std::setprecision(9);
+          stream << "{\n  \"runs\": " << run_ << ",\n  \"peak_bytes\": " << peak_bytes_ << ",\n  \"phases\": [";
+          for (std::size_t i=0; i<phases_.size(); ++i)
+          {
+            phase const & p = phases_[i];
+            stream << (i > 0 ? "," : "") << "\n    {";
+            stream << "\"path\": \"" << json_escape(path(i)) << "\", \"name\": \"" << json_escape(p.name) << "\", \"depth\": " << p.depth
+                   << ", \"calls\": " << p.calls << ", \"seconds\": " << p.seconds << ", \"self_seconds\": " << self_seconds(i)
+                   << ", \"min_seconds\": " << p.min_seconds << ", \"max_seconds\": " << p.max_seconds;
+
+            stream << ", \"counters\": {";
+            for (std::size_t j=0; j<p.counters.size(); ++j)
+              stream << (j > 0 ? ", " : "") << "\"" << json_escape(p.counters[j].first) << "\": " << p.counters[j].second;
+            stream << "}";
+
+            stream << ", \"peak_bytes\": " << p.peak_bytes << ", \"peak_memory\": {";
+            for (std::size_t j=0; j<p.peak_memory.size(); ++j)
+              stream << (j > 0 ? ", " : "") << "\"" << json_escape(p.peak_memory[j].first) << "\": " << p.peak_memory[j].second;
+            stream << "}";
+
+            std::vector<iteration_record> runs = per_run(p);
+            stream << ",\n     \"runs\": [";
+            for (std::size_t j=0; j<runs.size(); ++j)
+              stream << (j > 0 ? ", " : "") << "{\"run\": " << runs[j].run << ", \"calls\": " << runs[j].calls << ", \"seconds\": " << runs[j].seconds << "}";
+            stream << "],\n     \"iterations\": [";
+            for (std::size_t j=0; j<p.iterations.size(); ++j)
+              stream << (j > 0 ? ", " : "") << "{\"run\": " << p.iterations[j].run << ", \"iteration\": " << p.iterations[j].iteration
+                     << ", \"calls\": " << p.iterations[j].calls << ", \"seconds\": " << p.iterations[j].seconds << "}";
+            stream << "]}";
+          }
+          stream << "\n  ]\n}\n";
+        }
+
+        /** @brief Writes the report as CSV with one row per phase and scope (total, run, iteration) */
+        void write_csv(std::ostream & stream) const
+        {
+          stream << std::setprecision(9);
+          stream << "path,depth,scope,run,iteration,calls,seconds,self_seconds,counters,peak_memory\n";
+          for (std::size_t i=0; i<phases_.size(); ++i)
+          {
+            phase const & p = phases_[i];
+            std::string prefix = csv_escape(path(i));
+            stream << prefix << "," << p.depth << ",total,,," << p.calls << "," << p.seconds << "," << self_seconds(i) << ",";
+            for (std::size_t j=0; j<p.counters.size(); ++j)
+              stream << (j > 0 ? ";" : "") << csv_escape(p.counters[j].first) << "=" << p.counters[j].second;
+            stream << ",total=" << p.peak_bytes;
+            for (std::size_t j=0; j<p.peak_memory.size(); ++j)
+              stream << ";" << csv_escape(p.peak_memory[j].first) << "=" << p.peak_memory[j].second;
+            stream << "\n";
+
+            std::vector<iteration_record> runs = per_run(p);
+            for (std::size_t j=0; j<runs.size(); ++j)
+              stream << prefix << "," << p.depth << ",run," << runs[j].run << ",," << runs[j].calls << "," << runs[j].seconds << ",,,\n";
+            for (std::size_t j=0; j<p.iterations.size(); ++j)
+              stream << prefix << "," << p.depth << ",iteration," << p.iterations[j].run << "," << p.iterations[j].iteration << ","
+                     << p.iterations[j].calls << "," << p.iterations[j].seconds << ",,,\n";
+          }
+        }
+
+        void write_json(std::string const & filename) const
+        {
+          std::ofstream stream(filename.c_str());
+          if (!stream)
+            throw viennashe::io::cannot_open_file_exception(filename);
+          write_json(stream);
+        }
+
+        void write_csv(std::string const & filename) const
+        {
+          std::ofstream stream(filename.c_str());
+          if (!stream)
+            throw viennashe::io::cannot_open_file_exception(filename);
+          write_csv(stream);
+        }
+
+      private:
+        /** @brief Hardware event counts at the time a phase on the stack was entered */
+        struct hardware_sample
+        {
+          std::size_t index;                        ///< Position of the phase on the stack
+          double      values[HARDWARE_EVENT_NUM];
+        };
+
+        /** @brief Opens the counters for the calling thread, unless already open */
+        void open_hardware_counters()
+        {
+          if (!hardware_counters_ || hardware_thread_ != std::this_thread::get_id())
+          {
+            hardware_counters_.reset(new hardware_counters());
+            hardware_thread_ = std::this_thread::get_id();
+            stack_hardware_.clear();
+          }
+        }
+
+        /** @brief Records the hardware event counts for the innermost phase */
+        void read_hardware_counters()
+        {
+          open_hardware_counters();
+          if (!hardware_counters_->available())
+            return;
+          hardware_sample sample;
+          sample.index = stack_.size() - 1;
+          hardware_counters_->read(sample.values);
+          stack_hardware_.push_back(sample);
+        }
+
+        std::size_t find_child(std::size_t parent, char const * name) const
+        {
+          std::vector<std::size_t> const & candidates = (parent == no_parent) ? roots_ : phases_[parent].children;
+          for (std::size_t i=0; i<candidates.size(); ++i)
+            if (std::strcmp(phases_[candidates[i]].name.c_str(), name) == 0)
+              return candidates[i];
+          return no_parent;
+        }
+
+        std::size_t add_phase(std::size_t parent, char const * name)
+        {
+          phase p;
+          p.name        = name;
+          p.parent      = parent;
+          p.depth       = (parent == no_parent) ? 0 : phases_[parent].depth + 1;
+          p.calls       = 0;
+          p.seconds     = 0;
+          p.min_seconds = 0;
+          p.max_seconds = 0;
+          p.peak_bytes  = 0;
+          phases_.push_back(p);
+
+          std::size_t index = phases_.size() - 1;
+          if (parent == no_parent)
+            roots_.push_back(index);
+          else
+            phases_[parent].children.push_back(index);
+          return index;
+        }
+
+        void update_peak_memory(phase & p)
+        {
+          p.peak_bytes = std::max(p.peak_bytes, memory());
+          for (std::size_t i=0; i<memory_.size(); ++i)
+          {
+            std::size_t j = 0;
+            for (; j<p.peak_memory.size(); ++j)
+              if (p.peak_memory[j].first == memory_[i].first)
+                break;
+            if (j == p.peak_memory.size())
+              p.peak_memory.push_back(std::make_pair(memory_[i].first, 0.0));
+            p.peak_memory[j].second = std::max(p.peak_memory[j].second, memory_[i].second);
+          }
+        }
+
+        static std::vector<iteration_record> per_run(phase const & p)
+        {
+          std::vector<iteration_record> result;
+          for (std::size_t j=0; j<p.iterations.size(); ++j)
+          {
+            if (result.empty() || result.back().run != p.iterations[j].run)
+            {
+              iteration_record record = { p.iterations[j].run, 0, 0, 0.0 };
+              result.push_back(record);
+            }
+            result.back().calls   += p.iterations[j].calls;
+            result.back().seconds += p.iterations[j].seconds;
+          }
+          return result;
+        }
+
+        static std::string json_escape(std::string const & str)
+        {
+          std::string result;
+          for (std::size_t i=0; i<str.size(); ++i)
+          {
+            if (str[i] == '"' || str[i] == '\\')
+              result += '\\';
+            result += str[i];
+          }
+          return result;
+        }
+
+        static std::string csv_escape(std::string const & str)
+        {
+          if (str.find_first_of(",\"") == std::string::npos)
+            return str;
+          std::string result = "\"";
+          for (std::size_t i=0; i<str.size(); ++i)
+          {
+            if (str[i] == '"')
+              result += '"';
+            result += str[i];
+          }
+          return result + "\"";
+        }
+
+        std::vector<phase>         phases_;
+        std::vector<std::size_t>   roots_;
+        std::vector<std::size_t>   stack_;
+        std::vector<std::size_t>   stack_iterations_;
+        std::size_t                run_;
+        std::size_t                iteration_;
+        std::vector<std::pair<std::string, double> >  memory_;
+        double                     peak_bytes_;
+
+        bool                                 hardware_counters_enabled_;
+        std::shared_ptr<hardware_counters>   hardware_counters_;
+        std::thread::id                      hardware_thread_;
+        std::vector<hardware_sample>         stack_hardware_;
+    };
+
+
+    namespace detail
+    {
+      /** @brief The profiler active in the calling thread, or NULL */
+      inline profiler * & active_profiler()
+      {
+        static thread_local profiler * p = NULL;
+        return p;
+      }
+    }
+
+    /** @brief Returns the profiler active in the calling thread, or NULL if there is none */
+    inline profiler * current_profiler() { return detail::active_profiler(); }
+
+    /** @brief Activates a profiler for the calling thread for the lifetime of this object. Restores the previously active profiler afterwards. */
+    class profiler_activation
+    {
+      public:
+        explicit profiler_activation(profiler & p) : previous_(detail::active_profiler()) { detail::active_profiler() = &p; }
+        ~profiler_activation() { detail::active_profiler() = previous_; }
+
+      private:
+        profiler_activation(profiler_activation const &);
+        profiler_activation & operator=(profiler_activation const &);
+
+        profiler * previous_;
+    };
+
+    /** @brief Measures the time from construction to destruction (or stop()) as a phase of the profiler active in the calling thread.
+     *
+     * If no profiler is active (e.g. in worker threads), the scope does nothing.
+     */
+    class profiler_scope
+    {
+        typedef std::chrono::steady_clock     clock_type;
+
+      public:
+        explicit profiler_scope(char const * name) : profiler_(current_profiler()), index_(0)
+        {
+          if (profiler_)
+          {
+            index_ = profiler_->enter(name);
+            start_ = clock_type::now();
+          }
+        }
+
+        explicit profiler_scope(std::string const & name) : profiler_(current_profiler()), index_(0)
+        {
+          if (profiler_)
+          {
+            index_ = profiler_->enter(name.c_str());
+            start_ = clock_type::now();
+          }
+        }
+
+        ~profiler_scope() { stop(); }
+
+        /** @brief Adds a value to a named counter of this phase, see profiler::add_counter() */
+        void count(char const * name, double value)
+        {
+          if (profiler_)
+            profiler_->add_counter(index_, name, value);
+        }
+
+        /** @brief Ends the phase before the end of the enclosing block */
+        void stop()
+        {
+          if (profiler_)
+          {
+            profiler_->leave(index_, std::chrono::duration<double>(clock_type::now() - start_).count());
+            profiler_ = NULL;
+          }
+        }
+
+      private:
+        profiler_scope(profiler_scope const &);
+        profiler_scope & operator=(profiler_scope const &);
+
+        profiler *                profiler_;
+        std::size_t               index_;
+        clock_type::time_point    start_;
+    };
+
+    /** @brief Accounts the bytes held by a data structure in a memory category of the profiler active in the calling thread.
+     *
+     * The bytes are released from the category when the object is destroyed, so it should live as long as the data structure, e.g.
+     * @code
+     *   MatrixType A(n, n);
+     *   viennashe::util::tracked_memory A_memory("system_matrix");
+     *   ... // assemble A
+     *   A_memory.set(viennashe::util::memory_bytes(A));
+     * @endcode
+     * If no profiler is active, nothing is accounted.
+     */
+    class tracked_memory
+    {
+      public:
+        explicit tracked_memory(char const * category, double bytes = 0) : profiler_(current_profiler()), category_(category), bytes_(0) { set(bytes); }
+
+        ~tracked_memory() { set(0); }
+
+        /** @brief Sets the number of bytes currently held by the data structure */
+        void set(double bytes)
+        {
+          if (profiler_ && bytes != bytes_)
+            profiler_->add_memory(category_.c_str(), bytes - bytes_);
+          bytes_ = bytes;
+        }
+
+        double bytes() const { return bytes_; }
+
+      private:
+        tracked_memory(tracked_memory const &);
+        tracked_memory & operator=(tracked_memory const &);
+
+        profiler *     profiler_;
+        std::string    category_;
+        double         bytes_;
+    };
+
+  } //namespace util
+} //namespace viennashe
+
+#endif